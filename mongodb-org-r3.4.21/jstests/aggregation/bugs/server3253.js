@@ -100,5 +100,15 @@ var outputInSystem = db.system.server3253_out;
 assertErrorCode(input, {$out: outputInSystem.getName()}, 17385);
 assert(!collectionExists(outputInSystem));
 
+// indexes are built once all documents are in the temporary collection, so a duplicate key fails
+// the index build and leaves the output collection as it was
+var uniqueOutput = db.server3253_out_unique;
+uniqueOutput.drop();
+assert.commandWorked(uniqueOutput.createIndex({d: 1}, {unique: true}));
+assert.writeOK(uniqueOutput.insert({_id: 0, d: 0}));
+assertErrorCode(input, [{$project: {d: {$literal: 1}}}, {$out: uniqueOutput.getName()}], 16995);
+assert.eq(uniqueOutput.find().toArray(), [{_id: 0, d: 0}]);
+assert.eq(uniqueOutput.getIndexes().length, 2);
+
 // shoudn't leave temp collections laying around
 assert.eq([], listCollections(/tmp\.agg_out/));
@@ -80,3 +80,13 @@ for (var i = 0; i < plans.length; i++) {
     }
     assert(plans[i].reason.stats.hasOwnProperty('stage'), 'no stats inserted for plan ' + i);
 }
+
+// The winning plan reports moving statistics of its runs, and the entry the decisions made about
+// it.
+assert(plans[0].feedback.hasOwnProperty('trialWorks'), tojson(plans[0]));
+assert.gt(plans[0].feedback.executions.works.count, 0, tojson(plans[0]));
+assert.eq(false, plans[0].feedback.needsReevaluation, tojson(plans[0]));
+var res = t.runCommand('planCacheListPlans',
+                       {query: {a: 3, b: 3}, sort: {a: -1}, projection: {_id: 0, a: 1}});
+assert.commandWorked(res);
+assert.eq('cached', res.history[0].reason, tojson(res.history));
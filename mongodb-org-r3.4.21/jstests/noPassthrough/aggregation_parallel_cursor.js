@@ -0,0 +1,116 @@
+// Tests that aggregations which run their leading stages and a partial $group on several threads,
+// each scanning ranges of the collection, return the same results as when run on one thread.
+(function() {
+    "use strict";
+
+    // Scanning ranges of RecordIds needs a storage engine which returns records in that order.
+    var storageEngine = jsTest.options().storageEngine || "wiredTiger";
+    if (storageEngine !== "wiredTiger") {
+        return;
+    }
+
+    var conn = MongoRunner.runMongod(
+        {setParameter: "internalDocumentSourceParallelCursorMinRecords=1000"});
+    assert.neq(null, conn, "mongod was unable to start up");
+    var testDB = conn.getDB("test");
+    var coll = testDB.aggregation_parallel_cursor;
+    coll.drop();
+
+    var numDocs = 20000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, a: i % 13, b: i % 7, c: [i % 3, i % 5], s: "x" + (i % 11)});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Leave some holes in the RecordIds.
+    assert.writeOK(coll.remove({_id: {$gte: 5000, $lt: 9000}}));
+
+    var pipelines = [
+        [{$group: {_id: null, n: {$sum: 1}}}],
+        [
+          {$match: {b: {$lt: 5}}},
+          {$group: {
+              _id: "$a",
+              sum: {$sum: "$b"},
+              avg: {$avg: "$b"},
+              min: {$min: "$_id"},
+              max: {$max: "$_id"},
+              strings: {$addToSet: "$s"},
+          }},
+          // The order of the elements of $addToSet depends on the order of the input.
+          {$addFields: {strings: {$size: "$strings"}}},
+          {$sort: {_id: 1}},
+        ],
+        [
+          {$addFields: {d: {$multiply: ["$a", "$b"]}}},
+          {$unwind: "$c"},
+          {$match: {c: {$ne: 2}}},
+          {$project: {c: 1, d: 1}},
+          {$group: {_id: {c: "$c"}, d: {$sum: "$d"}, n: {$sum: 1}}},
+          {$sort: {"_id.c": 1}},
+        ],
+        [{$match: {a: 100}}, {$group: {_id: "$b", n: {$sum: 1}}}],
+    ];
+
+    function setThreads(numThreads) {
+        assert.commandWorked(testDB.adminCommand(
+            {setParameter: 1, internalDocumentSourceParallelCursorThreads: numThreads}));
+    }
+
+    pipelines.forEach(function(pipeline) {
+        setThreads(0);
+        var expected = coll.aggregate(pipeline).toArray();
+
+        setThreads(4);
+        var actual = coll.aggregate(pipeline).toArray();
+        assert.eq(expected, actual, tojson(pipeline));
+
+        // Small batches make the merged results come back over several getMores.
+        actual = coll.aggregate(pipeline, {cursor: {batchSize: 1}}).toArray();
+        assert.eq(expected, actual, tojson(pipeline));
+
+        actual = coll.aggregate(pipeline, {allowDiskUse: true}).toArray();
+        assert.eq(expected, actual, tojson(pipeline));
+    });
+
+    // Explain describes the single threaded plan.
+    var explain = coll.explain().aggregate([{$group: {_id: "$a"}}]);
+    assert.eq("COLLSCAN", explain.stages[0].$cursor.queryPlanner.winningPlan.stage, tojson(explain));
+
+    // An aggregation interrupted while the workers are still scanning, here by maxTimeMS, disposes
+    // of the stage under the collection lock without waiting for the workers, which need that lock
+    // to clean up. An exclusive lock request queued right behind must still go through.
+    setThreads(4);
+    for (var attempt = 0; attempt < 10; attempt++) {
+        var res = testDB.runCommand(
+            {aggregate: coll.getName(), pipeline: [{$group: {_id: "$a"}}], maxTimeMS: 1});
+        if (!res.ok) {
+            assert.eq(ErrorCodes.ExceededTimeLimit, res.code, tojson(res));
+        }
+        assert.commandWorked(coll.createIndex({a: 1}));
+        assert.commandWorked(coll.dropIndex({a: 1}));
+    }
+
+    // The threads of all the aggregations of the process are bounded. While an open cursor holds
+    // all of them, other aggregations run on one thread and return the same results. Shutdown
+    // stops the workers of the open cursor, which are waiting for it to be iterated.
+    var groupById = [{$group: {_id: "$_id"}}, {$sort: {_id: 1}}];
+    setThreads(0);
+    var expectedGroupById = coll.aggregate(groupById).toArray();
+    setThreads(4);
+    assert.commandWorked(testDB.adminCommand(
+        {setParameter: 1, internalDocumentSourceParallelCursorMaxTotalThreads: 4}));
+    var openCursor = coll.aggregate([{$group: {_id: "$_id"}}], {cursor: {batchSize: 1}});
+    assert(openCursor.hasNext());
+    assert.eq(expectedGroupById, coll.aggregate(groupById).toArray());
+
+    // Errors on the worker threads fail the aggregation.
+    assert.writeOK(coll.insert({_id: numDocs, a: "not a number", b: 0}));
+    assert.commandFailed(testDB.runCommand({
+        aggregate: coll.getName(),
+        pipeline: [{$group: {_id: null, x: {$sum: {$divide: [100, "$a"]}}}}],
+    }));
+
+    MongoRunner.stopMongod(conn);
+})();
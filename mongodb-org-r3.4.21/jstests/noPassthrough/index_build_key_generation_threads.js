@@ -0,0 +1,51 @@
+// Tests that foreground index builds which generate keys on several threads build the same indexes
+// as serial builds, including unique, partial and multikey indexes.
+(function() {
+    "use strict";
+
+    var conn = MongoRunner.runMongod({setParameter: "indexBuildKeyGenerationThreads=4"});
+    assert.neq(null, conn, "mongod was unable to start up");
+    var testDB = conn.getDB("test");
+    var coll = testDB.index_build_key_generation_threads;
+    coll.drop();
+
+    var numDocs = 20000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, a: numDocs - i, b: i % 7, c: [i, i + 1], s: "x".repeat(i % 50)});
+    }
+    assert.writeOK(bulk.execute());
+
+    assert.commandWorked(coll.createIndexes([
+        {a: 1},
+        {b: 1, a: -1},
+        {c: 1},
+    ]));
+    assert.commandWorked(coll.createIndex({s: 1}, {partialFilterExpression: {b: 3}}));
+    assert.commandWorked(coll.createIndex({a: 1, _id: 1}, {unique: true}));
+
+    assert.commandWorked(coll.validate(true));
+    assert.eq(numDocs, coll.find().hint({a: 1}).itcount());
+    assert.eq(numDocs, coll.find({b: {$gte: 0}}).hint({b: 1, a: -1}).itcount());
+    assert.eq(2, coll.find({c: 5}).hint({c: 1}).itcount());
+    assert.eq(coll.find({b: 3}).itcount(), coll.find({b: 3}).hint({s: 1}).itcount());
+
+    var explain = coll.find({c: 5}).hint({c: 1}).explain();
+    assert(explain.queryPlanner.winningPlan.inputStage.isMultiKey, tojson(explain));
+
+    // Keys in index order must be sorted across the documents of all threads.
+    var last = null;
+    coll.find({}, {_id: 0, a: 1}).hint({a: 1}).forEach(function(doc) {
+        if (last !== null) {
+            assert.lt(last, doc.a);
+        }
+        last = doc.a;
+    });
+
+    // A unique index build fails on duplicates found by any thread.
+    assert.writeOK(coll.insert({_id: numDocs, a: 1, b: (numDocs - 1) % 7}));
+    assert.commandFailedWithCode(coll.createIndex({a: 1, b: 1}, {unique: true}),
+                                 ErrorCodes.DuplicateKey);
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,57 @@
+/**
+ * Confirms that while $out builds the indexes of the target collection on its temporary
+ * collection, the rest of the database can still be read and written.
+ */
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({smallfiles: "", nojournal: ""});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    const testDB = conn.getDB("test");
+    assert.commandWorked(testDB.dropDatabase());
+
+    const bulk = testDB.source.initializeUnorderedBulkOp();
+    for (let i = 0; i < 100; i++) {
+        bulk.insert({_id: i, a: i});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(testDB.target.createIndex({a: 1}));
+    assert.writeOK(testDB.other.insert({_id: 0}));
+
+    // Returns true if an index build is under way. It is assumed that the $out is the only
+    // operation which builds indexes.
+    function outIndexBuildInProgress() {
+        const result = testDB.currentOp();
+        assert.commandWorked(result);
+        return result.inprog.some(function(op) {
+            return op.msg && op.msg.startsWith("Index Build");
+        });
+    }
+
+    assert.commandWorked(
+        testDB.adminCommand({configureFailPoint: 'hangAfterStartingIndexBuild', mode: 'alwaysOn'}));
+
+    const awaitOut = startParallelShell(function() {
+        const res = db.getSiblingDB("test").runCommand(
+            {aggregate: "source", pipeline: [{$out: "target"}], cursor: {}});
+        assert.commandWorked(res);
+    }, conn.port);
+
+    assert.soon(outIndexBuildInProgress, "$out index build not found in currentOp");
+
+    // The database isn't locked exclusively during the build, so these don't wait for it.
+    assert.commandWorked(testDB.runCommand({find: "other", maxTimeMS: 10 * 1000}));
+    assert.writeOK(testDB.other.insert({_id: 1}));
+    assert(outIndexBuildInProgress());
+
+    assert.commandWorked(
+        testDB.adminCommand({configureFailPoint: 'hangAfterStartingIndexBuild', mode: 'off'}));
+    awaitOut();
+
+    assert.eq(100, testDB.target.find({a: {$gte: 0}}).hint({a: 1}).itcount());
+    assert.eq(2, testDB.target.getIndexes().length);
+    assert.eq(2, testDB.other.find().itcount());
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,55 @@
+// Tests that with internalQueryPlannerUseCollectionStatistics enabled, a plan whose estimated cost
+// is clearly lowest is chosen without racing the candidates, and that plans are still raced when
+// the estimates are close or the query may stop early.
+(function() {
+    "use strict";
+
+    load("jstests/libs/analyze_plan.js");
+
+    var conn = MongoRunner.runMongod({
+        setParameter: {
+            internalQueryPlannerUseCollectionStatistics: true,
+            internalQueryStatisticsSampleSize: 5000
+        }
+    });
+    assert.neq(null, conn, "mongod was unable to start up");
+    var testDB = conn.getDB("test");
+    var coll = testDB.plan_selection_collection_statistics;
+    coll.drop();
+
+    var numDocs = 2000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, a: i, b: i % 2, c: Math.floor(i / 2) % 2});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.createIndexes([{a: 1}, {b: 1}, {c: 1}]));
+
+    // 'a' is unique and 'b' has two values, so the index on 'a' wins without a trial run.
+    var explain = coll.find({a: 5, b: 1}).explain();
+    assert.eq(0, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+    var ixscan = getPlanStage(explain.queryPlanner.winningPlan, "IXSCAN");
+    assert.neq(null, ixscan, tojson(explain));
+    assert.eq("a_1", ixscan.indexName, tojson(explain));
+    assert.eq([{_id: 5, a: 5, b: 1, c: 0}], coll.find({a: 5, b: 1}).toArray());
+
+    // 'b' and 'c' both have two equally common values, so their plans are raced.
+    explain = coll.find({b: 1, c: 1}).explain();
+    assert.gt(explain.queryPlanner.rejectedPlans.length, 0, tojson(explain));
+    assert.eq(numDocs / 4, coll.find({b: 1, c: 1}).itcount());
+
+    // Queries with a limit are raced, as a plan may stop early.
+    explain = coll.find({a: 5, b: 1}).limit(1).explain();
+    assert.gt(explain.queryPlanner.rejectedPlans.length, 0, tojson(explain));
+
+    // Dropping an index discards the statistics, and plans on the remaining indexes use new ones.
+    assert.commandWorked(coll.dropIndex({a: 1}));
+    assert.commandWorked(coll.createIndex({a: 1, c: 1}));
+    explain = coll.find({a: 5, b: 1}).explain();
+    assert.eq(0, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+    assert.eq("a_1_c_1",
+              getPlanStage(explain.queryPlanner.winningPlan, "IXSCAN").indexName,
+              tojson(explain));
+
+    MongoRunner.stopMongod(conn);
+})();
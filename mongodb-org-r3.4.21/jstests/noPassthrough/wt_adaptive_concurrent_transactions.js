@@ -0,0 +1,58 @@
+// Tests that WiredTiger adjusts its concurrent transaction tickets within the configured bounds
+// while adaptive sizing is enabled, and reports its decisions in serverStatus.
+(function() {
+    "use strict";
+
+    var storageEngine = jsTest.options().storageEngine || "wiredTiger";
+    if (storageEngine !== "wiredTiger") {
+        return;
+    }
+
+    var conn = MongoRunner.runMongod({
+        setParameter: {
+            wiredTigerAdaptiveConcurrentTransactions: true,
+            wiredTigerAdaptiveConcurrentTransactionsIntervalMillis: 100,
+            wiredTigerAdaptiveConcurrentTransactionsMin: 8,
+            wiredTigerAdaptiveConcurrentTransactionsMax: 32,
+        }
+    });
+    assert.neq(null, conn, "mongod was unable to start up");
+    var adminDB = conn.getDB("admin");
+
+    function concurrentTransactions() {
+        return assert.commandWorked(adminDB.runCommand({serverStatus: 1}))
+            .wiredTiger.concurrentTransactions;
+    }
+
+    // The default of 128 tickets is above the maximum.
+    assert.soon(function() {
+        var stats = concurrentTransactions();
+        return stats.read.totalTickets <= 32 && stats.write.totalTickets <= 32;
+    }, tojson(concurrentTransactions()));
+
+    var stats = concurrentTransactions();
+    assert(stats.adaptive.enabled, tojson(stats));
+    assert.eq("bounds", stats.adaptive.read.lastChange, tojson(stats));
+    assert.gte(stats.adaptive.read.decreases, 1, tojson(stats));
+    assert.gte(stats.adaptive.cache.usedRatio, 0, tojson(stats));
+    assert.gte(stats.read.totalTickets, 8, tojson(stats));
+
+    // Setting the tickets directly is still allowed, and gets corrected while sizing is enabled.
+    assert.commandWorked(
+        adminDB.runCommand({setParameter: 1, wiredTigerConcurrentReadTransactions: 100}));
+    assert.soon(function() {
+        return concurrentTransactions().read.totalTickets <= 32;
+    });
+
+    // Once disabled, the tickets stay as they are set.
+    assert.commandWorked(
+        adminDB.runCommand({setParameter: 1, wiredTigerAdaptiveConcurrentTransactions: false}));
+    assert.commandWorked(
+        adminDB.runCommand({setParameter: 1, wiredTigerConcurrentReadTransactions: 100}));
+    sleep(500);
+    stats = concurrentTransactions();
+    assert.eq(100, stats.read.totalTickets, tojson(stats));
+    assert(!stats.adaptive.enabled, tojson(stats));
+
+    MongoRunner.stopMongod(conn);
+})();
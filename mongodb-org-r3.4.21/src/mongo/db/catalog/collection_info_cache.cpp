@@ -34,21 +34,39 @@
 
 #include "mongo/db/catalog/collection_info_cache.h"
 
+#include <cstdlib>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/fts/fts_spec.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index_legacy.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/query/collection_statistics.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/planner_ixselect.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/ttl_collection_cache.h"
 #include "mongo/util/clock_source.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
+namespace {
+
+// Histogram buckets per index.
+const size_t kMaxStatisticsBuckets = 100;
+
+// Statistics are sampled again once the number of records changes by this fraction.
+const double kStatisticsStaleRecordsRatio = 0.2;
+
+}  // namespace
+
 CollectionInfoCache::CollectionInfoCache(Collection* collection)
     : _collection(collection),
       _keysComputed(false),
@@ -228,6 +246,10 @@ void CollectionInfoCache::droppedIndex(OperationContext* txn, StringData indexNa
 
 void CollectionInfoCache::rebuildIndexData(OperationContext* txn) {
     clearQueryCache();
+    {
+        stdx::lock_guard<stdx::mutex> lk(_statisticsMutex);
+        _statistics.reset();
+    }
 
     _keysComputed = false;
     computeIndexKeys(txn);
@@ -237,4 +259,109 @@ void CollectionInfoCache::rebuildIndexData(OperationContext* txn) {
 CollectionIndexUsageMap CollectionInfoCache::getIndexUsageStats() const {
     return _indexUsageTracker.getUsageStats();
 }
+
+std::shared_ptr<const CollectionStatistics> CollectionInfoCache::getStatistics(
+    OperationContext* txn) {
+    dassert(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_IS));
+
+    const long long numRecords = _collection->numRecords(txn);
+    const Date_t now = getGlobalServiceContext()->getFastClockSource()->now();
+    {
+        stdx::lock_guard<stdx::mutex> lk(_statisticsMutex);
+        if (_statistics) {
+            const Seconds maxAge(internalQueryStatisticsMaxAgeSecs.load());
+            const double sampledRecords =
+                std::max(_statistics->numRecords(),
+                         static_cast<long long>(internalQueryStatisticsSampleSize.load()));
+            const bool stale = now - _statistics->createdAt() > maxAge ||
+                std::llabs(numRecords - _statistics->numRecords()) >
+                    sampledRecords * kStatisticsStaleRecordsRatio;
+            if (!stale) {
+                return _statistics;
+            }
+        }
+        if (_samplingStatistics) {
+            return _statistics;
+        }
+        _samplingStatistics = true;
+    }
+    ON_BLOCK_EXIT([this] {
+        stdx::lock_guard<stdx::mutex> lk(_statisticsMutex);
+        _samplingStatistics = false;
+    });
+
+    auto statistics = sampleStatistics(txn, numRecords, now);
+
+    stdx::lock_guard<stdx::mutex> lk(_statisticsMutex);
+    _statistics = statistics;
+    return _statistics;
+}
+
+std::shared_ptr<const CollectionStatistics> CollectionInfoCache::sampleStatistics(
+    OperationContext* txn, long long numRecords, Date_t now) {
+    // Scan small collections whole. Larger ones are sampled at random, if the storage engine can.
+    const long long sampleSize = std::max(internalQueryStatisticsSampleSize.load(), 1);
+    std::unique_ptr<RecordCursor> cursor;
+    if (numRecords > sampleSize) {
+        cursor = _collection->getRecordStore()->getRandomCursor(txn);
+        if (!cursor) {
+            return nullptr;
+        }
+    } else {
+        cursor = _collection->getCursor(txn);
+    }
+
+    struct IndexSample {
+        const IndexDescriptor* desc;
+        const IndexCatalogEntry* entry;
+        std::vector<BSONObj> values;
+    };
+    std::vector<IndexSample> indexSamples;
+
+    const bool includeUnfinishedIndexes = false;
+    IndexCatalog::IndexIterator ii =
+        _collection->getIndexCatalog()->getIndexIterator(txn, includeUnfinishedIndexes);
+    while (ii.more()) {
+        const IndexDescriptor* desc = ii.next();
+        if (desc->getAccessMethodName() == IndexNames::BTREE) {
+            indexSamples.push_back({desc, ii.catalogEntry(desc), {}});
+        }
+    }
+
+    long long numSampled = 0;
+    while (numSampled < sampleSize) {
+        auto record = cursor->next();
+        if (!record) {
+            break;
+        }
+        ++numSampled;
+
+        const BSONObj doc = record->data.releaseToBson();
+        for (auto&& sample : indexSamples) {
+            const MatchExpression* filter = sample.entry->getFilterExpression();
+            if (filter && !filter->matchesBSON(doc)) {
+                continue;
+            }
+            BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+            MultikeyPaths* multikeyPaths = nullptr;
+            sample.entry->accessMethod()->getKeys(
+                doc, IndexAccessMethod::GetKeysMode::kRelaxConstraints, &keys, multikeyPaths);
+            for (auto&& key : keys) {
+                sample.values.push_back(key.firstElement().wrap(""));
+            }
+        }
+    }
+
+    const double scale = numSampled > 0 ? static_cast<double>(numRecords) / numSampled : 1;
+    auto statistics = std::make_shared<CollectionStatistics>(numRecords, now);
+    for (auto&& sample : indexSamples) {
+        statistics->addIndex(
+            sample.desc->indexName(),
+            IndexStatistics(std::move(sample.values), scale, kMaxStatisticsBuckets));
+    }
+
+    LOG(1) << _collection->ns() << ": sampled " << numSampled << " of " << numRecords
+           << " documents for statistics on " << indexSamples.size() << " indexes";
+    return statistics;
+}
 }
@@ -30,14 +30,19 @@
 
 #pragma once
 
+#include <memory>
+
 #include "mongo/db/collection_index_usage_tracker.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/update_index_data.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
 class Collection;
+class CollectionStatistics;
 class IndexDescriptor;
 class OperationContext;
 
@@ -75,6 +80,16 @@ public:
      */
     CollectionIndexUsageMap getIndexUsageStats() const;
 
+    /**
+     * Returns sampled statistics about the collection and its btree indexes, sampling the
+     * collection first if there are none yet or they are stale. Returns the previous statistics,
+     * possibly null, while another thread samples the collection, and null if the collection is
+     * too large to scan and its storage engine can't sample records at random.
+     *
+     * Callers must hold the collection lock in at least MODE_IS.
+     */
+    std::shared_ptr<const CollectionStatistics> getStatistics(OperationContext* txn);
+
     /**
      * Builds internal cache state based on the current state of the Collection's IndexCatalog
      */
@@ -124,6 +139,23 @@ private:
     // Tracks index usage statistics for this collection.
     CollectionIndexUsageTracker _indexUsageTracker;
 
+    // Protects '_statistics' and '_samplingStatistics'.
+    stdx::mutex _statisticsMutex;
+
+    // Statistics for cost-based plan selection. Reset whenever the indexes change.
+    std::shared_ptr<const CollectionStatistics> _statistics;
+
+    // Set while a thread samples the collection, so that concurrent queries don't do it too.
+    bool _samplingStatistics = false;
+
+    /**
+     * Samples documents of the collection, and builds statistics from the keys they generate for
+     * each ready btree index.
+     */
+    std::shared_ptr<const CollectionStatistics> sampleStatistics(OperationContext* txn,
+                                                                 long long numRecords,
+                                                                 Date_t now);
+
     void computeIndexKeys(OperationContext* txn);
     void updatePlanCacheIndexEntries(OperationContext* txn);
 
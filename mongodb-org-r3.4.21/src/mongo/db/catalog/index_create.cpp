@@ -34,6 +34,8 @@
 
 #include "mongo/db/catalog/index_create.h"
 
+#include <deque>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/audit.h"
@@ -44,11 +46,14 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -91,6 +96,179 @@ public:
 
 } exportedMaxIndexBuildMemoryUsageParameter;
 
+// Number of threads a foreground build of btree indexes generates keys on while the collection is
+// scanned, where 0 generates them on the scanning thread. The memory of each index build is split
+// evenly between the threads.
+MONGO_EXPORT_SERVER_PARAMETER(indexBuildKeyGenerationThreads, int, 0);
+
+namespace {
+
+/**
+ * Generates the keys of the documents of a foreground index build on a set of threads, while the
+ * thread holding the collection lock keeps scanning the collection.
+ *
+ * The scanned documents are handed to the threads in batches, each a contiguous range of the
+ * collection scan. Every thread inserts the keys it generates into bulk builders of its own, one per
+ * index, which are merged once the scan is done.
+ */
+class ParallelKeyGenerator {
+    MONGO_DISALLOW_COPYING(ParallelKeyGenerator);
+
+public:
+    struct Index {
+        const MatchExpression* filterExpression;  // might be NULL
+        const InsertDeleteOptions* options;
+
+        // One per thread.
+        std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> bulks;
+    };
+
+    ParallelKeyGenerator(std::vector<Index> indexes, size_t numThreads)
+        : _indexes(std::move(indexes)) {
+        for (size_t i = 0; i < numThreads; i++) {
+            _threads.emplace_back([this, i] { _run(i); });
+        }
+    }
+
+    ~ParallelKeyGenerator() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _closed = true;
+            _abandoned = true;
+        }
+        _cv.notify_all();
+        _join();
+    }
+
+    /**
+     * Queues the keys of 'doc' to be generated. Blocks while the threads are behind. Returns the
+     * error of a failed thread, if any.
+     */
+    Status add(const BSONObj& doc, const RecordId& loc) {
+        _batchBytes += doc.objsize();
+        _batch.emplace_back(doc.getOwned(), loc);
+        if (_batch.size() < kMaxBatchDocuments && _batchBytes < kMaxBatchBytes) {
+            return Status::OK();
+        }
+        return _pushBatch();
+    }
+
+    /**
+     * Waits for the keys of all added documents to be generated. On success, the bulk builders of
+     * each index may then be released.
+     */
+    Status finish() {
+        Status status = _batch.empty() ? Status::OK() : _pushBatch();
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _closed = true;
+        }
+        _cv.notify_all();
+        _join();
+        return status.isOK() ? _status : status;
+    }
+
+    std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> releaseBulks(size_t index) {
+        return std::move(_indexes[index].bulks);
+    }
+
+private:
+    using Batch = std::vector<std::pair<BSONObj, RecordId>>;
+
+    static const size_t kMaxBatchDocuments = 1000;
+    static const size_t kMaxBatchBytes = 1024 * 1024;
+
+    Status _pushBatch() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [&] { return _queue.size() < 2 * _threads.size() || !_status.isOK(); });
+        if (!_status.isOK()) {
+            return _status;
+        }
+
+        _queue.push_back(std::move(_batch));
+        _batch.clear();
+        _batchBytes = 0;
+        _cv.notify_all();
+        return Status::OK();
+    }
+
+    void _run(size_t thread) {
+        while (true) {
+            Batch batch;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _cv.wait(lk, [&] { return !_queue.empty() || _closed; });
+                if (_abandoned || !_status.isOK() || _queue.empty()) {
+                    return;
+                }
+                batch = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            _cv.notify_all();
+
+            Status status = _generateKeys(thread, batch);
+            if (!status.isOK()) {
+                {
+                    stdx::lock_guard<stdx::mutex> lk(_mutex);
+                    if (_status.isOK()) {
+                        _status = status;
+                    }
+                }
+                _cv.notify_all();
+                return;
+            }
+        }
+    }
+
+    Status _generateKeys(size_t thread, const Batch& batch) {
+        try {
+            for (auto&& doc : batch) {
+                for (auto&& index : _indexes) {
+                    if (index.filterExpression && !index.filterExpression->matchesBSON(doc.first)) {
+                        continue;
+                    }
+
+                    // BulkBuilder::insert() doesn't use the OperationContext, which belongs to the
+                    // scanning thread.
+                    int64_t unused;
+                    Status status = index.bulks[thread]->insert(
+                        nullptr, doc.first, doc.second, *index.options, &unused);
+                    if (!status.isOK()) {
+                        return status;
+                    }
+                }
+            }
+        } catch (...) {
+            return exceptionToStatus();
+        }
+        return Status::OK();
+    }
+
+    void _join() {
+        for (auto&& thread : _threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    std::vector<Index> _indexes;
+    std::vector<stdx::thread> _threads;
+
+    // Only used by the scanning thread.
+    Batch _batch;
+    size_t _batchBytes = 0;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    std::deque<Batch> _queue;
+    bool _closed = false;     // No more batches will be queued.
+    bool _abandoned = false;  // Queued batches are to be dropped.
+    Status _status = Status::OK();
+};
+
+}  // namespace
+
 
 /**
  * On rollback sets MultiIndexBlock::_needToCleanup to true.
@@ -217,6 +395,7 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(const std::vector<BSONObj
         eachIndexBuildMaxMemoryUsageBytes =
             std::size_t(maxIndexBuildMemoryUsageMegabytes) * 1024 * 1024 / indexSpecs.size();
     }
+    _eachIndexBuildMaxMemoryUsageBytes = eachIndexBuildMaxMemoryUsageBytes;
 
     for (size_t i = 0; i < indexSpecs.size(); i++) {
         BSONObj info = indexSpecs[i];
@@ -305,6 +484,29 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
 
     unsigned long long n = 0;
 
+    BSONObjBuilder phaseTimings;
+    auto reportPhaseTimings = [&] {
+        stdx::lock_guard<Client> lk(*_txn->getClient());
+        CurOp::get(_txn)->setPhaseTimings_inlock(phaseTimings.asTempObj().getOwned());
+    };
+
+    std::unique_ptr<ParallelKeyGenerator> keyGenerator;
+    if (const size_t numThreads = _numKeyGenerationThreads()) {
+        std::vector<ParallelKeyGenerator::Index> indexes;
+        for (auto&& index : _indexes) {
+            ParallelKeyGenerator::Index keyGeneratorIndex;
+            keyGeneratorIndex.filterExpression = index.filterExpression;
+            keyGeneratorIndex.options = &index.options;
+            for (size_t i = 0; i < numThreads; i++) {
+                keyGeneratorIndex.bulks.push_back(
+                    index.real->initiateBulk(_eachIndexBuildMaxMemoryUsageBytes / numThreads));
+            }
+            indexes.push_back(std::move(keyGeneratorIndex));
+        }
+        keyGenerator = stdx::make_unique<ParallelKeyGenerator>(std::move(indexes), numThreads);
+        log() << "generating index keys on " << numThreads << " threads";
+    }
+
     unique_ptr<PlanExecutor> exec(InternalPlanner::collectionScan(
         _txn, _collection->ns().ns(), _collection, PlanExecutor::YIELD_MANUAL));
     if (_buildInBackground) {
@@ -347,7 +549,8 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
             failPointHangDuringBuild(&hangBeforeIndexBuildOf, "before", objToIndex.value());
 
             WriteUnitOfWork wunit(_txn);
-            Status ret = insert(objToIndex.value(), loc);
+            Status ret = keyGenerator ? keyGenerator->add(objToIndex.value(), loc)
+                                      : insert(objToIndex.value(), loc);
             if (_buildInBackground)
                 exec->saveState();
             if (ret.isOK()) {
@@ -387,6 +590,24 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
                 WorkingSetCommon::toStatusString(objToIndex.value()),
             state == PlanExecutor::IS_EOF);
 
+    phaseTimings.append("scanMillis", t.millis());
+    reportPhaseTimings();
+
+    if (keyGenerator) {
+        Timer waitTimer;
+        Status status = keyGenerator->finish();
+        if (!status.isOK())
+            return status;
+        for (size_t i = 0; i < _indexes.size(); i++) {
+            _indexes[i].threadBulks = keyGenerator->releaseBulks(i);
+            _indexes[i].bulk.reset();
+        }
+        keyGenerator.reset();
+
+        phaseTimings.append("keyGenerationWaitMillis", waitTimer.millis());
+        reportPhaseTimings();
+    }
+
     if (MONGO_FAIL_POINT(hangAfterStartingIndexBuildUnlocked)) {
         // Unlock before hanging so replication recognizes we've completed.
         Locker::LockSnapshot lockInfo;
@@ -403,11 +624,16 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
 
     progress->finished();
 
+    Timer bulkLoadTimer;
     Status ret = doneInserting(dupsOut);
     if (!ret.isOK())
         return ret;
 
-    log() << "build index done.  scanned " << n << " total records. " << t.seconds() << " secs";
+    phaseTimings.append("bulkLoadMillis", bulkLoadTimer.millis());
+    reportPhaseTimings();
+
+    log() << "build index done.  scanned " << n << " total records. " << t.seconds() << " secs"
+          << " phase timings: " << phaseTimings.asTempObj();
 
     return Status::OK();
 }
@@ -434,12 +660,16 @@ Status MultiIndexBlock::insert(const BSONObj& doc, const RecordId& loc) {
 
 Status MultiIndexBlock::doneInserting(std::set<RecordId>* dupsOut) {
     for (size_t i = 0; i < _indexes.size(); i++) {
-        if (_indexes[i].bulk == NULL)
+        std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> bulks =
+            std::move(_indexes[i].threadBulks);
+        if (_indexes[i].bulk)
+            bulks.push_back(std::move(_indexes[i].bulk));
+        if (bulks.empty())
             continue;
         LOG(1) << "\t bulk commit starting for index: "
                << _indexes[i].block->getEntry()->descriptor()->indexName();
         Status status = _indexes[i].real->commitBulk(_txn,
-                                                     std::move(_indexes[i].bulk),
+                                                     std::move(bulks),
                                                      _allowInterruption,
                                                      _indexes[i].options.dupsAllowed,
                                                      dupsOut);
@@ -451,6 +681,22 @@ Status MultiIndexBlock::doneInserting(std::set<RecordId>* dupsOut) {
     return Status::OK();
 }
 
+size_t MultiIndexBlock::_numKeyGenerationThreads() const {
+    const int numThreads = indexBuildKeyGenerationThreads.load();
+    if (_buildInBackground || numThreads <= 0 || _indexes.empty()) {
+        return 0;
+    }
+
+    // Only btree key generation is known to be safe to run on several threads at once.
+    for (auto&& index : _indexes) {
+        if (!index.bulk ||
+            index.block->getEntry()->descriptor()->getAccessMethodName() != IndexNames::BTREE) {
+            return 0;
+        }
+    }
+    return numThreads;
+}
+
 void MultiIndexBlock::abortWithoutCleanup() {
     _indexes.clear();
     _needToCleanup = false;
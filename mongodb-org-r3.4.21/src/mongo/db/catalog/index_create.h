@@ -197,9 +197,19 @@ private:
         const MatchExpression* filterExpression;  // might be NULL, owned elsewhere
         std::unique_ptr<IndexAccessMethod::BulkBuilder> bulk;
 
+        // Filled by the key generation threads of insertAllDocumentsInCollection(), one per
+        // thread, in place of 'bulk'.
+        std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> threadBulks;
+
         InsertDeleteOptions options;
     };
 
+    /**
+     * Returns how many threads insertAllDocumentsInCollection() should generate keys on, or 0 to
+     * generate them while scanning the collection.
+     */
+    size_t _numKeyGenerationThreads() const;
+
     std::vector<IndexToBuild> _indexes;
 
     std::unique_ptr<BackgroundOperation> _backgroundOperation;
@@ -213,6 +223,8 @@ private:
     bool _ignoreUnique;
 
     bool _needToCleanup;
+
+    std::size_t _eachIndexBuildMaxMemoryUsageBytes = 0;
 };
 
 }  // namespace mongo
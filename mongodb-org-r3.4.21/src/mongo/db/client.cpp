@@ -91,6 +91,19 @@ void Client::destroy() {
     currentClient.reset(nullptr);
 }
 
+ServiceContext::UniqueClient Client::releaseCurrent() {
+    invariant(haveClient());
+    return std::move(*currentClient.get());
+}
+
+void Client::setCurrent(ServiceContext::UniqueClient client) {
+    invariant(client);
+    invariant(!haveClient());
+    setThreadName(client->desc());
+    client->_threadId = stdx::this_thread::get_id();
+    *currentClient.getMake() = std::move(client);
+}
+
 namespace {
 int64_t generateSeed(const std::string& desc) {
     size_t seed = 0;
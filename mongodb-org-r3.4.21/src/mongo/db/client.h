@@ -132,6 +132,21 @@ public:
      */
     static void destroy();
 
+    /**
+     * Detaches the Client object stored in TLS for the current thread and returns it to the
+     * caller, leaving the current thread without a Client.
+     *
+     * Used by service executors which run a session's requests on whichever worker thread is
+     * free, rather than on a thread dedicated to that session.
+     */
+    static ServiceContext::UniqueClient releaseCurrent();
+
+    /**
+     * Attaches 'client' to the current thread, which must not already have a Client. The thread
+     * name is changed to match the Client's description.
+     */
+    static void setCurrent(ServiceContext::UniqueClient client);
+
     std::string clientAddress(bool includePort = false) const;
     const std::string& desc() const {
         return _desc;
@@ -212,7 +227,7 @@ private:
     const std::string _desc;
 
     // OS id of the thread, which owns this client
-    const stdx::thread::id _threadId;
+    stdx::thread::id _threadId;
 
     // > 0 for things "conn", 0 otherwise
     const ConnectionId _connectionId;
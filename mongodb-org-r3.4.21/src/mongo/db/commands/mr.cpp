@@ -1797,8 +1797,7 @@ public:
                 // one big $or query, but then the sorting would not be efficient.
                 const string shardName = ShardingState::get(opCtx)->getShardName();
 
-                for (const auto& chunkEntry : cm->chunkMap()) {
-                    const auto& chunk = chunkEntry.second;
+                for (const auto& chunk : cm->chunkMap()) {
                     if (chunk->getShardId() == shardName) {
                         chunks.push_back(chunk);
                     }
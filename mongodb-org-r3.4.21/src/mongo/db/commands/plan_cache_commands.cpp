@@ -432,6 +432,24 @@ Status PlanCacheListPlans::list(OperationContext* txn,
                 scoreBob.append("score", entry->feedback[i]->score);
             }
             scoresBob.doneFast();
+
+            // Moving statistics of the trial periods and the complete runs of the cached plan.
+            BSONObjBuilder trialWorksBob(feedbackBob.subobjStart("trialWorks"));
+            entry->trialWorks.appendToBSON(&trialWorksBob);
+            trialWorksBob.doneFast();
+            BSONObjBuilder executionsBob(feedbackBob.subobjStart("executions"));
+            const std::pair<const char*, const PlanCacheMovingStats*> executionStats[] = {
+                {"works", &entry->works},
+                {"keysExamined", &entry->keysExamined},
+                {"docsExamined", &entry->docsExamined},
+                {"executionTimeMillis", &entry->executionTimeMillis}};
+            for (const auto& stat : executionStats) {
+                BSONObjBuilder statBob(executionsBob.subobjStart(stat.first));
+                stat.second->appendToBSON(&statBob);
+                statBob.doneFast();
+            }
+            executionsBob.doneFast();
+            feedbackBob.append("needsReevaluation", entry->needsReevaluation);
         }
         feedbackBob.doneFast();
 
@@ -439,6 +457,16 @@ Status PlanCacheListPlans::list(OperationContext* txn,
     }
     plansBuilder.doneFast();
 
+    // Decisions made about this query shape, oldest first.
+    BSONArrayBuilder historyBuilder(bob->subarrayStart("history"));
+    for (const auto& decision : entry->history) {
+        BSONObjBuilder decisionBob(historyBuilder.subobjStart());
+        decisionBob.appendDate("date", decision.date);
+        decisionBob.append("reason", decision.reason);
+        decisionBob.append("works", decision.works);
+    }
+    historyBuilder.doneFast();
+
     return Status::OK();
 }
 
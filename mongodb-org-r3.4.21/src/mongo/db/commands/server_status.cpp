@@ -48,6 +48,7 @@
 #include "mongo/db/stats/counters.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/transport/message_compressor_registry.h"
+#include "mongo/transport/service_entry_point_utils.h"
 #include "mongo/transport/transport_layer.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/hostname_canonicalization.h"
@@ -287,6 +288,21 @@ public:
 
 } network;
 
+class ServiceExecutorSSS : public ServerStatusSection {
+public:
+    ServiceExecutorSSS() : ServerStatusSection("serviceExecutor") {}
+    virtual bool includeByDefault() const {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* txn, const BSONElement& configElement) const {
+        BSONObjBuilder b;
+        appendServiceExecutorStats(&b);
+        return b.obj();
+    }
+
+} serviceExecutorSSS;
+
 #ifdef MONGO_CONFIG_SSL
 class Security : public ServerStatusSection {
 public:
@@ -372,7 +372,7 @@ void LockHead::migratePartitionedLockHeads() {
     // Migration time: lock each partition in turn and transfer its requests, if any
     while (partitioned()) {
         LockManager::Partition* partition = partitions.back();
-        stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
+        scoped_spinlock scopedLock(partition->mutex);
 
         LockManager::Partition::Map::iterator it = partition->data.find(resourceId);
         if (it != partition->data.end()) {
@@ -403,13 +403,10 @@ void LockHead::migratePartitionedLockHeads() {
 // Have more buckets than CPUs to reduce contention on lock and caches
 const unsigned LockManager::_numLockBuckets(128);
 
-// Balance scalability of intent locks against potential added cost of conflicting locks.
-// The exact value doesn't appear very important, but should be power of two
-const unsigned LockManager::_numPartitions = 32;
+const unsigned LockManager::_numPartitions;
 
 LockManager::LockManager() {
     _lockBuckets = new LockBucket[_numLockBuckets];
-    _partitions = new Partition[_numPartitions];
 }
 
 LockManager::~LockManager() {
@@ -421,7 +418,6 @@ LockManager::~LockManager() {
     }
 
     delete[] _lockBuckets;
-    delete[] _partitions;
 }
 
 LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mode) {
@@ -435,7 +431,7 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
     // For intent modes, try the PartitionedLockHead
     if (request->partitioned) {
         Partition* partition = _getPartition(request);
-        stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
+        scoped_spinlock scopedLock(partition->mutex);
 
         // Fast path for intent locks
         PartitionedLockHead* partitionedLock = partition->find(resId);
@@ -458,7 +454,7 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
     // Start a partitioned lock if possible
     if (request->partitioned && !(lock->grantedModes & (~intentModes)) && !lock->conflictModes) {
         Partition* partition = _getPartition(request);
-        stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
+        scoped_spinlock scopedLock(partition->mutex);
         PartitionedLockHead* partitionedLock = partition->findOrInsert(resId);
         invariant(partitionedLock);
         lock->partitions.push_back(partition);
@@ -567,7 +563,7 @@ bool LockManager::unlock(LockRequest* request) {
         invariant(request->status == LockRequest::STATUS_GRANTED ||
                   request->status == LockRequest::STATUS_CONVERTING);
         Partition* partition = _getPartition(request);
-        stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
+        scoped_spinlock scopedLock(partition->mutex);
         //  Fast path: still partitioned.
         if (request->partitionedLock) {
             request->partitionedLock->grantedList.remove(request);
@@ -802,7 +798,7 @@ LockManager::LockBucket* LockManager::_getBucket(ResourceId resId) const {
     return &_lockBuckets[resId % _numLockBuckets];
 }
 
-LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
+LockManager::Partition* LockManager::_getPartition(LockRequest* request) {
     return &_partitions[request->locker->getId() % _numPartitions];
 }
 
@@ -43,6 +43,7 @@
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
 
@@ -150,11 +151,14 @@ private:
     // Each locker maps to a partition that is used for resources acquired in intent modes
     // modes and potentially other modes that don't conflict with themselves. This avoids
     // contention on the regular LockHead in the lock manager.
-    struct Partition {
+    //
+    // The partition mutex is only held for a hash lookup and a list update, hence the spin lock.
+    // The alignment keeps lockers of neighbouring partitions from contending on a cache line.
+    struct MONGO_COMPILER_ALIGN_TYPE(128) Partition {
         PartitionedLockHead* find(ResourceId resId);
         PartitionedLockHead* findOrInsert(ResourceId resId);
         typedef unordered_map<ResourceId, PartitionedLockHead*> Map;
-        SimpleMutex mutex;
+        SpinLock mutex;
         Map data;
     };
 
@@ -168,7 +172,7 @@ private:
     /**
      * Retrieves the Partition that a particular LockRequest should use for intent locking.
      */
-    Partition* _getPartition(LockRequest* request) const;
+    Partition* _getPartition(LockRequest* request);
 
     /**
      * Prints the contents of a bucket to the log.
@@ -214,8 +218,10 @@ private:
     static const unsigned _numLockBuckets;
     LockBucket* _lockBuckets;
 
-    static const unsigned _numPartitions;
-    Partition* _partitions;
+    // Balance scalability of intent locks against potential added cost of conflicting locks.
+    // The exact value doesn't appear very important, but should be power of two
+    static const unsigned _numPartitions = 32;
+    Partition _partitions[_numPartitions];
 };
 
 
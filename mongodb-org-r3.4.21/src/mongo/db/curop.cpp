@@ -392,6 +392,10 @@ void CurOp::reportState(BSONObjBuilder* builder) {
         }
     }
 
+    if (!_phaseTimings.isEmpty()) {
+        builder->append("phaseTimings", _phaseTimings);
+    }
+
     builder->append("numYields", _numYields);
 }
 
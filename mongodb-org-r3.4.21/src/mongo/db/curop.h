@@ -374,6 +374,14 @@ public:
     const ProgressMeter& getProgressMeter() {
         return _progressMeter;
     }
+
+    /**
+     * Sets how long each phase of a multi-phase operation, such as an index build, has taken so
+     * far, for currentOp to report as "phaseTimings". The Client must be locked.
+     */
+    void setPhaseTimings_inlock(BSONObj phaseTimings) {
+        _phaseTimings = std::move(phaseTimings);
+    }
     CurOp* parent() const {
         return _parent;
     }
@@ -448,6 +456,7 @@ private:
     OpDebug _debug;
     std::string _message;
     ProgressMeter _progressMeter;
+    BSONObj _phaseTimings;
     int _numYields{0};
 
     // this is how much "extra" time a query might take
@@ -79,6 +79,7 @@
 #include "mongo/db/mongod_options.h"
 #include "mongo/db/op_observer_impl.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/pipeline/document_source_parallel_cursor.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/range_deleter_service.h"
 #include "mongo/db/repair_database.h"
@@ -779,7 +780,7 @@ ExitCode _initAndListen(int listenPort) {
 
         startMongoDFTDC();
 
-        getDeleter()->startWorkers();
+        getDeleter()->startWorkers(rangeDeleterWorkerThreads);
 
         restartInProgressIndexesFromLastShutdown(startupOpCtx.get());
 
@@ -1141,6 +1142,11 @@ static void shutdownTask() {
     // Shutdown Full-Time Data Capture
     stopMongoDFTDC();
 
+    // The workers of parallel aggregations hold locks and storage engine resources of their own,
+    // so they must have exited before the storage engine shuts down.
+    log() << "shutdown: waiting for parallel aggregation workers to exit...";
+    DocumentSourceParallelCursor::shutDownWorkers();
+
     if (txn) {
         ShardingState::get(txn)->shutDown(txn);
     }
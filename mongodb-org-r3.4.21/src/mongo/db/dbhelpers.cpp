@@ -277,6 +277,106 @@ MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchSize, int, 0);
 // continuing deletions.
 MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchDelayMS, int, 20);
 
+// The maximum number of bytes of documents to delete in a single batch during range deletion. A
+// batch ends as soon as either this or rangeDeleterBatchSize is reached. Negative values or 0
+// disable the limit.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchSizeBytes, int, 4 * 1024 * 1024);
+
+// The target number of documents per second that a single range deletion should not exceed. After
+// each batch the deletion sleeps for as long as it is ahead of this rate. Negative values or 0
+// (the default) disable the pacing.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterTargetDocsPerSecond, int, 0);
+
+// If the majority commit point trails this node's last applied optime by more than this many
+// seconds, range deletion pauses between batches until the secondaries catch up, for at most
+// kMaxSecondaryLagWait per batch. Negative values or 0 (the default) disable the check.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxSecondaryLagSecs, int, 0);
+
+namespace {
+
+// How often the sleeps between range deletion batches check whether the operation was interrupted
+const Milliseconds kInterruptCheckInterval(100);
+
+// The longest range deletion pauses after a batch for the secondaries to catch up
+const Seconds kMaxSecondaryLagWait(60);
+
+/**
+ * Sleeps for 'duration', checking every kInterruptCheckInterval whether the operation was
+ * interrupted. Throws if it is.
+ */
+void sleepForInterruptible(OperationContext* txn, Milliseconds duration) {
+    while (duration > Milliseconds(0)) {
+        txn->checkForInterrupt();
+
+        const Milliseconds slice = std::min(duration, kInterruptCheckInterval);
+        sleepFor(slice);
+        duration -= slice;
+    }
+}
+
+/**
+ * Returns how far the majority commit point is behind the last optime applied on this node, or
+ * zero if that cannot be determined (e.g. this node is not a member of a replica set).
+ */
+Seconds getMajorityCommitLag() {
+    auto replCoord = repl::getGlobalReplicationCoordinator();
+    if (replCoord->getReplicationMode() != repl::ReplicationCoordinator::modeReplSet) {
+        return Seconds(0);
+    }
+
+    const repl::OpTime lastCommitted = replCoord->getLastCommittedOpTime();
+    const repl::OpTime lastApplied = replCoord->getMyLastAppliedOpTime();
+    if (lastCommitted.isNull() || lastApplied <= lastCommitted) {
+        return Seconds(0);
+    }
+
+    return Seconds(static_cast<long long>(lastApplied.getTimestamp().getSecs()) -
+                   static_cast<long long>(lastCommitted.getTimestamp().getSecs()));
+}
+
+/**
+ * Blocks while the secondaries are more than rangeDeleterMaxSecondaryLagSecs behind, so that range
+ * deletion does not keep adding to the replication backlog, but no longer than
+ * kMaxSecondaryLagWait. Returns the time spent waiting. Throws if the operation is interrupted.
+ */
+Milliseconds waitForSecondariesToCatchUp(OperationContext* txn, const std::string& ns) {
+    Timer waitTimer;
+    bool logged = false;
+
+    while (true) {
+        const int maxLagSecs = rangeDeleterMaxSecondaryLagSecs.load();
+        if (maxLagSecs <= 0) {
+            break;
+        }
+
+        const Seconds lag = getMajorityCommitLag();
+        if (lag <= Seconds(maxLagSecs)) {
+            break;
+        }
+
+        if (Milliseconds(waitTimer.millis()) >= kMaxSecondaryLagWait) {
+            warning(LogComponent::kSharding)
+                << "resuming range deletion in " << ns << " although secondaries are still "
+                << durationCount<Seconds>(lag) << " seconds behind after waiting for "
+                << durationCount<Seconds>(kMaxSecondaryLagWait) << " seconds";
+            break;
+        }
+
+        if (!logged) {
+            MONGO_LOG_COMPONENT(1, LogComponent::kSharding)
+                << "pausing range deletion in " << ns << " because secondaries are "
+                << durationCount<Seconds>(lag) << " seconds behind";
+            logged = true;
+        }
+
+        sleepForInterruptible(txn, kInterruptCheckInterval);
+    }
+
+    return Milliseconds(waitTimer.millis());
+}
+
+}  // namespace
+
 long long Helpers::removeRange(OperationContext* txn,
                                const KeyRange& range,
                                BoundInclusion boundInclusion,
@@ -284,13 +384,15 @@ long long Helpers::removeRange(OperationContext* txn,
                                Milliseconds& replWaitDuration,
                                RemoveSaver* callback,
                                bool fromMigrate,
-                               bool onlyRemoveOrphanedDocs) {
+                               bool onlyRemoveOrphanedDocs,
+                               long long* deletedBytes) {
     Timer rangeRemoveTimer;
     const string& ns = range.ns;
 
     // The IndexChunk has a keyPattern that may apply to more than one index - we need to
     // select the index and get the full index keyPattern here.
     std::string indexName;
+    BSONObj indexKeyPatternObj;
     BSONObj min;
     BSONObj max;
 
@@ -319,7 +421,8 @@ long long Helpers::removeRange(OperationContext* txn,
         }
 
         indexName = idx->indexName();
-        KeyPattern indexKeyPattern(idx->keyPattern());
+        indexKeyPatternObj = idx->keyPattern().getOwned();
+        KeyPattern indexKeyPattern(indexKeyPatternObj);
 
         // Extend bounds to match the index we found
 
@@ -338,6 +441,13 @@ long long Helpers::removeRange(OperationContext* txn,
         << " with write concern: " << writeConcern.toBSON() << endl;
 
     long long numDeleted = 0;
+    long long numDeletedBytes = 0;
+
+    // Used to restart each batch right after the last deleted shard key, rather than scanning
+    // again over the index entries of the documents which were already deleted.
+    const BSONObj rangeMin = min;
+    const KeyPattern indexKeyPattern(indexKeyPatternObj);
+    const ShardKeyPattern shardKeyPattern(range.keyPattern);
 
     replWaitDuration = Milliseconds::zero();
 
@@ -348,6 +458,9 @@ long long Helpers::removeRange(OperationContext* txn,
             iterationsBetweenSleeps = std::max(int(internalQueryExecYieldIterations.load()), 1);
         }
         long long batchSize = writeConcern.shouldWaitForOtherNodes() ? 1 : iterationsBetweenSleeps;
+        const long long batchSizeBytes = rangeDeleterBatchSizeBytes.load();
+        long long batchBytes = 0;
+        BSONObj lastDeletedShardKey;
 
         // Scoping for write lock.
         {
@@ -379,7 +492,8 @@ long long Helpers::removeRange(OperationContext* txn,
 
             bool errorOccurred = false;
 
-            while (numDeleted - numDeletedPreviously < batchSize) {
+            while (numDeleted - numDeletedPreviously < batchSize &&
+                   (batchSizeBytes <= 0 || batchBytes < batchSizeBytes)) {
 
                 RecordId rloc;
                 BSONObj obj;
@@ -439,6 +553,10 @@ long long Helpers::removeRange(OperationContext* txn,
                     }
                 }
 
+                // 'obj' may not be valid any more once the document is deleted.
+                const int objSize = obj.objsize();
+                const BSONObj shardKey = shardKeyPattern.extractShardKeyFromDoc(obj);
+
                 exec->saveState();
 
                 MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
@@ -462,6 +580,9 @@ long long Helpers::removeRange(OperationContext* txn,
                 }
                 MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "delete range", ns);
 
+                batchBytes += objSize;
+                lastDeletedShardKey = shardKey;
+
                 if (!exec->restoreState()) {
                     MONGO_LOG_COMPONENT(1, LogComponent::kSharding)
                         << "unable to restore cursor state while trying to delete " << redact(min)
@@ -475,12 +596,21 @@ long long Helpers::removeRange(OperationContext* txn,
                 numDeleted++;
             }
 
+            numDeletedBytes += batchBytes;
+
             if (errorOccurred) {
                 break;
             }
 
         }  // End scope for write lock.
 
+        // Every document before the last deleted shard key is gone, so the next batch can start
+        // its index scan from there.
+        if (!lastDeletedShardKey.isEmpty()) {
+            min = Helpers::toKeyFormat(
+                indexKeyPattern.extendRangeBound(lastDeletedShardKey, false));
+        }
+
         if (numDeleted > 0) {
             if (writeConcern.shouldWaitForOtherNodes()) {
                 repl::ReplicationCoordinator::StatusAndDuration replStatus =
@@ -520,6 +650,18 @@ long long Helpers::removeRange(OperationContext* txn,
             if (batchSize != 1 || numDeleted % iterationsBetweenSleeps == 0) {
                 sleepmillis(rangeDeleterBatchDelayMS.load());
             }
+
+            // Hold back if this deletion is running ahead of rangeDeleterTargetDocsPerSecond.
+            const long long targetDocsPerSecond = rangeDeleterTargetDocsPerSecond.load();
+            if (targetDocsPerSecond > 0) {
+                const long long expectedMillis = numDeleted * 1000 / targetDocsPerSecond;
+                const long long aheadMillis = expectedMillis - rangeRemoveTimer.millis();
+                if (aheadMillis > 0) {
+                    sleepForInterruptible(txn, Milliseconds(aheadMillis));
+                }
+            }
+
+            replWaitDuration += waitForSecondariesToCatchUp(txn, ns);
         }
 
         // Loop back to get a new plan and go again.
@@ -530,9 +672,14 @@ long long Helpers::removeRange(OperationContext* txn,
             << "Helpers::removeRangeUnlocked time spent waiting for replication: "
             << durationCount<Milliseconds>(replWaitDuration) << "ms" << endl;
 
-    MONGO_LOG_COMPONENT(1, LogComponent::kSharding) << "end removal of " << redact(min) << " to "
-                                                    << redact(max) << " in " << ns << " (took "
-                                                    << rangeRemoveTimer.millis() << "ms)" << endl;
+    MONGO_LOG_COMPONENT(1, LogComponent::kSharding)
+        << "end removal of " << redact(rangeMin) << " to " << redact(max) << " in " << ns << " ("
+        << numDeleted << " documents, " << numDeletedBytes << " bytes, took "
+        << rangeRemoveTimer.millis() << "ms)" << endl;
+
+    if (deletedBytes) {
+        *deletedBytes = numDeletedBytes;
+    }
 
     return numDeleted;
 }
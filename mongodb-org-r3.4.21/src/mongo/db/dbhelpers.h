@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <boost/filesystem/path.hpp>
 #include <memory>
 
@@ -44,6 +45,16 @@ class OperationContext;
 struct KeyRange;
 struct WriteConcernOptions;
 
+/**
+ * Delay in milliseconds between the batches of Helpers::removeRange.
+ */
+extern std::atomic<int> rangeDeleterBatchDelayMS;  // NOLINT
+
+/**
+ * Maximum number of bytes of documents which Helpers::removeRange deletes in a single batch.
+ */
+extern std::atomic<int> rangeDeleterBatchSizeBytes;  // NOLINT
+
 /**
  * db helpers are helper functions and classes that let us easily manipulate the local
  * database instance in-proc.
@@ -153,6 +164,8 @@ struct Helpers {
      * Returns -1 when no usable index exists
      *
      * Does oplog the individual document deletions.
+     *
+     * If deletedBytes is not NULL, it is set to the total size of the deleted documents.
      * // TODO: Refactor this mechanism, it is growing too large
      */
     static long long removeRange(OperationContext* txn,
@@ -162,7 +175,8 @@ struct Helpers {
                                  Milliseconds& replWaitDuration,
                                  RemoveSaver* callback = NULL,
                                  bool fromMigrate = false,
-                                 bool onlyRemoveOrphanedDocs = false);
+                                 bool onlyRemoveOrphanedDocs = false,
+                                 long long* deletedBytes = NULL);
 
     /**
      * Remove all documents from a collection.
@@ -33,6 +33,7 @@
 #include "mongo/db/exec/cached_plan.h"
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/multi_plan.h"
 #include "mongo/db/exec/scoped_timer.h"
@@ -41,7 +42,6 @@
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/plan_yield_policy.h"
-#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/stage_builder.h"
 #include "mongo/stdx/memory.h"
@@ -59,13 +59,19 @@ CachedPlanStage::CachedPlanStage(OperationContext* txn,
                                  CanonicalQuery* cq,
                                  const QueryPlannerParams& params,
                                  size_t decisionWorks,
+                                 size_t maxWorksBeforeReplan,
+                                 bool needsReevaluation,
+                                 size_t executionSampleRate,
                                  PlanStage* root)
     : PlanStage(kStageType, txn),
       _collection(collection),
       _ws(ws),
       _canonicalQuery(cq),
       _plannerParams(params),
-      _decisionWorks(decisionWorks) {
+      _decisionWorks(decisionWorks),
+      _maxWorksBeforeReplan(maxWorksBeforeReplan),
+      _needsReevaluation(needsReevaluation),
+      _executionSampleRate(executionSampleRate) {
     invariant(_collection);
     _children.emplace_back(root);
 }
@@ -76,10 +82,24 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
     // make sense.
     ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
 
+    if (_needsReevaluation) {
+        LOG(1) << "A recent run of the cached plan cost much more than usual. Replanning query: "
+               << redact(_canonicalQuery->toStringShort())
+               << " plan summary before replan: " << Explain::getPlanSummary(child().get());
+
+        recordReplanDecision("reevaluated", 0);
+
+        // Only the race actually run consumes the flag. Nothing to clear if the entry was evicted
+        // meanwhile.
+        _collection->infoCache()->getPlanCache()->clearNeedsReevaluation(*_canonicalQuery);
+
+        const bool shouldCache = true;
+        return replan(yieldPolicy, shouldCache);
+    }
+
     // If we work this many times during the trial period, then we will replan the
     // query from scratch.
-    size_t maxWorksBeforeReplan =
-        static_cast<size_t>(internalQueryCacheEvictionRatio * _decisionWorks);
+    const size_t maxWorksBeforeReplan = _maxWorksBeforeReplan;
 
     // The trial period ends without replanning if the cached plan produces this many results.
     size_t numResults = MultiPlanStage::getTrialPeriodNumToReturn(*_canonicalQuery);
@@ -168,6 +188,7 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
            << redact(_canonicalQuery->toStringShort())
            << " plan summary before replan: " << Explain::getPlanSummary(child().get());
 
+    recordReplanDecision("trialExceededWorks", maxWorksBeforeReplan);
     const bool shouldCache = true;
     return replan(yieldPolicy, shouldCache);
 }
@@ -285,6 +306,7 @@ bool CachedPlanStage::isEOF() {
 
 PlanStage::StageState CachedPlanStage::doWork(WorkingSetID* out) {
     if (isEOF()) {
+        recordExecution();
         return PlanStage::IS_EOF;
     }
 
@@ -296,7 +318,11 @@ PlanStage::StageState CachedPlanStage::doWork(WorkingSetID* out) {
     }
 
     // Nothing left in trial period buffer.
-    return child()->work(out);
+    StageState state = child()->work(out);
+    if (PlanStage::IS_EOF == state) {
+        recordExecution();
+    }
+    return state;
 }
 
 void CachedPlanStage::doInvalidate(OperationContext* txn,
@@ -342,4 +368,35 @@ void CachedPlanStage::updatePlanCache() {
     }
 }
 
+void CachedPlanStage::recordExecution() {
+    // Only runs of the cached plan count, not runs of a replanned one.
+    if (_executionRecorded || _specificStats.replanned) {
+        return;
+    }
+    _executionRecorded = true;
+
+    // Recording a run builds the stats tree and locks the cache partition, so only a sample of
+    // the runs is recorded to keep that off the path of every cached query.
+    if (_executionSampleRate > 1) {
+        PseudoRandom& prng = getOpCtx()->getClient()->getPrng();
+        if (prng.nextInt32(static_cast<int32_t>(_executionSampleRate)) != 0) {
+            return;
+        }
+    }
+
+    PlanCache* cache = _collection->infoCache()->getPlanCache();
+    Status status = cache->recordExecution(*_canonicalQuery, *child()->getStats());
+    if (!status.isOK()) {
+        LOG(5) << _canonicalQuery->ns() << ": Failed to record execution of cached plan: "
+               << redact(status) << " - query " << redact(_canonicalQuery->toStringShort())
+               << " is no longer in plan cache.";
+    }
+}
+
+void CachedPlanStage::recordReplanDecision(const std::string& reason, size_t works) {
+    // Nothing to record if the entry was evicted meanwhile.
+    PlanCache* cache = _collection->infoCache()->getPlanCache();
+    cache->recordDecision(*_canonicalQuery, {Date_t::now(), reason, double(works)});
+}
+
 }  // namespace mongo
@@ -59,6 +59,9 @@ public:
                     CanonicalQuery* cq,
                     const QueryPlannerParams& params,
                     size_t decisionWorks,
+                    size_t maxWorksBeforeReplan,
+                    bool needsReevaluation,
+                    size_t executionSampleRate,
                     PlanStage* root);
 
     bool isEOF() final;
@@ -84,6 +87,8 @@ public:
      * Feedback from the trial period is passed to the plan cache. If the performance is lower
      * than expected, the old plan is evicted and a new plan is selected from scratch (again
      * yielding according to 'yieldPolicy'). Otherwise, the cached plan is run.
+     *
+     * If the cache entry needs reevaluation, a new plan is selected without a trial period.
      */
     Status pickBestPlan(PlanYieldPolicy* yieldPolicy);
 
@@ -96,6 +101,17 @@ private:
      */
     void updatePlanCache();
 
+    /**
+     * Passes the stats of a complete run of the cached plan to the plan cache, once. Only one in
+     * '_executionSampleRate' runs is passed on.
+     */
+    void recordExecution();
+
+    /**
+     * Records in the plan cache entry why the query is being replanned.
+     */
+    void recordReplanDecision(const std::string& reason, size_t works);
+
     /**
      * Uses the QueryPlanner and the MultiPlanStage to re-generate candidate plans for this
      * query and select a new winner.
@@ -130,6 +146,18 @@ private:
     // cached.
     size_t _decisionWorks;
 
+    // The trial period replans once it takes this many works.
+    size_t _maxWorksBeforeReplan;
+
+    // Whether to race the candidate plans again without trying the cached plan.
+    bool _needsReevaluation;
+
+    // The stats of one in this many complete runs are passed to the plan cache.
+    size_t _executionSampleRate;
+
+    // Whether the stats of a complete run have been passed to the plan cache.
+    bool _executionRecorded = false;
+
     // If we fall back to re-planning the query, and there is just one resulting query solution,
     // that solution is owned here.
     std::unique_ptr<QuerySolution> _replannedQs;
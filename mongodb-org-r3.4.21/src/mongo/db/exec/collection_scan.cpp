@@ -38,6 +38,7 @@
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -66,6 +67,17 @@ CollectionScan::CollectionScan(OperationContext* txn,
       _wsidForFetch(_workingSet->allocate()) {
     // Explain reports the direction of the collection scan.
     _specificStats.direction = params.direction;
+
+    if (_filter && internalQueryExecCompileFilters.load()) {
+        _compiledFilter = CompiledMatchExpression::compile(_filter);
+    }
+}
+
+PlanStage::StageState CollectionScan::doWorkBatch(size_t maxWorks,
+                                                  WorkBatch* batch,
+                                                  WorkingSetID* out) {
+    return fillBatch(
+        maxWorks, batch, out, _workingSet, [this](WorkingSetID* id) { return doWork(id); });
 }
 
 PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
@@ -109,6 +121,11 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
 
             _cursor = _params.collection->getCursor(getOpCtx(), forward);
 
+            if (!_params.minRecord.isNull() || !_params.maxRecord.isNull()) {
+                invariant(_params.start.isNull() && !_params.tailable);
+                invariant(_cursor->setRange(_params.minRecord, _params.maxRecord));
+            }
+
             if (!_lastSeenId.isNull()) {
                 invariant(_params.tailable);
                 // Seek to where we were last time. If it no longer exists, mark us as dead
@@ -184,9 +201,12 @@ PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID* out) {
     ++_specificStats.docsTested;
 
-    if (Filter::passes(member, _filter)) {
+    const bool passes = _compiledFilter ? _compiledFilter->matchesBSON(member->obj.value())
+                                        : Filter::passes(member, _filter);
+    if (passes) {
         if (_params.stopApplyingFilterAfterFirstMatch) {
             _filter = nullptr;
+            _compiledFilter.reset();
         }
         *out = memberID;
         return PlanStage::ADVANCED;
@@ -50,6 +50,12 @@ struct CollectionScanParams {
 
     Direction direction = FORWARD;
 
+    // If either is non-null, a forward scan only returns records with RecordIds in
+    // [minRecord, maxRecord), where a null RecordId leaves that side open. The record store cursor
+    // must support SeekableRecordCursor::setRange().
+    RecordId minRecord;
+    RecordId maxRecord;
+
     // Do we want the scan to be 'tailable'?  Only meaningful if the collection is capped.
     bool tailable = false;
 
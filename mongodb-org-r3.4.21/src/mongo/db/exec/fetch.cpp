@@ -35,6 +35,8 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -58,7 +60,10 @@ FetchStage::FetchStage(OperationContext* txn,
       _collection(collection),
       _ws(ws),
       _filter(filter),
-      _idRetrying(WorkingSet::INVALID_ID) {
+      _idRetrying(WorkingSet::INVALID_ID),
+      // Batches are only used where there are no RecordFetchers or invalidations to handle.
+      _maxBatchSize(supportsDocLocking() ? std::max(internalQueryExecFetchBatchSize.load(), 0)
+                                         : 0) {
     _children.emplace_back(child);
 }
 
@@ -71,6 +76,10 @@ bool FetchStage::isEOF() {
         return false;
     }
 
+    if (!_batch.empty() || !_fetched.empty()) {
+        return false;
+    }
+
     return child()->isEOF();
 }
 
@@ -79,6 +88,10 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
+    if (_maxBatchSize > 1) {
+        return doWorkBatched(out);
+    }
+
     // Either retry the last WSM we worked on or get a new one from our child.
     WorkingSetID id;
     StageState status;
@@ -132,17 +145,96 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
 
         return returnIfMatches(member, id, out);
     } else if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+        return returnChildFailure(status, id, out);
+    } else if (PlanStage::NEED_YIELD == status) {
         *out = id;
-        // If a stage fails, it may create a status WSM to indicate why it
-        // failed, in which case 'id' is valid.  If ID is invalid, we
-        // create our own error message.
-        if (WorkingSet::INVALID_ID == id) {
-            mongoutils::str::stream ss;
-            ss << "fetch stage failed to read in results from child";
-            Status status(ErrorCodes::InternalError, ss);
-            *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+
+    return status;
+}
+
+PlanStage::StageState FetchStage::doWorkBatched(WorkingSetID* out) {
+    if (_fetched.empty()) {
+        if (_batch.size() < _batchSize && !child()->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            StageState status = child()->work(&id);
+            if (PlanStage::ADVANCED == status) {
+                _batch.push_back(id);
+            } else if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+                return returnChildFailure(status, id, out);
+            } else if (PlanStage::NEED_YIELD == status) {
+                *out = id;
+                return status;
+            }
+
+            if (_batch.empty() || (_batch.size() < _batchSize && !child()->isEOF())) {
+                return PlanStage::NEED_TIME;
+            }
+        }
+
+        try {
+            fetchBatch();
+        } catch (const WriteConflictException& wce) {
+            // The batch is retried once we have yielded.
+            *out = WorkingSet::INVALID_ID;
+            return NEED_YIELD;
+        }
+
+        if (_fetched.empty()) {
+            return PlanStage::NEED_TIME;
+        }
+    }
+
+    WorkingSetID id = _fetched.front();
+    _fetched.pop_front();
+    return returnIfMatches(_ws->get(id), id, out);
+}
+
+PlanStage::StageState FetchStage::doWorkBatch(size_t maxWorks,
+                                              WorkBatch* batch,
+                                              WorkingSetID* out) {
+    if (_maxBatchSize <= 1 || WorkingSet::INVALID_ID != _idRetrying || !_batch.empty() ||
+        !_fetched.empty()) {
+        // We fetch one member at a time, or doWork() has a batch under way.
+        return fillBatch(
+            maxWorks, batch, out, _ws, [this](WorkingSetID* id) { return doWork(id); });
+    }
+
+    if (isEOF()) {
+        batch->works = 1;
+        return PlanStage::IS_EOF;
+    }
+
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    StageState status =
+        child()->workBatch(std::min(maxWorks, _maxBatchSize), &_childBatch, &id);
+    batch->works = _childBatch.works;
+
+    if (!_childBatch.results.empty()) {
+        _batch.swap(_childBatch.results);
+        try {
+            fetchBatch();
+        } catch (const WriteConflictException& wce) {
+            // '_batch' is fetched by doWork() once we have yielded. A failure of our child ends
+            // the query regardless, and a yield it requested serves for ours.
+            if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+                return returnChildFailure(status, id, out);
+            }
+            *out = (PlanStage::NEED_YIELD == status) ? id : WorkingSet::INVALID_ID;
+            return NEED_YIELD;
+        }
+
+        for (WorkingSetID fetched : _fetched) {
+            WorkingSetID result;
+            if (PlanStage::ADVANCED == returnIfMatches(_ws->get(fetched), fetched, &result)) {
+                batch->results.push_back(result);
+            }
         }
-        return status;
+        _fetched.clear();
+    }
+
+    if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+        return returnChildFailure(status, id, out);
     } else if (PlanStage::NEED_YIELD == status) {
         *out = id;
     }
@@ -150,6 +242,73 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+void FetchStage::fetchBatch() {
+    if (!_cursor)
+        _cursor = _collection->getCursor(getOpCtx());
+
+    // The members to fetch, by RecordId, along with their positions in '_batch'. Those which
+    // already have an object need no fetching.
+    std::vector<std::pair<RecordId, size_t>> toFetch;
+    toFetch.reserve(_batch.size());
+    for (size_t i = 0; i < _batch.size(); ++i) {
+        WorkingSetMember* member = _ws->get(_batch[i]);
+        if (!member->hasObj()) {
+            verify(WorkingSetMember::RID_AND_IDX == member->getState());
+            verify(member->hasRecordId());
+            toFetch.emplace_back(member->recordId, i);
+        }
+    }
+    std::sort(toFetch.begin(), toFetch.end());
+
+    std::vector<RecordId> ids;
+    ids.reserve(toFetch.size());
+    for (auto&& entry : toFetch) {
+        ids.push_back(entry.first);
+    }
+    auto records = _cursor->seekExactBatch(ids);
+    invariant(records.size() == ids.size());
+
+    std::vector<bool> exists(_batch.size(), true);
+    for (size_t i = 0; i < toFetch.size(); ++i) {
+        const size_t position = toFetch[i].second;
+        if (!records[i] ||
+            !WorkingSetCommon::fetchFromRecordData(
+                getOpCtx(), _ws, _batch[position], std::move(records[i]->data))) {
+            exists[position] = false;
+        }
+    }
+
+    const size_t numFetched = toFetch.size();
+    for (size_t i = 0; i < _batch.size(); ++i) {
+        if (exists[i]) {
+            _fetched.push_back(_batch[i]);
+        } else {
+            _ws->free(_batch[i]);
+        }
+    }
+
+    _specificStats.alreadyHasObj += _batch.size() - numFetched;
+    ++_specificStats.batches;
+    _batch.clear();
+    _batchSize = std::min(_batchSize * 2, _maxBatchSize);
+}
+
+PlanStage::StageState FetchStage::returnChildFailure(StageState status,
+                                                    WorkingSetID id,
+                                                    WorkingSetID* out) {
+    *out = id;
+    // If a stage fails, it may create a status WSM to indicate why it
+    // failed, in which case 'id' is valid.  If ID is invalid, we
+    // create our own error message.
+    if (WorkingSet::INVALID_ID == id) {
+        mongoutils::str::stream ss;
+        ss << "fetch stage failed to read in results from child";
+        Status status(ErrorCodes::InternalError, ss);
+        *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+    return status;
+}
+
 void FetchStage::doSaveState() {
     if (_cursor)
         _cursor->saveUnpositioned();
@@ -180,6 +339,20 @@ void FetchStage::doInvalidate(OperationContext* txn, const RecordId& dl, Invalid
             WorkingSetCommon::fetchAndInvalidateRecordId(txn, member, _collection);
         }
     }
+
+    // The same goes for the members we hold when fetching in batches.
+    for (WorkingSetID id : _batch) {
+        WorkingSetMember* member = _ws->get(id);
+        if (member->hasRecordId() && (member->recordId == dl)) {
+            WorkingSetCommon::fetchAndInvalidateRecordId(txn, member, _collection);
+        }
+    }
+    for (WorkingSetID id : _fetched) {
+        WorkingSetMember* member = _ws->get(id);
+        if (member->hasRecordId() && (member->recordId == dl)) {
+            WorkingSetCommon::fetchAndInvalidateRecordId(txn, member, _collection);
+        }
+    }
 }
 
 PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
@@ -28,7 +28,9 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
@@ -59,6 +61,7 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, WorkBatch* batch, WorkingSetID* out) final;
 
     void doSaveState() final;
     void doRestoreState() final;
@@ -83,6 +86,25 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Returns the FAILURE or DEAD 'status' of our child, with a status member describing it in
+     * *out if the child didn't provide one as 'id'.
+     */
+    StageState returnChildFailure(StageState status, WorkingSetID id, WorkingSetID* out);
+
+    /**
+     * doWork() when fetching in batches: buffers the results of our child in '_batch' until it is
+     * full, then fetches them all at once and returns them in the order our child returned them.
+     */
+    StageState doWorkBatched(WorkingSetID* out);
+
+    /**
+     * Fetches the members of '_batch' with a single call to SeekableRecordCursor::seekExactBatch()
+     * and moves those which still exist to '_fetched'. May throw WriteConflictException, in which
+     * case '_batch' is left as it was.
+     */
+    void fetchBatch();
+
     // Collection which is used by this stage. Used to resolve record ids retrieved by child
     // stages. The lifetime of the collection must supersede that of the stage.
     const Collection* _collection;
@@ -98,6 +120,18 @@ private:
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // When fetching in batches, the results of our child yet to be fetched and those fetched but
+    // not yet returned, both in the order our child returned them. The size of the next batch
+    // doubles after each batch, up to '_maxBatchSize'.
+    const size_t _maxBatchSize;
+    size_t _batchSize = 1;
+    std::vector<WorkingSetID> _batch;
+    std::deque<WorkingSetID> _fetched;
+
+    // Reused for the batches of our child. A batch of ours fetches a whole batch of our child at
+    // once, rather than buffering its results one call at a time.
+    WorkBatch _childBatch;
+
     // Stats
     FetchStats _specificStats;
 };
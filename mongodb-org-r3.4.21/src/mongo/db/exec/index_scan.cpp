@@ -107,27 +107,45 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
         // Start at one key, end at another.
         _startKey = _params.bounds.startKey;
         _endKey = _params.bounds.endKey;
-        _indexCursor->setEndPosition(_endKey, _endKeyInclusive);
-        return _indexCursor->seek(_startKey, _startKeyInclusive);
-    } else {
+    } else if (!IndexBoundsBuilder::isSingleInterval(
+                   _params.bounds, &_startKey, &_startKeyInclusive, &_endKey, &_endKeyInclusive)) {
         // For single intervals, we can use an optimized scan which checks against the position
         // of an end cursor.  For all other index scans, we fall back on using
         // IndexBoundsChecker to determine when we've finished the scan.
-        if (IndexBoundsBuilder::isSingleInterval(
-                _params.bounds, &_startKey, &_startKeyInclusive, &_endKey, &_endKeyInclusive)) {
-            _indexCursor->setEndPosition(_endKey, _endKeyInclusive);
-            return _indexCursor->seek(_startKey, _startKeyInclusive);
-        } else {
-            _checker.reset(new IndexBoundsChecker(&_params.bounds, _keyPattern, _params.direction));
+        _checker.reset(new IndexBoundsChecker(&_params.bounds, _keyPattern, _params.direction));
+    }
 
-            if (!_checker->getStartSeekPoint(&_seekPoint))
-                return boost::none;
+    // The bounds checker and the filter need the keys themselves, so only let the cursor
+    // project keys when the end of the scan is left to the cursor and nothing else looks at them.
+    _cursorProjectsKeys = !_coveredFieldNames.empty() && !_checker && !_filter &&
+        !_params.addKeyMetadata && _indexCursor->setKeyFieldNames(_coveredFieldNames);
 
-            return _indexCursor->seek(_seekPoint);
-        }
+    if (_checker) {
+        if (!_checker->getStartSeekPoint(&_seekPoint))
+            return boost::none;
+
+        return _indexCursor->seek(_seekPoint);
+    }
+
+    _indexCursor->setEndPosition(_endKey, _endKeyInclusive);
+    return _indexCursor->seek(_startKey, _startKeyInclusive);
+}
+
+void IndexScan::setCoveredKeyFieldNames(const std::vector<StringData>& fieldNames) {
+    invariant(_scanState == INITIALIZING);
+    _coveredFieldNames.clear();
+    for (auto&& fieldName : fieldNames) {
+        _coveredFieldNames.push_back(fieldName.toString());
     }
 }
 
+PlanStage::StageState IndexScan::doWorkBatch(size_t maxWorks,
+                                             WorkBatch* batch,
+                                             WorkingSetID* out) {
+    return fillBatch(
+        maxWorks, batch, out, _workingSet, [this](WorkingSetID* id) { return doWork(id); });
+}
+
 PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
     // Get the next kv pair from the index, if any.
     boost::optional<IndexKeyEntry> kv;
@@ -152,8 +170,9 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
     }
 
     if (kv) {
-        // In debug mode, check that the cursor isn't lying to us.
-        if (kDebugBuild && !_startKey.isEmpty()) {
+        // In debug mode, check that the cursor isn't lying to us. Projected keys can't be
+        // compared against the bounds, so the cursor's own KeyString comparisons are trusted.
+        if (kDebugBuild && !_cursorProjectsKeys && !_startKey.isEmpty()) {
             int cmp = kv->key.woCompare(_startKey,
                                         Ordering::make(_params.descriptor->keyPattern()),
                                         /*compareFieldNames*/ false);
@@ -162,7 +181,7 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
             dassert(_forward ? cmp >= 0 : cmp <= 0);
         }
 
-        if (kDebugBuild && !_endKey.isEmpty()) {
+        if (kDebugBuild && !_cursorProjectsKeys && !_endKey.isEmpty()) {
             int cmp = kv->key.woCompare(_endKey,
                                         Ordering::make(_params.descriptor->keyPattern()),
                                         /*compareFieldNames*/ false);
@@ -216,12 +235,36 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
         }
     }
 
-    if (!kv->key.isOwned())
-        kv->key = kv->key.getOwned();
-
     // We found something to return, so fill out the WSM.
     WorkingSetID id = _workingSet->allocate();
     WorkingSetMember* member = _workingSet->get(id);
+
+    if (!_coveredFieldNames.empty()) {
+        // Hand back the covered projection directly, skipping the copy of the key.
+        BSONObj projected;
+        if (_cursorProjectsKeys) {
+            projected = std::move(kv->key);
+        } else {
+            BSONObjBuilder bob;
+            size_t keyIndex = 0;
+            for (auto&& elt : kv->key) {
+                if (keyIndex < _coveredFieldNames.size() && !_coveredFieldNames[keyIndex].empty()) {
+                    bob.appendAs(elt, _coveredFieldNames[keyIndex]);
+                }
+                ++keyIndex;
+            }
+            projected = bob.obj();
+        }
+
+        member->obj = Snapshotted<BSONObj>(SnapshotId(), projected);
+        member->transitionToOwnedObj();
+        *out = id;
+        return PlanStage::ADVANCED;
+    }
+
+    if (!kv->key.isOwned())
+        kv->key = kv->key.getOwned();
+
     member->recordId = kv->loc;
     member->keyData.push_back(IndexKeyDatum(_keyPattern, kv->key, _iam));
     _workingSet->transitionToRecordIdAndIdx(id);
@@ -96,6 +96,7 @@ public:
               const MatchExpression* filter);
 
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, WorkBatch* batch, WorkingSetID* out) final;
     bool isEOF() final;
     void doSaveState() final;
     void doRestoreState() final;
@@ -111,6 +112,16 @@ public:
 
     const SpecificStats* getSpecificStats() const final;
 
+    /**
+     * Makes this scan produce each key as an owned object holding a covered projection of the
+     * key, instead of as index key data for a parent ProjectionStage to rebuild. The i-th key
+     * field is named 'fieldNames[i]', and fields with an empty name are left out.
+     *
+     * When the bounds are a single interval and there is no filter the projection is decoded
+     * straight out of the index cursor's keys. Must be called before the first call to work().
+     */
+    void setCoveredKeyFieldNames(const std::vector<StringData>& fieldNames);
+
     static const char* kStageType;
 
 private:
@@ -174,6 +185,12 @@ private:
     bool _startKeyInclusive;
     // Is the end key included in the range?
     bool _endKeyInclusive;
+
+    // Field names for a covered projection of each key, if set by setCoveredKeyFieldNames().
+    std::vector<std::string> _coveredFieldNames;
+
+    // Is the index cursor returning keys already projected with _coveredFieldNames?
+    bool _cursorProjectsKeys = false;
 };
 
 }  // namespace mongo
@@ -68,17 +68,34 @@ PlanStage::StageState LimitStage::doWork(WorkingSetID* out) {
         --_numToReturn;
         return PlanStage::ADVANCED;
     } else if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+        return returnChildFailure(status, id, out);
+    } else if (PlanStage::NEED_YIELD == status) {
         *out = id;
-        // If a stage fails, it may create a status WSM to indicate why it
-        // failed, in which case 'id' is valid.  If ID is invalid, we
-        // create our own error message.
-        if (WorkingSet::INVALID_ID == id) {
-            mongoutils::str::stream ss;
-            ss << "limit stage failed to read in results from child";
-            Status status(ErrorCodes::InternalError, ss);
-            *out = WorkingSetCommon::allocateStatusMember(_ws, status);
-        }
-        return status;
+    }
+
+    return status;
+}
+
+PlanStage::StageState LimitStage::doWorkBatch(size_t maxWorks,
+                                              WorkBatch* batch,
+                                              WorkingSetID* out) {
+    if (0 == _numToReturn) {
+        // We've returned as many results as we're limited to.
+        batch->works = 1;
+        return PlanStage::IS_EOF;
+    }
+
+    // Each unit of work of our child produces at most one result, so limiting the works of its
+    // batch keeps us within our limit.
+    const size_t childMaxWorks = std::min(maxWorks, static_cast<size_t>(_numToReturn));
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    StageState status = child()->workBatch(childMaxWorks, &_childBatch, &id);
+    batch->works = _childBatch.works;
+    batch->results.swap(_childBatch.results);
+    _numToReturn -= batch->results.size();
+
+    if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+        return returnChildFailure(status, id, out);
     } else if (PlanStage::NEED_YIELD == status) {
         *out = id;
     }
@@ -86,6 +103,22 @@ PlanStage::StageState LimitStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState LimitStage::returnChildFailure(StageState status,
+                                                     WorkingSetID id,
+                                                     WorkingSetID* out) {
+    *out = id;
+    // If a stage fails, it may create a status WSM to indicate why it
+    // failed, in which case 'id' is valid.  If ID is invalid, we
+    // create our own error message.
+    if (WorkingSet::INVALID_ID == id) {
+        mongoutils::str::stream ss;
+        ss << "limit stage failed to read in results from child";
+        Status status(ErrorCodes::InternalError, ss);
+        *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+    return status;
+}
+
 unique_ptr<PlanStageStats> LimitStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_LIMIT);
@@ -49,6 +49,7 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, WorkBatch* batch, WorkingSetID* out) final;
 
     StageType stageType() const final {
         return STAGE_LIMIT;
@@ -61,11 +62,20 @@ public:
     static const char* kStageType;
 
 private:
+    /**
+     * Returns the FAILURE or DEAD 'status' of our child, with a status member describing it in
+     * *out if the child didn't provide one as 'id'.
+     */
+    StageState returnChildFailure(StageState status, WorkingSetID id, WorkingSetID* out);
+
     WorkingSet* _ws;
 
     // We only return this many results.
     long long _numToReturn;
 
+    // Reused for the batches of our child.
+    WorkBatch _childBatch;
+
     // Stats
     LimitStats _specificStats;
 };
@@ -56,6 +56,28 @@ PlanStage::StageState PlanStage::work(WorkingSetID* out) {
     return workResult;
 }
 
+PlanStage::StageState PlanStage::workBatch(size_t maxWorks, WorkBatch* batch, WorkingSetID* out) {
+    invariant(_opCtx);
+    invariant(maxWorks > 0);
+    ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
+    batch->clear();
+
+    StageState workResult = doWorkBatch(maxWorks, batch, out);
+
+    // Account for the batch as for the calls to work() it stands for. All but the last unit of
+    // work of a batch ended early advanced or needed time.
+    _commonStats.works += batch->works;
+    _commonStats.advanced += batch->results.size();
+    const size_t endedEarly = (StageState::NEED_TIME == workResult) ? 0 : 1;
+    dassert(batch->works >= batch->results.size() + endedEarly);
+    _commonStats.needTime += batch->works - batch->results.size() - endedEarly;
+    if (StageState::NEED_YIELD == workResult) {
+        ++_commonStats.needYield;
+    }
+
+    return workResult;
+}
+
 void PlanStage::saveState() {
     ++_commonStats.yields;
     for (auto&& child : _children) {
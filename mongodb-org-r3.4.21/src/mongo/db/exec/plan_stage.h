@@ -188,6 +188,41 @@ public:
      */
     StageState work(WorkingSetID* out);
 
+    /**
+     * The output of workBatch().
+     */
+    struct WorkBatch {
+        void clear() {
+            results.clear();
+            works = 0;
+        }
+
+        // The results produced, in order. The caller must free them from the working set when
+        // done with them, as for a result of work().
+        std::vector<WorkingSetID> results;
+
+        // The number of units of work performed, each of which would have been a call to work().
+        size_t works = 0;
+    };
+
+    /**
+     * Performs up to 'maxWorks' units of work on the query, replacing the contents of 'batch'
+     * with the results they produced. The results come before the returned state, so the caller
+     * must consume them before acting on it:
+     *
+     *  - NEED_TIME if the batch ended with more work to do,
+     *  - IS_EOF, NEED_YIELD, FAILURE or DEAD, with *out set, as if returned by work(), if the last
+     *    unit of work ended the batch early.
+     *
+     * The results remain valid until the stage is worked again or saves its state, even though
+     * the stage may have moved its cursors on after producing them.
+     *
+     * A batch costs a single virtual call and timer for all of its results. Stages which can
+     * produce or transform results in bulk override doWorkBatch(); the others perform each unit of
+     * work with doWork().
+     */
+    StageState workBatch(size_t maxWorks, WorkBatch* batch, WorkingSetID* out);
+
     /**
      * Returns true if no more work can be done on the query / out of results.
      */
@@ -324,6 +359,43 @@ protected:
      */
     virtual StageState doWork(WorkingSetID* out) = 0;
 
+    /**
+     * Performs up to 'maxWorks' units of work into 'batch', which is empty.  See comment at
+     * workBatch() above.
+     */
+    virtual StageState doWorkBatch(size_t maxWorks, WorkBatch* batch, WorkingSetID* out) {
+        return fillBatch(
+            maxWorks, batch, out, nullptr, [this](WorkingSetID* id) { return doWork(id); });
+    }
+
+    /**
+     * Fills 'batch' by calling 'doWorkFn', which behaves as doWork(), once per unit of work.
+     * Stages whose doWork() is final pass a call to it which the compiler needn't dispatch.
+     *
+     * A result may point into a cursor which the next unit of work moves, so each result is made
+     * owned in 'ws' before working on. Without a working set, the batch ends at its first result.
+     */
+    template <typename DoWorkFn>
+    StageState fillBatch(
+        size_t maxWorks, WorkBatch* batch, WorkingSetID* out, WorkingSet* ws, DoWorkFn doWorkFn) {
+        while (batch->works < maxWorks) {
+            ++batch->works;
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            StageState state = doWorkFn(&id);
+            if (ADVANCED == state) {
+                batch->results.push_back(id);
+                if (!ws) {
+                    break;
+                }
+                ws->get(id)->makeObjOwnedIfNeeded();
+            } else if (NEED_TIME != state) {
+                *out = id;
+                return state;
+            }
+        }
+        return NEED_TIME;
+    }
+
     /**
      * Saves any stage-specific state required to resume where it was if the underlying data
      * changes.
@@ -30,11 +30,13 @@
 
 #include "mongo/db/exec/projection.h"
 
+#include "mongo/db/exec/index_scan.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/record_id.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
@@ -96,6 +98,15 @@ ProjectionStage::ProjectionStage(OperationContext* opCtx,
                     _includeKey.push_back(true);
                 }
             }
+
+            // An index scan directly beneath us can build the projection out of each key itself,
+            // unless an included field has an empty name that it would take for an excluded one.
+            if (internalQueryExecProjectCoveredKeysInIndexScan.load() &&
+                STAGE_IXSCAN == child->stageType() &&
+                _includedFields.end() == _includedFields.find(StringData())) {
+                static_cast<IndexScan*>(child)->setCoveredKeyFieldNames(_keyFieldNames);
+                _childProjectsKeys = true;
+            }
         } else {
             invariant(ProjectionStageParams::SIMPLE_DOC == params.projImpl);
         }
@@ -148,6 +159,12 @@ Status ProjectionStage::transform(WorkingSetMember* member) {
         return _exec->transform(member);
     }
 
+    if (_childProjectsKeys) {
+        // The index scan has already handed us the projected object.
+        invariant(member->hasOwnedObj());
+        return Status::OK();
+    }
+
     BSONObjBuilder bob;
 
     // Note that even if our fast path analysis is bug-free something that is
@@ -210,16 +227,33 @@ PlanStage::StageState ProjectionStage::doWork(WorkingSetID* out) {
 
         *out = id;
     } else if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+        return returnChildFailure(status, id, out);
+    } else if (PlanStage::NEED_YIELD == status) {
         *out = id;
-        // If a stage fails, it may create a status WSM to indicate why it
-        // failed, in which case 'id' is valid.  If ID is invalid, we
-        // create our own error message.
-        if (WorkingSet::INVALID_ID == id) {
-            mongoutils::str::stream ss;
-            ss << "projection stage failed to read in results from child";
-            Status status(ErrorCodes::InternalError, ss);
-            *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+
+    return status;
+}
+
+PlanStage::StageState ProjectionStage::doWorkBatch(size_t maxWorks,
+                                                   WorkBatch* batch,
+                                                   WorkingSetID* out) {
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    StageState status = child()->workBatch(maxWorks, &_childBatch, &id);
+    batch->works = _childBatch.works;
+    for (size_t i = 0; i < _childBatch.results.size(); ++i) {
+        Status projStatus = transform(_ws->get(_childBatch.results[i]));
+        if (!projStatus.isOK()) {
+            warning() << "Couldn't execute projection, status = " << redact(projStatus);
+            batch->results.assign(_childBatch.results.begin(), _childBatch.results.begin() + i);
+            *out = WorkingSetCommon::allocateStatusMember(_ws, projStatus);
+            return PlanStage::FAILURE;
         }
+    }
+    batch->results.swap(_childBatch.results);
+
+    if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+        return returnChildFailure(status, id, out);
     } else if (PlanStage::NEED_YIELD == status) {
         *out = id;
     }
@@ -227,6 +261,22 @@ PlanStage::StageState ProjectionStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState ProjectionStage::returnChildFailure(StageState status,
+                                                          WorkingSetID id,
+                                                          WorkingSetID* out) {
+    *out = id;
+    // If a stage fails, it may create a status WSM to indicate why it
+    // failed, in which case 'id' is valid.  If ID is invalid, we
+    // create our own error message.
+    if (WorkingSet::INVALID_ID == id) {
+        mongoutils::str::stream ss;
+        ss << "projection stage failed to read in results from child";
+        Status status(ErrorCodes::InternalError, ss);
+        *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+    return status;
+}
+
 unique_ptr<PlanStageStats> ProjectionStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_PROJECTION);
@@ -88,6 +88,7 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, WorkBatch* batch, WorkingSetID* out) final;
 
     StageType stageType() const final {
         return STAGE_PROJECTION;
@@ -121,11 +122,20 @@ public:
 private:
     Status transform(WorkingSetMember* member);
 
+    /**
+     * Returns the FAILURE or DEAD 'status' of our child with 'id', or our own status member if our
+     * child didn't create one, in *out.
+     */
+    StageState returnChildFailure(StageState status, WorkingSetID id, WorkingSetID* out);
+
     std::unique_ptr<ProjectionExec> _exec;
 
     // _ws is not owned by us.
     WorkingSet* _ws;
 
+    // Reused for the batches of our child.
+    WorkBatch _childBatch;
+
     // Stats
     ProjectionStats _specificStats;
 
@@ -150,6 +160,9 @@ private:
 
     // If the i-th entry of _includeKey is true this is the field name for the i-th key field.
     std::vector<StringData> _keyFieldNames;
+
+    // True if our child is an index scan which builds the covered projection of each key itself.
+    bool _childProjectsKeys = false;
 };
 
 }  // namespace mongo
@@ -68,22 +68,56 @@ PlanStage::StageState SkipStage::doWork(WorkingSetID* out) {
         *out = id;
         return PlanStage::ADVANCED;
     } else if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+        return returnChildFailure(status, id, out);
+    } else if (PlanStage::NEED_YIELD == status) {
         *out = id;
-        // If a stage fails, it may create a status WSM to indicate why it
-        // failed, in which case 'id' is valid.  If ID is invalid, we
-        // create our own error message.
-        if (WorkingSet::INVALID_ID == id) {
-            mongoutils::str::stream ss;
-            ss << "skip stage failed to read in results from child";
-            Status status(ErrorCodes::InternalError, ss);
-            *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+
+    // NEED_TIME, NEED_YIELD, ERROR, IS_EOF
+    return status;
+}
+
+PlanStage::StageState SkipStage::doWorkBatch(size_t maxWorks,
+                                             WorkBatch* batch,
+                                             WorkingSetID* out) {
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    StageState status = child()->workBatch(maxWorks, &_childBatch, &id);
+    batch->works = _childBatch.works;
+    if (0 == _toSkip) {
+        batch->results.swap(_childBatch.results);
+    } else {
+        for (WorkingSetID result : _childBatch.results) {
+            if (_toSkip > 0) {
+                --_toSkip;
+                _ws->free(result);
+                continue;
+            }
+            batch->results.push_back(result);
         }
-        return status;
+    }
+
+    if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+        return returnChildFailure(status, id, out);
     } else if (PlanStage::NEED_YIELD == status) {
         *out = id;
     }
 
-    // NEED_TIME, NEED_YIELD, ERROR, IS_EOF
+    return status;
+}
+
+PlanStage::StageState SkipStage::returnChildFailure(StageState status,
+                                                    WorkingSetID id,
+                                                    WorkingSetID* out) {
+    *out = id;
+    // If a stage fails, it may create a status WSM to indicate why it
+    // failed, in which case 'id' is valid.  If ID is invalid, we
+    // create our own error message.
+    if (WorkingSet::INVALID_ID == id) {
+        mongoutils::str::stream ss;
+        ss << "skip stage failed to read in results from child";
+        Status status(ErrorCodes::InternalError, ss);
+        *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
     return status;
 }
 
@@ -48,6 +48,7 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks, WorkBatch* batch, WorkingSetID* out) final;
 
     StageType stageType() const final {
         return STAGE_SKIP;
@@ -60,11 +61,20 @@ public:
     static const char* kStageType;
 
 private:
+    /**
+     * Passes on a FAILURE or DEAD 'status' of our child, allocating a status member for *out if
+     * 'id' is invalid.
+     */
+    StageState returnChildFailure(StageState status, WorkingSetID id, WorkingSetID* out);
+
     WorkingSet* _ws;
 
     // We drop the first _toSkip results that we would have returned.
     long long _toSkip;
 
+    // Reused for the batches of our child.
+    WorkBatch _childBatch;
+
     // Stats
     SkipStats _specificStats;
 };
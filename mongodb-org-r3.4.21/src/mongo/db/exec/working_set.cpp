@@ -39,27 +39,20 @@ using std::string;
 
 namespace dps = ::mongo::dotted_path_support;
 
+const size_t WorkingSet::kMinSlabSize;
+const size_t WorkingSet::kMaxSlabSize;
+
 WorkingSet::MemberHolder::MemberHolder() : member(NULL) {}
 WorkingSet::MemberHolder::~MemberHolder() {}
 
 WorkingSet::WorkingSet() : _freeList(INVALID_ID) {}
 
-WorkingSet::~WorkingSet() {
-    for (size_t i = 0; i < _data.size(); i++) {
-        delete _data[i].member;
-    }
-}
+WorkingSet::~WorkingSet() {}
 
 WorkingSetID WorkingSet::allocate() {
     if (_freeList == INVALID_ID) {
-        // The free list is empty so we need to make a single new WSM to return. This relies on
-        // vector::resize being amortized O(1) for efficient allocation. Note that the free list
-        // remains empty until something is returned by a call to free().
-        WorkingSetID id = _data.size();
-        _data.resize(_data.size() + 1);
-        _data.back().nextFreeOrSelf = id;
-        _data.back().member = new WorkingSetMember();
-        return id;
+        // The free list is empty so we need to make a new slab of WSMs.
+        return allocateSlab();
     }
 
     // Pop the head off the free list and return it.
@@ -69,6 +62,25 @@ WorkingSetID WorkingSet::allocate() {
     return id;
 }
 
+WorkingSetID WorkingSet::allocateSlab() {
+    invariant(_freeList == INVALID_ID);
+    const size_t slabSize = std::min(std::max(_data.size(), kMinSlabSize), kMaxSlabSize);
+    _slabs.emplace_back(new WorkingSetMember[slabSize]);
+    WorkingSetMember* slab = _slabs.back().get();
+
+    const WorkingSetID first = _data.size();
+    _data.resize(_data.size() + slabSize);
+    _data[first].nextFreeOrSelf = first;
+    _data[first].member = slab;
+    for (size_t i = 1; i < slabSize; ++i) {
+        MemberHolder& holder = _data[first + i];
+        holder.nextFreeOrSelf = (i + 1 < slabSize) ? first + i + 1 : INVALID_ID;
+        holder.member = slab + i;
+    }
+    _freeList = (slabSize > 1) ? first + 1 : INVALID_ID;
+    return first;
+}
+
 void WorkingSet::free(WorkingSetID i) {
     MemberHolder& holder = _data[i];
     verify(i < _data.size());            // ID has been allocated.
@@ -96,14 +108,12 @@ bool WorkingSet::isFlagged(WorkingSetID id) const {
 }
 
 void WorkingSet::clear() {
+    // Every member is now free, and the free list hands them out again in increasing id order.
     for (size_t i = 0; i < _data.size(); i++) {
-        delete _data[i].member;
+        _data[i].member->clear();
+        _data[i].nextFreeOrSelf = (i + 1 < _data.size()) ? i + 1 : INVALID_ID;
     }
-    _data.clear();
-
-    // Since working set is now empty, the free list pointer should
-    // point to nothing.
-    _freeList = INVALID_ID;
+    _freeList = _data.empty() ? INVALID_ID : 0;
 
     _flagged.clear();
     _yieldSensitiveIds.clear();
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
@@ -113,7 +114,7 @@ public:
     const unordered_set<WorkingSetID>& getFlagged() const;
 
     /**
-     * Removes and deallocates all members of this working set.
+     * Frees all members of this working set. Their memory is kept to be reused by allocate().
      */
     void clear();
 
@@ -147,10 +148,24 @@ private:
         // Free list link if freed. Points to self if in use.
         WorkingSetID nextFreeOrSelf;
 
-        // Owning pointer
+        // Points into one of '_slabs'.
         WorkingSetMember* member;
     };
 
+    /**
+     * Allocates a new slab of members and adds all but the first of them to the free list, in
+     * increasing id order. Returns the id of the first.
+     */
+    WorkingSetID allocateSlab();
+
+    // Members are allocated in slabs of contiguous WorkingSetMembers, rather than one at a time,
+    // so that a scan producing many results neither calls the allocator for each of them nor
+    // scatters them across the heap. Each slab is as large as all of the previous ones together,
+    // between kMinSlabSize and kMaxSlabSize members.
+    static const size_t kMinSlabSize = 4;
+    static const size_t kMaxSlabSize = 256;
+    std::vector<std::unique_ptr<WorkingSetMember[]>> _slabs;
+
     // All WorkingSetIDs are indexes into this, except for INVALID_ID.
     // Elements are added to _freeList rather than removed when freed.
     std::vector<MemberHolder> _data;
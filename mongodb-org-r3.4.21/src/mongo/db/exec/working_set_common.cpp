@@ -105,7 +105,19 @@ bool WorkingSetCommon::fetch(OperationContext* txn,
         return false;
     }
 
-    member->obj = {txn->recoveryUnit()->getSnapshotId(), record->data.releaseToBson()};
+    return fetchFromRecordData(txn, workingSet, id, std::move(record->data));
+}
+
+// static
+bool WorkingSetCommon::fetchFromRecordData(OperationContext* txn,
+                                           WorkingSet* workingSet,
+                                           WorkingSetID id,
+                                           RecordData data) {
+    WorkingSetMember* member = workingSet->get(id);
+    invariant(!member->hasFetcher());
+    invariant(member->hasRecordId());
+
+    member->obj = {txn->recoveryUnit()->getSnapshotId(), data.releaseToBson()};
 
     if (member->isSuspicious) {
         // Make sure that all of the keyData is still valid for this copy of the document.
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "mongo/db/exec/working_set.h"
+#include "mongo/db/storage/record_data.h"
 #include "mongo/util/unowned_ptr.h"
 
 namespace mongo {
@@ -75,6 +76,15 @@ public:
                       WorkingSetID id,
                       unowned_ptr<SeekableRecordCursor> cursor);
 
+    /**
+     * Like fetch(), with the document 'data' of the member's RecordId already read by the caller
+     * in the current snapshot.
+     */
+    static bool fetchFromRecordData(OperationContext* txn,
+                                    WorkingSet* workingSet,
+                                    WorkingSetID id,
+                                    RecordData data);
+
     static bool fetchIfUnfetched(OperationContext* txn,
                                  WorkingSet* workingSet,
                                  WorkingSetID id,
@@ -31,6 +31,8 @@
  */
 
 
+#include <set>
+
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
@@ -154,4 +156,39 @@ TEST_F(WorkingSetFixture, getDottedFieldFromIndex) {
     ASSERT_FALSE(member->getFieldDotted("y", &elt));
 }
 
+TEST(WorkingSetTest, MembersAreAllocatedInSlabsAndReused) {
+    WorkingSet ws;
+    std::vector<WorkingSetID> ids;
+    std::set<WorkingSetMember*> members;
+    for (size_t i = 0; i < 1000; ++i) {
+        WorkingSetID id = ws.allocate();
+        ASSERT_FALSE(ws.isFree(id));
+        ids.push_back(id);
+        members.insert(ws.get(id));
+    }
+    ASSERT_EQUALS(std::set<WorkingSetID>(ids.begin(), ids.end()).size(), ids.size());
+    ASSERT_EQUALS(members.size(), ids.size());
+
+    // A freed member is the next one handed out.
+    ws.get(ids[10])->obj = Snapshotted<BSONObj>(SnapshotId(), BSON("a" << 1));
+    ws.transitionToOwnedObj(ids[10]);
+    ws.free(ids[10]);
+    ASSERT_TRUE(ws.isFree(ids[10]));
+    WorkingSetID reused = ws.allocate();
+    ASSERT_EQUALS(reused, ids[10]);
+    ASSERT_EQUALS(WorkingSetMember::INVALID, ws.get(reused)->getState());
+
+    // Clearing the working set keeps its members to reuse.
+    ws.clear();
+    for (size_t i = 0; i < ids.size(); ++i) {
+        ASSERT_TRUE(ws.isFree(ids[i]));
+    }
+    for (size_t i = 0; i < ids.size(); ++i) {
+        WorkingSetID id = ws.allocate();
+        ASSERT_EQUALS(id, i);
+        ASSERT_EQUALS(1U, members.count(ws.get(id)));
+        ASSERT_EQUALS(WorkingSetMember::INVALID, ws.get(id)->getState());
+    }
+}
+
 }  // namespace
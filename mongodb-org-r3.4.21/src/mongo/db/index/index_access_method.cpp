@@ -44,6 +44,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/storage_options.h"
@@ -71,6 +72,24 @@ bool isMultikeyFromPaths(const MultikeyPaths& multikeyPaths) {
                        [](const std::set<std::size_t>& components) { return !components.empty(); });
 }
 
+/**
+ * Adds the path components of 'multikeyPaths' that cause the index to be multikey to 'out'.
+ */
+void mergeMultikeyPaths(const MultikeyPaths& multikeyPaths, MultikeyPaths* out) {
+    if (multikeyPaths.empty()) {
+        return;
+    }
+    if (out->empty()) {
+        *out = multikeyPaths;
+        return;
+    }
+
+    invariant(out->size() == multikeyPaths.size());
+    for (size_t i = 0; i < multikeyPaths.size(); ++i) {
+        (*out)[i].insert(multikeyPaths[i].begin(), multikeyPaths[i].end());
+    }
+}
+
 }  // namespace
 
 MONGO_EXPORT_SERVER_PARAMETER(failIndexKeyTooLong, bool, true);
@@ -415,7 +434,8 @@ IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
           SortOptions()
               .TempDir(storageGlobalParams.dbpath + "/_tmp")
               .ExtSortAllowed()
-              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
+              .MaxMemoryUsageBytes(maxMemoryUsageBytes)
+              .WorkerThreads(std::max(internalQueryExecSorterWorkerThreads.load(), 0)),
           BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
       _real(index) {}
 
@@ -431,16 +451,7 @@ Status IndexAccessMethod::BulkBuilder::insert(OperationContext* txn,
 
     _everGeneratedMultipleKeys = _everGeneratedMultipleKeys || (keys.size() > 1);
 
-    if (!multikeyPaths.empty()) {
-        if (_indexMultikeyPaths.empty()) {
-            _indexMultikeyPaths = multikeyPaths;
-        } else {
-            invariant(_indexMultikeyPaths.size() == multikeyPaths.size());
-            for (size_t i = 0; i < multikeyPaths.size(); ++i) {
-                _indexMultikeyPaths[i].insert(multikeyPaths[i].begin(), multikeyPaths[i].end());
-            }
-        }
-    }
+    mergeMultikeyPaths(multikeyPaths, &_indexMultikeyPaths);
 
     for (BSONObjSet::iterator it = keys.begin(); it != keys.end(); ++it) {
         _sorter->add(*it, loc);
@@ -460,14 +471,42 @@ Status IndexAccessMethod::commitBulk(OperationContext* txn,
                                      bool mayInterrupt,
                                      bool dupsAllowed,
                                      set<RecordId>* dupsToDrop) {
+    std::vector<std::unique_ptr<BulkBuilder>> bulks;
+    bulks.push_back(std::move(bulk));
+    return commitBulk(txn, std::move(bulks), mayInterrupt, dupsAllowed, dupsToDrop);
+}
+
+Status IndexAccessMethod::commitBulk(OperationContext* txn,
+                                     std::vector<std::unique_ptr<BulkBuilder>> bulks,
+                                     bool mayInterrupt,
+                                     bool dupsAllowed,
+                                     set<RecordId>* dupsToDrop) {
     Timer timer;
 
-    std::unique_ptr<BulkBuilder::Sorter::Iterator> i(bulk->_sorter->done());
+    invariant(!bulks.empty());
+    int64_t keysInserted = 0;
+    bool everGeneratedMultipleKeys = false;
+    MultikeyPaths indexMultikeyPaths;
+    std::vector<std::shared_ptr<BulkBuilder::Sorter::Iterator>> iters;
+    for (auto&& bulk : bulks) {
+        keysInserted += bulk->_keysInserted;
+        everGeneratedMultipleKeys = everGeneratedMultipleKeys || bulk->_everGeneratedMultipleKeys;
+        mergeMultikeyPaths(bulk->_indexMultikeyPaths, &indexMultikeyPaths);
+        iters.emplace_back(bulk->_sorter->done());
+    }
+
+    std::shared_ptr<BulkBuilder::Sorter::Iterator> i = iters.front();
+    if (iters.size() > 1) {
+        i.reset(BulkBuilder::Sorter::Iterator::merge(
+            iters,
+            SortOptions().WorkerThreads(std::max(internalQueryExecSorterWorkerThreads.load(), 0)),
+            BtreeExternalSortComparison(_descriptor->keyPattern(), _descriptor->version())));
+    }
 
     stdx::unique_lock<Client> lk(*txn->getClient());
     ProgressMeterHolder pm(*txn->setMessage_inlock("Index Bulk Build: (2/3) btree bottom up",
                                                    "Index: (2/3) BTree Bottom Up Progress",
-                                                   bulk->_keysInserted,
+                                                   keysInserted,
                                                    10));
     lk.unlock();
 
@@ -476,8 +515,8 @@ Status IndexAccessMethod::commitBulk(OperationContext* txn,
     MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
         WriteUnitOfWork wunit(txn);
 
-        if (bulk->_everGeneratedMultipleKeys || isMultikeyFromPaths(bulk->_indexMultikeyPaths)) {
-            _btreeState->setMultikey(txn, bulk->_indexMultikeyPaths);
+        if (everGeneratedMultipleKeys || isMultikeyFromPaths(indexMultikeyPaths)) {
+            _btreeState->setMultikey(txn, indexMultikeyPaths);
         }
 
         builder.reset(_newInterface->getBulkBuilder(txn, dupsAllowed));
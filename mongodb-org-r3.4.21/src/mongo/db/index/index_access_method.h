@@ -256,6 +256,17 @@ public:
                       bool dupsAllowed,
                       std::set<RecordId>* dups);
 
+    /**
+     * Like commitBulk() above, for several BulkBuilders that each hold the keys of a different set
+     * of documents, such as those filled by different threads. Their keys are merged into one
+     * bottom-up build.
+     */
+    Status commitBulk(OperationContext* txn,
+                      std::vector<std::unique_ptr<BulkBuilder>> bulks,
+                      bool mayInterrupt,
+                      bool dupsAllowed,
+                      std::set<RecordId>* dups);
+
     /**
      * Specifies whether getKeys should relax the index constraints or not.
      */
@@ -0,0 +1,276 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/compiled_match_expression.h"
+
+#include <cmath>
+
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/matcher/path_internal.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * Whether 'expr' is evaluated by LeafMatchExpression::matches(), and so is equivalent to calling
+ * matchesSingleElement() on the value of its path when that value is not an array.
+ */
+bool isSingleElementLeaf(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::REGEX:
+        case MatchExpression::MOD:
+        case MatchExpression::EXISTS:
+        case MatchExpression::MATCH_IN:
+        case MatchExpression::BITS_ALL_SET:
+        case MatchExpression::BITS_ALL_CLEAR:
+        case MatchExpression::BITS_ANY_SET:
+        case MatchExpression::BITS_ANY_CLEAR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+template <typename T>
+int compareNumbers(T lhs, T rhs) {
+    return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+bool comparisonResult(MatchExpression::MatchType matchType, int cmp) {
+    switch (matchType) {
+        case MatchExpression::LT:
+            return cmp < 0;
+        case MatchExpression::LTE:
+            return cmp <= 0;
+        case MatchExpression::EQ:
+            return cmp == 0;
+        case MatchExpression::GT:
+            return cmp > 0;
+        case MatchExpression::GTE:
+            return cmp >= 0;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<CompiledMatchExpression> CompiledMatchExpression::compile(
+    const MatchExpression* root) {
+    std::unique_ptr<CompiledMatchExpression> compiled(new CompiledMatchExpression());
+    compiled->_compileNode(root);
+
+    if (compiled->_program.front().op == Op::kTree) {
+        return nullptr;
+    }
+
+    compiled->_values.resize(compiled->_paths.size());
+    compiled->_resolvedAt.resize(compiled->_paths.size(), 0);
+    return compiled;
+}
+
+void CompiledMatchExpression::_compileNode(const MatchExpression* expr) {
+    const std::uint32_t pc = _program.size();
+    _program.push_back(Instruction());
+    _program[pc].matchType = expr->matchType();
+    _program[pc].typeMismatchFails = false;
+    _program[pc].pathId = 0;
+    _program[pc].expr = expr;
+
+    Op op = Op::kTree;
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+            op = Op::kAnd;
+            break;
+        case MatchExpression::OR:
+            op = Op::kOr;
+            break;
+        case MatchExpression::NOR:
+            op = Op::kNor;
+            break;
+        case MatchExpression::NOT:
+            op = Op::kNot;
+            break;
+        case MatchExpression::EQ:
+        case MatchExpression::LTE:
+        case MatchExpression::LT:
+        case MatchExpression::GT:
+        case MatchExpression::GTE: {
+            op = Op::kCompare;
+            const BSONElement& rhs = static_cast<const ComparisonMatchExpression*>(expr)->getData();
+            // Mirrors the special cases of ComparisonMatchExpression::matchesSingleElement(): null
+            // and undefined (or missing) compare equal to each other, and MinKey and MaxKey compare
+            // against every type.
+            const int rhsType = rhs.canonicalType();
+            _program[pc].typeMismatchFails =
+                rhsType != 0 && rhsType != 5 && rhs.type() != MinKey && rhs.type() != MaxKey;
+            _program[pc].rhs = rhs;
+            break;
+        }
+        default:
+            if (isSingleElementLeaf(expr)) {
+                op = Op::kLeaf;
+            }
+            break;
+    }
+    _program[pc].op = op;
+
+    switch (op) {
+        case Op::kAnd:
+        case Op::kOr:
+        case Op::kNor:
+        case Op::kNot:
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                _compileNode(expr->getChild(i));
+            }
+            break;
+        case Op::kCompare:
+        case Op::kLeaf:
+            _program[pc].pathId = _pathId(expr->path());
+            break;
+        case Op::kTree:
+            break;
+    }
+
+    _program[pc].end = _program.size();
+}
+
+std::uint32_t CompiledMatchExpression::_pathId(StringData path) {
+    for (size_t i = 0; i < _paths.size(); ++i) {
+        if (_paths[i]->dottedField() == path) {
+            return i;
+        }
+    }
+    _paths.push_back(stdx::make_unique<FieldRef>(path));
+    return _paths.size() - 1;
+}
+
+size_t CompiledMatchExpression::numTreeNodes() const {
+    size_t count = 0;
+    for (auto&& instr : _program) {
+        if (instr.op == Op::kTree) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool CompiledMatchExpression::matchesBSON(const BSONObj& doc) const {
+    ++_generation;
+    return _run(0, doc);
+}
+
+bool CompiledMatchExpression::_run(std::uint32_t pc, const BSONObj& doc) const {
+    const Instruction& instr = _program[pc];
+    switch (instr.op) {
+        case Op::kAnd:
+            for (std::uint32_t child = pc + 1; child < instr.end; child = _program[child].end) {
+                if (!_run(child, doc)) {
+                    return false;
+                }
+            }
+            return true;
+        case Op::kOr:
+            for (std::uint32_t child = pc + 1; child < instr.end; child = _program[child].end) {
+                if (_run(child, doc)) {
+                    return true;
+                }
+            }
+            return false;
+        case Op::kNor:
+            for (std::uint32_t child = pc + 1; child < instr.end; child = _program[child].end) {
+                if (_run(child, doc)) {
+                    return false;
+                }
+            }
+            return true;
+        case Op::kNot:
+            return !_run(pc + 1, doc);
+        case Op::kCompare:
+        case Op::kLeaf:
+            return _runLeaf(instr, doc);
+        case Op::kTree:
+            return instr.expr->matchesBSON(doc);
+    }
+    MONGO_UNREACHABLE;
+}
+
+bool CompiledMatchExpression::_runLeaf(const Instruction& instr, const BSONObj& doc) const {
+    const BSONElement& e = _resolve(instr.pathId, doc);
+
+    if (e.type() == Array) {
+        // Array traversal semantics are left to the tree.
+        return instr.expr->matchesBSON(doc);
+    }
+
+    if (instr.op == Op::kLeaf) {
+        return static_cast<const LeafMatchExpression*>(instr.expr)->matchesSingleElement(e);
+    }
+
+    if (e.type() == instr.rhs.type()) {
+        switch (e.type()) {
+            case NumberInt:
+                return comparisonResult(instr.matchType,
+                                        compareNumbers(e._numberInt(), instr.rhs._numberInt()));
+            case NumberLong:
+                return comparisonResult(instr.matchType,
+                                        compareNumbers(e._numberLong(), instr.rhs._numberLong()));
+            case NumberDouble:
+                if (!std::isnan(e._numberDouble()) && !std::isnan(instr.rhs._numberDouble())) {
+                    return comparisonResult(
+                        instr.matchType,
+                        compareNumbers(e._numberDouble(), instr.rhs._numberDouble()));
+                }
+                break;
+            default:
+                break;
+        }
+    } else if (instr.typeMismatchFails && e.canonicalType() != instr.rhs.canonicalType()) {
+        return false;
+    }
+
+    return static_cast<const ComparisonMatchExpression*>(instr.expr)->matchesSingleElement(e);
+}
+
+const BSONElement& CompiledMatchExpression::_resolve(std::uint32_t pathId,
+                                                     const BSONObj& doc) const {
+    if (_resolvedAt[pathId] != _generation) {
+        size_t idxPath;
+        _values[pathId] = getFieldDottedOrArray(doc, *_paths[pathId], &idxPath);
+        _resolvedAt[pathId] = _generation;
+    }
+    return _values[pathId];
+}
+
+}  // namespace mongo
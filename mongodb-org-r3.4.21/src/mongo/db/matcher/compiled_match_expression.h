@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/field_ref.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+/**
+ * A MatchExpression tree flattened into a program that is run directly against BSON documents.
+ *
+ * Each distinct path of the tree is resolved at most once per document rather than once per leaf,
+ * and comparisons whose operand is of another canonical type fail without calling into the leaf.
+ * A path which reaches an array, and every node with no flat form ($elemMatch, $type, $where, geo,
+ * text, ...), is handed to the original tree, so that matchesBSON() always agrees with
+ * MatchExpression::matchesBSON().
+ *
+ * The expression passed to compile() must outlive the CompiledMatchExpression. Evaluation keeps
+ * per-document state, so an instance may only be used by one thread at a time.
+ */
+class CompiledMatchExpression {
+    MONGO_DISALLOW_COPYING(CompiledMatchExpression);
+
+public:
+    /**
+     * Returns a program equivalent to 'root', or nullptr if no part of 'root' can be run faster
+     * than the tree itself.
+     */
+    static std::unique_ptr<CompiledMatchExpression> compile(const MatchExpression* root);
+
+    bool matchesBSON(const BSONObj& doc) const;
+
+    /**
+     * The number of distinct paths resolved for each document.
+     */
+    size_t numPaths() const {
+        return _paths.size();
+    }
+
+    /**
+     * The number of nodes which are evaluated by the original tree.
+     */
+    size_t numTreeNodes() const;
+
+private:
+    enum class Op : std::uint8_t {
+        kAnd,
+        kOr,
+        kNor,
+        kNot,
+        kCompare,  // A ComparisonMatchExpression.
+        kLeaf,     // Any other LeafMatchExpression without its own matches().
+        kTree,     // Evaluated by MatchExpression::matchesBSON().
+    };
+
+    struct Instruction {
+        Op op;
+        MatchExpression::MatchType matchType;
+
+        // Whether an operand whose canonical type differs from the right hand side never matches.
+        bool typeMismatchFails;
+
+        // Index one past the last instruction of this node's subtree.
+        std::uint32_t end;
+
+        // Index into '_paths' for leaves.
+        std::uint32_t pathId;
+
+        const MatchExpression* expr;
+
+        // The right hand side of kCompare instructions.
+        BSONElement rhs;
+    };
+
+    CompiledMatchExpression() = default;
+
+    void _compileNode(const MatchExpression* expr);
+    std::uint32_t _pathId(StringData path);
+
+    bool _run(std::uint32_t pc, const BSONObj& doc) const;
+    bool _runLeaf(const Instruction& instr, const BSONObj& doc) const;
+    const BSONElement& _resolve(std::uint32_t pathId, const BSONObj& doc) const;
+
+    std::vector<Instruction> _program;
+    std::vector<std::unique_ptr<FieldRef>> _paths;
+
+    // The value of each path for the current document, valid when the matching entry of
+    // '_resolvedAt' equals '_generation'. Missing values are EOO.
+    mutable std::vector<BSONElement> _values;
+    mutable std::vector<std::uint64_t> _resolvedAt;
+    mutable std::uint64_t _generation = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,170 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/compiled_match_expression.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/matcher/extensions_callback_disallow_extensions.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::unique_ptr<MatchExpression> parse(const char* filter,
+                                       const CollatorInterface* collator = nullptr) {
+    auto swExpr = MatchExpressionParser::parse(
+        fromjson(filter), ExtensionsCallbackDisallowExtensions(), collator);
+    ASSERT_OK(swExpr.getStatus());
+    return std::move(swExpr.getValue());
+}
+
+const char* kDocs[] = {
+    "{}",
+    "{a: 1}",
+    "{a: 5}",
+    "{a: 5.5}",
+    "{a: NumberLong(5)}",
+    "{a: NaN}",
+    "{a: null}",
+    "{a: undefined}",
+    "{a: 'abc'}",
+    "{a: 'ABC'}",
+    "{a: {$minKey: 1}}",
+    "{a: {$maxKey: 1}}",
+    "{a: [1, 5, 9]}",
+    "{a: []}",
+    "{a: [[5]]}",
+    "{a: {b: 5}}",
+    "{a: {b: null}}",
+    "{a: {b: [4, 6]}}",
+    "{a: [{b: 5}, {b: 7}]}",
+    "{a: 5, b: 'x', c: {d: 2}}",
+    "{a: 7, b: 'y', c: {d: [1, 2]}}",
+    "{a: 3, b: true, c: 2}",
+    "{a: {'0': 5}}",
+};
+
+/**
+ * Asserts that the compiled form of 'filter' agrees with the tree on every document of 'kDocs'.
+ */
+void assertSameResults(const char* filter, const CollatorInterface* collator = nullptr) {
+    auto expr = parse(filter, collator);
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled) << filter;
+
+    for (auto&& doc : kDocs) {
+        const BSONObj obj = fromjson(doc);
+        ASSERT_EQ(expr->matchesBSON(obj), compiled->matchesBSON(obj)) << filter << " on " << doc;
+    }
+}
+
+TEST(CompiledMatchExpressionTest, ComparisonsMatchTree) {
+    assertSameResults("{a: 5}");
+    assertSameResults("{a: {$lt: 5}}");
+    assertSameResults("{a: {$lte: 5}}");
+    assertSameResults("{a: {$gt: 5}}");
+    assertSameResults("{a: {$gte: 5.0}}");
+    assertSameResults("{a: {$gte: NumberLong(1)}}");
+    assertSameResults("{a: NaN}");
+    assertSameResults("{a: {$lt: NaN}}");
+    assertSameResults("{a: {$gte: NaN}}");
+    assertSameResults("{a: 'abc'}");
+    assertSameResults("{a: {$gt: 'a'}}");
+    assertSameResults("{'a.b': 5}");
+    assertSameResults("{'a.b': {$gt: 4}}");
+    assertSameResults("{'a.0': 5}");
+    assertSameResults("{'c.d': 2}");
+}
+
+TEST(CompiledMatchExpressionTest, NullUndefinedMinKeyAndMaxKeyMatchTree) {
+    assertSameResults("{a: null}");
+    assertSameResults("{a: {$lte: null}}");
+    assertSameResults("{a: {$gt: null}}");
+    assertSameResults("{'a.b': null}");
+    assertSameResults("{a: {$gt: {$minKey: 1}}}");
+    assertSameResults("{a: {$lt: {$maxKey: 1}}}");
+    assertSameResults("{a: {$minKey: 1}}");
+}
+
+TEST(CompiledMatchExpressionTest, OtherLeavesMatchTree) {
+    assertSameResults("{a: {$exists: true}}");
+    assertSameResults("{a: {$exists: false}}");
+    assertSameResults("{a: {$in: [1, 'abc', null]}}");
+    assertSameResults("{a: {$nin: [5, 7]}}");
+    assertSameResults("{a: /^a/}");
+    assertSameResults("{a: {$mod: [2, 1]}}");
+    assertSameResults("{a: {$bitsAllSet: 1}}");
+}
+
+TEST(CompiledMatchExpressionTest, LogicalOperatorsMatchTree) {
+    assertSameResults("{a: {$gt: 1, $lt: 7}}");
+    assertSameResults("{a: 5, b: 'x'}");
+    assertSameResults("{$or: [{a: 1}, {b: 'y'}, {'c.d': 2}]}");
+    assertSameResults("{$nor: [{a: 5}, {b: {$exists: true}}]}");
+    assertSameResults("{a: {$not: {$gt: 3}}}");
+    assertSameResults("{$and: [{$or: [{a: 5}, {a: 7}]}, {$or: [{b: 'x'}, {c: 2}]}]}");
+}
+
+TEST(CompiledMatchExpressionTest, NodesWithoutFlatFormMatchTree) {
+    assertSameResults("{a: {$size: 3}, b: 'x'}");
+    assertSameResults("{a: {$elemMatch: {$gt: 4}}, c: {$exists: true}}");
+    assertSameResults("{a: {$type: 'number'}, b: {$exists: false}}");
+    assertSameResults("{$or: [{a: {$type: 'array'}}, {a: 5}]}");
+}
+
+TEST(CompiledMatchExpressionTest, ComparisonsWithCollatorMatchTree) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kToLowerString);
+    assertSameResults("{a: 'abc'}", &collator);
+    assertSameResults("{a: {$gte: 'abc'}}", &collator);
+    assertSameResults("{a: {$in: ['abc']}}", &collator);
+}
+
+TEST(CompiledMatchExpressionTest, ResolvesEachDistinctPathOnce) {
+    auto expr = parse("{$or: [{a: 1}, {a: {$gt: 5}}, {'c.d': 1}, {'c.d': {$exists: false}}]}");
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled);
+    ASSERT_EQ(2U, compiled->numPaths());
+    ASSERT_EQ(0U, compiled->numTreeNodes());
+}
+
+TEST(CompiledMatchExpressionTest, DoesNotCompileTreeWithoutFlatForm) {
+    auto expr = parse("{a: {$elemMatch: {b: 1}}}");
+    ASSERT_FALSE(CompiledMatchExpression::compile(expr.get()));
+
+    expr = parse("{a: {$size: 1}, b: 1}");
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled);
+    ASSERT_EQ(1U, compiled->numTreeNodes());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -163,6 +163,19 @@ private:
 
 class AccumulatorSum final : public Accumulator {
 public:
+    /**
+     * The running total of a $sum. It is kept apart from the Accumulator so that $group can lay
+     * out the totals of many groups contiguously (see GroupHashTable).
+     */
+    struct State {
+        void process(const Value& input, bool merging);
+        Value getValue(bool toBeMerged) const;
+
+        BSONType totalType = NumberInt;
+        DoubleDoubleSummation nonDecimalTotal;
+        Decimal128 decimalTotal;
+    };
+
     explicit AccumulatorSum(const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
     void processInternal(const Value& input, bool merging) final;
@@ -182,9 +195,7 @@ public:
     }
 
 private:
-    BSONType totalType = NumberInt;
-    DoubleDoubleSummation nonDecimalTotal;
-    Decimal128 decimalTotal;
+    State _state;
 };
 
 
@@ -195,6 +206,19 @@ public:
         MAX = -1,  // Used to "scale" comparison.
     };
 
+    /**
+     * The current extreme value of a $min or $max, see AccumulatorSum::State.
+     */
+    struct State {
+        /**
+         * Returns true if 'input' replaced the current value.
+         */
+        bool process(const Value& input, const ValueComparator& comparator, Sense sense);
+        Value getValue() const;
+
+        Value val;
+    };
+
     AccumulatorMinMax(const boost::intrusive_ptr<ExpressionContext>& expCtx, Sense sense);
 
     void processInternal(const Value& input, bool merging) final;
@@ -211,7 +235,7 @@ public:
     }
 
 private:
-    Value _val;
+    State _state;
     const Sense _sense;
 };
 
@@ -251,6 +275,25 @@ private:
 
 class AccumulatorAvg final : public Accumulator {
 public:
+    /**
+     * The running total and count of an $avg, see AccumulatorSum::State.
+     */
+    struct State {
+        void process(const Value& input, bool merging);
+        Value getValue(bool toBeMerged) const;
+
+        /**
+         * The total of all values is partitioned between those that are decimals, and those that
+         * are not decimals, so the decimal total needs to add the non-decimal.
+         */
+        Decimal128 getDecimalTotal() const;
+
+        bool isDecimal = false;
+        DoubleDoubleSummation nonDecimalTotal;
+        Decimal128 decimalTotal;
+        long long count = 0;
+    };
+
     explicit AccumulatorAvg(const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
     void processInternal(const Value& input, bool merging) final;
@@ -262,16 +305,7 @@ public:
         const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
 private:
-    /**
-     * The total of all values is partitioned between those that are decimals, and those that are
-     * not decimals, so the decimal total needs to add the non-decimal.
-     */
-    Decimal128 _getDecimalTotal() const;
-
-    bool _isDecimal;
-    DoubleDoubleSummation _nonDecimalTotal;
-    Decimal128 _decimalTotal;
-    long long _count;
+    State _state;
 };
 
 
@@ -49,23 +49,36 @@ const char* AccumulatorMinMax::getOpName() const {
     return "$max";
 }
 
-void AccumulatorMinMax::processInternal(const Value& input, bool merging) {
+bool AccumulatorMinMax::State::process(const Value& input,
+                                       const ValueComparator& comparator,
+                                       Sense sense) {
     // nullish values should have no impact on result
     if (!input.nullish()) {
         /* compare with the current value; swap if appropriate */
-        int cmp = getExpressionContext()->getValueComparator().compare(_val, input) * _sense;
-        if (cmp > 0 || _val.missing()) {  // missing is lower than all other values
-            _val = input;
-            _memUsageBytes = sizeof(*this) + input.getApproximateSize() - sizeof(Value);
+        int cmp = comparator.compare(val, input) * sense;
+        if (cmp > 0 || val.missing()) {  // missing is lower than all other values
+            val = input;
+            return true;
         }
     }
+    return false;
 }
 
-Value AccumulatorMinMax::getValue(bool toBeMerged) const {
-    if (_val.missing()) {
+Value AccumulatorMinMax::State::getValue() const {
+    if (val.missing()) {
         return Value(BSONNULL);
     }
-    return _val;
+    return val;
+}
+
+void AccumulatorMinMax::processInternal(const Value& input, bool merging) {
+    if (_state.process(input, getExpressionContext()->getValueComparator(), _sense)) {
+        _memUsageBytes = sizeof(*this) + input.getApproximateSize() - sizeof(Value);
+    }
+}
+
+Value AccumulatorMinMax::getValue(bool toBeMerged) const {
+    return _state.getValue();
 }
 
 AccumulatorMinMax::AccumulatorMinMax(const boost::intrusive_ptr<ExpressionContext>& expCtx,
@@ -75,7 +88,7 @@ AccumulatorMinMax::AccumulatorMinMax(const boost::intrusive_ptr<ExpressionContex
 }
 
 void AccumulatorMinMax::reset() {
-    _val = Value();
+    _state = {};
     _memUsageBytes = sizeof(*this);
 }
 
@@ -565,6 +565,15 @@ public:
             const BSONObj& originalCollectionOptions,
             const std::list<BSONObj>& originalIndexes) = 0;
 
+        /**
+         * Builds the indexes described by 'indexSpecs' on the collection 'nss', skipping those
+         * which already exist. The documents are indexed while the collection, but not its
+         * database, is locked exclusively, so this is meant for collections no other operation
+         * writes to.
+         */
+        virtual Status buildIndexes(const NamespaceString& nss,
+                                    const std::vector<BSONObj>& indexSpecs) = 0;
+
         /**
          * Parses a Pipeline from a vector of BSONObjs representing DocumentSources and readies it
          * for execution. The returned pipeline is optimized and has a cursor source prepared.
@@ -38,6 +38,7 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
 
 namespace mongo {
@@ -47,6 +48,8 @@ using std::shared_ptr;
 using std::pair;
 using std::vector;
 
+const size_t DocumentSourceGroup::kCompactGroupsBatchSize;
+
 REGISTER_DOCUMENT_SOURCE(group,
                          LiteParsedDocumentSourceDefault::parse,
                          DocumentSourceGroup::createFromBson);
@@ -115,6 +118,18 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     // Not spilled, and not streaming.
+    if (_compactGroups) {
+        if (_compactGroupsPosition == _compactGroups->size())
+            return GetNextResult::makeEOF();
+
+        Document out = makeDocument(_compactGroupsPosition, pExpCtx->inShard);
+
+        if (++_compactGroupsPosition == _compactGroups->size())
+            dispose();
+
+        return std::move(out);
+    }
+
     if (_groups->empty())
         return GetNextResult::makeEOF();
 
@@ -172,10 +187,14 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
 void DocumentSourceGroup::dispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    if (_compactGroups) {
+        _compactGroups->clear();
+    }
     _sorterIterator.reset();
 
     // Make us look done.
     groupsIterator = _groups->end();
+    _compactGroupsPosition = 0;
 
     _firstDocOfNextGroup = boost::none;
 
@@ -496,8 +515,13 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
 
     dassert(numAccumulators == vpExpression.size());
 
-    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
-    GetNextResult input = pSource->getNext();
+    if (!_compactGroups && _groups->empty() && _sortedFiles.empty()) {
+        _compactGroups = makeCompactGroups();
+    }
+
+    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'. When the groups
+    // are compact, consumeIntoCompactGroups() does the same, so the loop is skipped.
+    GetNextResult input = _compactGroups ? consumeIntoCompactGroups() : pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
         if (_memoryUsageBytes > _maxMemoryUsageBytes) {
             uassert(16945,
@@ -567,12 +591,13 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
             // Do any final steps necessary to prepare to output results.
             if (!_sortedFiles.empty()) {
                 _spilled = true;
-                if (!_groups->empty()) {
+                if (_compactGroups ? !_compactGroups->empty() : !_groups->empty()) {
                     _sortedFiles.push_back(spill());
                 }
 
                 // We won't be using groups again so free its memory.
                 _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+                _compactGroups.reset();
 
                 _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
                     _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
@@ -588,6 +613,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
             } else {
                 // start the group iterator
                 groupsIterator = _groups->begin();
+                _compactGroupsPosition = 0;
             }
 
             // This must happen last so that, unless control gets here, we will re-enter
@@ -599,7 +625,101 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
+std::unique_ptr<GroupHashTable> DocumentSourceGroup::makeCompactGroups() const {
+    if (!internalDocumentSourceGroupUseCompactTable.load()) {
+        return nullptr;
+    }
+
+    vector<GroupHashTable::AccumulatorKind> kinds;
+    kinds.reserve(vpAccumulatorFactory.size());
+    for (auto&& factory : vpAccumulatorFactory) {
+        auto kind = GroupHashTable::parseKind(factory(pExpCtx)->getOpName());
+        if (!kind) {
+            return nullptr;
+        }
+        kinds.push_back(*kind);
+    }
+
+    return stdx::make_unique<GroupHashTable>(pExpCtx->getValueComparator(), std::move(kinds));
+}
+
+DocumentSource::GetNextResult DocumentSourceGroup::consumeIntoCompactGroups() {
+    const size_t numAccumulators = vpAccumulatorFactory.size();
+
+    vector<Value> ids;
+    vector<size_t> hashes;
+    vector<size_t> groups;
+    vector<Value> inputs;  // The argument of accumulator 'j' for document 'i' is at i * n + j.
+    ids.reserve(kCompactGroupsBatchSize);
+    hashes.reserve(kCompactGroupsBatchSize);
+    groups.reserve(kCompactGroupsBatchSize);
+    inputs.reserve(kCompactGroupsBatchSize * numAccumulators);
+
+    while (true) {
+        if (_compactGroups->getApproximateSize() > _maxMemoryUsageBytes) {
+            uassert(16945,
+                    "Exceeded memory limit for $group, but didn't allow external sort."
+                    " Pass allowDiskUse:true to opt in.",
+                    _extSortAllowed);
+            _sortedFiles.push_back(spill());
+        }
+
+        ids.clear();
+        inputs.clear();
+        GetNextResult input = GetNextResult::makeEOF();
+        while (ids.size() < kCompactGroupsBatchSize) {
+            input = pSource->getNext();
+            if (!input.isAdvanced()) {
+                break;
+            }
+
+            _variables->setRoot(input.releaseDocument());
+            ids.push_back(computeId(_variables.get()));
+            for (size_t j = 0; j < numAccumulators; j++) {
+                inputs.push_back(vpExpression[j]->evaluate(_variables.get()));
+            }
+            _variables->clearRoot();
+        }
+
+        const size_t batchSize = ids.size();
+        hashes.resize(batchSize);
+        for (size_t i = 0; i < batchSize; i++) {
+            hashes[i] = _compactGroups->hash(ids[i]);
+        }
+
+        bool sawDuplicate = false;
+        groups.resize(batchSize);
+        for (size_t i = 0; i < batchSize; i++) {
+            bool inserted;
+            groups[i] = _compactGroups->findOrInsert(std::move(ids[i]), hashes[i], &inserted);
+            sawDuplicate = sawDuplicate || !inserted;
+        }
+
+        for (size_t j = 0; j < numAccumulators; j++) {
+            for (size_t i = 0; i < batchSize; i++) {
+                _compactGroups->process(groups[i], j, inputs[i * numAccumulators + j], _doingMerge);
+            }
+        }
+
+        if (kDebugBuild && !storageGlobalParams.readOnly) {
+            // In debug mode, spill every time we have a duplicate id to stress merge logic.
+            if (sawDuplicate && !pExpCtx->inRouter && !_extSortAllowed &&
+                _sortedFiles.size() < 20) {
+                _sortedFiles.push_back(spill());
+            }
+        }
+
+        if (!input.isAdvanced()) {
+            return input;
+        }
+    }
+}
+
 shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
+    if (_compactGroups) {
+        return spillCompactGroups();
+    }
+
     vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
     ptrs.reserve(_groups->size());
     for (GroupsMap::const_iterator it = _groups->begin(), end = _groups->end(); it != end; ++it) {
@@ -639,6 +759,36 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
 }
 
+shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spillCompactGroups() {
+    const vector<uint32_t> sortedGroups = _compactGroups->sortedGroups();
+
+    SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
+    const size_t numAccumulators = _compactGroups->numAccumulators();
+    for (auto group : sortedGroups) {
+        switch (numAccumulators) {  // mirrors switch in spill()
+            case 0:
+                writer.addAlreadySorted(_compactGroups->getId(group), Value());
+                break;
+            case 1:
+                writer.addAlreadySorted(_compactGroups->getId(group),
+                                        _compactGroups->getValue(group, 0, /*toBeMerged=*/true));
+                break;
+            default: {
+                vector<Value> accums;
+                accums.reserve(numAccumulators);
+                for (size_t j = 0; j < numAccumulators; j++) {
+                    accums.push_back(_compactGroups->getValue(group, j, /*toBeMerged=*/true));
+                }
+                writer.addAlreadySorted(_compactGroups->getId(group), Value(std::move(accums)));
+            }
+        }
+    }
+
+    _compactGroups->clear();
+
+    return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+}
+
 boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
     if (true) {
         // Until streaming $group correctly handles nullish values, the streaming behavior is
@@ -845,6 +995,25 @@ Document DocumentSourceGroup::makeDocument(const Value& id,
     return out.freeze();
 }
 
+Document DocumentSourceGroup::makeDocument(size_t compactGroup, bool mergeableOutput) {
+    const size_t n = vFieldName.size();
+    MutableDocument out(1 + n);
+
+    out.addField("_id", expandId(_compactGroups->getId(compactGroup)));
+
+    for (size_t i = 0; i < n; ++i) {
+        Value val = _compactGroups->getValue(compactGroup, i, mergeableOutput);
+        if (val.missing()) {
+            // we return null in this case so return objects are predictable
+            out.addField(vFieldName[i], Value(BSONNULL));
+        } else {
+            out.addField(vFieldName[i], val);
+        }
+    }
+
+    return out.freeze();
+}
+
 intrusive_ptr<DocumentSource> DocumentSourceGroup::getShardSource() {
     return this;  // No modifications necessary when on shard
 }
@@ -34,6 +34,7 @@
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/group_hash_table.h"
 #include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
@@ -45,6 +46,10 @@ public:
 
     static const size_t kDefaultMaxMemoryUsageBytes = 100 * 1024 * 1024;
 
+    // The number of input documents whose group keys are hashed together before being looked up
+    // in a GroupHashTable.
+    static const size_t kCompactGroupsBatchSize = 64;
+
     // Virtuals from DocumentSource.
     boost::intrusive_ptr<DocumentSource> optimize() final;
     GetDepsReturn getDependencies(DepsTracker* deps) const final;
@@ -127,6 +132,22 @@ private:
      */
     GetNextResult initialize();
 
+    /**
+     * Returns a GroupHashTable to hold the groups of this stage, or nullptr if the accumulators
+     * can't be kept in one or internalDocumentSourceGroupUseCompactTable is off.
+     */
+    std::unique_ptr<GroupHashTable> makeCompactGroups() const;
+
+    /**
+     * Used by initialize() in place of the per-document loop over 'pSource' when the groups are
+     * held in '_compactGroups'. Consumes input in batches of up to kCompactGroupsBatchSize
+     * documents, first evaluating the _id and accumulator arguments of each document of the batch,
+     * then hashing and looking up all of their keys, and finally updating the state of each
+     * accumulator for the whole batch at once. Returns the first result from 'pSource' which isn't
+     * an advanced document.
+     */
+    GetNextResult consumeIntoCompactGroups();
+
     /**
      * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
      * does not exhaust the previous stage before returning, and thus does not maintain as large a
@@ -134,7 +155,14 @@ private:
      */
     std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
 
+    /**
+     * Like spill(), for groups held in '_compactGroups'. Writes the same format as spill(), so that
+     * getNextSpilled() need not know where the groups came from.
+     */
+    std::shared_ptr<Sorter<Value, Value>::Iterator> spillCompactGroups();
+
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
+    Document makeDocument(size_t compactGroup, bool mergeableOutput);
 
     /**
      * Computes the internal representation of the group key.
@@ -176,11 +204,16 @@ private:
     // definition of equality.
     boost::optional<GroupsMap> _groups;
 
+    // When set, the groups are held here rather than in '_groups'. It is created by initialize()
+    // if makeCompactGroups() allows.
+    std::unique_ptr<GroupHashTable> _compactGroups;
+
     std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
     bool _spilled;
 
     // Only used when '_spilled' is false.
     GroupsMap::iterator groupsIterator;
+    size_t _compactGroupsPosition = 0;
 
     // Only used when '_spilled' is true.
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
@@ -30,14 +30,19 @@
 
 #include "mongo/db/pipeline/document_source_lookup.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 #include "mongo/base/init.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_algo.h"
+#include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_path_support.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
 
 namespace mongo {
@@ -117,6 +122,87 @@ BSONObj buildEqualityOrQuery(const std::string& fieldName, const BSONArray& valu
     return orBuilder.obj();
 }
 
+/**
+ * Returns the values at 'localFieldPath' in 'input' to join on, with any arrays expanded. A missing
+ * value is treated as null.
+ */
+BSONArray getLocalFieldValues(const Document& input, const FieldPath& localFieldPath) {
+    BSONArrayBuilder arrBuilder;
+    document_path_support::visitAllValuesAtPath(
+        input, localFieldPath, [&](const Value& nextValue) { arrBuilder << nextValue; });
+
+    if (arrBuilder.arrSize() == 0) {
+        // Missing values are treated as null.
+        arrBuilder << BSONNULL;
+    }
+    return arrBuilder.arr();
+}
+
+bool isAllDigits(StringData str) {
+    return std::all_of(str.begin(), str.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+/**
+ * Calls 'addKey' with every value which an equality match on 'path' could compare equal to the
+ * value of 'path' in 'value', starting at component 'index' of 'path'. Those include the elements
+ * of arrays and null where the path is missing. Some values are reported which an equality match
+ * would not consider, such as those within nested arrays, so matches must still be verified.
+ */
+void visitJoinKeys(const Value& value,
+                   const FieldPath& path,
+                   size_t index,
+                   const stdx::function<void(const Value&)>& addKey) {
+    auto addKeyOrNull = [&](const Value& key) {
+        addKey(key);
+        if (key.getType() == Undefined) {
+            addKey(Value(BSONNULL));
+        }
+    };
+
+    if (index == path.getPathLength()) {
+        addKeyOrNull(value);
+        if (value.isArray()) {
+            for (auto&& elem : value.getArray()) {
+                addKeyOrNull(elem);
+            }
+        }
+        return;
+    }
+
+    const StringData fieldName = path.getFieldName(index);
+    switch (value.getType()) {
+        case Object: {
+            Value child = value.getDocument()[fieldName];
+            if (child.missing()) {
+                addKey(Value(BSONNULL));
+            } else {
+                visitJoinKeys(child, path, index + 1, addKey);
+            }
+            return;
+        }
+        case Array: {
+            const auto& elems = value.getArray();
+            if (elems.empty()) {
+                addKey(Value(BSONNULL));
+            }
+            for (auto&& elem : elems) {
+                visitJoinKeys(elem, path, index, addKey);
+            }
+            if (isAllDigits(fieldName)) {
+                // The path may refer to an array element by its position.
+                const size_t position = std::strtoull(fieldName.toString().c_str(), nullptr, 10);
+                if (position < elems.size()) {
+                    visitJoinKeys(elems[position], path, index + 1, addKey);
+                }
+            }
+            return;
+        }
+        default:
+            addKey(Value(BSONNULL));
+            return;
+    }
+}
+
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
@@ -146,22 +232,43 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     // '_handlingUnwind' would be set to true, and we would not have made it here.
     invariant(!_matchSrc);
 
-    auto matchStage =
-        makeMatchStageFromInput(inputDoc, _localField, _foreignFieldFieldName, BSONObj());
-    // We've already allocated space for the trailing $match stage in '_fromPipeline'.
-    _fromPipeline.back() = matchStage;
-    auto pipeline = uassertStatusOK(_mongod->makePipeline(_fromPipeline, _fromExpCtx));
-
     std::vector<Value> results;
     int objsize = 0;
-    while (auto result = pipeline->getNext()) {
-        objsize += result->getApproximateSize();
+    auto addResult = [&](Document result) {
+        objsize += result.getApproximateSize();
         uassert(4568,
                 str::stream() << "Total size of documents in " << _fromNs.coll() << " matching "
-                              << matchStage
+                              << makeMatchStageFromInput(
+                                     inputDoc, _localField, _foreignFieldFieldName, BSONObj())
                               << " exceeds maximum document size",
                 objsize <= BSONObjMaxInternalSize);
-        results.emplace_back(std::move(*result));
+        results.emplace_back(std::move(result));
+    };
+
+    const BSONArray localValues = getLocalFieldValues(inputDoc, _localField);
+    if (auto foreignDocs = findForeignDocuments(localValues)) {
+        for (auto&& foreignDoc : *foreignDocs) {
+            addResult(Document(foreignDoc));
+        }
+    } else {
+        auto matchStage =
+            makeMatchStageFromInput(inputDoc, _localField, _foreignFieldFieldName, BSONObj());
+        // We've already allocated space for the trailing $match stage in '_fromPipeline'.
+        _fromPipeline.back() = matchStage;
+        auto pipeline = uassertStatusOK(_mongod->makePipeline(_fromPipeline, _fromExpCtx));
+
+        std::vector<BSONObj> foreignDocsToCache;
+        const bool caching = cacheEnabled();
+        while (auto result = pipeline->getNext()) {
+            if (caching) {
+                foreignDocsToCache.push_back(result->toBson());
+            }
+            addResult(std::move(*result));
+        }
+
+        if (caching) {
+            cacheForeignDocuments(localValues, std::move(foreignDocsToCache));
+        }
     }
 
     MutableDocument output(std::move(inputDoc));
@@ -283,8 +390,120 @@ Pipeline::SourceContainer::iterator DocumentSourceLookUp::doOptimizeAt(
     return itr;
 }
 
+bool DocumentSourceLookUp::cacheEnabled() const {
+    return internalDocumentSourceLookupCacheMaxMemoryBytes.load() > 0;
+}
+
+boost::optional<std::vector<BSONObj>> DocumentSourceLookUp::findForeignDocuments(
+    const BSONArray& localValues) {
+    if (_hashJoinState == HashJoinState::kNotBuilt &&
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.load() > 0) {
+        buildHashJoinTable();
+    }
+
+    if (_hashJoinState == HashJoinState::kBuilt) {
+        // Every document matching the query for 'localValues' is among the candidates found in the
+        // table, which are verified with the equality match the query would have used.
+        std::vector<size_t> matching;
+        for (auto&& localValue : localValues) {
+            auto it = _hashJoinTable->find(Value(localValue));
+            if (it == _hashJoinTable->end()) {
+                continue;
+            }
+
+            EqualityMatchExpression equality;
+            uassertStatusOK(equality.init(_foreignFieldFieldName, localValue));
+            equality.setCollator(_fromExpCtx->getCollator());
+            for (size_t position : it->second) {
+                if (equality.matchesBSON(_hashJoinDocs[position])) {
+                    matching.push_back(position);
+                }
+            }
+        }
+
+        std::sort(matching.begin(), matching.end());
+        matching.erase(std::unique(matching.begin(), matching.end()), matching.end());
+
+        std::vector<BSONObj> foreignDocs;
+        foreignDocs.reserve(matching.size());
+        for (size_t position : matching) {
+            foreignDocs.push_back(_hashJoinDocs[position]);
+        }
+        return foreignDocs;
+    }
+
+    if (!cacheEnabled()) {
+        return boost::none;
+    }
+
+    if (_cache) {
+        if (auto cached = (*_cache)[Value(localValues)]) {
+            ++_cacheHits;
+            return cached;
+        }
+    }
+    ++_cacheMisses;
+    return boost::none;
+}
+
+void DocumentSourceLookUp::cacheForeignDocuments(const BSONArray& localValues,
+                                                 std::vector<BSONObj> foreignDocs) {
+    const long long maxMemoryUsageBytes = internalDocumentSourceLookupCacheMaxMemoryBytes.load();
+    if (maxMemoryUsageBytes <= 0) {
+        return;
+    }
+
+    if (!_cache) {
+        _cache = stdx::make_unique<LookupSetCache>(_fromExpCtx->getValueComparator());
+    }
+    _cache->insertAll(Value(localValues), std::move(foreignDocs));
+    _cache->evictDownTo(maxMemoryUsageBytes);
+}
+
+void DocumentSourceLookUp::buildHashJoinTable() {
+    invariant(_hashJoinState == HashJoinState::kNotBuilt);
+    const long long maxMemoryUsageBytes =
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+
+    _fromPipeline.back() = BSON("$match" << _additionalFilter.value_or(BSONObj()));
+    auto pipeline = uassertStatusOK(_mongod->makePipeline(_fromPipeline, _fromExpCtx));
+
+    _hashJoinTable = _fromExpCtx->getValueComparator().makeUnorderedValueMap<std::vector<size_t>>();
+    long long memoryUsageBytes = 0;
+    while (auto result = pipeline->getNext()) {
+        const size_t position = _hashJoinDocs.size();
+        _hashJoinDocs.push_back(result->toBson());
+        memoryUsageBytes += _hashJoinDocs.back().objsize();
+
+        visitJoinKeys(Value(*result), _foreignField, 0, [&](const Value& key) {
+            auto& positions = (*_hashJoinTable)[key];
+            if (positions.empty()) {
+                memoryUsageBytes += key.getApproximateSize();
+            }
+            // A document can be reached by the same key more than once, but only in a row.
+            if (positions.empty() || positions.back() != position) {
+                positions.push_back(position);
+                memoryUsageBytes += sizeof(size_t);
+            }
+        });
+
+        if (memoryUsageBytes > maxMemoryUsageBytes) {
+            _hashJoinDocs.clear();
+            _hashJoinTable = boost::none;
+            _hashJoinState = HashJoinState::kExceededMemoryLimit;
+            return;
+        }
+    }
+    _hashJoinState = HashJoinState::kBuilt;
+}
+
 void DocumentSourceLookUp::dispose() {
     _pipeline.reset();
+    _foreignDocs = boost::none;
+    _foreignDocsToCache = boost::none;
+    _hashJoinDocs.clear();
+    _hashJoinTable = boost::none;
+    _cache.reset();
     pSource->dispose();
 }
 
@@ -295,23 +514,16 @@ BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
     // Add the 'localFieldPath' of 'input' into 'localFieldList'. If 'localFieldPath' references a
     // field with an array in its path, we may need to join on multiple values, so we add each
     // element to 'localFieldList'.
-    BSONArrayBuilder arrBuilder;
+    const auto localFieldList = getLocalFieldValues(input, localFieldPath);
+    const auto localFieldListSize = localFieldList.nFields();
     bool containsRegex = false;
-    document_path_support::visitAllValuesAtPath(input, localFieldPath, [&](const Value& nextValue) {
-        arrBuilder << nextValue;
-        if (!containsRegex && nextValue.getType() == RegEx) {
+    for (auto&& elem : localFieldList) {
+        if (elem.type() == RegEx) {
             containsRegex = true;
+            break;
         }
-    });
-
-    if (arrBuilder.arrSize() == 0) {
-        // Missing values are treated as null.
-        arrBuilder << BSONNULL;
     }
 
-    const auto localFieldListSize = arrBuilder.arrSize();
-    const auto localFieldList = arrBuilder.arr();
-
     // We construct a query of one of the following forms, depending on the contents of
     // 'localFieldList'.
     //
@@ -378,7 +590,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     // Loop until we get a document that has at least one match.
     // Note we may return early from this loop if our source stage is exhausted or if the unwind
     // source was asked to return empty arrays and we get a document without a match.
-    while (!_pipeline || !_nextValue) {
+    while ((!_pipeline && !_foreignDocs) || !_nextValue) {
         auto nextInput = pSource->getNext();
         if (!nextInput.isAdvanced()) {
             return nextInput;
@@ -386,15 +598,28 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
         _input = nextInput.releaseDocument();
 
-        BSONObj filter = _additionalFilter.value_or(BSONObj());
-        auto matchStage =
-            makeMatchStageFromInput(*_input, _localField, _foreignFieldFieldName, filter);
-        // We've already allocated space for the trailing $match stage in '_fromPipeline'.
-        _fromPipeline.back() = matchStage;
-        _pipeline = uassertStatusOK(_mongod->makePipeline(_fromPipeline, _fromExpCtx));
+        _inputLocalValues = getLocalFieldValues(*_input, _localField);
+        _foreignDocs = findForeignDocuments(_inputLocalValues);
+        _foreignDocsIndex = 0;
+        _foreignDocsToCache = boost::none;
+        if (_foreignDocs) {
+            _pipeline.reset();
+        } else {
+            BSONObj filter = _additionalFilter.value_or(BSONObj());
+            auto matchStage =
+                makeMatchStageFromInput(*_input, _localField, _foreignFieldFieldName, filter);
+            // We've already allocated space for the trailing $match stage in '_fromPipeline'.
+            _fromPipeline.back() = matchStage;
+            _pipeline = uassertStatusOK(_mongod->makePipeline(_fromPipeline, _fromExpCtx));
+
+            if (cacheEnabled()) {
+                _foreignDocsToCache.emplace();
+                _foreignDocsToCacheBytes = 0;
+            }
+        }
 
         _cursorIndex = 0;
-        _nextValue = _pipeline->getNext();
+        _nextValue = nextUnwindValue();
 
         if (_unwindSrc->preserveNullAndEmptyArrays() && !_nextValue) {
             // There were no results for this cursor, but the $unwind was asked to preserve empty
@@ -412,7 +637,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
     invariant(bool(_input) && bool(_nextValue));
     auto currentValue = *_nextValue;
-    _nextValue = _pipeline->getNext();
+    _nextValue = nextUnwindValue();
 
     // Move input document into output if this is the last or only result, otherwise perform a copy.
     MutableDocument output(_nextValue ? *_input : std::move(*_input));
@@ -426,6 +651,32 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     return output.freeze();
 }
 
+boost::optional<Document> DocumentSourceLookUp::nextUnwindValue() {
+    if (_foreignDocs) {
+        if (_foreignDocsIndex == _foreignDocs->size()) {
+            return boost::none;
+        }
+        return Document((*_foreignDocs)[_foreignDocsIndex++]);
+    }
+
+    auto result = _pipeline->getNext();
+    if (_foreignDocsToCache) {
+        if (!result) {
+            cacheForeignDocuments(_inputLocalValues, std::move(*_foreignDocsToCache));
+            _foreignDocsToCache = boost::none;
+        } else {
+            _foreignDocsToCache->push_back(result->toBson());
+            _foreignDocsToCacheBytes += _foreignDocsToCache->back().objsize();
+            if (_foreignDocsToCacheBytes >
+                static_cast<size_t>(internalDocumentSourceLookupCacheMaxMemoryBytes.load())) {
+                // Too large to be cached.
+                _foreignDocsToCache = boost::none;
+            }
+        }
+    }
+    return result;
+}
+
 void DocumentSourceLookUp::serializeToArray(std::vector<Value>& array, bool explain) const {
     MutableDocument output(DOC(
         getSourceName() << DOC("from" << _fromNs.coll() << "as" << _as.fullPath() << "localField"
@@ -451,6 +702,29 @@ void DocumentSourceLookUp::serializeToArray(std::vector<Value>& array, bool expl
                           ->getQuery());
         }
 
+        if (internalDocumentSourceLookupHashJoinMaxMemoryBytes.load() > 0) {
+            StringData state;
+            switch (_hashJoinState) {
+                case HashJoinState::kNotBuilt:
+                    state = "notBuilt"_sd;
+                    break;
+                case HashJoinState::kBuilt:
+                    state = "built"_sd;
+                    break;
+                case HashJoinState::kExceededMemoryLimit:
+                    state = "exceededMemoryLimit"_sd;
+                    break;
+            }
+            output[getSourceName()]["hashJoin"] =
+                Value(DOC("state" << state << "foreignDocuments"
+                                  << static_cast<long long>(_hashJoinDocs.size())));
+        }
+
+        if (cacheEnabled()) {
+            output[getSourceName()]["cache"] =
+                Value(DOC("hits" << _cacheHits << "misses" << _cacheMisses));
+        }
+
         array.push_back(Value(output.freeze()));
     } else {
         array.push_back(Value(output.freeze()));
@@ -127,6 +127,32 @@ private:
 
     GetNextResult unwindResult();
 
+    /**
+     * Returns the foreign documents joined with an input document whose local field holds
+     * 'localValues', from the hash join table or the cache. Returns boost::none if they have to be
+     * queried for.
+     */
+    boost::optional<std::vector<BSONObj>> findForeignDocuments(const BSONArray& localValues);
+
+    /**
+     * Caches 'foreignDocs' as the documents joined with input documents whose local field holds
+     * 'localValues', if caching is enabled.
+     */
+    void cacheForeignDocuments(const BSONArray& localValues, std::vector<BSONObj> foreignDocs);
+
+    /**
+     * Returns the next of the foreign documents joined with '_input' while unwinding.
+     */
+    boost::optional<Document> nextUnwindValue();
+
+    /**
+     * Reads the whole foreign collection into '_hashJoinDocs', indexed by the values of the
+     * foreign field, unless it doesn't fit in internalDocumentSourceLookupHashJoinMaxMemoryBytes.
+     */
+    void buildHashJoinTable();
+
+    bool cacheEnabled() const;
+
     NamespaceString _fromNs;
     FieldPath _as;
     FieldPath _localField;
@@ -153,6 +179,29 @@ private:
     boost::intrusive_ptr<Pipeline> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
+
+    // Set while unwinding results which were found without querying, in place of '_pipeline'.
+    boost::optional<std::vector<BSONObj>> _foreignDocs;
+    size_t _foreignDocsIndex = 0;
+
+    // Set while unwinding queried results which are to be cached once all are read, along with the
+    // local values of '_input' they are cached for.
+    boost::optional<std::vector<BSONObj>> _foreignDocsToCache;
+    size_t _foreignDocsToCacheBytes = 0;
+    BSONArray _inputLocalValues;
+
+    enum class HashJoinState { kNotBuilt, kBuilt, kExceededMemoryLimit };
+    HashJoinState _hashJoinState = HashJoinState::kNotBuilt;
+
+    // The documents of the foreign collection, in the order read, and the positions of those whose
+    // foreign field may equal a value. Only set when '_hashJoinState' is kBuilt.
+    std::vector<BSONObj> _hashJoinDocs;
+    boost::optional<ValueUnorderedMap<std::vector<size_t>>> _hashJoinTable;
+
+    // Foreign documents by the values of the local field they were queried for.
+    std::unique_ptr<LookupSetCache> _cache;
+    long long _cacheHits = 0;
+    long long _cacheMisses = 0;
 };
 
 }  // namespace mongo
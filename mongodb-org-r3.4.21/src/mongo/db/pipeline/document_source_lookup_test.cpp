@@ -43,6 +43,7 @@
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/stub_mongod_interface.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
 
 namespace mongo {
 namespace {
@@ -168,9 +169,12 @@ public:
         pipeline.getValue()->addInitialSource(DocumentSourceMock::create(_mockResults));
         pipeline.getValue()->optimizePipeline();
 
+        ++numPipelinesMade;
         return pipeline;
     }
 
+    int numPipelinesMade = 0;
+
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
 };
@@ -277,6 +281,169 @@ TEST_F(DocumentSourceLookUpTest, ShouldPropagatePausesWhileUnwinding) {
     ASSERT_TRUE(lookup->getNext().isEOF());
 }
 
+/**
+ * Sets a knob for the lifetime of this object.
+ */
+class KnobGuard {
+public:
+    KnobGuard(std::atomic<long long>& knob, long long value)  // NOLINT
+        : _knob(knob), _oldValue(knob.load()) {
+        _knob.store(value);
+    }
+
+    ~KnobGuard() {
+        _knob.store(_oldValue);
+    }
+
+private:
+    std::atomic<long long>& _knob;  // NOLINT
+    const long long _oldValue;
+};
+
+/**
+ * Joins the 'local' documents with the 'foreign' ones on "x" and "y" respectively, optionally
+ * unwinding the results, and returns the output.
+ */
+vector<Document> runLookup(const intrusive_ptr<ExpressionContextForTest>& expCtx,
+                           deque<DocumentSource::GetNextResult> local,
+                           deque<DocumentSource::GetNextResult> foreign,
+                           bool unwind,
+                           int* numPipelinesMade = nullptr,
+                           Document* explain = nullptr) {
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "x"},
+                                         {"foreignField", "y"},
+                                         {"as", "joined"}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+    if (unwind) {
+        lookup->setUnwindStage(DocumentSourceUnwind::create(expCtx, "joined", false, boost::none));
+    }
+
+    auto mockLocalSource = DocumentSourceMock::create(std::move(local));
+    lookup->setSource(mockLocalSource.get());
+    auto mongod = std::make_shared<MockMongodInterface>(std::move(foreign));
+    lookup->injectMongodInterface(mongod);
+
+    vector<Document> results;
+    for (auto next = lookup->getNext(); !next.isEOF(); next = lookup->getNext()) {
+        ASSERT_TRUE(next.isAdvanced());
+        results.push_back(next.releaseDocument());
+    }
+
+    if (numPipelinesMade) {
+        *numPipelinesMade = mongod->numPipelinesMade;
+    }
+    if (explain) {
+        vector<Value> serialized;
+        lookup->serializeToArray(serialized, true);
+        ASSERT_EQ(1U, serialized.size());
+        *explain = serialized[0].getDocument();
+    }
+    return results;
+}
+
+deque<DocumentSource::GetNextResult> makeJoinTestLocalDocuments() {
+    return {Document{{"x", 1}},
+            Document{{"x", 2.0}},
+            Document{{"x", vector<Value>{Value(3), Value(1)}}},
+            Document{{"x", BSONNULL}},
+            Document{{"z", 1}},
+            Document{{"x", Document{{"a", 1}}}},
+            Document{{"x", "str"_sd}},
+            Document{{"x", 1}}};
+}
+
+deque<DocumentSource::GetNextResult> makeJoinTestForeignDocuments() {
+    return {Document{{"_id", 0}, {"y", 1}},
+            Document{{"_id", 1}, {"y", 2LL}},
+            Document{{"_id", 2}, {"y", vector<Value>{Value(1), Value(3)}}},
+            Document{{"_id", 3}},
+            Document{{"_id", 4}, {"y", BSONNULL}},
+            Document{{"_id", 5}, {"y", Document{{"a", 1}}}},
+            Document{{"_id", 6}, {"y", vector<Value>{Value(vector<Value>{Value(1)})}}},
+            Document{{"_id", 7}, {"y", "str"_sd}}};
+}
+
+void assertSameResults(const vector<Document>& expected, const vector<Document>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_DOCUMENT_EQ(expected[i], actual[i]);
+    }
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinShouldProduceSameResultsAsQuerying) {
+    for (bool unwind : {false, true}) {
+        int numQueries;
+        auto expected = runLookup(getExpCtx(),
+                                  makeJoinTestLocalDocuments(),
+                                  makeJoinTestForeignDocuments(),
+                                  unwind,
+                                  &numQueries);
+        ASSERT_EQ(8, numQueries);
+
+        KnobGuard hashJoin(internalDocumentSourceLookupHashJoinMaxMemoryBytes, 1024 * 1024);
+        int numHashJoinQueries;
+        Document explain;
+        auto actual = runLookup(getExpCtx(),
+                                makeJoinTestLocalDocuments(),
+                                makeJoinTestForeignDocuments(),
+                                unwind,
+                                &numHashJoinQueries,
+                                &explain);
+        assertSameResults(expected, actual);
+        ASSERT_EQ(1, numHashJoinQueries);
+        ASSERT_VALUE_EQ(Value("built"_sd), explain["$lookup"]["hashJoin"]["state"]);
+        ASSERT_VALUE_EQ(Value(8LL), explain["$lookup"]["hashJoin"]["foreignDocuments"]);
+    }
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinShouldFallBackToQueryingWhenOverMemoryLimit) {
+    auto expected = runLookup(
+        getExpCtx(), makeJoinTestLocalDocuments(), makeJoinTestForeignDocuments(), false);
+
+    KnobGuard hashJoin(internalDocumentSourceLookupHashJoinMaxMemoryBytes, 64);
+    int numQueries;
+    Document explain;
+    auto actual = runLookup(getExpCtx(),
+                            makeJoinTestLocalDocuments(),
+                            makeJoinTestForeignDocuments(),
+                            false,
+                            &numQueries,
+                            &explain);
+    assertSameResults(expected, actual);
+    ASSERT_EQ(9, numQueries);
+    ASSERT_VALUE_EQ(Value("exceededMemoryLimit"_sd), explain["$lookup"]["hashJoin"]["state"]);
+}
+
+TEST_F(DocumentSourceLookUpTest, CacheShouldAvoidQueryingForRepeatedLocalValues) {
+    for (bool unwind : {false, true}) {
+        auto expected = runLookup(
+            getExpCtx(), makeJoinTestLocalDocuments(), makeJoinTestForeignDocuments(), unwind);
+
+        KnobGuard cache(internalDocumentSourceLookupCacheMaxMemoryBytes, 1024 * 1024);
+        int numQueries;
+        Document explain;
+        auto actual = runLookup(getExpCtx(),
+                                makeJoinTestLocalDocuments(),
+                                makeJoinTestForeignDocuments(),
+                                unwind,
+                                &numQueries,
+                                &explain);
+        assertSameResults(expected, actual);
+
+        // The last input document and the one missing "x" join on values seen before.
+        ASSERT_EQ(6, numQueries);
+        ASSERT_VALUE_EQ(Value(2LL), explain["$lookup"]["cache"]["hits"]);
+        ASSERT_VALUE_EQ(Value(6LL), explain["$lookup"]["cache"]["misses"]);
+    }
+}
+
 TEST_F(DocumentSourceLookUpTest, LookupReportsAsFieldIsModified) {
     auto expCtx = getExpCtx();
     NamespaceString fromNs("test", "foreign");
@@ -111,26 +111,24 @@ void DocumentSourceOut::initialize() {
                 ok);
     }
 
-    // copy indexes to _tempNs
+    _initialized = true;
+}
+
+void DocumentSourceOut::copyIndexes() {
+    vector<BSONObj> indexSpecs;
     for (std::list<BSONObj>::const_iterator it = _originalIndexes.begin();
          it != _originalIndexes.end();
          ++it) {
         MutableDocument index((Document(*it)));
         index.remove("_id");  // indexes shouldn't have _ids but some existing ones do
         index["ns"] = Value(_tempNs.ns());
-
-        BSONObj indexBson = index.freeze().toBson();
-        conn->insert(_tempNs.getSystemIndexesCollection(), indexBson);
-        BSONObj err = conn->getLastErrorDetailed();
-        uassert(16995,
-                str::stream() << "copying index for $out failed."
-                              << " index: "
-                              << indexBson
-                              << " error: "
-                              << err,
-                DBClientWithCommands::getLastErrorString(err).empty());
+        indexSpecs.push_back(index.freeze().toBson());
     }
-    _initialized = true;
+
+    auto status = _mongod->buildIndexes(_tempNs, indexSpecs);
+    uassert(16995,
+            str::stream() << "copying indexes for $out failed: " << status.toString(),
+            status.isOK());
 }
 
 void DocumentSourceOut::spill(const vector<BSONObj>& toInsert) {
@@ -178,6 +176,7 @@ DocumentSource::GetNextResult DocumentSourceOut::getNext() {
             return nextInput;  // Propagate the pause.
         }
         case GetNextResult::ReturnStatus::kEOF: {
+            copyIndexes();
 
             auto renameCommandObj =
                 BSON("renameCollection" << _tempNs.ns() << "to" << _outputNs.ns() << "dropTarget"
@@ -80,12 +80,20 @@ private:
      * Sets '_tempNs' to a unique temporary namespace, makes sure the output collection isn't
      * sharded or capped, and saves the collection options and indexes of the target collection.
      * Then creates the temporary collection we will insert into by copying the collection options
-     * and indexes from the target collection.
+     * from the target collection.
      *
      * Sets '_initialized' to true upon completion.
      */
     void initialize();
 
+    /**
+     * Creates the indexes of the target collection on the temporary collection. This is done once
+     * all of the documents have been inserted, so that each index is built from the sorted keys of
+     * all of the documents rather than having every insert update it. Only the temporary
+     * collection, not its database, is locked exclusively while the keys are sorted.
+     */
+    void copyIndexes();
+
     /**
      * Inserts all of 'toInsert' into the temporary collection.
      */
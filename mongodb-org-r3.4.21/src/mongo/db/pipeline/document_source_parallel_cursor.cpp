@@ -0,0 +1,535 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_parallel_cursor.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/matcher/extensions_callback_real.h"
+#include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_request.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+/**
+ * The state shared between a DocumentSourceParallelCursor and its worker threads. Each worker
+ * holds a reference to it, so it outlives the stage if the stage is disposed of while the workers
+ * are still cleaning up.
+ */
+class DocumentSourceParallelCursor::Workers
+    : public std::enable_shared_from_this<DocumentSourceParallelCursor::Workers> {
+public:
+    Workers(const NamespaceString& nss,
+            BSONObj query,
+            BSONObj collation,
+            std::vector<BSONObj> shardPipeline,
+            std::vector<Range> ranges,
+            size_t reservedThreads)
+        : nss(nss),
+          query(query.getOwned()),
+          collation(collation.getOwned()),
+          shardPipeline(std::move(shardPipeline)),
+          ranges(std::move(ranges)),
+          numThreads(std::min(reservedThreads, this->ranges.size())),
+          _unstartedThreads(reservedThreads) {
+        invariant(this->numThreads > 0);
+    }
+
+    /**
+     * Implementations of the static methods of DocumentSourceParallelCursor, which account for
+     * the threads of all the Workers of the process.
+     */
+    static size_t reserveThreads(size_t wanted);
+    static void releaseThreads(size_t count);
+    static void shutDownAll();
+
+    /**
+     * Registers 'workers' to be stopped by shutDownAll(), or stops them if it has already begun.
+     */
+    static void registerWorkers(const std::shared_ptr<Workers>& workers);
+
+    /**
+     * Starts one detached thread per worker, each running with its own copy of 'expCtx'.
+     */
+    void start(const intrusive_ptr<ExpressionContext>& expCtx, Date_t deadline);
+
+    /**
+     * Interrupts the worker threads, without waiting for them to exit, and drops any queued
+     * results. Releases the reserved threads if the workers were never started.
+     */
+    void stop();
+
+    /**
+     * Returns the next queued result, or boost::none once all of the workers are done. Throws if
+     * a worker failed or if 'txn' is interrupted.
+     */
+    boost::optional<Document> next(OperationContext* txn);
+
+    const NamespaceString nss;
+    const BSONObj query;
+    const BSONObj collation;
+    const std::vector<BSONObj> shardPipeline;
+    const std::vector<Range> ranges;
+    const size_t numThreads;
+
+private:
+    /**
+     * Body of each worker thread, which scans ranges until there are none left.
+     */
+    void runWorker(intrusive_ptr<ExpressionContext> workerExpCtx, Date_t deadline);
+
+    /**
+     * Runs a new copy of the shard pipeline over the documents in 'ranges[rangeIndex]'.
+     */
+    void scanRange(OperationContext* txn,
+                   const intrusive_ptr<ExpressionContext>& workerExpCtx,
+                   size_t rangeIndex);
+
+    /**
+     * Queues a result for next(), waiting for room if too many are queued already. Returns false
+     * if the workers are being stopped.
+     */
+    bool pushResult(Document result);
+
+    stdx::mutex _mutex;
+
+    // Signaled when a result is queued or a worker exits.
+    stdx::condition_variable _produced;
+
+    // Signaled when a result is dequeued or the workers are being stopped.
+    stdx::condition_variable _consumed;
+
+    // Everything below is protected by _mutex.
+    std::deque<Document> _results;
+    size_t _resultsBytes = 0;
+    size_t _nextRange = 0;
+    size_t _runningWorkers = 0;
+    bool _stopping = false;
+    Status _workerStatus = Status::OK();
+
+    // Clients of the running workers, so that their operations can be killed.
+    std::vector<Client*> _workerClients;
+
+    // Reserved threads which have not been started, and are released on start() or stop().
+    size_t _unstartedThreads;
+
+    // Protects the static members below, which are shared by the Workers of the whole process.
+    // Never acquired while holding the _mutex of a Workers.
+    static stdx::mutex _poolMutex;
+
+    // Signaled when reserved threads are released.
+    static stdx::condition_variable _poolReleased;
+
+    static size_t _poolReservedThreads;
+    static bool _poolShuttingDown;
+
+    // The Workers to stop on shutdown.
+    static std::vector<std::weak_ptr<Workers>> _poolWorkers;
+};
+
+stdx::mutex DocumentSourceParallelCursor::Workers::_poolMutex;
+stdx::condition_variable DocumentSourceParallelCursor::Workers::_poolReleased;
+size_t DocumentSourceParallelCursor::Workers::_poolReservedThreads = 0;
+bool DocumentSourceParallelCursor::Workers::_poolShuttingDown = false;
+std::vector<std::weak_ptr<DocumentSourceParallelCursor::Workers>>
+    DocumentSourceParallelCursor::Workers::_poolWorkers;
+
+size_t DocumentSourceParallelCursor::Workers::reserveThreads(size_t wanted) {
+    const int maxTotalThreads = internalDocumentSourceParallelCursorMaxTotalThreads.load();
+    const size_t maxThreads = static_cast<size_t>(std::max(maxTotalThreads, 0));
+
+    stdx::lock_guard<stdx::mutex> lk(_poolMutex);
+    if (_poolShuttingDown || _poolReservedThreads >= maxThreads) {
+        return 0;
+    }
+
+    const size_t reserved = std::min(wanted, maxThreads - _poolReservedThreads);
+    _poolReservedThreads += reserved;
+    return reserved;
+}
+
+void DocumentSourceParallelCursor::Workers::releaseThreads(size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_poolMutex);
+    invariant(_poolReservedThreads >= count);
+    _poolReservedThreads -= count;
+    _poolReleased.notify_all();
+}
+
+void DocumentSourceParallelCursor::Workers::registerWorkers(
+    const std::shared_ptr<Workers>& workers) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_poolMutex);
+        if (!_poolShuttingDown) {
+            _poolWorkers.erase(
+                std::remove_if(_poolWorkers.begin(),
+                               _poolWorkers.end(),
+                               [](const std::weak_ptr<Workers>& w) { return w.expired(); }),
+                _poolWorkers.end());
+            _poolWorkers.push_back(workers);
+            return;
+        }
+    }
+
+    // Reserved its threads before shutDownAll() started, but would be missed by it.
+    workers->stop();
+}
+
+void DocumentSourceParallelCursor::Workers::shutDownAll() {
+    std::vector<std::shared_ptr<Workers>> liveWorkers;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_poolMutex);
+        _poolShuttingDown = true;
+        for (auto&& w : _poolWorkers) {
+            if (auto workers = w.lock()) {
+                liveWorkers.push_back(std::move(workers));
+            }
+        }
+        _poolWorkers.clear();
+    }
+
+    // Stages whose cursors are not being iterated would otherwise keep their workers waiting for
+    // room to queue results forever.
+    for (auto&& workers : liveWorkers) {
+        workers->stop();
+    }
+    liveWorkers.clear();
+
+    stdx::unique_lock<stdx::mutex> lk(_poolMutex);
+    _poolReleased.wait(lk, [] { return _poolReservedThreads == 0; });
+}
+
+void DocumentSourceParallelCursor::Workers::start(const intrusive_ptr<ExpressionContext>& expCtx,
+                                                  Date_t deadline) {
+    size_t excessThreads;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_stopping) {
+            // Disposed of before the first call to getNext(), which released the threads.
+            return;
+        }
+        _runningWorkers = numThreads;
+
+        // Each worker releases its own thread as it exits.
+        excessThreads = _unstartedThreads - numThreads;
+        _unstartedThreads = 0;
+    }
+    releaseThreads(excessThreads);
+
+    for (size_t i = 0; i < numThreads; ++i) {
+        // Each worker gets its own ExpressionContext, made here since the one of the stage may be
+        // detached and reattached by its thread while the workers run. The shard half of a $group
+        // outputs partial results to be merged, just as it does on a shard.
+        auto workerExpCtx = expCtx->copyWith(nss);
+        workerExpCtx->opCtx = nullptr;
+        workerExpCtx->inShard = true;
+        auto self = shared_from_this();
+        stdx::thread([self, workerExpCtx, deadline]() mutable {
+            self->runWorker(std::move(workerExpCtx), deadline);
+            self.reset();
+            releaseThreads(1);
+        }).detach();
+    }
+}
+
+void DocumentSourceParallelCursor::Workers::stop() {
+    size_t unstartedThreads;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _stopping = true;
+        for (Client* client : _workerClients) {
+            stdx::lock_guard<Client> clientLock(*client);
+            if (OperationContext* txn = client->getOperationContext()) {
+                txn->getServiceContext()->killOperation(txn);
+            }
+        }
+        _results.clear();
+        _resultsBytes = 0;
+        _consumed.notify_all();
+
+        unstartedThreads = _unstartedThreads;
+        _unstartedThreads = 0;
+    }
+    releaseThreads(unstartedThreads);
+}
+
+boost::optional<Document> DocumentSourceParallelCursor::Workers::next(OperationContext* txn) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    txn->waitForConditionOrInterrupt(_produced, lk, [this] {
+        return !_results.empty() || !_workerStatus.isOK() || _runningWorkers == 0;
+    });
+
+    uassertStatusOK(_workerStatus);
+
+    if (_results.empty()) {
+        return boost::none;
+    }
+
+    Document out = std::move(_results.front());
+    _results.pop_front();
+    _resultsBytes -= out.getApproximateSize();
+    _consumed.notify_one();
+    return std::move(out);
+}
+
+void DocumentSourceParallelCursor::Workers::runWorker(
+    intrusive_ptr<ExpressionContext> workerExpCtx, Date_t deadline) {
+    Client::initThread("aggParallelCursor");
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _workerClients.push_back(&cc());
+    }
+
+    Status status = Status::OK();
+    try {
+        auto txn = cc().makeOperationContext();
+        if (deadline != Date_t::max()) {
+            txn->setDeadlineByDate(deadline);
+        }
+        workerExpCtx->opCtx = txn.get();
+
+        while (true) {
+            size_t rangeIndex;
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                if (_stopping || _nextRange == ranges.size()) {
+                    break;
+                }
+                rangeIndex = _nextRange++;
+            }
+
+            scanRange(txn.get(), workerExpCtx, rangeIndex);
+        }
+
+        workerExpCtx->opCtx = nullptr;
+    } catch (const DBException& ex) {
+        status = ex.toStatus();
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _workerClients.erase(std::find(_workerClients.begin(), _workerClients.end(), &cc()));
+
+        // The first failure fails the whole scan, while failures due to stopping are expected.
+        if (!status.isOK() && !_stopping && _workerStatus.isOK()) {
+            _workerStatus = status;
+        }
+        --_runningWorkers;
+    }
+    _produced.notify_all();
+
+    Client::destroy();
+}
+
+void DocumentSourceParallelCursor::Workers::scanRange(
+    OperationContext* txn,
+    const intrusive_ptr<ExpressionContext>& workerExpCtx,
+    size_t rangeIndex) {
+    auto pipeline = uassertStatusOK(Pipeline::parse(shardPipeline, workerExpCtx));
+    pipeline->optimizePipeline();
+
+    // The executor must be destroyed under the collection lock, even if the scan stops early. No
+    // thread ever waits for this one while holding a lock, so taking it again here is safe.
+    ON_BLOCK_EXIT([&] {
+        AutoGetCollectionForRead autoColl(txn, nss);
+        pipeline.reset();
+    });
+
+    {
+        AutoGetCollectionForRead autoColl(txn, nss);
+        Collection* collection = autoColl.getCollection();
+        uassert(40705,
+                str::stream() << "collection " << nss.ns()
+                              << " was dropped during a parallel aggregation",
+                collection);
+
+        auto qr = stdx::make_unique<QueryRequest>(nss);
+        qr->setFilter(query);
+        qr->setCollation(collation);
+        auto cq = uassertStatusOK(
+            CanonicalQuery::canonicalize(txn, std::move(qr), ExtensionsCallbackReal(txn, &nss)));
+
+        CollectionScanParams params;
+        params.collection = collection;
+        params.minRecord = ranges[rangeIndex].first;
+        params.maxRecord = ranges[rangeIndex].second;
+
+        auto ws = stdx::make_unique<WorkingSet>();
+        auto root = stdx::make_unique<CollectionScan>(txn, params, ws.get(), cq->root());
+        auto exec = uassertStatusOK(PlanExecutor::make(txn,
+                                                       std::move(ws),
+                                                       std::move(root),
+                                                       std::move(cq),
+                                                       collection,
+                                                       PlanExecutor::YIELD_AUTO));
+
+        // DocumentSourceCursor expects a yielding PlanExecutor that has had its state saved.
+        exec->saveState();
+
+        auto source =
+            DocumentSourceCursor::create(collection, nss.ns(), std::move(exec), workerExpCtx);
+        source->setQuery(query);
+
+        DepsTracker deps = pipeline->getDependencies(DepsTracker::MetadataAvailable::kNoMetadata);
+        if (deps.hasNoRequirements()) {
+            source->shouldProduceEmptyDocs();
+        }
+        source->setProjection(deps.toProjection(), deps.toParsedDeps());
+
+        pipeline->addInitialSource(source);
+    }
+
+    while (auto next = pipeline->getNext()) {
+        if (!pushResult(std::move(*next))) {
+            return;
+        }
+    }
+}
+
+bool DocumentSourceParallelCursor::Workers::pushResult(Document result) {
+    // Allow about one cursor batch per thread to be queued before making the workers wait.
+    const size_t maxQueuedBytes =
+        static_cast<size_t>(internalDocumentSourceCursorBatchSizeBytes.load()) * numThreads;
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _consumed.wait(lk, [&] { return _stopping || _resultsBytes < maxQueuedBytes; });
+    if (_stopping) {
+        return false;
+    }
+
+    _resultsBytes += result.getApproximateSize();
+    _results.push_back(std::move(result));
+    _produced.notify_one();
+    return true;
+}
+
+intrusive_ptr<DocumentSourceParallelCursor> DocumentSourceParallelCursor::create(
+    const NamespaceString& nss,
+    BSONObj query,
+    BSONObj collation,
+    std::vector<BSONObj> shardPipeline,
+    std::vector<Range> ranges,
+    size_t numThreads,
+    const intrusive_ptr<ExpressionContext>& expCtx) {
+    auto workers = std::make_shared<Workers>(nss,
+                                             std::move(query),
+                                             std::move(collation),
+                                             std::move(shardPipeline),
+                                             std::move(ranges),
+                                             numThreads);
+    Workers::registerWorkers(workers);
+    return new DocumentSourceParallelCursor(std::move(workers), expCtx);
+}
+
+size_t DocumentSourceParallelCursor::reserveThreads(size_t wanted) {
+    return Workers::reserveThreads(wanted);
+}
+
+void DocumentSourceParallelCursor::releaseThreads(size_t count) {
+    Workers::releaseThreads(count);
+}
+
+void DocumentSourceParallelCursor::shutDownWorkers() {
+    Workers::shutDownAll();
+}
+
+DocumentSourceParallelCursor::DocumentSourceParallelCursor(
+    std::shared_ptr<Workers> workers, const intrusive_ptr<ExpressionContext>& expCtx)
+    : DocumentSource(expCtx), _workers(std::move(workers)) {}
+
+DocumentSourceParallelCursor::~DocumentSourceParallelCursor() {
+    _workers->stop();
+}
+
+const char* DocumentSourceParallelCursor::getSourceName() const {
+    return "$parallelCursor";
+}
+
+Value DocumentSourceParallelCursor::serialize(bool explain) const {
+    std::vector<Value> shardPipeline;
+    for (auto&& stage : _workers->shardPipeline) {
+        shardPipeline.push_back(Value(stage));
+    }
+
+    return Value(DOC(getSourceName() << DOC(
+                         "query" << _workers->query << "threads"
+                                 << static_cast<long long>(_workers->numThreads)
+                                 << "ranges"
+                                 << static_cast<long long>(_workers->ranges.size())
+                                 << "shardPipeline"
+                                 << Value(shardPipeline))));
+}
+
+void DocumentSourceParallelCursor::dispose() {
+    _workers->stop();
+}
+
+DocumentSource::GetNextResult DocumentSourceParallelCursor::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    if (!_started) {
+        startWorkers();
+    }
+
+    if (auto next = _workers->next(pExpCtx->opCtx)) {
+        return std::move(*next);
+    }
+    return GetNextResult::makeEOF();
+}
+
+void DocumentSourceParallelCursor::startWorkers() {
+    _started = true;
+    _workers->start(pExpCtx, pExpCtx->opCtx->getDeadline());
+}
+
+}  // namespace mongo
@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/record_id.h"
+
+namespace mongo {
+
+/**
+ * Runs the front of a pipeline, up to and including the shard half of its first $group, on
+ * several threads, each scanning ranges of RecordIds of a collection in turn. Returns the partial
+ * results of all the threads, in no particular order, for the rest of the pipeline to merge the
+ * same way mongos merges results from shards.
+ *
+ * Each thread has its own Client and OperationContext, takes its own locks and yields on its own,
+ * so each range is read in a separate snapshot. The threads inherit the deadline of the operation
+ * that starts them and are interrupted when this stage is disposed of.
+ *
+ * The threads share their state with this stage and are never joined. Disposing of the stage only
+ * interrupts them, because it usually happens under the collection lock that the threads need to
+ * clean up, and waiting for them there could deadlock with a queued exclusive lock request.
+ *
+ * The threads of all the stages of the process are reserved out of
+ * internalDocumentSourceParallelCursorMaxTotalThreads before the stage is created, and shutdown
+ * stops them and waits for them to exit through shutDownWorkers().
+ *
+ * PipelineD puts this stage in place of a $cursor over a large collection scan.
+ */
+class DocumentSourceParallelCursor final : public DocumentSource {
+public:
+    // A range of RecordIds [first, second), where a null RecordId leaves that side open.
+    using Range = std::pair<RecordId, RecordId>;
+
+    /**
+     * Reserves up to 'wanted' worker threads out of those which all the stages of the process may
+     * run at once, without waiting for any to be released. Returns how many were reserved, which
+     * is 0 once shutDownWorkers() has been called.
+     */
+    static size_t reserveThreads(size_t wanted);
+
+    /**
+     * Gives back 'count' threads reserved with reserveThreads() which were not passed to create().
+     */
+    static void releaseThreads(size_t count);
+
+    /**
+     * Stops the workers of every stage, makes reserveThreads() fail from now on and waits for all
+     * the worker threads to exit. Called once on shutdown, after all operations have been killed.
+     */
+    static void shutDownWorkers();
+
+    /**
+     * Creates a stage which runs 'shardPipeline' on up to 'numThreads' threads over the documents
+     * in 'ranges' of the collection 'nss' which match 'query', using 'collation'. Takes over
+     * 'numThreads' threads reserved with reserveThreads().
+     */
+    static boost::intrusive_ptr<DocumentSourceParallelCursor> create(
+        const NamespaceString& nss,
+        BSONObj query,
+        BSONObj collation,
+        std::vector<BSONObj> shardPipeline,
+        std::vector<Range> ranges,
+        size_t numThreads,
+        const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    ~DocumentSourceParallelCursor();
+
+    GetNextResult getNext() final;
+    const char* getSourceName() const final;
+    Value serialize(bool explain = false) const final;
+    bool isValidInitialSource() const final {
+        return true;
+    }
+    void dispose() final;
+
+private:
+    class Workers;
+
+    DocumentSourceParallelCursor(std::shared_ptr<Workers> workers,
+                                 const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    /**
+     * Starts the worker threads, which inherit the deadline of the current operation.
+     */
+    void startWorkers();
+
+    // Shared with the worker threads, which keep it alive until they exit.
+    const std::shared_ptr<Workers> _workers;
+    bool _started = false;
+};
+
+}  // namespace mongo
@@ -37,6 +37,7 @@
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
 
 namespace mongo {
 
@@ -238,6 +239,7 @@ SortOptions DocumentSourceSort::makeSortOptions() const {
     if (pExpCtx->extSortAllowed && !pExpCtx->inRouter) {
         opts.extSortAllowed = true;
         opts.tempDir = pExpCtx->tempDir;
+        opts.workerThreads = std::max(internalQueryExecSorterWorkerThreads.load(), 0);
     }
 
     return opts;
@@ -305,7 +307,9 @@ void DocumentSourceSort::populateFromCursors(const vector<DBClientCursor*>& curs
         iterators.push_back(std::make_shared<IteratorFromCursor>(this, cursors[i]));
     }
 
-    _output.reset(MySorter::Iterator::merge(iterators, makeSortOptions(), Comparator(*this)));
+    // The cursors may only be read from this thread, so they can't be merged in the background.
+    _output.reset(MySorter::Iterator::merge(
+        iterators, makeSortOptions().WorkerThreads(0), Comparator(*this)));
     _populated = true;
 }
 
@@ -0,0 +1,206 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/group_hash_table.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+const size_t kInitialNumSlots = 16;
+}  // namespace
+
+const uint32_t GroupHashTable::kEmptySlot;
+
+boost::optional<GroupHashTable::AccumulatorKind> GroupHashTable::parseKind(StringData opName) {
+    if (opName == "$sum") {
+        return AccumulatorKind::kSum;
+    } else if (opName == "$avg") {
+        return AccumulatorKind::kAvg;
+    } else if (opName == "$min") {
+        return AccumulatorKind::kMin;
+    } else if (opName == "$max") {
+        return AccumulatorKind::kMax;
+    }
+    return boost::none;
+}
+
+GroupHashTable::GroupHashTable(const ValueComparator& comparator,
+                               std::vector<AccumulatorKind> kinds)
+    : _comparator(comparator),
+      _slots(kInitialNumSlots, kEmptySlot),
+      _slotMask(kInitialNumSlots - 1),
+      _fixedBytesPerGroup(sizeof(Value) + sizeof(size_t) + 2 * sizeof(uint32_t)) {
+    _columns.resize(kinds.size());
+    for (size_t i = 0; i < kinds.size(); ++i) {
+        _columns[i].kind = kinds[i];
+        switch (kinds[i]) {
+            case AccumulatorKind::kSum:
+                _fixedBytesPerGroup += sizeof(AccumulatorSum::State);
+                break;
+            case AccumulatorKind::kAvg:
+                _fixedBytesPerGroup += sizeof(AccumulatorAvg::State);
+                break;
+            case AccumulatorKind::kMin:
+            case AccumulatorKind::kMax:
+                _fixedBytesPerGroup += sizeof(AccumulatorMinMax::State);
+                break;
+        }
+    }
+}
+
+size_t GroupHashTable::findOrInsert(Value id, size_t idHash, bool* inserted) {
+    size_t slot = idHash & _slotMask;
+    while (_slots[slot] != kEmptySlot) {
+        const size_t group = _slots[slot] - 1;
+        if (_hashes[group] == idHash && _comparator.evaluate(_ids[group] == id)) {
+            *inserted = false;
+            return group;
+        }
+        slot = (slot + 1) & _slotMask;
+    }
+
+    uassert(40702,
+            "$group produced too many groups",
+            _ids.size() < std::numeric_limits<uint32_t>::max() - 1);
+
+    const size_t group = _ids.size();
+    _slots[slot] = group + 1;
+    _memUsageBytes += _fixedBytesPerGroup + id.getApproximateSize() - sizeof(Value);
+    _ids.push_back(std::move(id));
+    _hashes.push_back(idHash);
+
+    for (auto&& column : _columns) {
+        switch (column.kind) {
+            case AccumulatorKind::kSum:
+                column.sums.emplace_back();
+                break;
+            case AccumulatorKind::kAvg:
+                column.avgs.emplace_back();
+                break;
+            case AccumulatorKind::kMin:
+            case AccumulatorKind::kMax:
+                column.extremes.emplace_back();
+                break;
+        }
+    }
+
+    if (2 * _ids.size() > _slots.size()) {
+        _grow();
+    }
+
+    *inserted = true;
+    return group;
+}
+
+void GroupHashTable::_grow() {
+    const size_t numSlots = 2 * _slots.size();
+    _memUsageBytes += (numSlots - _slots.size()) * sizeof(uint32_t);
+
+    _slots.assign(numSlots, kEmptySlot);
+    _slotMask = numSlots - 1;
+    for (size_t group = 0; group < _hashes.size(); ++group) {
+        size_t slot = _hashes[group] & _slotMask;
+        while (_slots[slot] != kEmptySlot) {
+            slot = (slot + 1) & _slotMask;
+        }
+        _slots[slot] = group + 1;
+    }
+}
+
+void GroupHashTable::process(size_t group, size_t accumulator, const Value& input, bool merging) {
+    Column& column = _columns[accumulator];
+    switch (column.kind) {
+        case AccumulatorKind::kSum:
+            column.sums[group].process(input, merging);
+            return;
+        case AccumulatorKind::kAvg:
+            column.avgs[group].process(input, merging);
+            return;
+        case AccumulatorKind::kMin:
+        case AccumulatorKind::kMax: {
+            auto& state = column.extremes[group];
+            const size_t oldSize = state.val.getApproximateSize();
+            const auto sense = column.kind == AccumulatorKind::kMin ? AccumulatorMinMax::MIN
+                                                                    : AccumulatorMinMax::MAX;
+            if (state.process(input, _comparator, sense)) {
+                _memUsageBytes += state.val.getApproximateSize();
+                _memUsageBytes -= oldSize;
+            }
+            return;
+        }
+    }
+    MONGO_UNREACHABLE;
+}
+
+Value GroupHashTable::getValue(size_t group, size_t accumulator, bool toBeMerged) const {
+    const Column& column = _columns[accumulator];
+    switch (column.kind) {
+        case AccumulatorKind::kSum:
+            return column.sums[group].getValue(toBeMerged);
+        case AccumulatorKind::kAvg:
+            return column.avgs[group].getValue(toBeMerged);
+        case AccumulatorKind::kMin:
+        case AccumulatorKind::kMax:
+            return column.extremes[group].getValue();
+    }
+    MONGO_UNREACHABLE;
+}
+
+std::vector<uint32_t> GroupHashTable::sortedGroups() const {
+    std::vector<uint32_t> groups(_ids.size());
+    for (size_t i = 0; i < groups.size(); ++i) {
+        groups[i] = i;
+    }
+
+    std::stable_sort(groups.begin(), groups.end(), [this](uint32_t lhs, uint32_t rhs) {
+        return _comparator.evaluate(_ids[lhs] < _ids[rhs]);
+    });
+    return groups;
+}
+
+void GroupHashTable::clear() {
+    std::vector<uint32_t>(kInitialNumSlots, kEmptySlot).swap(_slots);
+    _slotMask = kInitialNumSlots - 1;
+    std::vector<Value>().swap(_ids);
+    std::vector<size_t>().swap(_hashes);
+    for (auto&& column : _columns) {
+        std::vector<AccumulatorSum::State>().swap(column.sums);
+        std::vector<AccumulatorAvg::State>().swap(column.avgs);
+        std::vector<AccumulatorMinMax::State>().swap(column.extremes);
+    }
+    _memUsageBytes = 0;
+}
+
+}  // namespace mongo
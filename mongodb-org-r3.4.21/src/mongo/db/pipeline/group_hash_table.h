@@ -0,0 +1,159 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/pipeline/value_comparator.h"
+
+namespace mongo {
+
+/**
+ * The groups of a $group stage whose accumulators are all $sum, $avg, $min or $max.
+ *
+ * Rather than giving every group its own vector of heap-allocated Accumulators, the table keeps the
+ * group keys in one vector and the state of each accumulator in a column with one entry per group,
+ * so that accumulating into an existing group allocates nothing. Keys are found by open addressing
+ * with linear probing over a slot array holding indexes into the key vector.
+ *
+ * Groups are identified by their index, which is assigned in insertion order and stays valid until
+ * clear() is called.
+ */
+class GroupHashTable {
+public:
+    enum class AccumulatorKind { kSum, kAvg, kMin, kMax };
+
+    /**
+     * Returns the kind of accumulator named 'opName' (e.g. "$sum"), or boost::none if the table
+     * can't hold the state of that accumulator.
+     */
+    static boost::optional<AccumulatorKind> parseKind(StringData opName);
+
+    GroupHashTable(const ValueComparator& comparator, std::vector<AccumulatorKind> kinds);
+
+    /**
+     * Hashes 'id' consistently with the comparator's definition of equality.
+     */
+    size_t hash(const Value& id) const {
+        return _comparator.hash(id);
+    }
+
+    /**
+     * Returns the index of the group with key 'id', whose hash must be 'idHash', adding a group
+     * with blank accumulator state if there is none. Sets '*inserted' to whether a group was added.
+     */
+    size_t findOrInsert(Value id, size_t idHash, bool* inserted);
+
+    /**
+     * Adds 'input' to the state of the accumulator at position 'accumulator' of group 'group'.
+     */
+    void process(size_t group, size_t accumulator, const Value& input, bool merging);
+
+    /**
+     * Returns what Accumulator::getValue() would return for the accumulator at position
+     * 'accumulator' of group 'group'.
+     */
+    Value getValue(size_t group, size_t accumulator, bool toBeMerged) const;
+
+    const Value& getId(size_t group) const {
+        return _ids[group];
+    }
+
+    size_t size() const {
+        return _ids.size();
+    }
+
+    bool empty() const {
+        return _ids.empty();
+    }
+
+    size_t numAccumulators() const {
+        return _columns.size();
+    }
+
+    /**
+     * Returns the indexes of all groups, ordered by key.
+     */
+    std::vector<uint32_t> sortedGroups() const;
+
+    /**
+     * Returns the approximate number of bytes used by the keys and accumulator state, to be checked
+     * against the memory limit of the $group.
+     */
+    size_t getApproximateSize() const {
+        return _memUsageBytes;
+    }
+
+    /**
+     * Removes all groups, releasing their memory.
+     */
+    void clear();
+
+private:
+    struct Column {
+        AccumulatorKind kind;
+
+        // Only the vector matching 'kind' is used.
+        std::vector<AccumulatorSum::State> sums;
+        std::vector<AccumulatorAvg::State> avgs;
+        std::vector<AccumulatorMinMax::State> extremes;
+    };
+
+    static const uint32_t kEmptySlot = 0;
+
+    /**
+     * Doubles the number of slots and reinserts every group.
+     */
+    void _grow();
+
+    ValueComparator _comparator;
+
+    // Each slot is either kEmptySlot or one more than the index of a group. The number of slots is
+    // always a power of two and at least twice the number of groups.
+    std::vector<uint32_t> _slots;
+    size_t _slotMask;
+
+    // Indexed by group.
+    std::vector<Value> _ids;
+    std::vector<size_t> _hashes;
+
+    // Indexed by accumulator.
+    std::vector<Column> _columns;
+
+    // The bytes used by one group apart from the contents of its key and of any $min or $max value.
+    size_t _fixedBytesPerGroup;
+    size_t _memUsageBytes = 0;
+};
+
+}  // namespace mongo
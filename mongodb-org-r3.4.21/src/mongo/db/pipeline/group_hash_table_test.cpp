@@ -0,0 +1,181 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/group_hash_table.h"
+#include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using Kind = GroupHashTable::AccumulatorKind;
+
+size_t insert(GroupHashTable* table, Value id, bool* inserted) {
+    const size_t idHash = table->hash(id);
+    return table->findOrInsert(std::move(id), idHash, inserted);
+}
+
+size_t insert(GroupHashTable* table, Value id) {
+    bool inserted;
+    return insert(table, std::move(id), &inserted);
+}
+
+TEST(GroupHashTableTest, ParsesSupportedAccumulatorsOnly) {
+    ASSERT(GroupHashTable::parseKind("$sum") == Kind::kSum);
+    ASSERT(GroupHashTable::parseKind("$avg") == Kind::kAvg);
+    ASSERT(GroupHashTable::parseKind("$min") == Kind::kMin);
+    ASSERT(GroupHashTable::parseKind("$max") == Kind::kMax);
+    ASSERT_FALSE(GroupHashTable::parseKind("$push"));
+    ASSERT_FALSE(GroupHashTable::parseKind("$first"));
+}
+
+TEST(GroupHashTableTest, FindsExistingGroups) {
+    GroupHashTable table(ValueComparator(), {});
+
+    bool inserted;
+    ASSERT_EQ(0U, insert(&table, Value(1), &inserted));
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(1U, insert(&table, Value("a"_sd), &inserted));
+    ASSERT_TRUE(inserted);
+
+    // Numbers of different types compare equal, so they share a group.
+    ASSERT_EQ(0U, insert(&table, Value(1.0), &inserted));
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(1U, insert(&table, Value("a"_sd), &inserted));
+    ASSERT_FALSE(inserted);
+
+    ASSERT_EQ(2U, table.size());
+    ASSERT_VALUE_EQ(Value(1), table.getId(0));
+}
+
+TEST(GroupHashTableTest, KeepsGroupsWhenGrowing) {
+    GroupHashTable table(ValueComparator(), {Kind::kSum});
+
+    const int numGroups = 10000;
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < numGroups; ++i) {
+            const size_t group = insert(&table, Value(i));
+            ASSERT_EQ(static_cast<size_t>(i), group);
+            table.process(group, 0, Value(i), false);
+        }
+    }
+
+    ASSERT_EQ(static_cast<size_t>(numGroups), table.size());
+    for (int i = 0; i < numGroups; ++i) {
+        ASSERT_VALUE_EQ(Value(2 * i), table.getValue(i, 0, false));
+    }
+}
+
+TEST(GroupHashTableTest, AccumulatesLikeAccumulators) {
+    GroupHashTable table(ValueComparator(), {Kind::kSum, Kind::kAvg, Kind::kMin, Kind::kMax});
+
+    const size_t group = insert(&table, Value(BSONNULL));
+    for (auto&& input : {Value(3), Value(1), Value(BSONNULL), Value(8)}) {
+        for (size_t j = 0; j < table.numAccumulators(); ++j) {
+            table.process(group, j, input, false);
+        }
+    }
+
+    ASSERT_VALUE_EQ(Value(12), table.getValue(group, 0, false));
+    ASSERT_VALUE_EQ(Value(4.0), table.getValue(group, 1, false));
+    ASSERT_VALUE_EQ(Value(1), table.getValue(group, 2, false));
+    ASSERT_VALUE_EQ(Value(8), table.getValue(group, 3, false));
+
+    // Merging the partial results of another table gives the combined result.
+    GroupHashTable merger(ValueComparator(), {Kind::kSum, Kind::kAvg, Kind::kMin, Kind::kMax});
+    const size_t merged = insert(&merger, Value(BSONNULL));
+    for (size_t j = 0; j < table.numAccumulators(); ++j) {
+        merger.process(merged, j, table.getValue(group, j, true), true);
+        merger.process(merged, j, table.getValue(group, j, true), true);
+    }
+
+    ASSERT_VALUE_EQ(Value(24), merger.getValue(merged, 0, false));
+    ASSERT_VALUE_EQ(Value(4.0), merger.getValue(merged, 1, false));
+    ASSERT_VALUE_EQ(Value(1), merger.getValue(merged, 2, false));
+    ASSERT_VALUE_EQ(Value(8), merger.getValue(merged, 3, false));
+}
+
+TEST(GroupHashTableTest, MinAndMaxOfEmptyGroupAreNull) {
+    GroupHashTable table(ValueComparator(), {Kind::kMin, Kind::kMax});
+    const size_t group = insert(&table, Value(1));
+    ASSERT_VALUE_EQ(Value(BSONNULL), table.getValue(group, 0, false));
+    ASSERT_VALUE_EQ(Value(BSONNULL), table.getValue(group, 1, false));
+}
+
+TEST(GroupHashTableTest, UsesCollationForKeysAndMinMax) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kReverseString);
+    GroupHashTable table(ValueComparator(&collator), {Kind::kMin});
+
+    const size_t group = insert(&table, Value("xa"_sd));
+    bool inserted;
+    ASSERT_EQ(group, insert(&table, Value("xa"_sd), &inserted));
+    ASSERT_FALSE(inserted);
+
+    table.process(group, 0, Value("az"_sd), false);
+    table.process(group, 0, Value("za"_sd), false);
+    ASSERT_VALUE_EQ(Value("za"_sd), table.getValue(group, 0, false));
+}
+
+TEST(GroupHashTableTest, SortsGroupsById) {
+    GroupHashTable table(ValueComparator(), {});
+    for (auto&& id : {Value(3), Value("b"_sd), Value(1), Value("a"_sd), Value(2)}) {
+        insert(&table, id);
+    }
+
+    const std::vector<uint32_t> sorted = table.sortedGroups();
+    ASSERT_EQ(5U, sorted.size());
+    ASSERT_VALUE_EQ(Value(1), table.getId(sorted[0]));
+    ASSERT_VALUE_EQ(Value(2), table.getId(sorted[1]));
+    ASSERT_VALUE_EQ(Value(3), table.getId(sorted[2]));
+    ASSERT_VALUE_EQ(Value("a"_sd), table.getId(sorted[3]));
+    ASSERT_VALUE_EQ(Value("b"_sd), table.getId(sorted[4]));
+}
+
+TEST(GroupHashTableTest, TracksAndReleasesMemory) {
+    GroupHashTable table(ValueComparator(), {Kind::kMax});
+    ASSERT_EQ(0U, table.getApproximateSize());
+
+    const size_t group = insert(&table, Value(1));
+    const size_t sizeWithGroup = table.getApproximateSize();
+    ASSERT_GT(sizeWithGroup, 0U);
+
+    table.process(group, 0, Value(std::string(1000, 'x')), false);
+    ASSERT_GT(table.getApproximateSize(), sizeWithGroup + 1000);
+
+    table.clear();
+    ASSERT_TRUE(table.empty());
+    ASSERT_EQ(0U, table.getApproximateSize());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -120,6 +120,26 @@ public:
         _memoryUsage += static_cast<size_t>(value.objsize());
     }
 
+    /**
+     * Insert "values", which may be empty, as the vector of values with key "key", which must not
+     * already be present in the cache. The key is inserted in the middle of the cache, as by
+     * insert().
+     */
+    void insertAll(Value key, std::vector<BSONObj> values) {
+        size_t middle = size() / 2;
+        auto it = _container.begin();
+        std::advance(it, middle);
+
+        size_t memoryUsage = key.getApproximateSize();
+        for (auto&& value : values) {
+            memoryUsage += static_cast<size_t>(value.objsize());
+        }
+
+        auto result = _container.insert(it, {std::move(key), std::move(values)});
+        invariant(result.second);
+        _memoryUsage += memoryUsage;
+    }
+
     /**
      * Evict the least-recently-used item.
      */
@@ -70,6 +70,23 @@ TEST(LookupSetCacheTest, InsertAndRetrieveWorksCorrectly) {
     ASSERT_FALSE(vectorContains(cache[Value(0)], intToObj(5)));
 }
 
+TEST(LookupSetCacheTest, InsertAllDoesCacheEmptyAndNonEmptyVectors) {
+    LookupSetCache cache(defaultComparator);
+    cache.insertAll(Value(0), {});
+    cache.insertAll(Value(1), {intToObj(1), intToObj(2)});
+
+    ASSERT_EQ(2U, cache.size());
+    ASSERT(cache[Value(0)]);
+    ASSERT_TRUE(cache[Value(0)]->empty());
+    ASSERT_EQ(2U, cache[Value(1)]->size());
+    ASSERT_TRUE(vectorContains(cache[Value(1)], intToObj(1)));
+    ASSERT_TRUE(vectorContains(cache[Value(1)], intToObj(2)));
+    ASSERT_FALSE(cache[Value(2)]);
+
+    cache.evictDownTo(0);
+    ASSERT_EQ(0U, cache.size());
+}
+
 TEST(LookupSetCacheTest, CacheDoesEvictInExpectedOrder) {
     LookupSetCache cache(defaultComparator);
 
@@ -34,9 +34,12 @@
 
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/client/dbclientinterface.h"
+#include "mongo/db/background.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/document_validation.h"
+#include "mongo/db/catalog/index_create.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
@@ -49,10 +52,13 @@
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/op_observer.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_merge_cursors.h"
+#include "mongo/db/pipeline/document_source_parallel_cursor.h"
 #include "mongo/db/pipeline/document_source_sample.h"
 #include "mongo/db/pipeline/document_source_sample_from_random_cursor.h"
 #include "mongo/db/pipeline/document_source_sort.h"
@@ -60,7 +66,9 @@
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/sharded_connection_info.h"
 #include "mongo/db/s/sharding_state.h"
@@ -72,6 +80,7 @@
 #include "mongo/s/chunk_version.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -176,6 +185,97 @@ public:
                                           str::stream() << "renameCollection failed: " << info};
     }
 
+    Status buildIndexes(const NamespaceString& nss,
+                        const std::vector<BSONObj>& indexSpecs) final {
+        OperationContext* txn = _ctx->opCtx;
+        const auto notPrimaryStatus = [&] {
+            return Status(ErrorCodes::NotMaster,
+                          str::stream() << "Not primary while building indexes in " << nss.ns());
+        };
+
+        // Registering the build keeps the collection from being dropped or renamed while the
+        // database isn't locked exclusively.
+        BackgroundOperation backgroundOp(nss.ns());
+
+        ScopedTransaction transaction(txn, MODE_IX);
+        Lock::DBLock dbLock(txn->lockState(), nss.db(), MODE_X);
+        if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(nss)) {
+            return notPrimaryStatus();
+        }
+
+        Database* db = dbHolder().get(txn, nss.db());
+        Collection* collection = db ? db->getCollection(nss) : nullptr;
+        if (!collection) {
+            return {ErrorCodes::NamespaceNotFound,
+                    str::stream() << "collection " << nss.ns() << " dropped before index build"};
+        }
+
+        MultiIndexBlock indexer(txn, collection);
+        indexer.allowInterruption();
+
+        std::vector<BSONObj> specs(indexSpecs);
+        indexer.removeExistingIndexes(&specs);
+        if (specs.empty()) {
+            return Status::OK();
+        }
+
+        std::vector<BSONObj> indexInfoObjs;
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+            auto initStatus = indexer.init(specs);
+            if (!initStatus.isOK()) {
+                return initStatus.getStatus();
+            }
+            indexInfoObjs = std::move(initStatus.getValue());
+        }
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "$out index build", nss.ns());
+
+        // Only the collection is locked exclusively while its documents are indexed, so that the
+        // rest of the database stays available. The build is still a foreground one, and so goes
+        // through the sorted bulk builders.
+        txn->recoveryUnit()->abandonSnapshot();
+        dbLock.relockWithMode(MODE_IX);
+
+        // The database must be locked exclusively again before 'indexer' cleans up a failed build.
+        auto relockGuard = MakeGuard([&] {
+            txn->recoveryUnit()->abandonSnapshot();
+            dbLock.relockWithMode(MODE_X);
+        });
+
+        Status status = Status::OK();
+        if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(nss)) {
+            status = notPrimaryStatus();
+        } else {
+            Lock::CollectionLock collLock(txn->lockState(), nss.ns(), MODE_X);
+            status = indexer.insertAllDocumentsInCollection();
+        }
+
+        relockGuard.Dismiss();
+        txn->recoveryUnit()->abandonSnapshot();
+        dbLock.relockWithMode(MODE_X);
+        if (!status.isOK()) {
+            return status;
+        }
+        if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(nss)) {
+            return notPrimaryStatus();
+        }
+
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+            WriteUnitOfWork wunit(txn);
+
+            indexer.commit();
+
+            for (auto&& infoObj : indexInfoObjs) {
+                getGlobalServiceContext()->getOpObserver()->onCreateIndex(
+                    txn, nss.getSystemIndexesCollection(), infoObj, false);
+            }
+
+            wunit.commit();
+        }
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "$out index build", nss.ns());
+
+        return Status::OK();
+    }
+
     StatusWith<boost::intrusive_ptr<Pipeline>> makePipeline(
         const std::vector<BSONObj>& rawPipeline,
         const boost::intrusive_ptr<ExpressionContext>& expCtx) final {
@@ -419,10 +519,111 @@ void PipelineD::prepareCursorSource(Collection* collection,
                                                 &sortObj,
                                                 &projForQuery));
 
+    if (addParallelCursorSource(collection, pipeline, expCtx, *exec, queryObj)) {
+        return;
+    }
+
     addCursorSource(
         collection, pipeline, expCtx, std::move(exec), deps, queryObj, sortObj, projForQuery);
 }
 
+bool PipelineD::addParallelCursorSource(Collection* collection,
+                                        const intrusive_ptr<Pipeline>& pipeline,
+                                        const intrusive_ptr<ExpressionContext>& expCtx,
+                                        const PlanExecutor& exec,
+                                        const BSONObj& queryObj) {
+    // Each thread scans this many ranges on average, so that a thread which gets through sparse
+    // ranges quickly can take over some of the work of the others.
+    const int kRangesPerThread = 4;
+
+    OperationContext* txn = expCtx->opCtx;
+    const int numThreads = internalDocumentSourceParallelCursorThreads.load();
+
+    // The workers read at their own local snapshots, so they can't serve a stronger read concern.
+    if (txn->recoveryUnit()->isReadingFromMajorityCommittedSnapshot()) {
+        return false;
+    }
+
+    if (numThreads < 2 || !collection || collection->isCapped() || expCtx->isExplain ||
+        exec.getRootStage()->stageType() != STAGE_COLLSCAN ||
+        collection->numRecords(txn) < internalDocumentSourceParallelCursorMinRecords.load() ||
+        ShardingState::get(txn)->needCollectionMetadata(txn, expCtx->ns.ns())) {
+        return false;
+    }
+
+    // The threads may only run stages which look at one document at a time, followed by the
+    // shard half of a $group whose merging half puts their partial results back together.
+    bool splitsAtGroup = false;
+    for (auto&& source : pipeline->_sources) {
+        if (dynamic_cast<SplittableDocumentSource*>(source.get())) {
+            splitsAtGroup = dynamic_cast<DocumentSourceGroup*>(source.get());
+            break;
+        }
+
+        const StringData name = source->getSourceName();
+        if (name != "$match" && name != "$project" && name != "$addFields" && name != "$unwind") {
+            return false;
+        }
+    }
+    if (!splitsAtGroup) {
+        return false;
+    }
+
+    // Run on one thread rather than exceed the threads the whole process may run at once.
+    const size_t reservedThreads = DocumentSourceParallelCursor::reserveThreads(numThreads);
+    auto releaseThreadsGuard =
+        MakeGuard([&] { DocumentSourceParallelCursor::releaseThreads(reservedThreads); });
+    if (reservedThreads < 2) {
+        return false;
+    }
+
+    // Split the RecordIds between the first and last records evenly. The outermost ranges are
+    // left open, so that the scan sees what a single cursor would.
+    auto forwardCursor = collection->getCursor(txn, true);
+    if (!forwardCursor->setRange(RecordId(), RecordId())) {
+        return false;
+    }
+    auto first = forwardCursor->next();
+    auto last = collection->getCursor(txn, false)->next();
+    if (!first || !last || last->id <= first->id) {
+        return false;
+    }
+
+    const long long span = last->id.repr() - first->id.repr() + 1;
+    const long long numRanges =
+        std::min(span, static_cast<long long>(reservedThreads) * kRangesPerThread);
+    const long long step = span / numRanges;
+
+    std::vector<DocumentSourceParallelCursor::Range> ranges;
+    RecordId rangeStart;
+    for (long long i = 1; i < numRanges; ++i) {
+        RecordId rangeEnd(first->id.repr() + step * i);
+        ranges.emplace_back(rangeStart, rangeEnd);
+        rangeStart = rangeEnd;
+    }
+    ranges.emplace_back(rangeStart, RecordId());
+
+    std::vector<BSONObj> shardStages;
+    for (auto&& stage : pipeline->splitForSharded()->serialize()) {
+        shardStages.push_back(stage.getDocument().toBson());
+    }
+
+    // As in attemptToGetExecutor(), fill in the options of the collation the user omitted.
+    BSONObj collation =
+        expCtx->getCollator() ? expCtx->getCollator()->getSpec().toBSON() : expCtx->collation;
+
+    releaseThreadsGuard.Dismiss();
+    pipeline->addInitialSource(DocumentSourceParallelCursor::create(expCtx->ns,
+                                                                    queryObj,
+                                                                    collation,
+                                                                    std::move(shardStages),
+                                                                    std::move(ranges),
+                                                                    reservedThreads,
+                                                                    expCtx));
+    pipeline->optimizePipeline();
+    return true;
+}
+
 StatusWith<std::unique_ptr<PlanExecutor>> PipelineD::prepareExecutor(
     OperationContext* txn,
     Collection* collection,
@@ -104,6 +104,19 @@ private:
         BSONObj* sortObj,
         BSONObj* projectionObj);
 
+    /**
+     * If 'exec' would scan the whole of a large collection and the pipeline begins with stages
+     * which can run on several threads followed by a $group, splits the pipeline as for a sharded
+     * collection and adds a DocumentSourceParallelCursor running the shard half to the front of
+     * the merging half. Returns false, leaving the pipeline alone, if it can't, or if the
+     * operation reads from a majority committed snapshot, which the workers can't share.
+     */
+    static bool addParallelCursorSource(Collection* collection,
+                                        const boost::intrusive_ptr<Pipeline>& pipeline,
+                                        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                        const PlanExecutor& exec,
+                                        const BSONObj& queryObj);
+
     /**
      * Creates a DocumentSourceCursor from the given PlanExecutor and adds it to the front of the
      * Pipeline.
@@ -87,6 +87,11 @@ public:
         MONGO_UNREACHABLE;
     }
 
+    Status buildIndexes(const NamespaceString& nss,
+                        const std::vector<BSONObj>& indexSpecs) override {
+        MONGO_UNREACHABLE;
+    }
+
     StatusWith<boost::intrusive_ptr<Pipeline>> makePipeline(
         const std::vector<BSONObj>& rawPipeline,
         const boost::intrusive_ptr<ExpressionContext>& expCtx) override {
@@ -0,0 +1,182 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/db/query/interval.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+int compareValue(const BSONObj& value, const BSONElement& bound) {
+    return value.firstElement().woCompare(bound, false);
+}
+
+bool valueInInterval(const BSONObj& value, const Interval& interval) {
+    const int startCmp = compareValue(value, interval.start);
+    if (startCmp < 0 || (startCmp == 0 && !interval.startInclusive)) {
+        return false;
+    }
+    const int endCmp = compareValue(value, interval.end);
+    return endCmp < 0 || (endCmp == 0 && interval.endInclusive);
+}
+
+}  // namespace
+
+CardinalityEstimate& CardinalityEstimate::operator+=(const CardinalityEstimate& other) {
+    low += other.low;
+    expected += other.expected;
+    high += other.high;
+    return *this;
+}
+
+IndexStatistics::IndexStatistics(std::vector<BSONObj> values, double scale, size_t maxBuckets)
+    : _numSampled(values.size()), _scale(scale) {
+    invariant(maxBuckets > 0);
+    std::sort(values.begin(), values.end(), [](const BSONObj& lhs, const BSONObj& rhs) {
+        return lhs.firstElement().woCompare(rhs.firstElement(), false) < 0;
+    });
+
+    const double bucketSize = std::max(1.0, _numSampled / maxBuckets);
+    double numSampledDistinct = 0;
+    double numSeenOnce = 0;
+
+    // Each run of equal values either joins the range of the current bucket or becomes its upper
+    // bound. The first run always becomes the bound of the first bucket, so that the range of the
+    // first bucket is empty.
+    Bucket current;
+    size_t i = 0;
+    while (i < values.size()) {
+        size_t j = i + 1;
+        while (j < values.size() &&
+               values[j].firstElement().woCompare(values[i].firstElement(), false) == 0) {
+            ++j;
+        }
+        const double run = j - i;
+        ++numSampledDistinct;
+        if (run == 1) {
+            ++numSeenOnce;
+        }
+
+        if (_buckets.empty() || current.numRange + run >= bucketSize || j == values.size()) {
+            current.upper = values[i];
+            current.numEqual = run;
+            _buckets.push_back(std::move(current));
+            current = Bucket();
+        } else {
+            current.numRange += run;
+            current.numRangeDistinct++;
+            current.numRangeMostCommon = std::max(current.numRangeMostCommon, run);
+        }
+        i = j;
+    }
+
+    _numDistinct = std::min(numKeys(),
+                            std::sqrt(std::max(_scale, 1.0)) * numSeenOnce +
+                                (numSampledDistinct - numSeenOnce));
+    if (numSampledDistinct > 0) {
+        _distinctRatio = std::max(1.0, _numDistinct / numSampledDistinct);
+    }
+}
+
+CardinalityEstimate IndexStatistics::estimateKeys(const OrderedIntervalList& oil) const {
+    CardinalityEstimate sampled;
+    for (auto&& interval : oil.intervals) {
+        if (interval.getDirection() == Interval::Direction::kDirectionDescending) {
+            estimateInterval(interval.reverseClone(), &sampled);
+        } else {
+            estimateInterval(interval, &sampled);
+        }
+    }
+
+    // Widen the range by about two standard deviations of the sampling error. Even an interval
+    // with no sampled keys may hold a few keys per sampled document.
+    CardinalityEstimate estimate;
+    estimate.low = std::max(0.0, sampled.low - 2 * std::sqrt(sampled.low)) * _scale;
+    estimate.high = (sampled.high + 2 * std::sqrt(sampled.high + 1) + 1) * _scale;
+    estimate.expected =
+        std::min(estimate.high, std::max(estimate.low, sampled.expected * _scale));
+    return estimate;
+}
+
+void IndexStatistics::estimateInterval(const Interval& interval,
+                                       CardinalityEstimate* sampled) const {
+    if (interval.isEmpty()) {
+        return;
+    }
+
+    for (size_t i = 0; i < _buckets.size(); ++i) {
+        const Bucket& bucket = _buckets[i];
+        if (valueInInterval(bucket.upper, interval)) {
+            *sampled += CardinalityEstimate(bucket.numEqual, bucket.numEqual, bucket.numEqual);
+        }
+        if (bucket.numRange == 0) {
+            continue;
+        }
+
+        // The range of this bucket lies strictly between 'previous' and 'bucket.upper'.
+        const BSONObj& previous = _buckets[i - 1].upper;
+        if (compareValue(previous, interval.end) >= 0) {
+            break;
+        }
+        if (compareValue(bucket.upper, interval.start) <= 0) {
+            continue;
+        }
+
+        if (compareValue(previous, interval.start) >= 0 &&
+            compareValue(bucket.upper, interval.end) <= 0) {
+            *sampled += CardinalityEstimate(bucket.numRange, bucket.numRange, bucket.numRange);
+        } else if (interval.isPoint()) {
+            *sampled += CardinalityEstimate(
+                0,
+                bucket.numRange / (bucket.numRangeDistinct * _distinctRatio),
+                bucket.numRangeMostCommon);
+        } else {
+            *sampled += CardinalityEstimate(0, bucket.numRange / 2, bucket.numRange);
+        }
+    }
+}
+
+void CollectionStatistics::addIndex(const std::string& indexName, IndexStatistics stats) {
+    _indexes.emplace(indexName, std::move(stats));
+}
+
+const IndexStatistics* CollectionStatistics::getIndex(StringData indexName) const {
+    auto it = _indexes.find(indexName.toString());
+    return it == _indexes.end() ? nullptr : &it->second;
+}
+
+}  // namespace mongo
@@ -0,0 +1,166 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+struct Interval;
+struct OrderedIntervalList;
+
+/**
+ * A range of estimated counts. 'low' and 'high' bound the count we believe to be likely, and
+ * 'expected' is the best single guess.
+ */
+struct CardinalityEstimate {
+    CardinalityEstimate() = default;
+    CardinalityEstimate(double l, double e, double h) : low(l), expected(e), high(h) {}
+
+    CardinalityEstimate& operator+=(const CardinalityEstimate& other);
+
+    double low = 0;
+    double expected = 0;
+    double high = 0;
+};
+
+/**
+ * Statistics about the leading field of one btree index's keys, computed from the keys of a
+ * sample of the collection's documents: an equi-depth histogram and an estimate of the number of
+ * distinct values.
+ */
+class IndexStatistics {
+public:
+    /**
+     * A histogram bucket covers the values after the previous bucket's upper bound up to and
+     * including 'upper'. Counts are of sampled keys.
+     */
+    struct Bucket {
+        // A single field object holding the upper bound.
+        BSONObj upper;
+
+        // Keys equal to 'upper'.
+        double numEqual = 0;
+
+        // Keys strictly between the previous bucket's bound and 'upper', how many different values
+        // they have and the number of keys of the most common of those values.
+        double numRange = 0;
+        double numRangeDistinct = 0;
+        double numRangeMostCommon = 0;
+    };
+
+    /**
+     * Builds the statistics from 'values', the leading fields of the keys generated for a sample
+     * of documents, each as a single field object. 'scale' is the ratio of the collection's
+     * documents to the sampled documents. Uses at most 'maxBuckets' histogram buckets.
+     */
+    IndexStatistics(std::vector<BSONObj> values, double scale, size_t maxBuckets);
+
+    /**
+     * Estimates how many keys of the index have a leading field within 'oil', which may be in
+     * either direction.
+     */
+    CardinalityEstimate estimateKeys(const OrderedIntervalList& oil) const;
+
+    /**
+     * Estimated number of keys in the index.
+     */
+    double numKeys() const {
+        return _numSampled * _scale;
+    }
+
+    /**
+     * Estimated number of distinct leading field values in the index.
+     */
+    double numDistinct() const {
+        return _numDistinct;
+    }
+
+    const std::vector<Bucket>& getBuckets() const {
+        return _buckets;
+    }
+
+private:
+    /**
+     * Adds the sampled keys which fall in 'interval', whose start is not after its end.
+     */
+    void estimateInterval(const Interval& interval, CardinalityEstimate* sampled) const;
+
+    std::vector<Bucket> _buckets;
+
+    double _numSampled;
+    double _scale;
+
+    // Estimated from the sample by the guaranteed-error estimator: values seen once are scaled
+    // up by the square root of 'scale', values seen more often are counted once.
+    double _numDistinct = 0;
+
+    // Ratio of the estimated distinct values to the distinct values in the sample.
+    double _distinctRatio = 1;
+};
+
+/**
+ * Sampled statistics about a collection and its btree indexes, used to estimate the cost of
+ * candidate plans without running them. Immutable once built, so it can be shared between
+ * concurrent queries.
+ */
+class CollectionStatistics {
+public:
+    CollectionStatistics(long long numRecords, Date_t createdAt)
+        : _numRecords(numRecords), _createdAt(createdAt) {}
+
+    void addIndex(const std::string& indexName, IndexStatistics stats);
+
+    /**
+     * Returns the statistics of the index named 'indexName', or nullptr if it has none.
+     */
+    const IndexStatistics* getIndex(StringData indexName) const;
+
+    long long numRecords() const {
+        return _numRecords;
+    }
+
+    Date_t createdAt() const {
+        return _createdAt;
+    }
+
+private:
+    long long _numRecords;
+    Date_t _createdAt;
+
+    std::map<std::string, IndexStatistics> _indexes;
+};
+
+}  // namespace mongo
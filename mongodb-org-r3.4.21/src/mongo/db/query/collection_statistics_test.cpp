@@ -0,0 +1,142 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+OrderedIntervalList makeRange(int start, int end) {
+    OrderedIntervalList oil("a");
+    oil.intervals.push_back(IndexBoundsBuilder::makeRangeInterval(
+        BSON("" << start << "" << end), BoundInclusion::kIncludeBothStartAndEndKeys));
+    return oil;
+}
+
+OrderedIntervalList makePoint(int value) {
+    OrderedIntervalList oil("a");
+    oil.intervals.push_back(IndexBoundsBuilder::makePointInterval(BSON("" << value)));
+    return oil;
+}
+
+std::vector<BSONObj> makeValues(int count, int repeat) {
+    std::vector<BSONObj> values;
+    for (int i = count - 1; i >= 0; --i) {
+        for (int j = 0; j < repeat; ++j) {
+            values.push_back(BSON("" << i));
+        }
+    }
+    return values;
+}
+
+void assertWithin(const CardinalityEstimate& estimate, double actual) {
+    ASSERT_LESS_THAN_OR_EQUALS(estimate.low, actual);
+    ASSERT_LESS_THAN_OR_EQUALS(estimate.low, estimate.expected);
+    ASSERT_LESS_THAN_OR_EQUALS(estimate.expected, estimate.high);
+    ASSERT_GREATER_THAN_OR_EQUALS(estimate.high, actual);
+}
+
+TEST(IndexStatisticsTest, BuildsEquiDepthHistogram) {
+    IndexStatistics stats(makeValues(1000, 1), 1, 10);
+    ASSERT_EQUALS(stats.numKeys(), 1000);
+    ASSERT_EQUALS(stats.numDistinct(), 1000);
+    ASSERT_LESS_THAN_OR_EQUALS(stats.getBuckets().size(), 11U);
+
+    // The first bucket holds only the smallest value.
+    ASSERT_EQUALS(stats.getBuckets()[0].upper.firstElement().numberInt(), 0);
+    ASSERT_EQUALS(stats.getBuckets()[0].numRange, 0);
+
+    double total = 0;
+    for (auto&& bucket : stats.getBuckets()) {
+        total += bucket.numEqual + bucket.numRange;
+    }
+    ASSERT_EQUALS(total, 1000);
+}
+
+TEST(IndexStatisticsTest, EstimatesRanges) {
+    IndexStatistics stats(makeValues(1000, 1), 1, 10);
+    assertWithin(stats.estimateKeys(makeRange(100, 199)), 100);
+    assertWithin(stats.estimateKeys(makeRange(0, 999)), 1000);
+    assertWithin(stats.estimateKeys(makeRange(5000, 6000)), 0);
+
+    // A descending interval covers the same keys.
+    auto oil = makeRange(100, 199);
+    oil.intervals[0].reverse();
+    auto estimate = stats.estimateKeys(oil);
+    auto ascending = stats.estimateKeys(makeRange(100, 199));
+    ASSERT_EQUALS(estimate.low, ascending.low);
+    ASSERT_EQUALS(estimate.expected, ascending.expected);
+    ASSERT_EQUALS(estimate.high, ascending.high);
+}
+
+TEST(IndexStatisticsTest, EstimatesPointsOnSkewedValues) {
+    std::vector<BSONObj> values = makeValues(500, 1);
+    for (int i = 0; i < 500; ++i) {
+        values.push_back(BSON("" << 7));
+    }
+    IndexStatistics stats(std::move(values), 1, 10);
+
+    auto common = stats.estimateKeys(makePoint(7));
+    assertWithin(common, 501);
+    ASSERT_GREATER_THAN(common.low, 400);
+
+    auto rare = stats.estimateKeys(makePoint(300));
+    assertWithin(rare, 1);
+    ASSERT_LESS_THAN(rare.high, 10);
+}
+
+TEST(IndexStatisticsTest, ScalesSampleToCollection) {
+    // Every value was sampled once from a collection four times the size of the sample.
+    IndexStatistics stats(makeValues(100, 1), 4, 10);
+    ASSERT_EQUALS(stats.numKeys(), 400);
+    ASSERT_EQUALS(stats.numDistinct(), 200);
+    assertWithin(stats.estimateKeys(makeRange(0, 99)), 400);
+
+    // Values sampled many times are unlikely to have more distinct values than were seen.
+    IndexStatistics repeated(makeValues(10, 10), 4, 10);
+    ASSERT_EQUALS(repeated.numKeys(), 400);
+    ASSERT_EQUALS(repeated.numDistinct(), 10);
+}
+
+TEST(CollectionStatisticsTest, GetIndex) {
+    CollectionStatistics stats(1000, Date_t());
+    stats.addIndex("a_1", IndexStatistics(makeValues(10, 1), 1, 10));
+    ASSERT_EQUALS(stats.numRecords(), 1000);
+    ASSERT(stats.getIndex("a_1"));
+    ASSERT_EQUALS(stats.getIndex("a_1")->numKeys(), 10);
+    ASSERT_FALSE(stats.getIndex("b_1"));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -60,10 +60,12 @@
 #include "mongo/db/ops/update_lifecycle.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
+#include "mongo/db/query/collection_statistics.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_cost_estimator.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
@@ -348,14 +350,17 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
 
             // Add a CachedPlanStage on top of the previous root.
             //
-            // 'decisionWorks' is used to determine whether the existing cache entry should
-            // be evicted, and the query replanned.
+            // 'maxWorksBeforeReplan' and 'needsReevaluation' determine whether the existing cache
+            // entry should be evicted, and the query replanned.
             root = make_unique<CachedPlanStage>(opCtx,
                                                 collection,
                                                 ws,
                                                 canonicalQuery.get(),
                                                 plannerParams,
                                                 cs->decisionWorks,
+                                                cs->maxWorksBeforeReplan,
+                                                cs->needsReevaluation,
+                                                cs->executionSampleRate,
                                                 rawRoot);
             querySolution.reset(qs);
             return PrepareExecutionResult(
@@ -416,6 +421,36 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
         }
     }
 
+    // Given collection statistics, a plan whose estimated cost is clearly below that of every
+    // other candidate is run without racing them. Like a single plan, it is not cached.
+    if (solutions.size() > 1 && internalQueryPlannerUseCollectionStatistics.load()) {
+        auto stats = collection->infoCache()->getStatistics(opCtx);
+        boost::optional<size_t> choice;
+        if (stats) {
+            choice = PlanCostEstimator::chooseSolution(*canonicalQuery, solutions, *stats);
+        }
+        if (choice) {
+            for (size_t j = 0; j < solutions.size(); ++j) {
+                if (j != *choice) {
+                    delete solutions[j];
+                }
+            }
+
+            PlanStage* rawRoot;
+            verify(StageBuilder::build(
+                opCtx, collection, *canonicalQuery, *solutions[*choice], ws, &rawRoot));
+            root.reset(rawRoot);
+
+            LOG(2) << "Chose plan by estimated cost; it will be run but will not be cached. "
+                   << redact(canonicalQuery->toStringShort())
+                   << ", planSummary: " << Explain::getPlanSummary(root.get());
+
+            querySolution.reset(solutions[*choice]);
+            return PrepareExecutionResult(
+                std::move(canonicalQuery), std::move(querySolution), std::move(root));
+        }
+    }
+
     if (1 == solutions.size()) {
         // Only one possible plan.  Run it.  Build the stages from the solution.
         PlanStage* rawRoot;
@@ -624,8 +659,12 @@ StatusWith<unique_ptr<PlanExecutor>> getExecutorFind(OperationContext* txn,
     if (ShardingState::get(txn)->needCollectionMetadata(txn, nss.ns())) {
         options |= QueryPlannerParams::INCLUDE_SHARD_FILTER;
     }
-    return getExecutor(
+    auto exec = getExecutor(
         txn, collection, std::move(canonicalQuery), PlanExecutor::YIELD_AUTO, options);
+    if (exec.isOK()) {
+        exec.getValue()->setWorkBatchSize(std::max(internalQueryExecWorkBatchSize.load(), 0));
+    }
+    return exec;
 }
 
 namespace {
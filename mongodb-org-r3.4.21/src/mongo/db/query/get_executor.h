@@ -82,7 +82,8 @@ StatusWith<std::unique_ptr<PlanExecutor>> getExecutor(
  * Get a plan executor for a .find() operation.
  *
  * If the query is valid and an executor could be created, returns a StatusWith with the
- * PlanExecutor.
+ * PlanExecutor. It works its plan in batches of internalQueryExecWorkBatchSize, so callers must
+ * ask getNext() for objects and not RecordIds.
  *
  * If the query cannot be executed, returns a Status indicating why.
  */
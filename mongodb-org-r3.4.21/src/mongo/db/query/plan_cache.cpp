@@ -40,10 +40,13 @@
 #include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_solution.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <math.h>
 #include <memory>
 
@@ -246,8 +249,107 @@ void encodeGeoNearMatchExpression(const GeoNearMatchExpression* tree, StringBuil
     }
 }
 
+// Weight of the latest run in the moving statistics of a cache entry.
+const double kMovingStatsWeight = 0.1;
+
+// Runs of a cached plan needed before its moving statistics are trusted.
+const size_t kMinRunsForMovingStats = 10;
+
+// A run costs much more than usual when its works exceed the moving mean by this many standard
+// deviations, by this factor and by this many works.
+const double kDriftStdDevs = 4;
+const double kDriftRatio = 2;
+const double kMinDriftWorks = 1000;
+
+// Planning decisions kept per query shape.
+const size_t kMaxDecisionHistory = 20;
+
+bool isCostDrift(const PlanCacheMovingStats& stats, double value) {
+    return stats.count() >= kMinRunsForMovingStats && value >= kMinDriftWorks &&
+        value > kDriftRatio * stats.mean() &&
+        value > stats.mean() + kDriftStdDevs * stats.stdDev();
+}
+
+size_t computeMaxWorksBeforeReplan(const PlanCacheEntry& entry, size_t decisionWorks) {
+    const size_t ratioWorks =
+        static_cast<size_t>(internalQueryCacheEvictionRatio * decisionWorks);
+    if (!internalQueryCacheAdaptiveReplanning.load() ||
+        entry.trialWorks.count() < kMinRunsForMovingStats) {
+        return ratioWorks;
+    }
+
+    // Replan once a trial is an outlier among the recent trials, but never later than the fixed
+    // ratio would.
+    const double adaptiveWorks =
+        std::max(kDriftRatio * std::max<double>(decisionWorks, entry.trialWorks.mean()),
+                 entry.trialWorks.mean() + kDriftStdDevs * entry.trialWorks.stdDev());
+    return std::min(ratioWorks, static_cast<size_t>(adaptiveWorks));
+}
+
+size_t computeExecutionSampleRate(const PlanCacheEntry& entry) {
+    if (entry.works.count() < kMinRunsForMovingStats) {
+        return 1;
+    }
+    return std::max(internalQueryCacheExecutionSampleRate.load(), 1);
+}
+
+void appendDecision(PlanCacheEntry* entry, PlanCacheDecision decision) {
+    entry->history.push_back(std::move(decision));
+    if (entry->history.size() > kMaxDecisionHistory) {
+        entry->history.pop_front();
+    }
+}
+
+/**
+ * Adds the index keys and documents examined by the stages of the tree rooted at 'stats'.
+ */
+void addExamined(const PlanStageStats& stats, double* keysExamined, double* docsExamined) {
+    switch (stats.stageType) {
+        case STAGE_IXSCAN:
+            *keysExamined += static_cast<const IndexScanStats*>(stats.specific.get())->keysExamined;
+            break;
+        case STAGE_FETCH:
+            *docsExamined += static_cast<const FetchStats*>(stats.specific.get())->docsExamined;
+            break;
+        case STAGE_COLLSCAN:
+            *docsExamined +=
+                static_cast<const CollectionScanStats*>(stats.specific.get())->docsTested;
+            break;
+        default:
+            break;
+    }
+    for (auto&& child : stats.children) {
+        addExamined(*child, keysExamined, docsExamined);
+    }
+}
+
 }  // namespace
 
+//
+// PlanCacheMovingStats
+//
+
+void PlanCacheMovingStats::add(double value) {
+    if (_count++ == 0) {
+        _mean = value;
+        return;
+    }
+    const double diff = value - _mean;
+    const double increment = kMovingStatsWeight * diff;
+    _mean += increment;
+    _variance = (1 - kMovingStatsWeight) * (_variance + diff * increment);
+}
+
+double PlanCacheMovingStats::stdDev() const {
+    return std::sqrt(_variance);
+}
+
+void PlanCacheMovingStats::appendToBSON(BSONObjBuilder* builder) const {
+    builder->appendNumber("count", static_cast<long long>(_count));
+    builder->append("mean", _mean);
+    builder->append("stdDev", stdDev());
+}
+
 //
 // Cache-related functions for CanonicalQuery
 //
@@ -313,7 +415,10 @@ CachedSolution::CachedSolution(const PlanCacheKey& key, const PlanCacheEntry& en
       sort(entry.sort.getOwned()),
       projection(entry.projection.getOwned()),
       collation(entry.collation.getOwned()),
-      decisionWorks(entry.decision->stats[0]->common.works) {
+      decisionWorks(entry.decision->stats[0]->common.works),
+      maxWorksBeforeReplan(computeMaxWorksBeforeReplan(entry, decisionWorks)),
+      needsReevaluation(entry.needsReevaluation),
+      executionSampleRate(computeExecutionSampleRate(entry)) {
     // CachedSolution should not having any references into
     // cache entry. All relevant data should be cloned/copied.
     for (size_t i = 0; i < entry.plannerData.size(); ++i) {
@@ -382,6 +487,13 @@ PlanCacheEntry* PlanCacheEntry::clone() const {
         fb->score = feedback[i]->score;
         entry->feedback.push_back(fb);
     }
+    entry->trialWorks = trialWorks;
+    entry->works = works;
+    entry->keysExamined = keysExamined;
+    entry->docsExamined = docsExamined;
+    entry->executionTimeMillis = executionTimeMillis;
+    entry->needsReevaluation = needsReevaluation;
+    entry->history = history;
     return entry;
 }
 
@@ -481,12 +593,36 @@ std::string SolutionCacheData::toString() const {
 // PlanCache
 //
 
-PlanCache::PlanCache() : _cache(internalQueryCacheSize) {}
+PlanCache::PlanCache() {
+    initPartitions();
+}
 
-PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize), _ns(ns) {}
+PlanCache::PlanCache(const std::string& ns) : _ns(ns) {
+    initPartitions();
+}
 
 PlanCache::~PlanCache() {}
 
+void PlanCache::initPartitions() {
+    // Entries are evicted per partition, so a partition must be large enough that a few query
+    // shapes hashing to it do not evict each other while the cache as a whole has plenty of room.
+    // Caches too small to give every partition kMinPartitionSize entries use fewer partitions.
+    const size_t cacheSize = std::max(internalQueryCacheSize.load(), 1);
+    const size_t numPartitions =
+        std::min(static_cast<size_t>(std::max(internalQueryCachePartitions.load(), 1)),
+                 std::max(cacheSize / kMinPartitionSize, size_t(1)));
+    const size_t partitionSize = (cacheSize + numPartitions - 1) / numPartitions;
+
+    _partitions.reserve(numPartitions);
+    for (size_t i = 0; i < numPartitions; ++i) {
+        _partitions.push_back(stdx::make_unique<Partition>(partitionSize));
+    }
+}
+
+PlanCache::Partition& PlanCache::getPartition(const PlanCacheKey& key) const {
+    return *_partitions[std::hash<PlanCacheKey>()(key) % _partitions.size()];
+}
+
 /**
  * Traverses expression tree pre-order.
  * Appends an encoding of each node's match type and path name
@@ -667,8 +803,20 @@ Status PlanCache::add(const CanonicalQuery& query,
     }
     entry->projection = projBuilder.obj();
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(computeKey(query), entry);
+    PlanCacheKey key = computeKey(query);
+    Partition& partition = getPartition(key);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+
+    // A replanned entry keeps the history of the entry it replaces.
+    PlanCacheEntry* oldEntry;
+    if (partition.cache.get(key, &oldEntry).isOK()) {
+        entry->history = std::move(oldEntry->history);
+    }
+    const double decisionWorks = entry->decision->stats[0]->common.works;
+    appendDecision(entry, {Date_t::now(), "cached", decisionWorks});
+
+    std::unique_ptr<PlanCacheEntry> evictedEntry = partition.cache.add(key, entry);
 
     if (NULL != evictedEntry.get()) {
         LOG(1) << _ns << ": plan cache maximum size exceeded - "
@@ -682,9 +830,11 @@ Status PlanCache::get(const CanonicalQuery& query, CachedSolution** crOut) const
     PlanCacheKey key = computeKey(query);
     verify(crOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Partition& partition = getPartition(key);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    Status cacheStatus = partition.cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -702,14 +852,20 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     std::unique_ptr<PlanCacheEntryFeedback> autoFeedback(feedback);
     PlanCacheKey ck = computeKey(cq);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Partition& partition = getPartition(ck);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(ck, &entry);
+    Status cacheStatus = partition.cache.get(ck, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
     invariant(entry);
 
+    if (!autoFeedback->stats->children.empty()) {
+        entry->trialWorks.add(autoFeedback->stats->children[0]->common.works);
+    }
+
     // We store up to a constant number of feedback entries.
     if (entry->feedback.size() < size_t(internalQueryCacheFeedbacksStored)) {
         entry->feedback.push_back(autoFeedback.release());
@@ -718,14 +874,84 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     return Status::OK();
 }
 
+Status PlanCache::recordExecution(const CanonicalQuery& cq, const PlanStageStats& stats) {
+    double keysExamined = 0;
+    double docsExamined = 0;
+    addExamined(stats, &keysExamined, &docsExamined);
+    const double works = stats.common.works;
+
+    PlanCacheKey key = computeKey(cq);
+    Partition& partition = getPartition(key);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+    PlanCacheEntry* entry;
+    Status cacheStatus = partition.cache.get(key, &entry);
+    if (!cacheStatus.isOK()) {
+        return cacheStatus;
+    }
+    invariant(entry);
+
+    if (internalQueryCacheAdaptiveReplanning.load() && !entry->needsReevaluation &&
+        isCostDrift(entry->works, works)) {
+        LOG(1) << _ns << ": run of cached plan took " << works << " works, against a mean of "
+               << entry->works.mean() << "; racing the candidate plans again on the next run of "
+               << redact(cq.toStringShort());
+        entry->needsReevaluation = true;
+        appendDecision(entry, {Date_t::now(), "executionCostDrift", works});
+    }
+
+    entry->works.add(works);
+    entry->keysExamined.add(keysExamined);
+    entry->docsExamined.add(docsExamined);
+    entry->executionTimeMillis.add(stats.common.executionTimeMillis);
+    return Status::OK();
+}
+
+Status PlanCache::clearNeedsReevaluation(const CanonicalQuery& cq) {
+    PlanCacheKey key = computeKey(cq);
+    Partition& partition = getPartition(key);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+    PlanCacheEntry* entry;
+    Status cacheStatus = partition.cache.get(key, &entry);
+    if (!cacheStatus.isOK()) {
+        return cacheStatus;
+    }
+    invariant(entry);
+
+    entry->needsReevaluation = false;
+    return Status::OK();
+}
+
+Status PlanCache::recordDecision(const CanonicalQuery& cq, PlanCacheDecision decision) {
+    PlanCacheKey key = computeKey(cq);
+    Partition& partition = getPartition(key);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+    PlanCacheEntry* entry;
+    Status cacheStatus = partition.cache.get(key, &entry);
+    if (!cacheStatus.isOK()) {
+        return cacheStatus;
+    }
+    invariant(entry);
+
+    appendDecision(entry, std::move(decision));
+    return Status::OK();
+}
+
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.remove(computeKey(canonicalQuery));
+    PlanCacheKey key = computeKey(canonicalQuery);
+    Partition& partition = getPartition(key);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+    return partition.cache.remove(key);
 }
 
 void PlanCache::clear() {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    _cache.clear();
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> cacheLock(partition->mutex);
+        partition->cache.clear();
+    }
     _writeOperations.store(0);
 }
 
@@ -741,9 +967,11 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
     PlanCacheKey key = computeKey(query);
     verify(entryOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Partition& partition = getPartition(key);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    Status cacheStatus = partition.cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -755,25 +983,34 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
 }
 
 std::vector<PlanCacheEntry*> PlanCache::getAllEntries() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     std::vector<PlanCacheEntry*> entries;
     typedef std::list<std::pair<PlanCacheKey, PlanCacheEntry*>>::const_iterator ConstIterator;
-    for (ConstIterator i = _cache.begin(); i != _cache.end(); i++) {
-        PlanCacheEntry* entry = i->second;
-        entries.push_back(entry->clone());
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> cacheLock(partition->mutex);
+        for (ConstIterator i = partition->cache.begin(); i != partition->cache.end(); i++) {
+            PlanCacheEntry* entry = i->second;
+            entries.push_back(entry->clone());
+        }
     }
 
     return entries;
 }
 
 bool PlanCache::contains(const CanonicalQuery& cq) const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.hasKey(computeKey(cq));
+    PlanCacheKey key = computeKey(cq);
+    Partition& partition = getPartition(key);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+    return partition.cache.hasKey(key);
 }
 
 size_t PlanCache::size() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.size();
+    size_t total = 0;
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> cacheLock(partition->mutex);
+        total += partition->cache.size();
+    }
+    return total;
 }
 
 void PlanCache::notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries) {
@@ -29,7 +29,9 @@
 #pragma once
 
 #include <boost/optional/optional.hpp>
+#include <deque>
 #include <set>
+#include <vector>
 
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/canonical_query.h"
@@ -39,6 +41,7 @@
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -62,6 +65,48 @@ struct PlanCacheEntryFeedback {
     double score;
 };
 
+/**
+ * Exponentially weighted moving mean and variance of a quantity measured on each run of a cached
+ * plan, so that recent runs weigh the most.
+ */
+class PlanCacheMovingStats {
+public:
+    void add(double value);
+
+    size_t count() const {
+        return _count;
+    }
+
+    double mean() const {
+        return _mean;
+    }
+
+    double stdDev() const;
+
+    void appendToBSON(BSONObjBuilder* builder) const;
+
+private:
+    size_t _count = 0;
+    double _mean = 0;
+    double _variance = 0;
+};
+
+/**
+ * A planning decision taken for a query shape, shown by planCacheListPlans.
+ */
+struct PlanCacheDecision {
+    PlanCacheDecision(Date_t d, std::string r, double w)
+        : date(d), reason(std::move(r)), works(w) {}
+
+    Date_t date;
+
+    // One of "cached", "executionCostDrift", "reevaluated" or "trialExceededWorks".
+    std::string reason;
+
+    // The works of the run which led to the decision.
+    double works;
+};
+
 // TODO: Replace with opaque type.
 typedef std::string PlanID;
 
@@ -206,6 +251,17 @@ public:
     // The number of work cycles taken to decide on a winning plan when the plan was first
     // cached.
     size_t decisionWorks;
+
+    // The CachedPlanStage replans if its trial period takes this many works.
+    size_t maxWorksBeforeReplan;
+
+    // Whether a recent run cost so much more than usual that the candidate plans should be raced
+    // again rather than running the cached plan.
+    bool needsReevaluation;
+
+    // The CachedPlanStage records one in this many complete runs with recordExecution(). Every run
+    // is recorded until the entry has enough of them for adaptive replanning.
+    size_t executionSampleRate;
 };
 
 /**
@@ -264,6 +320,23 @@ public:
     // Annotations from cached runs.  The CachedPlanStage provides these stats about its
     // runs when they complete.
     std::vector<PlanCacheEntryFeedback*> feedback;
+
+    // Works of the cached plan's trial periods.
+    PlanCacheMovingStats trialWorks;
+
+    // Costs of complete runs of the cached plan.
+    PlanCacheMovingStats works;
+    PlanCacheMovingStats keysExamined;
+    PlanCacheMovingStats docsExamined;
+    PlanCacheMovingStats executionTimeMillis;
+
+    // Set when a complete run cost much more than the runs before it. Handed to every lookup until
+    // the CachedPlanStage which races the candidate plans again clears it.
+    bool needsReevaluation = false;
+
+    // The latest planning decisions for this query shape, oldest first. Carried over to the entry
+    // which replaces this one.
+    std::deque<PlanCacheDecision> history;
 };
 
 /**
@@ -315,7 +388,7 @@ public:
      * If there is no entry in the cache for the 'query', returns an error Status.
      *
      * If there is an entry in the cache, populates 'crOut' and returns Status::OK().  Caller
-     * owns '*crOut'.
+     * owns '*crOut'. An entry's need for reevaluation is handed to only one caller.
      */
     Status get(const CanonicalQuery& query, CachedSolution** crOut) const;
 
@@ -334,6 +407,27 @@ public:
      */
     Status feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* feedback);
 
+    /**
+     * Records the stats of a complete run of the cached plan for 'cq', where 'stats' are those
+     * of the cached plan's root stage. If the run cost much more than the recent runs, marks the
+     * entry so that the next run races the candidate plans again.
+     *
+     * Returns an error Status if the entry isn't in the cache anymore.
+     */
+    Status recordExecution(const CanonicalQuery& cq, const PlanStageStats& stats);
+
+    /**
+     * Clears the flag set by recordExecution() on the entry for 'cq', once the candidate plans are
+     * being raced again. Returns an error Status if the entry isn't in the cache anymore.
+     */
+    Status clearNeedsReevaluation(const CanonicalQuery& cq);
+
+    /**
+     * Appends 'decision' to the history of the entry for 'cq'. Returns an error Status if the
+     * entry isn't in the cache anymore.
+     */
+    Status recordDecision(const CanonicalQuery& cq, PlanCacheDecision decision);
+
     /**
      * Remove the entry corresponding to 'ck' from the cache.  Returns Status::OK() if the plan
      * was present and removed and an error status otherwise.
@@ -368,7 +462,7 @@ public:
     Status getEntry(const CanonicalQuery& cq, PlanCacheEntry** entryOut) const;
 
     /**
-     * Returns a vector of all cache entries.
+     * Returns a vector of all cache entries, grouped by partition.
      * Caller owns the result vector and is responsible for cleaning up
      * the cache entry copies.
      * Used by planCacheListQueryShapes and index_filter_commands_test.cpp.
@@ -377,7 +471,7 @@ public:
 
     /**
      * Returns true if there is an entry in the cache for the 'query'.
-     * Internally calls hasKey() on the LRU cache.
+     * Internally calls hasKey() on the LRU cache of the key's partition.
      */
     bool contains(const CanonicalQuery& cq) const;
 
@@ -400,10 +494,37 @@ private:
     void encodeKeyForSort(const BSONObj& sortObj, StringBuilder* keyBuilder) const;
     void encodeKeyForProj(const BSONObj& projObj, StringBuilder* keyBuilder) const;
 
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
+    /**
+     * A slice of the cache holding the keys which hash to it. Each partition has its own LRU
+     * list and mutex, so lookups and feedback for different query shapes do not contend.
+     */
+    struct Partition {
+        explicit Partition(size_t maxSize) : cache(maxSize) {}
+
+        // Protects 'cache'.
+        stdx::mutex mutex;
+
+        LRUKeyValue<PlanCacheKey, PlanCacheEntry> cache;
+    };
+
+    // The fewest entries a partition is given, unless the whole cache is smaller than that.
+    static const size_t kMinPartitionSize = 64;
+
+    /**
+     * Sizes '_partitions' from the internalQueryCacheSize and internalQueryCachePartitions knobs,
+     * using fewer partitions than requested if they would hold less than kMinPartitionSize entries.
+     */
+    void initPartitions();
+
+    /**
+     * Returns the partition which holds 'key'.
+     */
+    Partition& getPartition(const PlanCacheKey& key) const;
 
-    // Protects _cache.
-    mutable stdx::mutex _cacheMutex;
+    // Never resized after construction. Least recently used entries are evicted per partition
+    // once the partition is full, even if other partitions still have room, so the cache as a
+    // whole holds at most about internalQueryCacheSize entries.
+    std::vector<std::unique_ptr<Partition>> _partitions;
 
     // Counter for write notifications since initialization or last clear() invocation.  Starts
     // at 0.
@@ -46,9 +46,12 @@
 #include "mongo/db/query/query_planner_test_lib.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/query_test_service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 using namespace mongo;
 
@@ -422,6 +425,272 @@ TEST(PlanCacheTest, AddValidSolution) {
     ASSERT_EQUALS(planCache.size(), 1U);
 }
 
+/**
+ * Returns 'count' canonical queries which each have a different plan cache key.
+ */
+std::vector<unique_ptr<CanonicalQuery>> makeDistinctShapes(size_t count) {
+    std::vector<unique_ptr<CanonicalQuery>> queries;
+    for (size_t i = 0; i < count; ++i) {
+        const std::string fieldName = str::stream() << "a" << i;
+        queries.push_back(canonicalize(BSON(fieldName << 1)));
+    }
+    return queries;
+}
+
+TEST(PlanCacheTest, PartitionedCacheListRemoveAndClear) {
+    PlanCache planCache;
+    auto queries = makeDistinctShapes(100);
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    for (auto&& cq : queries) {
+        ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+    }
+    ASSERT_EQUALS(planCache.size(), queries.size());
+    for (auto&& cq : queries) {
+        ASSERT_TRUE(planCache.contains(*cq));
+    }
+
+    std::vector<PlanCacheEntry*> entries = planCache.getAllEntries();
+    ASSERT_EQUALS(entries.size(), queries.size());
+    for (auto entry : entries) {
+        delete entry;
+    }
+
+    ASSERT_OK(planCache.remove(*queries[0]));
+    ASSERT_FALSE(planCache.contains(*queries[0]));
+    ASSERT_NOT_OK(planCache.remove(*queries[0]));
+    ASSERT_EQUALS(planCache.size(), queries.size() - 1);
+
+    planCache.clear();
+    ASSERT_EQUALS(planCache.size(), 0U);
+    ASSERT_TRUE(planCache.getAllEntries().empty());
+}
+
+TEST(PlanCacheTest, PartitionedCacheStaysWithinCacheSize) {
+    const int oldCacheSize = internalQueryCacheSize.load();
+    const int oldPartitions = internalQueryCachePartitions.load();
+    ON_BLOCK_EXIT([&] {
+        internalQueryCacheSize.store(oldCacheSize);
+        internalQueryCachePartitions.store(oldPartitions);
+    });
+    internalQueryCacheSize.store(8);
+    internalQueryCachePartitions.store(4);
+
+    PlanCache planCache;
+    auto queries = makeDistinctShapes(100);
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    for (auto&& cq : queries) {
+        ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+        ASSERT_TRUE(planCache.contains(*cq));
+        ASSERT_LESS_THAN_OR_EQUALS(planCache.size(), 8U);
+    }
+
+    // A cache too small to split keeps a single partition, so it does not evict while it has room.
+    PlanCache smallCache;
+    for (size_t i = 0; i < 8; ++i) {
+        ASSERT_OK(smallCache.add(*queries[i], solns, createDecision(1U)));
+    }
+    ASSERT_EQUALS(smallCache.size(), 8U);
+    for (size_t i = 0; i < 8; ++i) {
+        ASSERT_TRUE(smallCache.contains(*queries[i]));
+    }
+
+    internalQueryCacheSize.store(1);
+    PlanCache tinyCache;
+    for (auto&& cq : queries) {
+        ASSERT_OK(tinyCache.add(*cq, solns, createDecision(1U)));
+    }
+    ASSERT_EQUALS(tinyCache.size(), 1U);
+    ASSERT_TRUE(tinyCache.contains(*queries.back()));
+}
+
+/**
+ * Returns the stats of a run of a cached index scan plan which did 'works' works.
+ */
+unique_ptr<PlanStageStats> makeIndexScanStats(size_t works) {
+    CommonStats common("IXSCAN");
+    common.works = works;
+    auto stats = stdx::make_unique<PlanStageStats>(common, STAGE_IXSCAN);
+    auto ixscanStats = stdx::make_unique<IndexScanStats>();
+    ixscanStats->keysExamined = works;
+    stats->specific = std::move(ixscanStats);
+    return stats;
+}
+
+TEST(PlanCacheTest, ExecutionsSampledOnceEntryHasEnoughRuns) {
+    const int oldSampleRate = internalQueryCacheExecutionSampleRate.load();
+    ON_BLOCK_EXIT([&] { internalQueryCacheExecutionSampleRate.store(oldSampleRate); });
+    internalQueryCacheExecutionSampleRate.store(10);
+
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+
+    // Every run is recorded while there are too few of them to detect cost drift.
+    CachedSolution* rawCachedSolution;
+    ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+    unique_ptr<CachedSolution> cachedSolution(rawCachedSolution);
+    ASSERT_EQUALS(cachedSolution->executionSampleRate, 1U);
+
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_OK(planCache.recordExecution(*cq, *makeIndexScanStats(2000)));
+    }
+
+    ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+    cachedSolution.reset(rawCachedSolution);
+    ASSERT_EQUALS(cachedSolution->executionSampleRate, 10U);
+}
+
+TEST(PlanCacheTest, RecordExecutionFlagsCostDrift) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_OK(planCache.recordExecution(*cq, *makeIndexScanStats(2000)));
+    }
+
+    PlanCacheEntry* rawEntry;
+    ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+    unique_ptr<PlanCacheEntry> entry(rawEntry);
+    ASSERT_EQUALS(entry->works.count(), 20U);
+    ASSERT_EQUALS(entry->works.mean(), 2000);
+    ASSERT_EQUALS(entry->keysExamined.mean(), 2000);
+    ASSERT_FALSE(entry->needsReevaluation);
+
+    // A run far more costly than the recent ones flags the entry. Lookups do not consume the
+    // flag, only the replanning clears it.
+    ASSERT_OK(planCache.recordExecution(*cq, *makeIndexScanStats(100 * 1000)));
+    CachedSolution* rawCachedSolution;
+    ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+    unique_ptr<CachedSolution> cachedSolution(rawCachedSolution);
+    ASSERT_TRUE(cachedSolution->needsReevaluation);
+    ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+    cachedSolution.reset(rawCachedSolution);
+    ASSERT_TRUE(cachedSolution->needsReevaluation);
+
+    ASSERT_OK(planCache.clearNeedsReevaluation(*cq));
+    ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+    cachedSolution.reset(rawCachedSolution);
+    ASSERT_FALSE(cachedSolution->needsReevaluation);
+
+    ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+    entry.reset(rawEntry);
+    ASSERT_EQUALS(entry->history.size(), 2U);
+    ASSERT_EQUALS(entry->history[0].reason, "cached");
+    ASSERT_EQUALS(entry->history[1].reason, "executionCostDrift");
+    ASSERT_EQUALS(entry->history[1].works, 100 * 1000);
+
+    // The entry replacing this one keeps its history, but not its run statistics.
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+    ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+    entry.reset(rawEntry);
+    ASSERT_EQUALS(entry->history.size(), 3U);
+    ASSERT_EQUALS(entry->history[2].reason, "cached");
+    ASSERT_EQUALS(entry->works.count(), 0U);
+}
+
+TEST(PlanCacheTest, TrialFeedbackLowersReplanThreshold) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    unique_ptr<PlanRankingDecision> decision(createDecision(1U));
+    decision->stats.vector()[0]->common.works = 100;
+    ASSERT_OK(planCache.add(*cq, solns, decision.release()));
+
+    const size_t ratioWorks = static_cast<size_t>(internalQueryCacheEvictionRatio * 100);
+    CachedSolution* rawCachedSolution;
+    ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+    unique_ptr<CachedSolution> cachedSolution(rawCachedSolution);
+    ASSERT_EQUALS(cachedSolution->maxWorksBeforeReplan, ratioWorks);
+
+    // Steady trials of 100 works each replan once a trial takes twice as long.
+    for (int i = 0; i < 20; ++i) {
+        auto feedback = stdx::make_unique<PlanCacheEntryFeedback>();
+        feedback->stats = stdx::make_unique<PlanStageStats>(CommonStats("CACHED_PLAN"),
+                                                            STAGE_CACHED_PLAN);
+        feedback->stats->children.push_back(makeIndexScanStats(100));
+        feedback->score = 1;
+        ASSERT_OK(planCache.feedback(*cq, feedback.release()));
+    }
+    ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+    cachedSolution.reset(rawCachedSolution);
+    ASSERT_EQUALS(cachedSolution->maxWorksBeforeReplan, 200U);
+
+    // Without adaptive replanning the fixed ratio applies.
+    internalQueryCacheAdaptiveReplanning.store(false);
+    ON_BLOCK_EXIT([] { internalQueryCacheAdaptiveReplanning.store(true); });
+    ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+    cachedSolution.reset(rawCachedSolution);
+    ASSERT_EQUALS(cachedSolution->maxWorksBeforeReplan, ratioWorks);
+}
+
+// Measures plan cache lookups per second for a growing number of threads looking up a working set
+// of cached query shapes. Lookups of shapes in different partitions should not serialize.
+TEST(PlanCacheTest, ConcurrentLookupThroughput) {
+    const size_t kLookupsPerThread = 20 * 1000;
+    PlanCache planCache;
+    auto queries = makeDistinctShapes(64);
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    for (auto&& cq : queries) {
+        ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+    }
+
+    for (size_t numThreads : {1, 2, 4, 8}) {
+        AtomicUInt64 misses;
+        std::vector<stdx::thread> threads;
+        Timer timer;
+        for (size_t t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&, t] {
+                for (size_t i = 0; i < kLookupsPerThread; ++i) {
+                    CachedSolution* rawCachedSolution;
+                    const auto& cq = queries[(i + t * 7) % queries.size()];
+                    if (!planCache.get(*cq, &rawCachedSolution).isOK()) {
+                        misses.fetchAndAdd(1);
+                        continue;
+                    }
+                    delete rawCachedSolution;
+                }
+            });
+        }
+        for (auto&& thread : threads) {
+            thread.join();
+        }
+        const long long micros = std::max(timer.micros(), 1LL);
+
+        ASSERT_EQUALS(misses.load(), 0U);
+        unittest::log() << "plan cache lookups with " << numThreads << " thread(s): "
+                        << (numThreads * kLookupsPerThread * 1000 * 1000 / micros) << " per second";
+    }
+}
+
 /**
  * Each test in the CachePlanSelectionTest suite goes through
  * the following flow:
@@ -0,0 +1,167 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cost_estimator.h"
+
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_solution.h"
+
+namespace mongo {
+
+namespace {
+
+bool isAllValues(const OrderedIntervalList& oil) {
+    if (oil.intervals.size() != 1) {
+        return false;
+    }
+    const Interval& interval = oil.intervals[0];
+    return (interval.start.type() == MinKey && interval.end.type() == MaxKey) ||
+        (interval.start.type() == MaxKey && interval.end.type() == MinKey);
+}
+
+}  // namespace
+
+// static
+boost::optional<CardinalityEstimate> PlanCostEstimator::estimateCost(
+    const QuerySolution& soln, const CollectionStatistics& stats) {
+    if (!soln.root) {
+        return boost::none;
+    }
+    CardinalityEstimate cost;
+    if (!estimateNode(soln.root.get(), stats, &cost)) {
+        return boost::none;
+    }
+    return cost;
+}
+
+// static
+boost::optional<size_t> PlanCostEstimator::chooseSolution(
+    const CanonicalQuery& query,
+    const std::vector<QuerySolution*>& solutions,
+    const CollectionStatistics& stats) {
+    const QueryRequest& qr = query.getQueryRequest();
+    if (!qr.getSort().isEmpty() || qr.getLimit() || qr.getSkip() || qr.getNToReturn() ||
+        qr.isTailable()) {
+        return boost::none;
+    }
+
+    std::vector<CardinalityEstimate> costs;
+    for (auto soln : solutions) {
+        auto cost = estimateCost(*soln, stats);
+        if (!cost) {
+            return boost::none;
+        }
+        costs.push_back(*cost);
+    }
+
+    size_t best = 0;
+    for (size_t i = 1; i < costs.size(); ++i) {
+        if (costs[i].expected < costs[best].expected) {
+            best = i;
+        }
+    }
+    for (size_t i = 0; i < costs.size(); ++i) {
+        if (i != best && costs[best].high >= costs[i].low) {
+            return boost::none;
+        }
+    }
+    return best;
+}
+
+// static
+boost::optional<CardinalityEstimate> PlanCostEstimator::estimateNode(
+    const QuerySolutionNode* node, const CollectionStatistics& stats, CardinalityEstimate* cost) {
+    CardinalityEstimate output;
+    switch (node->getType()) {
+        case STAGE_COLLSCAN: {
+            const double numRecords = stats.numRecords();
+            output = CardinalityEstimate(numRecords, numRecords, numRecords);
+            *cost += output;
+            break;
+        }
+        case STAGE_IXSCAN: {
+            const IndexScanNode* ixn = static_cast<const IndexScanNode*>(node);
+            const IndexStatistics* indexStats = stats.getIndex(ixn->index.name);
+            if (!indexStats || ixn->bounds.isSimpleRange || ixn->bounds.fields.empty()) {
+                return boost::none;
+            }
+            output = indexStats->estimateKeys(ixn->bounds.fields[0]);
+
+            // Only the leading field has statistics. Bounds on the other fields may skip any
+            // number of the keys counted.
+            for (size_t i = 1; i < ixn->bounds.fields.size(); ++i) {
+                if (!isAllValues(ixn->bounds.fields[i])) {
+                    output.low = 0;
+                }
+            }
+            *cost += output;
+            break;
+        }
+        case STAGE_FETCH: {
+            auto input = estimateNode(node->children[0], stats, cost);
+            if (!input) {
+                return boost::none;
+            }
+            output = *input;
+            *cost += output;
+            break;
+        }
+        case STAGE_OR: {
+            for (auto child : node->children) {
+                auto input = estimateNode(child, stats, cost);
+                if (!input) {
+                    return boost::none;
+                }
+                output += *input;
+            }
+            break;
+        }
+        case STAGE_KEEP_MUTATIONS:
+        case STAGE_PROJECTION:
+        case STAGE_SHARDING_FILTER: {
+            auto input = estimateNode(node->children[0], stats, cost);
+            if (!input) {
+                return boost::none;
+            }
+            output = *input;
+            break;
+        }
+        default:
+            return boost::none;
+    }
+
+    // A filter may reject any number of the results.
+    if (node->filter) {
+        output.low = 0;
+    }
+    return output;
+}
+
+}  // namespace mongo
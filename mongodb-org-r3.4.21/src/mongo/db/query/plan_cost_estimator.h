@@ -0,0 +1,77 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "mongo/db/query/collection_statistics.h"
+
+namespace mongo {
+
+class CanonicalQuery;
+struct QuerySolution;
+struct QuerySolutionNode;
+
+/**
+ * Estimates the work candidate plans will do from sampled collection statistics, so that a plan
+ * can be chosen without trial runs when the estimates leave no doubt about the winner.
+ *
+ * A unit of cost is one index key examined or one document fetched or scanned, like a unit of
+ * work in the trial runs of the MultiPlanStage.
+ */
+class PlanCostEstimator {
+public:
+    /**
+     * Returns the estimated cost of running 'soln' to completion, or boost::none if it contains
+     * stages the cost model does not handle or scans indexes without statistics.
+     */
+    static boost::optional<CardinalityEstimate> estimateCost(const QuerySolution& soln,
+                                                            const CollectionStatistics& stats);
+
+    /**
+     * Returns the index in 'solutions' of the plan whose estimated cost is certainly lower than
+     * that of every other plan, or boost::none if the plans should be raced instead. Queries that
+     * may stop early, such as those with a sort or a limit, are always raced.
+     */
+    static boost::optional<size_t> chooseSolution(const CanonicalQuery& query,
+                                                  const std::vector<QuerySolution*>& solutions,
+                                                  const CollectionStatistics& stats);
+
+private:
+    /**
+     * Adds the cost of the subtree rooted at 'node' to 'cost' and returns the estimated number of
+     * results it produces, or boost::none if the subtree can't be estimated.
+     */
+    static boost::optional<CardinalityEstimate> estimateNode(const QuerySolutionNode* node,
+                                                            const CollectionStatistics& stats,
+                                                            CardinalityEstimate* cost);
+};
+
+}  // namespace mongo
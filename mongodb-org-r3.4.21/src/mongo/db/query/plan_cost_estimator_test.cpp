@@ -0,0 +1,185 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cost_estimator.h"
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/extensions_callback_disallow_extensions.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString nss("test.collection");
+
+std::unique_ptr<CanonicalQuery> canonicalize(const char* queryStr,
+                                             const char* sortStr = "{}",
+                                             boost::optional<long long> limit = boost::none) {
+    QueryTestServiceContext serviceContext;
+    auto txn = serviceContext.makeOperationContext();
+
+    auto qr = stdx::make_unique<QueryRequest>(nss);
+    qr->setFilter(fromjson(queryStr));
+    qr->setSort(fromjson(sortStr));
+    qr->setLimit(limit);
+    auto statusWithCQ = CanonicalQuery::canonicalize(
+        txn.get(), std::move(qr), ExtensionsCallbackDisallowExtensions());
+    ASSERT_OK(statusWithCQ.getStatus());
+    return std::move(statusWithCQ.getValue());
+}
+
+OrderedIntervalList makePoint(const std::string& field, int value) {
+    OrderedIntervalList oil(field);
+    oil.intervals.push_back(IndexBoundsBuilder::makePointInterval(BSON("" << value)));
+    return oil;
+}
+
+/**
+ * Returns a plan which fetches the documents found by a scan of the index named 'indexName'
+ * with the given bounds.
+ */
+QuerySolution* makeIndexPlan(const BSONObj& keyPattern,
+                             const std::string& indexName,
+                             std::vector<OrderedIntervalList> bounds) {
+    auto ixn = new IndexScanNode(IndexEntry(keyPattern, indexName));
+    ixn->bounds.fields = std::move(bounds);
+    auto fetch = new FetchNode();
+    fetch->children.push_back(ixn);
+
+    auto soln = new QuerySolution();
+    soln->root.reset(fetch);
+    return soln;
+}
+
+QuerySolution* makeCollScanPlan() {
+    auto soln = new QuerySolution();
+    soln->root.reset(new CollectionScanNode());
+    return soln;
+}
+
+/**
+ * Statistics for 1000 documents where 'a' is unique and 'b' is always 5.
+ */
+CollectionStatistics makeStats() {
+    std::vector<BSONObj> aValues;
+    std::vector<BSONObj> bValues;
+    for (int i = 0; i < 1000; ++i) {
+        aValues.push_back(BSON("" << i));
+        bValues.push_back(BSON("" << 5));
+    }
+    CollectionStatistics stats(1000, Date_t());
+    stats.addIndex("a_1", IndexStatistics(std::move(aValues), 1, 100));
+    stats.addIndex("b_1", IndexStatistics(std::move(bValues), 1, 100));
+    return stats;
+}
+
+TEST(PlanCostEstimatorTest, EstimatesIndexAndCollectionScans) {
+    CollectionStatistics stats = makeStats();
+
+    OwnedPointerVector<QuerySolution> solns;
+    solns.push_back(makeIndexPlan(BSON("a" << 1), "a_1", {makePoint("a", 5)}));
+    solns.push_back(makeIndexPlan(BSON("b" << 1), "b_1", {makePoint("b", 5)}));
+    solns.push_back(makeCollScanPlan());
+
+    auto selective = PlanCostEstimator::estimateCost(*solns[0], stats);
+    ASSERT(selective);
+    ASSERT_LESS_THAN(selective->high, 20);
+
+    // Every document is fetched after its key is examined.
+    auto unselective = PlanCostEstimator::estimateCost(*solns[1], stats);
+    ASSERT(unselective);
+    ASSERT_GREATER_THAN(unselective->low, 1500);
+    ASSERT_LESS_THAN_OR_EQUALS(unselective->low, 2000);
+    ASSERT_GREATER_THAN_OR_EQUALS(unselective->high, 2000);
+
+    auto collScan = PlanCostEstimator::estimateCost(*solns[2], stats);
+    ASSERT(collScan);
+    ASSERT_EQUALS(collScan->expected, 1000);
+}
+
+TEST(PlanCostEstimatorTest, ChoosesClearlyCheapestPlan) {
+    CollectionStatistics stats = makeStats();
+    auto cq = canonicalize("{a: 5, b: 5}");
+
+    OwnedPointerVector<QuerySolution> solns;
+    solns.push_back(makeIndexPlan(BSON("b" << 1), "b_1", {makePoint("b", 5)}));
+    solns.push_back(makeIndexPlan(BSON("a" << 1), "a_1", {makePoint("a", 5)}));
+
+    auto choice = PlanCostEstimator::chooseSolution(*cq, solns.vector(), stats);
+    ASSERT(choice);
+    ASSERT_EQUALS(*choice, 1U);
+}
+
+TEST(PlanCostEstimatorTest, RacesPlansWithOverlappingEstimates) {
+    CollectionStatistics stats = makeStats();
+    auto cq = canonicalize("{a: 5, c: 5}");
+
+    // Bounds on the second field of a compound index may skip any number of keys, so the
+    // compound index can't be shown to be worse than the single field index.
+    OwnedPointerVector<QuerySolution> solns;
+    solns.push_back(makeIndexPlan(BSON("a" << 1), "a_1", {makePoint("a", 5)}));
+    solns.push_back(
+        makeIndexPlan(BSON("b" << 1 << "c" << 1), "b_1", {makePoint("b", 5), makePoint("c", 5)}));
+
+    ASSERT_FALSE(PlanCostEstimator::chooseSolution(*cq, solns.vector(), stats));
+}
+
+TEST(PlanCostEstimatorTest, RacesPlansOfQueriesThatMayStopEarly) {
+    CollectionStatistics stats = makeStats();
+
+    OwnedPointerVector<QuerySolution> solns;
+    solns.push_back(makeIndexPlan(BSON("b" << 1), "b_1", {makePoint("b", 5)}));
+    solns.push_back(makeIndexPlan(BSON("a" << 1), "a_1", {makePoint("a", 5)}));
+
+    ASSERT_FALSE(PlanCostEstimator::chooseSolution(
+        *canonicalize("{a: 5, b: 5}", "{b: 1}"), solns.vector(), stats));
+    ASSERT_FALSE(PlanCostEstimator::chooseSolution(
+        *canonicalize("{a: 5, b: 5}", "{}", 1LL), solns.vector(), stats));
+}
+
+TEST(PlanCostEstimatorTest, RacesPlansOnIndexesWithoutStatistics) {
+    CollectionStatistics stats = makeStats();
+    auto cq = canonicalize("{a: 5, d: 5}");
+
+    OwnedPointerVector<QuerySolution> solns;
+    solns.push_back(makeIndexPlan(BSON("a" << 1), "a_1", {makePoint("a", 5)}));
+    solns.push_back(makeIndexPlan(BSON("d" << 1), "d_1", {makePoint("d", 5)}));
+
+    ASSERT_FALSE(PlanCostEstimator::estimateCost(*solns[1], stats));
+    ASSERT_FALSE(PlanCostEstimator::chooseSolution(*cq, solns.vector(), stats));
+}
+
+}  // namespace
+}  // namespace mongo
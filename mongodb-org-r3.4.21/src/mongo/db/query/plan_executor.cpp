@@ -47,6 +47,7 @@
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/stacktrace.h"
 
 namespace mongo {
@@ -280,6 +281,10 @@ OperationContext* PlanExecutor::getOpCtx() const {
 void PlanExecutor::saveState() {
     invariant(_currentState == kUsable || _currentState == kSaved);
 
+    if (!killed()) {
+        stashBatchResults();
+    }
+
     // The query stages inside this stage tree might buffer record ids (e.g. text, geoNear,
     // mergeSort, sort) which are no longer protected by the storage engine's transactional
     // boundaries.
@@ -358,6 +363,37 @@ PlanExecutor::ExecState PlanExecutor::getNextSnapshotted(Snapshotted<BSONObj>* o
     return getNextImpl(objOut, dlOut);
 }
 
+bool PlanExecutor::extractResult(WorkingSetID id,
+                                 Snapshotted<BSONObj>* objOut,
+                                 RecordId* dlOut) {
+    WorkingSetMember* member = _workingSet->get(id);
+    ON_BLOCK_EXIT([&] { _workingSet->free(id); });
+
+    if (NULL != objOut) {
+        if (WorkingSetMember::RID_AND_IDX == member->getState()) {
+            if (1 != member->keyData.size()) {
+                return false;
+            }
+            // TODO: currently snapshot ids are only associated with documents, and not with
+            // index keys.
+            *objOut = Snapshotted<BSONObj>(SnapshotId(), member->keyData[0].keyData);
+        } else if (member->hasObj()) {
+            *objOut = member->obj;
+        } else {
+            return false;
+        }
+    }
+
+    if (NULL != dlOut) {
+        if (!member->hasRecordId()) {
+            return false;
+        }
+        *dlOut = member->recordId;
+    }
+
+    return true;
+}
+
 PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut, RecordId* dlOut) {
     MONGO_FAIL_POINT_BLOCK(planExecutorAlwaysDead, customKill) {
         const BSONObj& data = customKill.getData();
@@ -401,7 +437,11 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
         //   2) some stage requested a yield due to a document fetch, or
         //   3) we need to yield and retry due to a WriteConflictException.
         // In all cases, the actual yielding happens here.
-        if (_yieldPolicy->shouldYield()) {
+        //
+        // A yield would copy the results left in the current batch into _stash, so we only yield
+        // once they are all handed out.
+        const bool inBatch = _nextBatchResult < _batch.results.size();
+        if (!inBatch && _yieldPolicy->shouldYield()) {
             if (!_yieldPolicy->yield(fetcher.get())) {
                 // A return of false from a yield should only happen if we've been killed during the
                 // yield.
@@ -422,44 +462,32 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
         fetcher.reset();
 
         WorkingSetID id = WorkingSet::INVALID_ID;
-        PlanStage::StageState code = _root->work(&id);
+        PlanStage::StageState code;
+        if (inBatch) {
+            id = _batch.results[_nextBatchResult++];
+            code = PlanStage::ADVANCED;
+        } else if (_batchEndState) {
+            code = *_batchEndState;
+            id = _batchEndId;
+            _batchEndState = boost::none;
+        } else if (_workBatchSize > 1) {
+            code = _root->workBatch(_workBatchSize, &_batch, &id);
+            _nextBatchResult = 0;
+            if (!_batch.results.empty()) {
+                // Hand out the results of the batch before acting on the state which ended it.
+                _batchEndState = code;
+                _batchEndId = id;
+                code = PlanStage::NEED_TIME;
+            }
+        } else {
+            code = _root->work(&id);
+        }
 
         if (code != PlanStage::NEED_YIELD)
             writeConflictsInARow = 0;
 
         if (PlanStage::ADVANCED == code) {
-            WorkingSetMember* member = _workingSet->get(id);
-            bool hasRequestedData = true;
-
-            if (NULL != objOut) {
-                if (WorkingSetMember::RID_AND_IDX == member->getState()) {
-                    if (1 != member->keyData.size()) {
-                        _workingSet->free(id);
-                        hasRequestedData = false;
-                    } else {
-                        // TODO: currently snapshot ids are only associated with documents, and
-                        // not with index keys.
-                        *objOut = Snapshotted<BSONObj>(SnapshotId(), member->keyData[0].keyData);
-                    }
-                } else if (member->hasObj()) {
-                    *objOut = member->obj;
-                } else {
-                    _workingSet->free(id);
-                    hasRequestedData = false;
-                }
-            }
-
-            if (NULL != dlOut) {
-                if (member->hasRecordId()) {
-                    *dlOut = member->recordId;
-                } else {
-                    _workingSet->free(id);
-                    hasRequestedData = false;
-                }
-            }
-
-            if (hasRequestedData) {
-                _workingSet->free(id);
+            if (extractResult(id, objOut, dlOut)) {
                 return PlanExecutor::ADVANCED;
             }
             // This result didn't have the data the caller wanted, try again.
@@ -502,7 +530,9 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
 
 bool PlanExecutor::isEOF() {
     invariant(_currentState == kUsable);
-    return killed() || (_stash.empty() && _root->isEOF());
+    return killed() ||
+        (_stash.empty() && _nextBatchResult == _batch.results.size() &&
+         (!_batchEndState || PlanStage::IS_EOF == *_batchEndState) && _root->isEOF());
 }
 
 void PlanExecutor::registerExec(const Collection* collection) {
@@ -576,6 +606,27 @@ void PlanExecutor::enqueue(const BSONObj& obj) {
     _stash.push(obj.getOwned());
 }
 
+void PlanExecutor::setWorkBatchSize(size_t batchSize) {
+    _workBatchSize = batchSize;
+}
+
+void PlanExecutor::stashBatchResults() {
+    while (_nextBatchResult < _batch.results.size()) {
+        Snapshotted<BSONObj> obj;
+        if (extractResult(_batch.results[_nextBatchResult++], &obj, NULL)) {
+            _stash.push(obj.value().getOwned());
+        }
+    }
+    _batch.clear();
+    _nextBatchResult = 0;
+
+    // The stage which asked to yield retries once we restore, so the request is served by the
+    // yield about to happen.
+    if (_batchEndState && PlanStage::NEED_YIELD == *_batchEndState) {
+        _batchEndState = boost::none;
+    }
+}
+
 //
 // ScopedExecutorRegistration
 //
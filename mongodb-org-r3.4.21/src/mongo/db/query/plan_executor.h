@@ -32,6 +32,7 @@
 #include <queue>
 
 #include "mongo/base/status.h"
+#include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/invalidation_type.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/storage/snapshot.h"
@@ -371,6 +372,17 @@ public:
      */
     void enqueue(const BSONObj& obj);
 
+    /**
+     * Work the plan in batches of up to 'batchSize' units of work with PlanStage::workBatch(),
+     * handing out the results of each batch from getNext() one at a time. A 'batchSize' of 0 or 1
+     * works the plan one unit at a time, which is the default.
+     *
+     * Results of a batch which are left over when the executor saves its state are kept as if
+     * enqueue()d, so subsequent calls to getNext() must request the BSONObj and *not* the
+     * RecordId.
+     */
+    void setWorkBatchSize(size_t batchSize);
+
     /**
      * Helper method which returns a set of BSONObj, where each represents a sort order of our
      * output.
@@ -380,6 +392,17 @@ public:
 private:
     ExecState getNextImpl(Snapshotted<BSONObj>* objOut, RecordId* dlOut);
 
+    /**
+     * Hands the data requested by getNext() of the result 'id' out through 'objOut' and 'dlOut'
+     * and frees it. Returns false if the result lacks the requested data.
+     */
+    bool extractResult(WorkingSetID id, Snapshotted<BSONObj>* objOut, RecordId* dlOut);
+
+    /**
+     * Moves the results of the current batch which are yet to be handed out into _stash.
+     */
+    void stashBatchResults();
+
     /**
      * RAII approach to ensuring that plan executors are deregistered.
      *
@@ -474,6 +497,16 @@ private:
     // stages.
     std::queue<BSONObj> _stash;
 
+    // Units of work per call to PlanStage::workBatch(), or 0 or 1 to call work() instead.
+    size_t _workBatchSize = 0;
+
+    // The current batch, of which the results from _nextBatchResult on are yet to be handed out.
+    // The state which ended the batch, along with its WorkingSetID, is acted on after them.
+    PlanStage::WorkBatch _batch;
+    size_t _nextBatchResult = 0;
+    boost::optional<PlanStage::StageState> _batchEndState;
+    WorkingSetID _batchEndId = WorkingSet::INVALID_ID;
+
     enum { kUsable, kSaved, kDetached } _currentState = kUsable;
 
     bool _everDetachedFromOperationContext = false;
@@ -40,10 +40,16 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxResults, int, 101);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheSize, int, 5000);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCachePartitions, int, 16);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheFeedbacksStored, int, 20);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheEvictionRatio, double, 10.0);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheAdaptiveReplanning, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheExecutionSampleRate, int, 10);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxIndexedSolutions, int, 64);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryEnumerationMaxOrSolutions, int, 10);
@@ -58,10 +64,26 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableHashIntersection, bool,
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanOrChildrenIndependently, bool, true);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerUseCollectionStatistics, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryStatisticsSampleSize, int, 1000);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryStatisticsMaxAgeSecs, int, 60);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecFetchBatchSize, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecWorkBatchSize, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecSorterWorkerThreads, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecCompileFilters, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecProjectCoveredKeysInIndexScan, bool, true);
+
 // Yield every 128 cycles or 10ms.
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
@@ -74,4 +96,18 @@ MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize,
 
 MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceCursorBatchSizeBytes, int, 4 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupUseCompactTable, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupHashJoinMaxMemoryBytes, long long, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupCacheMaxMemoryBytes, long long, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceParallelCursorThreads, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceParallelCursorMaxTotalThreads, int, 16);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceParallelCursorMinRecords,
+                              long long,
+                              1000 * 1000);
+
 }  // namespace mongo
@@ -65,6 +65,12 @@ extern std::atomic<bool> internalQueryPlannerEnableHashIntersection;  // NOLINT
 // How many entries in the cache?
 extern std::atomic<int> internalQueryCacheSize;  // NOLINT
 
+// How many independently locked partitions is each collection's plan cache split into? Read when
+// the cache is created. Each partition evicts its own least recently used entries once it holds its
+// share of internalQueryCacheSize, and small caches use fewer partitions so that each holds at
+// least 64 entries.
+extern std::atomic<int> internalQueryCachePartitions;  // NOLINT
+
 // How many feedback entries do we collect before possibly evicting from the cache based on bad
 // performance?
 extern std::atomic<int> internalQueryCacheFeedbacksStored;  // NOLINT
@@ -73,6 +79,14 @@ extern std::atomic<int> internalQueryCacheFeedbacksStored;  // NOLINT
 // and replanning?
 extern AtomicDouble internalQueryCacheEvictionRatio;  // NOLINT
 
+// Do we replan a cached plan once its trial or complete runs cost much more than its recent runs,
+// rather than only once a trial exceeds internalQueryCacheEvictionRatio times the decision works?
+extern std::atomic<bool> internalQueryCacheAdaptiveReplanning;  // NOLINT
+
+// One in how many complete runs of a cached plan is recorded in its cache entry for adaptive
+// replanning, once the entry has enough runs to detect cost drift? 1 or less records every run.
+extern std::atomic<int> internalQueryCacheExecutionSampleRate;  // NOLINT
+
 //
 // Planning and enumeration.
 //
@@ -89,6 +103,16 @@ extern std::atomic<int> internalQueryEnumerationMaxIntersectPerAnd;  // NOLINT
 // Do we want to plan each child of the OR independently?
 extern std::atomic<bool> internalQueryPlanOrChildrenIndependently;  // NOLINT
 
+// Do we choose between candidate plans from sampled collection statistics, racing them only when
+// the estimated costs do not pick a clear winner?
+extern std::atomic<bool> internalQueryPlannerUseCollectionStatistics;  // NOLINT
+
+// How many documents are sampled to build a collection's statistics?
+extern std::atomic<int> internalQueryStatisticsSampleSize;  // NOLINT
+
+// After how many seconds are a collection's statistics sampled again?
+extern std::atomic<int> internalQueryStatisticsMaxAgeSecs;  // NOLINT
+
 // How many index scans are we willing to produce in order to obtain a sort order
 // during explodeForSort?
 extern std::atomic<int> internalQueryMaxScansToExplode;  // NOLINT
@@ -99,6 +123,29 @@ extern std::atomic<int> internalQueryMaxScansToExplode;  // NOLINT
 
 extern std::atomic<int> internalQueryExecMaxBlockingSortBytes;  // NOLINT
 
+// The most records a FETCH stage may read from the storage engine at once, sorted by RecordId,
+// where 0 or 1 fetches each record as it arrives. Batches start small and double in size, so that
+// plans racing in the multi-planner and stages under a small limit don't pay for a full batch.
+// Only used by storage engines which support document-level locking.
+extern std::atomic<int> internalQueryExecFetchBatchSize;  // NOLINT
+
+// The most units of work a find or getMore performs on its plan at once, through
+// PlanStage::workBatch(), where 0 or 1 works the plan one unit at a time. Only results of stages
+// which can batch them are produced several at a time.
+extern std::atomic<int> internalQueryExecWorkBatchSize;  // NOLINT
+
+// Background threads used by each external sort (SortOptions::workerThreads) of a blocking $sort or
+// an index build. 0 sorts on the calling thread only.
+extern std::atomic<int> internalQueryExecSorterWorkerThreads;  // NOLINT
+
+// If true, a COLLSCAN stage evaluates its filter as a CompiledMatchExpression, which resolves each
+// path of the filter once per document.
+extern std::atomic<bool> internalQueryExecCompileFilters;  // NOLINT
+
+// If true, an IXSCAN stage beneath a covered PROJECTION builds the projected documents itself,
+// decoding them straight out of the index cursor's keys where the storage engine supports it.
+extern std::atomic<bool> internalQueryExecProjectCoveredKeysInIndexScan;  // NOLINT
+
 // Yield after this many "should yield?" checks.
 extern std::atomic<int> internalQueryExecYieldIterations;  // NOLINT
 
@@ -115,4 +162,28 @@ extern std::atomic<int> internalInsertMaxBatchSize;  // NOLINT
 
 extern std::atomic<int> internalDocumentSourceCursorBatchSizeBytes;  // NOLINT
 
+// Whether $group may keep the state of $sum, $avg, $min and $max in a GroupHashTable rather than in
+// one set of Accumulator objects per group.
+extern std::atomic<bool> internalDocumentSourceGroupUseCompactTable;  // NOLINT
+
+// Memory which $lookup may use to read a foreign collection once and join with it in a hash table,
+// rather than query it for every input document. 0 disables hash joins.
+extern std::atomic<long long> internalDocumentSourceLookupHashJoinMaxMemoryBytes;  // NOLINT
+
+// Threads on which an aggregation runs the stages up to and including the shard half of its first
+// $group, each scanning ranges of RecordIds, when the query would scan the whole collection. Less
+// than 2 runs every aggregation on one thread.
+extern std::atomic<int> internalDocumentSourceParallelCursorThreads;  // NOLINT
+
+// Threads which the parallel aggregations of the whole process may run at once. An aggregation
+// which can't get at least 2 of them runs on one thread.
+extern std::atomic<int> internalDocumentSourceParallelCursorMaxTotalThreads;  // NOLINT
+
+// The fewest records a collection must hold for an aggregation over it to use several threads.
+extern std::atomic<long long> internalDocumentSourceParallelCursorMinRecords;  // NOLINT
+
+// Memory which $lookup may use to cache the foreign documents it has queried for, by the values of
+// the local field. 0 disables the cache.
+extern std::atomic<long long> internalDocumentSourceLookupCacheMaxMemoryBytes;  // NOLINT
+
 }  // namespace mongo
@@ -32,6 +32,7 @@
 
 #include "mongo/db/range_deleter.h"
 
+#include <algorithm>
 #include <boost/date_time/posix_time/posix_time_duration.hpp>
 #include <memory>
 
@@ -180,9 +181,15 @@ RangeDeleter::~RangeDeleter() {
     }
 }
 
-void RangeDeleter::startWorkers() {
-    if (!_worker) {
-        _worker.reset(new stdx::thread(stdx::bind(&RangeDeleter::doWork, this)));
+void RangeDeleter::startWorkers(int numWorkers) {
+    if (!_workers.empty()) {
+        return;
+    }
+
+    numWorkers = std::max(numWorkers, 1);
+    _workers.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; i++) {
+        _workers.emplace_back(stdx::bind(&RangeDeleter::doWork, this));
     }
 }
 
@@ -192,8 +199,8 @@ void RangeDeleter::stopWorkers() {
         _stopRequested = true;
     }
 
-    if (_worker) {
-        _worker->join();
+    for (auto& worker : _workers) {
+        worker.join();
     }
 
     stdx::unique_lock<stdx::mutex> sl(_queueMutex);
@@ -357,6 +364,7 @@ bool RangeDeleter::deleteNow(OperationContext* txn,
     bool result = _env->deleteRange(txn,
                                     taskDetails,
                                     &taskDetails.stats.deletedDocCount,
+                                    &taskDetails.stats.deletedBytes,
                                     taskDetails.stats.waitForReplDurationMs,
                                     errMsg);
     taskDetails.stats.deleteEndTS = jsTime();
@@ -485,6 +493,7 @@ void RangeDeleter::doWork() {
             bool delResult = _env->deleteRange(txn.get(),
                                                *nextTask,
                                                &nextTask->stats.deletedDocCount,
+                                               &nextTask->stats.deletedBytes,
                                                nextTask->stats.waitForReplDurationMs,
                                                &errMsg);
             nextTask->stats.deleteEndTS = jsTime();
@@ -61,9 +61,10 @@ struct RangeDeleterOptions;
  *
  * Threading assumptions:
  *
- *   This class has (currently) one worker thread attacking the queue, one
- *   job at a time. If we want an immediate deletion, that job is going to
- *   be performed on the thread that is requesting it.
+ *   This class has a pool of worker threads attacking the queue, each one
+ *   working on one job at a time. Queued ranges never overlap, so the workers
+ *   can delete them independently. If we want an immediate deletion, that job
+ *   is going to be performed on the thread that is requesting it.
  *
  *   All calls regarding deletion are synchronized.
  *
@@ -96,15 +97,15 @@ public:
     //
 
     /**
-     * Starts the background thread to work on this queue. Does nothing if the worker
-     * thread is already active.
+     * Starts numWorkers (at least one) background threads to work on this queue. Does
+     * nothing if the worker threads are already active.
      *
      * This call is _not_ thread safe and must be issued before any other call.
      */
-    void startWorkers();
+    void startWorkers(int numWorkers = 1);
 
     /**
-     * Stops the background thread working on this queue. This will block if there are
+     * Stops the background threads working on this queue. This will block if there are
      * tasks that are being deleted, but will leave the pending tasks in the queue.
      *
      * Steps:
@@ -117,7 +118,7 @@ public:
      *
      * + restarting this deleter with startWorkers after stopping it is not supported.
      *
-     * + the worker thread could be running a call in the environment. The thread is
+     * + a worker thread could be running a call in the environment. The thread is
      *   only going to be returned when the environment decides so. In production,
      *   KillCurrentOp::killAll can be used to get the thread back from the environment.
      */
@@ -184,7 +185,7 @@ private:
 
     typedef std::set<NSMinMax*, NSMinMaxCmp> NSMinMaxSet;  // owned here
 
-    /** Body of the worker thread */
+    /** Body of the worker threads */
     void doWork();
 
     /** Returns true if the range doesn't intersect with one other range */
@@ -199,7 +200,7 @@ private:
     std::unique_ptr<RangeDeleterEnv> _env;
 
     // Initially not active. Must be started explicitly.
-    std::unique_ptr<stdx::thread> _worker;
+    std::vector<stdx::thread> _workers;
 
     // Protects _stopRequested.
     mutable stdx::mutex _stopMutex;
@@ -257,8 +258,9 @@ struct DeleteJobStats {
     Milliseconds waitForReplDurationMs;
 
     long long int deletedDocCount;
+    long long int deletedBytes;
 
-    DeleteJobStats() : deletedDocCount(0) {}
+    DeleteJobStats() : deletedDocCount(0), deletedBytes(0) {}
 };
 
 struct RangeDeleterOptions {
@@ -311,10 +313,13 @@ struct RangeDeleterEnv {
      *
      * Must be a synchronous call. Docs should be deleted after call ends.
      * Must not throw Exceptions.
+     *
+     * May be called concurrently from several threads for non-overlapping ranges.
      */
     virtual bool deleteRange(OperationContext* txn,
                              const RangeDeleteEntry& taskDetails,
                              long long int* deletedDocs,
+                             long long int* deletedBytes,
                              Milliseconds& replWaitDuration,
                              std::string* errMsg) = 0;
 
@@ -61,6 +61,7 @@ using std::string;
 bool RangeDeleterDBEnv::deleteRange(OperationContext* txn,
                                     const RangeDeleteEntry& taskDetails,
                                     long long int* deletedDocs,
+                                    long long int* deletedBytes,
                                     Milliseconds& replWaitDuration,
                                     std::string* errMsg) {
     const string ns(taskDetails.options.range.ns);
@@ -74,6 +75,7 @@ bool RangeDeleterDBEnv::deleteRange(OperationContext* txn,
     Client::initThreadIfNotAlready("RangeDeleter");
 
     *deletedDocs = 0;
+    *deletedBytes = 0;
     OperationShardingState::IgnoreVersioningBlock forceVersion(txn, NamespaceString(ns));
 
     Helpers::RemoveSaver removeSaver("moveChunk", ns, taskDetails.options.removeSaverReason);
@@ -96,7 +98,8 @@ bool RangeDeleterDBEnv::deleteRange(OperationContext* txn,
                                  replWaitDuration,
                                  removeSaverPtr,
                                  fromMigrate,
-                                 onlyRemoveOrphans);
+                                 onlyRemoveOrphans,
+                                 deletedBytes);
 
         if (*deletedDocs < 0) {
             *errMsg = "collection or index dropped before data could be cleaned";
@@ -105,8 +108,9 @@ bool RangeDeleterDBEnv::deleteRange(OperationContext* txn,
             return false;
         }
 
-        log() << "rangeDeleter deleted " << *deletedDocs << " documents for " << ns << " from "
-              << redact(inclusiveLower) << " -> " << redact(exclusiveUpper);
+        log() << "rangeDeleter deleted " << *deletedDocs << " documents (" << *deletedBytes
+              << " bytes) for " << ns << " from " << redact(inclusiveLower) << " -> "
+              << redact(exclusiveUpper);
     } catch (const DBException& ex) {
         *errMsg = str::stream() << "Error encountered while deleting range: "
                                 << "ns" << ns << " from " << inclusiveLower << " -> "
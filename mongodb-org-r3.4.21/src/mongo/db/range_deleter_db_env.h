@@ -46,7 +46,8 @@ struct RangeDeleterDBEnv : public RangeDeleterEnv {
      * Note that secondaryThrottle will be ignored if current process is not part
      * of a replica set.
      *
-     * deletedDocs would contain the number of docs deleted if the deletion was successful.
+     * deletedDocs and deletedBytes would contain the number and total size of the docs deleted
+     * if the deletion was successful.
      *
      * Returns time spent waiting for majority replication in replWaitDuration.
      *
@@ -55,6 +56,7 @@ struct RangeDeleterDBEnv : public RangeDeleterEnv {
     virtual bool deleteRange(OperationContext* txn,
                              const RangeDeleteEntry& taskDetails,
                              long long int* deletedDocs,
+                             long long int* deletedBytes,
                              Milliseconds& replWaitDuration,
                              std::string* errMsg);
 
@@ -30,6 +30,7 @@
 
 #include "mongo/base/init.h"
 #include "mongo/db/range_deleter_db_env.h"
+#include "mongo/db/server_parameters.h"
 
 namespace {
 
@@ -38,6 +39,10 @@ mongo::RangeDeleter* _deleter = NULL;
 
 namespace mongo {
 
+// The number of threads deleting queued ranges concurrently. Each range is deleted by a single
+// thread, so this only helps when several ranges are pending at once.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(rangeDeleterWorkerThreads, int, 2);
+
 MONGO_INITIALIZER(RangeDeleterInit)(InitializerContext* context) {
     _deleter = new RangeDeleter(new RangeDeleterDBEnv);
     return Status::OK();
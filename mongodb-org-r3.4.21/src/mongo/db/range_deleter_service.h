@@ -32,6 +32,11 @@
 
 namespace mongo {
 
+/**
+ * Number of worker threads the global deleter is started with.
+ */
+extern int rangeDeleterWorkerThreads;
+
 /**
  * Gets the global instance of the deleter and starts it.
  */
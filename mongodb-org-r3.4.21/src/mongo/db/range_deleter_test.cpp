@@ -173,6 +173,56 @@ TEST_F(QueuedDelete, StopWhileWaitingCursor) {
     ASSERT_FALSE(env->deleteOccured());
 }
 
+// Should delete independent ranges concurrently when there is more than one worker.
+TEST_F(QueuedDelete, MultipleWorkersDeleteConcurrently) {
+    const string ns("test.user");
+
+    RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
+    RangeDeleter deleter(env);
+
+    std::unique_ptr<mongo::repl::ReplicationCoordinatorMock> mock(
+        new mongo::repl::ReplicationCoordinatorMock(replSettings));
+
+    mongo::repl::ReplicationCoordinator::set(mongo::getGlobalServiceContext(), std::move(mock));
+
+    deleter.startWorkers(2);
+
+    env->pauseDeletes();
+
+    Notification<void> doneSignal1;
+    ASSERT_TRUE(deleter.queueDelete(
+        opCtx(),
+        RangeDeleterOptions(KeyRange(ns, BSON("x" << 0), BSON("x" << 10), BSON("x" << 1))),
+        &doneSignal1,
+        NULL /* errMsg not needed */));
+
+    Notification<void> doneSignal2;
+    ASSERT_TRUE(deleter.queueDelete(
+        opCtx(),
+        RangeDeleterOptions(KeyRange(ns, BSON("x" << 10), BSON("x" << 20), BSON("x" << 1))),
+        &doneSignal2,
+        NULL /* errMsg not needed */));
+
+    // Both deletes can only be paused at the same time if they run on different workers.
+    env->waitForNthPausedDelete(2u);
+
+    ASSERT_EQUALS(2U, deleter.getDeletesInProgress());
+    ASSERT_EQUALS(0U, deleter.getPendingDeletes());
+
+    // The resumed delete pauses the environment again before recording itself, so wait for it
+    // before resuming the other one.
+    env->resumeOneDelete();
+    while (!env->deleteOccured()) {
+        sleepmillis(1);
+    }
+    env->resumeOneDelete();
+
+    doneSignal1.get(opCtx());
+    doneSignal2.get(opCtx());
+
+    deleter.stopWorkers();
+}
+
 using ImmediateDelete = RangeDeleterTestFixture;
 
 // Should not start delete if the set of cursors that were open when the deleteNow method is called
@@ -0,0 +1,179 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_buffer_compressed_queue.h"
+
+#include <cstring>
+#include <snappy.h>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+// Limit buffer to 256MB of compressed entries.
+const size_t kOplogBufferSize = 256 * 1024 * 1024;
+
+}  // namespace
+
+OplogBufferCompressedQueue::OplogBufferCompressedQueue()
+    : _queue(kOplogBufferSize, [](const Entry& entry) { return entry.size; }) {}
+
+// static
+OplogBufferCompressedQueue::Entry OplogBufferCompressedQueue::_compress(const BSONObj& obj) {
+    const size_t maxSize = snappy::MaxCompressedLength(obj.objsize());
+    SharedBuffer buffer = SharedBuffer::allocate(maxSize);
+    size_t size = maxSize;
+    snappy::RawCompress(obj.objdata(), obj.objsize(), buffer.get(), &size);
+
+    // Don't hold on to the slack of the worst case allocation.
+    if (size < maxSize) {
+        buffer.realloc(size);
+    }
+
+    Entry entry;
+    entry.data = std::move(buffer);
+    entry.size = size;
+    return entry;
+}
+
+// static
+BSONObj OplogBufferCompressedQueue::_decompress(const Entry& entry) {
+    size_t size = 0;
+    fassert(40703, snappy::GetUncompressedLength(entry.data.get(), entry.size, &size));
+    SharedBuffer buffer = SharedBuffer::allocate(size);
+    fassert(40704, snappy::RawUncompress(entry.data.get(), entry.size, buffer.get()));
+    return BSONObj(std::move(buffer));
+}
+
+BSONObj OplogBufferCompressedQueue::_decompressFront(const Entry& entry) {
+    stdx::lock_guard<stdx::mutex> lk(_frontMutex);
+    if (_frontData.get() != entry.data.get()) {
+        _front = _decompress(entry);
+        _frontData = entry.data;
+    }
+    return _front;
+}
+
+void OplogBufferCompressedQueue::startup(OperationContext*) {}
+
+void OplogBufferCompressedQueue::shutdown(OperationContext* txn) {
+    clear(txn);
+}
+
+void OplogBufferCompressedQueue::pushEvenIfFull(OperationContext*, const Value& value) {
+    _queue.pushEvenIfFull(_compress(value));
+}
+
+void OplogBufferCompressedQueue::push(OperationContext*, const Value& value) {
+    _queue.push(_compress(value));
+}
+
+void OplogBufferCompressedQueue::pushAllNonBlocking(OperationContext*,
+                                                    Batch::const_iterator begin,
+                                                    Batch::const_iterator end) {
+    std::vector<Entry> entries;
+    entries.reserve(std::distance(begin, end));
+    for (auto it = begin; it != end; ++it) {
+        entries.push_back(_compress(*it));
+    }
+    _queue.pushAllNonBlocking(entries.cbegin(), entries.cend());
+}
+
+void OplogBufferCompressedQueue::waitForSpace(OperationContext*, std::size_t size) {
+    // 'size' is the uncompressed size of the entries about to be pushed, which is an upper bound
+    // of their compressed size for all but incompressible entries.
+    _queue.waitForSpace(std::min(size, kOplogBufferSize));
+}
+
+bool OplogBufferCompressedQueue::isEmpty() const {
+    return _queue.empty();
+}
+
+std::size_t OplogBufferCompressedQueue::getMaxSize() const {
+    return kOplogBufferSize;
+}
+
+std::size_t OplogBufferCompressedQueue::getSize() const {
+    return _queue.size();
+}
+
+std::size_t OplogBufferCompressedQueue::getCount() const {
+    return _queue.count();
+}
+
+void OplogBufferCompressedQueue::clear(OperationContext*) {
+    _queue.clear();
+
+    stdx::lock_guard<stdx::mutex> lk(_frontMutex);
+    _frontData = ConstSharedBuffer();
+    _front = BSONObj();
+}
+
+bool OplogBufferCompressedQueue::tryPop(OperationContext*, Value* value) {
+    Entry entry;
+    if (!_queue.tryPop(entry)) {
+        return false;
+    }
+    *value = _decompressFront(entry);
+
+    stdx::lock_guard<stdx::mutex> lk(_frontMutex);
+    _frontData = ConstSharedBuffer();
+    _front = BSONObj();
+    return true;
+}
+
+bool OplogBufferCompressedQueue::waitForData(Seconds waitDuration) {
+    Entry ignored;
+    return _queue.blockingPeek(ignored, static_cast<int>(durationCount<Seconds>(waitDuration)));
+}
+
+bool OplogBufferCompressedQueue::peek(OperationContext*, Value* value) {
+    Entry entry;
+    if (!_queue.peek(entry)) {
+        return false;
+    }
+    *value = _decompressFront(entry);
+    return true;
+}
+
+boost::optional<OplogBuffer::Value> OplogBufferCompressedQueue::lastObjectPushed(
+    OperationContext*) const {
+    auto entry = _queue.lastObjectPushed();
+    if (!entry) {
+        return boost::none;
+    }
+    return _decompress(*entry);
+}
+
+}  // namespace repl
+}  // namespace mongo
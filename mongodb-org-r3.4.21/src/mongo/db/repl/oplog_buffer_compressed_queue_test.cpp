@@ -0,0 +1,107 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_buffer_compressed_queue.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+using namespace mongo::repl;
+
+BSONObj makeOplogEntry(int t) {
+    return BSON("ts" << Timestamp(t, 1) << "h" << static_cast<long long>(t) << "ns"
+                     << "test.t"
+                     << "op"
+                     << "i"
+                     << "o"
+                     << BSON("_id" << t << "padding" << std::string(1000, 'x')));
+}
+
+TEST(OplogBufferCompressedQueueTest, PushedEntriesArePoppedInOrder) {
+    OplogBufferCompressedQueue buffer;
+    OperationContext* txn = nullptr;
+    buffer.startup(txn);
+
+    ASSERT_TRUE(buffer.isEmpty());
+    buffer.push(txn, makeOplogEntry(1));
+    OplogBuffer::Batch batch = {makeOplogEntry(2), makeOplogEntry(3)};
+    buffer.pushAllNonBlocking(txn, batch.cbegin(), batch.cend());
+    ASSERT_EQUALS(3U, buffer.getCount());
+    ASSERT_BSONOBJ_EQ(makeOplogEntry(3), *buffer.lastObjectPushed(txn));
+
+    for (int t = 1; t <= 3; t++) {
+        BSONObj peeked;
+        ASSERT_TRUE(buffer.peek(txn, &peeked));
+        ASSERT_BSONOBJ_EQ(makeOplogEntry(t), peeked);
+
+        BSONObj popped;
+        ASSERT_TRUE(buffer.tryPop(txn, &popped));
+        ASSERT_BSONOBJ_EQ(makeOplogEntry(t), popped);
+        ASSERT_TRUE(popped.isOwned());
+    }
+
+    BSONObj ignored;
+    ASSERT_FALSE(buffer.peek(txn, &ignored));
+    ASSERT_FALSE(buffer.tryPop(txn, &ignored));
+    ASSERT_FALSE(buffer.lastObjectPushed(txn));
+    buffer.shutdown(txn);
+}
+
+TEST(OplogBufferCompressedQueueTest, SizeCountsCompressedBytes) {
+    OplogBufferCompressedQueue buffer;
+    OperationContext* txn = nullptr;
+
+    const BSONObj entry = makeOplogEntry(1);
+    buffer.push(txn, entry);
+    ASSERT_GREATER_THAN(buffer.getSize(), 0U);
+    ASSERT_LESS_THAN(buffer.getSize(), static_cast<size_t>(entry.objsize()));
+}
+
+TEST(OplogBufferCompressedQueueTest, ClearRemovesPeekedEntry) {
+    OplogBufferCompressedQueue buffer;
+    OperationContext* txn = nullptr;
+
+    buffer.push(txn, makeOplogEntry(1));
+    BSONObj peeked;
+    ASSERT_TRUE(buffer.peek(txn, &peeked));
+    buffer.clear(txn);
+    ASSERT_TRUE(buffer.isEmpty());
+    ASSERT_EQUALS(0U, buffer.getSize());
+
+    buffer.push(txn, makeOplogEntry(2));
+    ASSERT_TRUE(buffer.peek(txn, &peeked));
+    ASSERT_BSONOBJ_EQ(makeOplogEntry(2), peeked);
+}
+
+}  // namespace
@@ -60,6 +60,7 @@
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/oplog_buffer_blocking_queue.h"
 #include "mongo/db/repl/oplog_buffer_collection.h"
+#include "mongo/db/repl/oplog_buffer_compressed_queue.h"
 #include "mongo/db/repl/oplog_buffer_proxy.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
@@ -131,6 +132,10 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncOplogBuffer,
 // Set this to specify size of read ahead buffer in the OplogBufferCollection.
 MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncOplogBufferPeekCacheSize, int, 10000);
 
+// Set this to keep the oplog entries buffered during steady state replication snappy-compressed, so
+// that a larger backlog fits in the buffer at the cost of compressing and decompressing each entry.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(replCompressOplogBuffer, bool, false);
+
 // Set this to specify the maximum number of times the oplog fetcher will consecutively restart the
 // oplog tailing query on non-cancellation errors during steady state replication.
 server_parameter_storage_type<int, ServerParameterType::kStartupAndRuntime>::value_type
@@ -980,6 +985,9 @@ std::unique_ptr<OplogBuffer> ReplicationCoordinatorExternalStateImpl::makeInitia
 
 std::unique_ptr<OplogBuffer> ReplicationCoordinatorExternalStateImpl::makeSteadyStateOplogBuffer(
     OperationContext* txn) const {
+    if (replCompressOplogBuffer) {
+        return stdx::make_unique<OplogBufferCompressedQueue>();
+    }
     return stdx::make_unique<OplogBufferBlockingQueue>();
 }
 
@@ -34,6 +34,7 @@
 #include "mongo/db/repl/sync_tail.h"
 
 #include "third_party/murmurhash3/MurmurHash3.h"
+#include <array>
 #include <boost/functional/hash.hpp>
 #include <memory>
 
@@ -74,6 +75,7 @@
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/socket_exception.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -145,6 +147,56 @@ ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
 // Number and time of each ApplyOps worker pool round
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
+
+// Time each writer spent applying its share of the batches, and time writers spent idle at the end
+// of each batch waiting for the slowest writer to finish.
+class WriterApplyStats final : public ServerStatusMetric {
+public:
+    WriterApplyStats() : ServerStatusMetric("repl.apply.writers") {}
+
+    void recordBatch(const std::vector<MultiApplier::OperationPtrs>& writerVectors,
+                     const std::vector<long long>& busyMicros,
+                     long long batchMicros) {
+        invariant(writerVectors.size() == busyMicros.size());
+        const size_t numWriters = std::min(writerVectors.size(), kMaxWriters);
+        if (_numWriters.load() < numWriters) {
+            _numWriters.store(numWriters);
+        }
+
+        long long waitMicros = 0;
+        for (size_t i = 0; i < numWriters; i++) {
+            if (writerVectors[i].empty()) {
+                continue;
+            }
+            _busyMicros[i].fetchAndAdd(busyMicros[i]);
+            waitMicros += std::max(0LL, batchMicros - busyMicros[i]);
+        }
+        _barrierWaitMicros.fetchAndAdd(waitMicros);
+    }
+
+    void appendAtLeaf(BSONObjBuilder& b) const final {
+        BSONObjBuilder writers(b.subobjStart(_leafName));
+        BSONArrayBuilder busy(writers.subarrayStart("busyMillis"));
+        for (size_t i = 0; i < _numWriters.load(); i++) {
+            busy.append(static_cast<long long>(_busyMicros[i].load() / 1000));
+        }
+        busy.done();
+        writers.append("batchBarrierWaitMillis",
+                       static_cast<long long>(_barrierWaitMicros.load() / 1000));
+    }
+
+private:
+    // The largest allowed replWriterThreadCount.
+    static const size_t kMaxWriters = 256;
+
+    std::array<AtomicUInt64, kMaxWriters> _busyMicros;
+    AtomicUInt64 _barrierWaitMicros;
+    AtomicWord<size_t> _numWriters;
+} writerApplyStats;
+
+// The most inserts applied as a single grouped insert, and so the length of the runs of inserts
+// into one collection which fillWriterVectors() gives to the same writer.
+const int kMaxInsertGroupCount = 64;
 void initializePrefetchThread() {
     if (!Client::getCurrent()) {
         Client::initThreadIfNotAlready();
@@ -443,15 +495,20 @@ void prefetchOps(const MultiApplier::Operations& ops, OldThreadPool* prefetcherP
 
 // Doles out all the work to the writer pool threads.
 // Does not modify writerVectors, but passes non-const pointers to inner vectors into func.
+// Records the time each writer spends applying its ops in busyMicros.
 void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
               OldThreadPool* writerPool,
               const MultiApplier::ApplyOperationFn& func,
-              std::vector<Status>* statusVector) {
+              std::vector<Status>* statusVector,
+              std::vector<long long>* busyMicros) {
     invariant(writerVectors.size() == statusVector->size());
+    invariant(writerVectors.size() == busyMicros->size());
     for (size_t i = 0; i < writerVectors.size(); i++) {
         if (!writerVectors[i].empty()) {
-            writerPool->schedule([&func, &writerVectors, statusVector, i] {
+            writerPool->schedule([&func, &writerVectors, statusVector, busyMicros, i] {
+                Timer timer;
                 (*statusVector)[i] = func(&writerVectors[i]);
+                (*busyMicros)[i] = timer.micros();
             });
         }
     }
@@ -570,17 +627,45 @@ private:
     StringMap<CollectionProperties> _cache;
 };
 
+// Returns the namespaces which only see inserts in 'ops'.
+StringMap<bool> findInsertOnlyNamespaces(const MultiApplier::Operations& ops) {
+    StringMap<bool> insertOnly;
+    for (auto&& op : ops) {
+        if (!op.isCrudOpType()) {
+            continue;
+        }
+        const bool isInsert = op.opType == "i";
+        auto it = insertOnly.find(op.ns);
+        if (it == insertOnly.end()) {
+            insertOnly[op.ns] = isInsert;
+        } else if (!isInsert) {
+            it->second = false;
+        }
+    }
+    return insertOnly;
+}
+
+}  // namespace
+
 // This only modifies the isForCappedCollection field on each op. It does not alter the ops vector
 // in any other way.
 void fillWriterVectors(OperationContext* txn,
                        MultiApplier::Operations* ops,
-                       std::vector<MultiApplier::OperationPtrs>* writerVectors) {
-    const bool supportsDocLocking =
-        getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking();
+                       std::vector<MultiApplier::OperationPtrs>* writerVectors,
+                       bool supportsDocLocking) {
     const uint32_t numWriters = writerVectors->size();
 
     CachedCollectionProperties collPropertiesCache;
 
+    // The writer and length of the current run of inserts into each insert-only namespace.
+    struct InsertRun {
+        uint32_t writer = 0;
+        int length = 0;
+    };
+    StringMap<InsertRun> insertRuns;
+    const StringMap<bool> insertOnly =
+        supportsDocLocking ? findInsertOnlyNamespaces(*ops) : StringMap<bool>();
+
     for (auto&& op : *ops) {
         StringMapTraits::HashedKey hashedNs(op.ns);
         uint32_t hash = hashedNs.hash();
@@ -588,12 +673,25 @@ void fillWriterVectors(OperationContext* txn,
         if (op.isCrudOpType()) {
             auto collProperties = collPropertiesCache.getCollectionProperties(txn, hashedNs);
 
-            // For doc locking engines, include the _id of the document in the hash so we get
-            // parallelism even if all writes are to a single collection.
-            //
-            // For capped collections, this is illegal, since capped collections must preserve
-            // insertion order.
-            if (supportsDocLocking && !collProperties.isCapped) {
+            if (supportsDocLocking && !collProperties.isCapped && insertOnly.find(op.ns)->second) {
+                // No later op of this batch depends on which writer applies an insert into a
+                // namespace that only sees inserts, so give runs of consecutive inserts to the same
+                // writer rather than spreading them by _id. Each writer then applies its runs as
+                // grouped inserts of neighbouring documents, and successive runs still go to
+                // different writers.
+                auto& run = insertRuns[op.ns];
+                if (run.length == kMaxInsertGroupCount) {
+                    ++run.writer;
+                    run.length = 0;
+                }
+                ++run.length;
+                hash += run.writer;
+            } else if (supportsDocLocking && !collProperties.isCapped) {
+                // For doc locking engines, include the _id of the document in the hash so we get
+                // parallelism even if all writes are to a single collection.
+                //
+                // For capped collections, this is illegal, since capped collections must preserve
+                // insertion order.
                 BSONElement id = op.getIdElement();
                 BSONElementComparator elementHasher(BSONElementComparator::FieldNamesMode::kIgnore,
                                                     collProperties.collator);
@@ -615,8 +713,6 @@ void fillWriterVectors(OperationContext* txn,
     }
 }
 
-}  // namespace
-
 // Applies a batch of oplog entries, by using a set of threads to apply the operations and then
 // writes the oplog entries to the local oplog.
 OpTime SyncTail::multiApply(OperationContext* txn, MultiApplier::Operations ops) {
@@ -1122,7 +1218,7 @@ Status multiSyncApply_noAbort(OperationContext* txn,
             std::vector<BSONObj> toInsert;
 
             auto maxBatchSize = insertVectorMaxBytes;
-            auto maxBatchCount = 64;
+            auto maxBatchCount = kMaxInsertGroupCount;
 
             // Make sure to include the first op in the batch size.
             int batchSize = (*oplogEntriesIterator)->o.Obj().objsize();
@@ -1331,20 +1427,29 @@ StatusWith<OpTime> multiApply(OperationContext* txn,
         TimerHolder timer(&applyBatchStats);
 
         // We must wait for the all work we've dispatched to complete before leaving this block
-        // because the spawned threads refer to objects on our stack, including writerVectors.
+        // because the spawned threads refer to objects on our stack, including writerVectors and
+        // writerBusyMicros.
         std::vector<MultiApplier::OperationPtrs> writerVectors(workerPool->getNumThreads());
+        std::vector<long long> writerBusyMicros(writerVectors.size(), 0);
         ON_BLOCK_EXIT([&] { workerPool->join(); });
 
         storage->setOplogDeleteFromPoint(txn, ops.front().ts.timestamp());
         scheduleWritesToOplog(txn, workerPool, ops);
-        fillWriterVectors(txn, &ops, &writerVectors);
+        fillWriterVectors(
+            txn,
+            &ops,
+            &writerVectors,
+            getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking());
 
         workerPool->join();
 
         storage->setOplogDeleteFromPoint(txn, Timestamp());
         storage->setMinValidToAtLeast(txn, ops.back().getOpTime());
 
-        applyOps(writerVectors, workerPool, applyOperation, &statusVector);
+        Timer applyTimer;
+        applyOps(writerVectors, workerPool, applyOperation, &statusVector, &writerBusyMicros);
+        workerPool->join();
+        writerApplyStats.recordBatch(writerVectors, writerBusyMicros, applyTimer.micros());
     }
 
     // If any of the statuses is not ok, return error.
@@ -257,6 +257,19 @@ StatusWith<OpTime> multiApply(OperationContext* txn,
                               MultiApplier::Operations ops,
                               MultiApplier::ApplyOperationFn applyOperation);
 
+/**
+ * Distributes the operations in "ops" among "writerVectors", one vector per writer thread. Ops
+ * that must be applied in order relative to each other always go to the same writer. On storage
+ * engines with document-level locking, runs of inserts into a namespace which sees only inserts
+ * are kept together on one writer.
+ *
+ * Only modifies the isForCappedCollection field of the ops. Exposed for testing.
+ */
+void fillWriterVectors(OperationContext* txn,
+                       MultiApplier::Operations* ops,
+                       std::vector<MultiApplier::OperationPtrs>* writerVectors,
+                       bool supportsDocLocking);
+
 // These free functions are used by the thread pool workers to write ops to the db.
 // They consume the passed in OperationPtrs and callers should not make any assumptions about the
 // state of the container after calling. However, these functions cannot modify the pointed-to
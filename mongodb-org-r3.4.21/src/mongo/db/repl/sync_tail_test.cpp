@@ -39,6 +39,7 @@
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_internal.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
@@ -622,6 +623,146 @@ TEST_F(SyncTailTest, MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceH
     ASSERT_BSONOBJ_EQ(op2.raw, operationsWrittenToOplog[1]);
 }
 
+/**
+ * Returns the index of the writer vector which was given the operation 'op'.
+ */
+size_t findWriterForOperation(const std::vector<MultiApplier::OperationPtrs>& writerVectors,
+                              const OplogEntry* op) {
+    for (size_t i = 0; i < writerVectors.size(); i++) {
+        if (std::find(writerVectors[i].begin(), writerVectors[i].end(), op) !=
+            writerVectors[i].end()) {
+            return i;
+        }
+    }
+    FAIL("operation was not given to any writer");
+    MONGO_UNREACHABLE;
+}
+
+TEST_F(SyncTailTest, FillWriterVectorsGivesRunsOfInsertsIntoOneNamespaceToTheSameWriter) {
+    NamespaceString nss("test.t");
+
+    // A full run of inserts, followed by a few more.
+    MultiApplier::Operations ops;
+    for (int i = 0; i < 70; i++) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), i), 1LL}, nss, BSON("_id" << i)));
+    }
+
+    std::vector<MultiApplier::OperationPtrs> writerVectors(4);
+    fillWriterVectors(_opCtx.get(), &ops, &writerVectors, true /* supportsDocLocking */);
+
+    // The first 64 inserts must have been given in order to a single writer.
+    const auto& firstRun = writerVectors[findWriterForOperation(writerVectors, &ops[0])];
+    ASSERT_EQUALS(64U, firstRun.size());
+    for (size_t i = 0; i < 64; i++) {
+        ASSERT_EQUALS(&ops[i], firstRun[i]);
+    }
+
+    // The remaining inserts form the next run, which goes to another writer.
+    const auto& secondRun = writerVectors[findWriterForOperation(writerVectors, &ops[64])];
+    ASSERT_NOT_EQUALS(&firstRun, &secondRun);
+    ASSERT_EQUALS(6U, secondRun.size());
+    for (size_t i = 0; i < 6; i++) {
+        ASSERT_EQUALS(&ops[64 + i], secondRun[i]);
+    }
+}
+
+TEST_F(SyncTailTest, FillWriterVectorsHashesByIdWhenNamespaceSeesOtherOperations) {
+    NamespaceString nss("test.t");
+
+    MultiApplier::Operations ops;
+    for (int i = 0; i < 64; i++) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), i), 1LL}, nss, BSON("_id" << i)));
+    }
+    ops.push_back(makeUpdateDocumentOplogEntry({Timestamp(Seconds(2), 0), 1LL},
+                                               nss,
+                                               BSON("_id" << 0),
+                                               BSON("$set" << BSON("x" << 1))));
+
+    std::vector<MultiApplier::OperationPtrs> writerVectors(4);
+    fillWriterVectors(_opCtx.get(), &ops, &writerVectors, true /* supportsDocLocking */);
+
+    // The inserts are spread across the writers by _id, and the update of a document goes to the
+    // same writer as its insert.
+    size_t nonEmptyWriters = 0;
+    for (auto&& writer : writerVectors) {
+        if (!writer.empty()) {
+            nonEmptyWriters++;
+        }
+    }
+    ASSERT_GREATER_THAN(nonEmptyWriters, 1U);
+    ASSERT_EQUALS(findWriterForOperation(writerVectors, &ops[0]),
+                  findWriterForOperation(writerVectors, &ops.back()));
+}
+
+TEST_F(SyncTailTest, FillWriterVectorsWithoutDocLockingGivesANamespaceToOneWriter) {
+    NamespaceString nss("test.t");
+
+    MultiApplier::Operations ops;
+    for (int i = 0; i < 70; i++) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), i), 1LL}, nss, BSON("_id" << i)));
+    }
+
+    std::vector<MultiApplier::OperationPtrs> writerVectors(4);
+    fillWriterVectors(_opCtx.get(), &ops, &writerVectors, false /* supportsDocLocking */);
+
+    const auto& writer = writerVectors[findWriterForOperation(writerVectors, &ops[0])];
+    ASSERT_EQUALS(ops.size(), writer.size());
+}
+
+/**
+ * Returns the serverStatus metrics.repl.apply.writers section.
+ */
+BSONObj getWriterApplyStats() {
+    BSONObjBuilder bob;
+    MetricTree::theMetricTree->appendTo(bob);
+    return bob.obj()["repl"]["apply"]["writers"].Obj().getOwned();
+}
+
+long long sumBusyMillis(const BSONObj& writerStats) {
+    long long busyMillis = 0;
+    for (auto&& elem : writerStats["busyMillis"].Array()) {
+        busyMillis += elem.numberLong();
+    }
+    return busyMillis;
+}
+
+TEST_F(SyncTailTest, MultiApplyReportsWriterBusyAndBarrierWaitTime) {
+    // Relies on the same namespace hashing as
+    // MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceHash to give each op to a different
+    // writer.
+    NamespaceString slowNss("test.t0");
+    NamespaceString fastNss("test.t1");
+    OldThreadPool writerPool(2);
+
+    auto applyOperationFn =
+        [&slowNss](MultiApplier::OperationPtrs* operationsForWriterThreadToApply) -> Status {
+        if (operationsForWriterThreadToApply->front()->ns == slowNss.ns()) {
+            sleepmillis(200);
+        }
+        return Status::OK();
+    };
+
+    auto op1 =
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(1), 0), 1LL}, slowNss, BSON("x" << 1));
+    auto op2 =
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(2), 0), 1LL}, fastNss, BSON("x" << 2));
+
+    const BSONObj statsBefore = getWriterApplyStats();
+    unittest::assertGet(multiApply(_opCtx.get(), &writerPool, {op1, op2}, applyOperationFn));
+    const BSONObj statsAfter = getWriterApplyStats();
+
+    ASSERT_EQUALS(2U, statsAfter["busyMillis"].Array().size());
+
+    // The slow writer was busy for the whole batch, while the fast one waited for it at the end.
+    ASSERT_GREATER_THAN_OR_EQUALS(sumBusyMillis(statsAfter) - sumBusyMillis(statsBefore), 190);
+    ASSERT_GREATER_THAN_OR_EQUALS(statsAfter["batchBarrierWaitMillis"].numberLong() -
+                                      statsBefore["batchBarrierWaitMillis"].numberLong(),
+                                  150);
+}
+
 TEST_F(SyncTailTest, MultiSyncApplyUsesSyncApplyToApplyOperation) {
     NamespaceString nss("local." + _agent.getSuiteName() + "_" + _agent.getTestName());
     auto op = makeCreateCollectionOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss);
@@ -373,7 +373,9 @@ void Balancer::_mainThread() {
                 LOG(1) << "*** start balancing round. "
                        << "waitForDelete: " << balancerConfig->waitForDelete()
                        << ", secondaryThrottle: "
-                       << balancerConfig->getSecondaryThrottle().toBSON();
+                       << balancerConfig->getSecondaryThrottle().toBSON()
+                       << ", maxConcurrentMigrationsPerShard: "
+                       << balancerConfig->getMaxConcurrentMigrationsPerShard();
 
                 OCCASIONALLY warnOnMultiVersion(
                     uassertStatusOK(_clusterStats->getStats(opCtx.get())));
@@ -37,6 +37,8 @@
 
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj_comparator_interface.h"
+#include "mongo/db/s/balancer/cluster_statistics.h"
+#include "mongo/s/balancer_configuration.h"
 #include "mongo/s/catalog/sharding_catalog_client.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/catalog/type_collection.h"
@@ -71,9 +73,7 @@ StatusWith<DistributionStatus> createCollectionDistributionStatus(
         shardToChunksMap[stat.shardId];
     }
 
-    for (const auto& entry : chunkMgr->chunkMap()) {
-        const auto& chunkEntry = entry.second;
-
+    for (const auto& chunkEntry : chunkMgr->chunkMap()) {
         ChunkType chunk;
         chunk.setNS(chunkMgr->getns());
         chunk.setMin(chunkEntry->getMin());
@@ -261,7 +261,12 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
     }
 
     MigrateInfoVector candidateChunks;
-    std::set<ShardId> usedShards;
+    const int maxRecipientReplicationLagSecs = balancerMaxRecipientReplicationLagSecs.load();
+
+    UsedShards usedShards(
+        Grid::get(opCtx)->getBalancerConfiguration()->getMaxConcurrentMigrationsPerShard(),
+        maxRecipientReplicationLagSecs > 0 ? Milliseconds(Seconds(maxRecipientReplicationLagSecs))
+                                           : Milliseconds::max());
 
     std::shuffle(collections.begin(), collections.end(), _random);
 
@@ -423,7 +428,7 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
     const NamespaceString& nss,
     const ShardStatisticsVector& shardStats,
     bool aggressiveBalanceHint,
-    std::set<ShardId>* usedShards) {
+    UsedShards* usedShards) {
     auto routingInfoStatus =
         Grid::get(opCtx)->catalogCache()->getShardedCollectionRoutingInfoWithRefresh(opCtx, nss);
     if (!routingInfoStatus.isOK()) {
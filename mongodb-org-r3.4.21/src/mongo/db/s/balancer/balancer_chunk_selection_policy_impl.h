@@ -69,7 +69,7 @@ private:
         const NamespaceString& nss,
         const ShardStatisticsVector& shardStats,
         bool aggressiveBalanceHint,
-        std::set<ShardId>* usedShards);
+        UsedShards* usedShards);
 
     // Source for obtaining cluster statistics. Not owned and must not be destroyed before the
     // policy object is destroyed.
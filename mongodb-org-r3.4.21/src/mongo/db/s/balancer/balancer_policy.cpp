@@ -32,6 +32,8 @@
 
 #include "mongo/db/s/balancer/balancer_policy.h"
 
+#include <algorithm>
+
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/catalog/type_tags.h"
 #include "mongo/util/log.h"
@@ -52,6 +54,48 @@ namespace {
 const size_t kDefaultImbalanceThreshold = 2;
 const size_t kAggressiveImbalanceThreshold = 1;
 
+/**
+ * Returns whether the specified chunk is already the subject of one of 'migrations'.
+ */
+bool isChunkSelectedForMigration(const vector<MigrateInfo>& migrations, const ChunkType& chunk) {
+    return std::any_of(
+        migrations.begin(), migrations.end(), [&chunk](const MigrateInfo& migrateInfo) {
+            return migrateInfo.ns == chunk.getNS() &&
+                SimpleBSONObjComparator::kInstance.evaluate(migrateInfo.minKey == chunk.getMin());
+        });
+}
+
+/**
+ * Returns the number of chunks with the specified tag (or of all chunks if 'tag' is not set), which
+ * the shard will own once all of the already selected 'migrations' complete.
+ */
+size_t numberOfChunksAfterMigrations(const DistributionStatus& distribution,
+                                     const vector<MigrateInfo>& migrations,
+                                     const ShardId& shardId,
+                                     const boost::optional<string>& tag) {
+    size_t numChunks = (tag ? distribution.numberOfChunksInShardWithTag(shardId, *tag)
+                            : distribution.numberOfChunksInShard(shardId));
+
+    for (const auto& migrateInfo : migrations) {
+        if (migrateInfo.from != shardId && migrateInfo.to != shardId)
+            continue;
+
+        if (tag &&
+            distribution.getTagForRange(ChunkRange(migrateInfo.minKey, migrateInfo.maxKey)) !=
+                *tag)
+            continue;
+
+        if (migrateInfo.from == shardId) {
+            invariant(numChunks > 0);
+            numChunks--;
+        } else {
+            numChunks++;
+        }
+    }
+
+    return numChunks;
+}
+
 }  // namespace
 
 DistributionStatus::DistributionStatus(NamespaceString nss, ShardToChunksMap shardToChunksMap)
@@ -149,8 +193,12 @@ Status DistributionStatus::addRangeToZone(const ZoneRange& range) {
 }
 
 string DistributionStatus::getTagForChunk(const ChunkType& chunk) const {
-    const auto minIntersect = _zoneRanges.upper_bound(chunk.getMin());
-    const auto maxIntersect = _zoneRanges.lower_bound(chunk.getMax());
+    return getTagForRange(ChunkRange(chunk.getMin(), chunk.getMax()));
+}
+
+string DistributionStatus::getTagForRange(const ChunkRange& range) const {
+    const auto minIntersect = _zoneRanges.upper_bound(range.getMin());
+    const auto maxIntersect = _zoneRanges.lower_bound(range.getMax());
 
     // We should never have a partial overlap with a chunk range. If it happens, treat it as if this
     // chunk doesn't belong to a tag
@@ -165,8 +213,8 @@ string DistributionStatus::getTagForChunk(const ChunkType& chunk) const {
     const ZoneRange& intersectRange = minIntersect->second;
 
     // Check for containment
-    if (SimpleBSONObjComparator::kInstance.evaluate(intersectRange.min <= chunk.getMin()) &&
-        SimpleBSONObjComparator::kInstance.evaluate(chunk.getMax() <= intersectRange.max)) {
+    if (SimpleBSONObjComparator::kInstance.evaluate(intersectRange.min <= range.getMin()) &&
+        SimpleBSONObjComparator::kInstance.evaluate(range.getMax() <= intersectRange.max)) {
         return intersectRange.zone;
     }
 
@@ -217,6 +265,43 @@ string DistributionStatus::toString() const {
     return builder.obj().toString();
 }
 
+UsedShards::UsedShards() = default;
+
+UsedShards::UsedShards(int maxMigrationsPerShard, Milliseconds maxRecipientReplicationLag)
+    : _maxMigrationsPerShard(maxMigrationsPerShard),
+      _maxRecipientReplicationLag(maxRecipientReplicationLag) {
+    invariant(_maxMigrationsPerShard > 0);
+}
+
+bool UsedShards::canDonate(const ShardId& shardId) const {
+    return numMigrations(shardId) < _maxMigrationsPerShard;
+}
+
+bool UsedShards::canReceive(const ClusterStatistics::ShardStatistics& stat,
+                            bool ignoreReplicationLag) const {
+    if (ignoreReplicationLag) {
+        return numMigrations(stat.shardId) < _maxMigrationsPerShard;
+    }
+
+    if (stat.replicationLag >= _maxRecipientReplicationLag) {
+        return false;
+    }
+
+    const int maxMigrations =
+        (stat.replicationLag > _maxRecipientReplicationLag / 2) ? 1 : _maxMigrationsPerShard;
+
+    return numMigrations(stat.shardId) < maxMigrations;
+}
+
+void UsedShards::add(const ShardId& shardId) {
+    _numMigrations[shardId]++;
+}
+
+int UsedShards::numMigrations(const ShardId& shardId) const {
+    auto it = _numMigrations.find(shardId);
+    return (it == _numMigrations.end()) ? 0 : it->second;
+}
+
 Status BalancerPolicy::isShardSuitableReceiver(const ClusterStatistics::ShardStatistics& stat,
                                                const string& chunkTag) {
     if (stat.isSizeMaxed()) {
@@ -240,12 +325,14 @@ Status BalancerPolicy::isShardSuitableReceiver(const ClusterStatistics::ShardSta
 ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector& shardStats,
                                                      const DistributionStatus& distribution,
                                                      const string& tag,
-                                                     const set<ShardId>& excludedShards) {
+                                                     const vector<MigrateInfo>& migrations,
+                                                     const UsedShards& usedShards,
+                                                     bool ignoreReplicationLag) {
     ShardId best;
     unsigned minChunks = numeric_limits<unsigned>::max();
 
     for (const auto& stat : shardStats) {
-        if (excludedShards.count(stat.shardId))
+        if (!usedShards.canReceive(stat, ignoreReplicationLag))
             continue;
 
         auto status = isShardSuitableReceiver(stat, tag);
@@ -253,7 +340,8 @@ ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector
             continue;
         }
 
-        unsigned myChunks = distribution.numberOfChunksInShard(stat.shardId);
+        unsigned myChunks =
+            numberOfChunksAfterMigrations(distribution, migrations, stat.shardId, boost::none);
         if (myChunks >= minChunks) {
             continue;
         }
@@ -268,16 +356,17 @@ ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector
 ShardId BalancerPolicy::_getMostOverloadedShard(const ShardStatisticsVector& shardStats,
                                                 const DistributionStatus& distribution,
                                                 const string& chunkTag,
-                                                const set<ShardId>& excludedShards) {
+                                                const vector<MigrateInfo>& migrations,
+                                                const UsedShards& usedShards) {
     ShardId worst;
     unsigned maxChunks = 0;
 
     for (const auto& stat : shardStats) {
-        if (excludedShards.count(stat.shardId))
+        if (!usedShards.canDonate(stat.shardId))
             continue;
 
         const unsigned shardChunkCount =
-            distribution.numberOfChunksInShardWithTag(stat.shardId, chunkTag);
+            numberOfChunksAfterMigrations(distribution, migrations, stat.shardId, chunkTag);
         if (shardChunkCount <= maxChunks)
             continue;
 
@@ -291,7 +380,7 @@ ShardId BalancerPolicy::_getMostOverloadedShard(const ShardStatisticsVector& sha
 vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardStats,
                                             const DistributionStatus& distribution,
                                             bool shouldAggressivelyBalance,
-                                            std::set<ShardId>* usedShards) {
+                                            UsedShards* usedShards) {
     vector<MigrateInfo> migrations;
 
     // 1) Check for shards, which are in draining mode
@@ -300,7 +389,7 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
             if (!stat.isDraining)
                 continue;
 
-            if (usedShards->count(stat.shardId))
+            if (!usedShards->canDonate(stat.shardId))
                 continue;
 
             const vector<ChunkType>& chunks = distribution.getChunks(stat.shardId);
@@ -319,10 +408,15 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
                     continue;
                 }
 
+                if (isChunkSelectedForMigration(migrations, chunk))
+                    continue;
+
                 const string tag = distribution.getTagForChunk(chunk);
 
-                const ShardId to =
-                    _getLeastLoadedReceiverShard(shardStats, distribution, tag, *usedShards);
+                // Draining is not throttled on the replication lag of the recipients, because
+                // nothing else would move the chunks off the shard which is being removed
+                const ShardId to = _getLeastLoadedReceiverShard(
+                    shardStats, distribution, tag, migrations, *usedShards, true);
                 if (!to.isValid()) {
                     if (migrations.empty()) {
                         warning() << "Chunk " << redact(chunk.toString())
@@ -333,9 +427,11 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
 
                 invariant(to != stat.shardId);
                 migrations.emplace_back(to, chunk);
-                invariant(usedShards->insert(stat.shardId).second);
-                invariant(usedShards->insert(to).second);
-                break;
+                usedShards->add(stat.shardId);
+                usedShards->add(to);
+
+                if (!usedShards->canDonate(stat.shardId))
+                    break;
             }
 
             if (migrations.empty()) {
@@ -348,12 +444,15 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
     // 2) Check for chunks, which are on the wrong shard and must be moved off of it
     if (!distribution.tags().empty()) {
         for (const auto& stat : shardStats) {
-            if (usedShards->count(stat.shardId))
+            if (!usedShards->canDonate(stat.shardId))
                 continue;
 
             const vector<ChunkType>& chunks = distribution.getChunks(stat.shardId);
 
             for (const auto& chunk : chunks) {
+                if (isChunkSelectedForMigration(migrations, chunk))
+                    continue;
+
                 const string tag = distribution.getTagForChunk(chunk);
 
                 if (tag.empty())
@@ -368,8 +467,8 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
                     continue;
                 }
 
-                const ShardId to =
-                    _getLeastLoadedReceiverShard(shardStats, distribution, tag, *usedShards);
+                const ShardId to = _getLeastLoadedReceiverShard(
+                    shardStats, distribution, tag, migrations, *usedShards, false);
                 if (!to.isValid()) {
                     if (migrations.empty()) {
                         warning() << "Chunk " << redact(chunk.toString()) << " violates zone "
@@ -380,9 +479,11 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
 
                 invariant(to != stat.shardId);
                 migrations.emplace_back(to, chunk);
-                invariant(usedShards->insert(stat.shardId).second);
-                invariant(usedShards->insert(to).second);
-                break;
+                usedShards->add(stat.shardId);
+                usedShards->add(to);
+
+                if (!usedShards->canDonate(stat.shardId))
+                    break;
             }
         }
     }
@@ -443,8 +544,8 @@ boost::optional<MigrateInfo> BalancerPolicy::balanceSingleChunk(
     const DistributionStatus& distribution) {
     const string tag = distribution.getTagForChunk(chunk);
 
-    ShardId newShardId =
-        _getLeastLoadedReceiverShard(shardStats, distribution, tag, set<ShardId>());
+    ShardId newShardId = _getLeastLoadedReceiverShard(
+        shardStats, distribution, tag, vector<MigrateInfo>(), UsedShards(), false);
     if (!newShardId.isValid() || newShardId == chunk.getShard()) {
         return boost::optional<MigrateInfo>();
     }
@@ -458,18 +559,20 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
                                         size_t idealNumberOfChunksPerShardForTag,
                                         size_t imbalanceThreshold,
                                         vector<MigrateInfo>* migrations,
-                                        set<ShardId>* usedShards) {
-    const ShardId from = _getMostOverloadedShard(shardStats, distribution, tag, *usedShards);
+                                        UsedShards* usedShards) {
+    const ShardId from =
+        _getMostOverloadedShard(shardStats, distribution, tag, *migrations, *usedShards);
     if (!from.isValid())
         return false;
 
-    const size_t max = distribution.numberOfChunksInShardWithTag(from, tag);
+    const size_t max = numberOfChunksAfterMigrations(distribution, *migrations, from, tag);
 
     // Do not use a shard if it already has less entries than the optimal per-shard chunk count
     if (max <= idealNumberOfChunksPerShardForTag)
         return false;
 
-    const ShardId to = _getLeastLoadedReceiverShard(shardStats, distribution, tag, *usedShards);
+    const ShardId to = _getLeastLoadedReceiverShard(
+        shardStats, distribution, tag, *migrations, *usedShards, false);
     if (!to.isValid()) {
         if (migrations->empty()) {
             log() << "No available shards to take chunks for zone [" << tag << "]";
@@ -477,7 +580,7 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
         return false;
     }
 
-    const size_t min = distribution.numberOfChunksInShardWithTag(to, tag);
+    const size_t min = numberOfChunksAfterMigrations(distribution, *migrations, to, tag);
 
     // Do not use a shard if it already has more entries than the optimal per-shard chunk count
     if (min >= idealNumberOfChunksPerShardForTag)
@@ -509,9 +612,12 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
             continue;
         }
 
+        if (isChunkSelectedForMigration(*migrations, chunk))
+            continue;
+
         migrations->emplace_back(to, chunk);
-        invariant(usedShards->insert(chunk.getShard()).second);
-        invariant(usedShards->insert(to).second);
+        usedShards->add(chunk.getShard());
+        usedShards->add(to);
         return true;
     }
 
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <map>
 #include <set>
 #include <vector>
 
@@ -37,6 +38,7 @@
 #include "mongo/db/s/balancer/cluster_statistics.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/shard_id.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -138,6 +140,7 @@ public:
      * specified chunk. If the chunk doesn't fall into any tag returns the empty string.
      */
     std::string getTagForChunk(const ChunkType& chunk) const;
+    std::string getTagForRange(const ChunkRange& range) const;
 
     /**
      * Returns a BSON/string representation of this distribution status.
@@ -159,6 +162,56 @@ private:
     std::set<std::string> _allTags;
 };
 
+/**
+ * Keeps track of the number of migrations, which each shard has been selected to take part in
+ * (either as a donor or as a recipient) over the course of a single balancer round, so that no
+ * shard is given more migrations than it is allowed to handle.
+ */
+class UsedShards {
+public:
+    /**
+     * Allows each shard to take part in a single migration and does not take replication lag into
+     * account.
+     */
+    UsedShards();
+
+    /**
+     * Allows each shard to take part in up to 'maxMigrationsPerShard' migrations. Recipients whose
+     * replication lag has reached 'maxRecipientReplicationLag' are not given any chunks and the
+     * ones which are lagging by more than half of it are limited to a single migration.
+     */
+    UsedShards(int maxMigrationsPerShard, Milliseconds maxRecipientReplicationLag);
+
+    /**
+     * Returns whether the specified shard can donate one more chunk.
+     */
+    bool canDonate(const ShardId& shardId) const;
+
+    /**
+     * Returns whether the shard with the specified statistics can receive one more chunk. Chunks
+     * moved off draining shards pass 'ignoreReplicationLag' so that they are not throttled.
+     */
+    bool canReceive(const ClusterStatistics::ShardStatistics& stat,
+                    bool ignoreReplicationLag) const;
+
+    /**
+     * Records that the specified shard will take part in one more migration.
+     */
+    void add(const ShardId& shardId);
+
+    /**
+     * Returns the number of migrations in which the specified shard has been selected to take part.
+     */
+    int numMigrations(const ShardId& shardId) const;
+
+private:
+    int _maxMigrationsPerShard{1};
+
+    Milliseconds _maxRecipientReplicationLag{Milliseconds::max()};
+
+    std::map<ShardId, int> _numMigrations;
+};
+
 class BalancerPolicy {
 public:
     /**
@@ -173,8 +226,8 @@ public:
      * Returns a suggested set of chunks to move whithin a collection's shards, given the specified
      * state of the shards (draining, max size reached, etc) and the number of chunks for that
      * collection. If the policy doesn't recommend anything to move, it returns an empty vector. The
-     * entries in the vector do are all for separate source/destination shards and as such do not
-     * need to be done serially and can be scheduled in parallel.
+     * same shard may appear in as many entries as 'usedShards' allows it to, so entries which share
+     * a shard must not be executed at the same time.
      *
      * The balancing logic calculates the optimum number of chunks per shard for each zone and if
      * any of the shards have chunks, which are sufficiently higher than this number, suggests
@@ -183,14 +236,13 @@ public:
      * The shouldAggressivelyBalance parameter causes the threshold for chunk could disparity
      * between shards to be lowered.
      *
-     * The usedShards parameter is in/out and it contains the set of shards, which have already been
-     * used for migrations. Used so we don't return multiple conflicting migrations for the same
-     * shard.
+     * The usedShards parameter is in/out and it tracks the migrations, which each shard has already
+     * been selected for. Used so we don't return more migrations for a shard than it is allowed.
      */
     static std::vector<MigrateInfo> balance(const ShardStatisticsVector& shardStats,
                                             const DistributionStatus& distribution,
                                             bool shouldAggressivelyBalance,
-                                            std::set<ShardId>* usedShards);
+                                            UsedShards* usedShards);
 
     /**
      * Using the specified distribution information, returns a suggested better location for the
@@ -202,22 +254,26 @@ public:
 
 private:
     /**
-     * Return the shard with the specified tag, which has the least number of chunks. If the tag is
-     * empty, considers all shards.
+     * Return the shard with the specified tag, which has the least number of chunks once the
+     * already selected 'migrations' complete. If the tag is empty, considers all shards. The
+     * replication lag of the candidates is not taken into account if 'ignoreReplicationLag' is set.
      */
     static ShardId _getLeastLoadedReceiverShard(const ShardStatisticsVector& shardStats,
                                                 const DistributionStatus& distribution,
                                                 const std::string& tag,
-                                                const std::set<ShardId>& excludedShards);
+                                                const std::vector<MigrateInfo>& migrations,
+                                                const UsedShards& usedShards,
+                                                bool ignoreReplicationLag);
 
     /**
-     * Return the shard which has the least number of chunks with the specified tag. If the tag is
-     * empty, considers all chunks.
+     * Return the shard which has the most chunks with the specified tag once the already selected
+     * 'migrations' complete. If the tag is empty, considers all chunks.
      */
     static ShardId _getMostOverloadedShard(const ShardStatisticsVector& shardStats,
                                            const DistributionStatus& distribution,
                                            const std::string& chunkTag,
-                                           const std::set<ShardId>& excludedShards);
+                                           const std::vector<MigrateInfo>& migrations,
+                                           const UsedShards& usedShards);
 
     /**
      * Selects one chunk for the specified zone (if appropriate) to be moved in order to bring the
@@ -237,7 +293,7 @@ private:
                                    size_t idealNumberOfChunksPerShardForTag,
                                    size_t imbalanceThreshold,
                                    std::vector<MigrateInfo>* migrations,
-                                   std::set<ShardId>* usedShards);
+                                   UsedShards* usedShards);
 };
 
 }  // namespace mongo
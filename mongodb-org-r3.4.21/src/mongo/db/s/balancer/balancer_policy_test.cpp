@@ -113,7 +113,7 @@ std::pair<ShardStatisticsVector, ShardToChunksMap> generateCluster(
 std::vector<MigrateInfo> balanceChunks(const ShardStatisticsVector& shardStats,
                                        const DistributionStatus& distribution,
                                        bool shouldAggressivelyBalance) {
-    std::set<ShardId> usedShards;
+    UsedShards usedShards;
     return BalancerPolicy::balance(
         shardStats, distribution, shouldAggressivelyBalance, &usedShards);
 }
@@ -243,7 +243,8 @@ TEST(BalancerPolicy, ParallelBalancingNotSchedulingOnInUseSourceShardsWithMoveNe
          {ShardStatistics(kShardId3, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
 
     // Here kShardId0 would have been selected as a donor
-    std::set<ShardId> usedShards{kShardId0};
+    UsedShards usedShards;
+    usedShards.add(kShardId0);
     const auto migrations(BalancerPolicy::balance(
         cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
     ASSERT_EQ(1U, migrations.size());
@@ -262,7 +263,8 @@ TEST(BalancerPolicy, ParallelBalancingNotSchedulingOnInUseSourceShardsWithMoveNo
          {ShardStatistics(kShardId3, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
 
     // Here kShardId0 would have been selected as a donor
-    std::set<ShardId> usedShards{kShardId0};
+    UsedShards usedShards;
+    usedShards.add(kShardId0);
     const auto migrations(BalancerPolicy::balance(
         cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
     ASSERT_EQ(0U, migrations.size());
@@ -276,7 +278,8 @@ TEST(BalancerPolicy, ParallelBalancingNotSchedulingOnInUseDestinationShards) {
          {ShardStatistics(kShardId3, kNoMaxSize, 1, false, emptyTagSet, emptyShardVersion), 1}});
 
     // Here kShardId2 would have been selected as a recipient
-    std::set<ShardId> usedShards{kShardId2};
+    UsedShards usedShards;
+    usedShards.add(kShardId2);
     const auto migrations(BalancerPolicy::balance(
         cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
     ASSERT_EQ(1U, migrations.size());
@@ -287,6 +290,131 @@ TEST(BalancerPolicy, ParallelBalancingNotSchedulingOnInUseDestinationShards) {
     ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMax(), migrations[0].maxKey);
 }
 
+TEST(BalancerPolicy, ParallelBalancingMultipleMigrationsPerShard) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8},
+         {ShardStatistics(kShardId1, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8},
+         {ShardStatistics(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId3, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    UsedShards usedShards(2, Seconds(10));
+    const auto migrations(BalancerPolicy::balance(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+    ASSERT_EQ(4U, migrations.size());
+
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId2, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMin(), migrations[0].minKey);
+
+    ASSERT_EQ(kShardId1, migrations[1].from);
+    ASSERT_EQ(kShardId3, migrations[1].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId1][0].getMin(), migrations[1].minKey);
+
+    ASSERT_EQ(kShardId0, migrations[2].from);
+    ASSERT_EQ(kShardId2, migrations[2].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), migrations[2].minKey);
+
+    ASSERT_EQ(kShardId1, migrations[3].from);
+    ASSERT_EQ(kShardId3, migrations[3].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId1][1].getMin(), migrations[3].minKey);
+
+    for (const auto& shardId : {kShardId0, kShardId1, kShardId2, kShardId3}) {
+        ASSERT_EQ(2, usedShards.numMigrations(shardId));
+    }
+}
+
+TEST(BalancerPolicy, ParallelBalancingDoesNotMoveMoreChunksThanNecessary) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 5},
+         {ShardStatistics(kShardId1, kNoMaxSize, 3, false, emptyTagSet, emptyShardVersion), 3}});
+
+    UsedShards usedShards(10, Seconds(10));
+    const auto migrations(BalancerPolicy::balance(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+    ASSERT_EQ(1U, migrations.size());
+
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+}
+
+TEST(BalancerPolicy, LaggingRecipientNotSelected) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId2, kNoMaxSize, 1, false, emptyTagSet, emptyShardVersion), 1}});
+    cluster.first[1].replicationLag = Seconds(10);
+
+    UsedShards usedShards(1, Seconds(10));
+    const auto migrations(BalancerPolicy::balance(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+    ASSERT_EQ(1U, migrations.size());
+
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId2, migrations[0].to);
+}
+
+TEST(BalancerPolicy, SomewhatLaggingRecipientGetsSingleMigration) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    {
+        UsedShards usedShards(3, Seconds(10));
+        const auto migrations(BalancerPolicy::balance(
+            cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+        ASSERT_EQ(3U, migrations.size());
+    }
+
+    cluster.first[1].replicationLag = Seconds(6);
+
+    {
+        UsedShards usedShards(3, Seconds(10));
+        const auto migrations(BalancerPolicy::balance(
+            cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+        ASSERT_EQ(1U, migrations.size());
+
+        ASSERT_EQ(kShardId0, migrations[0].from);
+        ASSERT_EQ(kShardId1, migrations[0].to);
+    }
+}
+
+TEST(BalancerPolicy, DrainingIgnoresRecipientReplicationLag) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, true, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+    cluster.first[1].replicationLag = Seconds(10);
+
+    UsedShards usedShards(2, Seconds(10));
+    const auto migrations(BalancerPolicy::balance(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+    ASSERT_EQ(2U, migrations.size());
+
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_EQ(kShardId0, migrations[1].from);
+    ASSERT_EQ(kShardId1, migrations[1].to);
+}
+
+TEST(BalancerPolicy, DrainingShardDonatesMultipleChunksPerRound) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, true, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    UsedShards usedShards(2, Seconds(10));
+    const auto migrations(BalancerPolicy::balance(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false, &usedShards));
+    ASSERT_EQ(2U, migrations.size());
+
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMin(), migrations[0].minKey);
+
+    ASSERT_EQ(kShardId0, migrations[1].from);
+    ASSERT_EQ(kShardId2, migrations[1].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), migrations[1].minKey);
+}
+
 TEST(BalancerPolicy, JumboChunksNotMoved) {
     auto cluster = generateCluster(
         {{ShardStatistics(kShardId0, kNoMaxSize, 2, false, emptyTagSet, emptyShardVersion), 4},
@@ -32,9 +32,16 @@
 
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
 
+// Recipient shards whose majority commit point trails the primary by this many seconds or more are
+// not given any chunks, and the ones trailing by more than half of it are given at most one chunk
+// per round. Chunks moved off draining shards are never throttled. 0 or negative values (the
+// default) disable the throttling and the collection of the shards' replication lag.
+MONGO_EXPORT_SERVER_PARAMETER(balancerMaxRecipientReplicationLagSecs, int, 0);
+
 ClusterStatistics::ClusterStatistics() = default;
 
 ClusterStatistics::~ClusterStatistics() = default;
@@ -72,6 +79,7 @@ BSONObj ClusterStatistics::ShardStatistics::toBSON() const {
     }
 
     builder.append("version", mongoVersion);
+    builder.append("replicationLagMillis", durationCount<Milliseconds>(replicationLag));
     return builder.obj();
 }
 
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -35,6 +36,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/s/client/shard.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -43,6 +45,12 @@ class OperationContext;
 template <typename T>
 class StatusWith;
 
+/**
+ * Replication lag in seconds at which the balancer stops giving chunks to a recipient shard. The
+ * shards' replication lag is only collected while this is positive.
+ */
+extern std::atomic<int> balancerMaxRecipientReplicationLagSecs;  // NOLINT
+
 /**
  * This interface serves as means for obtaining data distribution and shard utilization statistics
  * for the entire sharded cluster. Implementations may choose whatever means necessary to perform
@@ -92,6 +100,10 @@ public:
 
         // Version of mongod, which runs on this shard's primary
         std::string mongoVersion;
+
+        // How far behind the shard primary its majority commit point is. Zero if the shard is not
+        // a replica set, if the lag could not be obtained or if it is not being collected.
+        Milliseconds replicationLag{0};
     };
 
     virtual ~ClusterStatistics();
@@ -53,6 +53,10 @@ using std::vector;
 namespace {
 
 const char kVersionField[] = "version";
+const char kOpTimesField[] = "optimes";
+const char kAppliedOpTimeField[] = "appliedOpTime";
+const char kLastCommittedOpTimeField[] = "lastCommittedOpTime";
+const char kOpTimeTimestampField[] = "ts";
 
 /**
  * Executes the serverStatus command against the specified shard and obtains the version of the
@@ -94,6 +98,97 @@ StatusWith<string> retrieveShardMongoDVersion(OperationContext* txn, ShardId sha
     return version;
 }
 
+/**
+ * Extracts the timestamp of an optime reported by replSetGetStatus, which is a plain timestamp
+ * under protocol version 0 and a {ts, t} document under protocol version 1.
+ */
+StatusWith<Timestamp> extractOpTimeTimestamp(const BSONObj& optimes, StringData fieldName) {
+    BSONElement opTimeElem;
+    Status status = bsonExtractField(optimes, fieldName, &opTimeElem);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    if (opTimeElem.type() == bsonTimestamp) {
+        return opTimeElem.timestamp();
+    }
+
+    if (opTimeElem.type() == Object) {
+        Timestamp ts;
+        status = bsonExtractTimestampField(opTimeElem.Obj(), kOpTimeTimestampField, &ts);
+        if (!status.isOK()) {
+            return status;
+        }
+        return ts;
+    }
+
+    return {ErrorCodes::TypeMismatch,
+            str::stream() << "\"" << fieldName << "\" had the wrong type: " << opTimeElem};
+}
+
+/**
+ * Executes the replSetGetStatus command against the specified shard and computes by how much the
+ * majority commit point trails the last operation applied on the primary. Unlike the lag of the
+ * individual secondaries, this does not count hidden or delayed members, which the majority does
+ * not need to wait for.
+ *
+ * Returns the replication lag or an error. Known error codes are:
+ *  ShardNotFound if shard by that id is not available on the registry
+ *  NoReplicationEnabled if the shard is not running as a replica set
+ *  NoSuchKey if the optimes could not be retrieved
+ */
+StatusWith<Milliseconds> retrieveShardReplicationLag(OperationContext* txn, ShardId shardId) {
+    auto shardRegistry = Grid::get(txn)->shardRegistry();
+    auto shardStatus = shardRegistry->getShard(txn, shardId);
+    if (!shardStatus.isOK()) {
+        return shardStatus.getStatus();
+    }
+    auto shard = shardStatus.getValue();
+
+    auto commandResponse =
+        shard->runCommandWithFixedRetryAttempts(txn,
+                                                ReadPreferenceSetting{ReadPreference::PrimaryOnly},
+                                                "admin",
+                                                BSON("replSetGetStatus" << 1),
+                                                Shard::RetryPolicy::kIdempotent);
+    if (!commandResponse.isOK()) {
+        return commandResponse.getStatus();
+    }
+    if (!commandResponse.getValue().commandStatus.isOK()) {
+        return commandResponse.getValue().commandStatus;
+    }
+
+    BSONObj replSetStatus = std::move(commandResponse.getValue().response);
+
+    BSONElement optimesElem;
+    Status status = bsonExtractTypedField(replSetStatus, kOpTimesField, Object, &optimesElem);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    auto appliedStatus = extractOpTimeTimestamp(optimesElem.Obj(), kAppliedOpTimeField);
+    if (!appliedStatus.isOK()) {
+        return appliedStatus.getStatus();
+    }
+
+    auto committedStatus = extractOpTimeTimestamp(optimesElem.Obj(), kLastCommittedOpTimeField);
+    if (!committedStatus.isOK()) {
+        return committedStatus.getStatus();
+    }
+
+    const Timestamp& applied = appliedStatus.getValue();
+    const Timestamp& committed = committedStatus.getValue();
+
+    // A null commit point means that the shard has not yet established one, so there is nothing to
+    // measure the lag against
+    if (committed.isNull() || committed >= applied) {
+        return Milliseconds(0);
+    }
+
+    return Milliseconds(
+        Seconds(static_cast<long long>(applied.getSecs()) - committed.getSecs()));
+}
+
 }  // namespace
 
 using ShardStatistics = ClusterStatistics::ShardStatistics;
@@ -163,6 +258,21 @@ StatusWith<vector<ShardStatistics>> ClusterStatisticsImpl::getStats(OperationCon
                            shard.getDraining(),
                            std::move(shardTags),
                            std::move(mongoDVersion));
+
+        // The replication lag is only used to throttle migrations towards lagging recipients, so
+        // it is not collected while the throttling is disabled and failure to obtain it should not
+        // fail the round either
+        if (balancerMaxRecipientReplicationLagSecs.load() <= 0) {
+            continue;
+        }
+
+        auto replicationLagStatus = retrieveShardReplicationLag(txn, shard.getName());
+        if (replicationLagStatus.isOK()) {
+            stats.back().replicationLag = replicationLagStatus.getValue();
+        } else if (replicationLagStatus != ErrorCodes::NoReplicationEnabled) {
+            LOG(1) << "Unable to obtain replication lag for " << shard.getName()
+                   << causedBy(replicationLagStatus.getStatus());
+        }
     }
 
     return stats;
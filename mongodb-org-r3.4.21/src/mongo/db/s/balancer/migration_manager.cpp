@@ -32,7 +32,9 @@
 
 #include "mongo/db/s/balancer/migration_manager.h"
 
+#include <algorithm>
 #include <memory>
+#include <set>
 
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/bson/util/bson_extract.h"
@@ -149,48 +151,100 @@ MigrationStatuses MigrationManager::executeMigrationsForAutoBalance(
     vector<MigrateInfo> rescheduledMigrations;
 
     {
+        using MigrationResponse =
+            std::pair<shared_ptr<Notification<RemoteCommandResponse>>, MigrateInfo>;
+
         std::map<MigrationIdentifier, ScopedMigrationRequest> scopedMigrationRequests;
-        vector<std::pair<shared_ptr<Notification<RemoteCommandResponse>>, MigrateInfo>> responses;
-
-        for (const auto& migrateInfo : migrateInfos) {
-            // Write a document to the config.migrations collection, in case this migration must be
-            // recovered by the Balancer. Fail if the chunk is already moving.
-            auto statusWithScopedMigrationRequest =
-                ScopedMigrationRequest::writeMigration(opCtx, migrateInfo, waitForDelete);
-            if (!statusWithScopedMigrationRequest.isOK()) {
-                migrationStatuses.emplace(migrateInfo.getName(),
-                                          std::move(statusWithScopedMigrationRequest.getStatus()));
-                continue;
+        std::list<MigrationResponse> responses;
+
+        // A shard can only donate or receive one chunk at a time, so migrations which share a
+        // shard with an active migration are kept pending until that migration completes.
+        std::list<MigrateInfo> pendingMigrations(migrateInfos.begin(), migrateInfos.end());
+        std::set<ShardId> busyShards;
+
+        while (true) {
+            for (auto itPending = pendingMigrations.begin();
+                 itPending != pendingMigrations.end();) {
+                const auto& migrateInfo = *itPending;
+                if (busyShards.count(migrateInfo.from) || busyShards.count(migrateInfo.to)) {
+                    ++itPending;
+                    continue;
+                }
+
+                // Write a document to the config.migrations collection, in case this migration
+                // must be recovered by the Balancer. Fail if the chunk is already moving.
+                auto statusWithScopedMigrationRequest =
+                    ScopedMigrationRequest::writeMigration(opCtx, migrateInfo, waitForDelete);
+                if (!statusWithScopedMigrationRequest.isOK()) {
+                    migrationStatuses.emplace(
+                        migrateInfo.getName(),
+                        std::move(statusWithScopedMigrationRequest.getStatus()));
+                    itPending = pendingMigrations.erase(itPending);
+                    continue;
+                }
+                scopedMigrationRequests.emplace(
+                    migrateInfo.getName(), std::move(statusWithScopedMigrationRequest.getValue()));
+
+                responses.emplace_back(
+                    _schedule(opCtx,
+                              migrateInfo,
+                              false,  // Config server takes the collection dist lock
+                              maxChunkSizeBytes,
+                              secondaryThrottle,
+                              waitForDelete),
+                    migrateInfo);
+
+                busyShards.insert(migrateInfo.from);
+                busyShards.insert(migrateInfo.to);
+                itPending = pendingMigrations.erase(itPending);
             }
-            scopedMigrationRequests.emplace(migrateInfo.getName(),
-                                            std::move(statusWithScopedMigrationRequest.getValue()));
 
-            responses.emplace_back(_schedule(opCtx,
-                                             migrateInfo,
-                                             false,  // Config server takes the collection dist lock
-                                             maxChunkSizeBytes,
-                                             secondaryThrottle,
-                                             waitForDelete),
-                                   migrateInfo);
-        }
+            if (responses.empty()) {
+                invariant(pendingMigrations.empty());
+                break;
+            }
+
+            // Wait for at least one of the scheduled migrations to complete
+            {
+                stdx::unique_lock<stdx::mutex> lock(_mutex);
+                _condVar.wait(lock, [&responses] {
+                    return std::any_of(responses.begin(),
+                                       responses.end(),
+                                       [](const MigrationResponse& response) {
+                                           return static_cast<bool>(*response.first);
+                                       });
+                });
+            }
 
-        // Wait for all the scheduled migrations to complete and note the ones, which failed with a
-        // LockBusy error code. These need to be executed serially, without the distributed lock
-        // being held by the config server for backwards compatibility with 3.2 shards.
-        for (auto& response : responses) {
-            auto notification = std::move(response.first);
-            auto migrateInfo = std::move(response.second);
-
-            const auto& remoteCommandResponse = notification->get();
-
-            auto it = scopedMigrationRequests.find(migrateInfo.getName());
-            invariant(it != scopedMigrationRequests.end());
-            Status commandStatus =
-                _processRemoteCommandResponse(remoteCommandResponse, &it->second);
-            if (commandStatus == ErrorCodes::LockBusy) {
-                rescheduledMigrations.emplace_back(std::move(migrateInfo));
-            } else {
-                migrationStatuses.emplace(migrateInfo.getName(), std::move(commandStatus));
+            // Process the completed migrations and note the ones, which failed with a LockBusy
+            // error code. These need to be executed serially, without the distributed lock being
+            // held by the config server for backwards compatibility with 3.2 shards.
+            for (auto itResponse = responses.begin(); itResponse != responses.end();) {
+                auto& notification = itResponse->first;
+                if (!*notification) {
+                    ++itResponse;
+                    continue;
+                }
+
+                auto migrateInfo = std::move(itResponse->second);
+
+                const auto& remoteCommandResponse = notification->get();
+
+                auto it = scopedMigrationRequests.find(migrateInfo.getName());
+                invariant(it != scopedMigrationRequests.end());
+                Status commandStatus =
+                    _processRemoteCommandResponse(remoteCommandResponse, &it->second);
+                scopedMigrationRequests.erase(it);
+
+                if (commandStatus == ErrorCodes::LockBusy) {
+                    rescheduledMigrations.emplace_back(migrateInfo);
+                } else {
+                    migrationStatuses.emplace(migrateInfo.getName(), std::move(commandStatus));
+                }
+
+                busyShards.erase(migrateInfo.from);
+                busyShards.erase(migrateInfo.to);
+                itResponse = responses.erase(itResponse);
             }
         }
     }
@@ -677,6 +731,7 @@ void MigrationManager::_completeWithDistLock_inlock(
     }
 
     notificationToSignal->set(remoteCommandResponse);
+    _condVar.notify_all();
 }
 
 void MigrationManager::_scheduleWithoutDistLock_inlock(OperationContext* opCtx,
@@ -703,6 +758,7 @@ void MigrationManager::_scheduleWithoutDistLock_inlock(OperationContext* opCtx,
                 _checkDrained_inlock();
 
                 notificationToSignal->set(args.response);
+                _condVar.notify_all();
             });
 
     if (callbackHandleWithStatus.isOK()) {
@@ -716,6 +772,7 @@ void MigrationManager::_scheduleWithoutDistLock_inlock(OperationContext* opCtx,
     _checkDrained_inlock();
 
     notificationToSignal->set(std::move(callbackHandleWithStatus.getStatus()));
+    _condVar.notify_all();
 }
 
 void MigrationManager::_checkDrained_inlock() {
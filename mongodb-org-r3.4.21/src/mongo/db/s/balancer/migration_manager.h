@@ -75,6 +75,10 @@ public:
      * "candidateMigrations" and wait for them to complete. Takes the distributed lock for each
      * collection with a chunk being migrated.
      *
+     * Since a shard can only take part in one migration at a time, migrations which share a donor
+     * or recipient shard are executed one after the other, each being scheduled as soon as the
+     * shards it needs become free.
+     *
      * If any of the migrations, which were scheduled in parallel fails with a LockBusy error
      * reported from the shard, retries it serially without the distributed lock.
      *
@@ -301,7 +305,8 @@ private:
     State _state{State::kStopped};
 
     // Condition variable, which is waited on when the migration manager's state is changing and
-    // signaled when the state change is complete.
+    // signaled when the state change is complete. It is also signaled whenever a scheduled
+    // migration completes.
     stdx::condition_variable _condVar;
 
     // Holds information about each collection's distributed lock and active migrations via a
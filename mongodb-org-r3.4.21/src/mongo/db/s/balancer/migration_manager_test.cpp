@@ -341,6 +341,55 @@ TEST_F(MigrationManagerTest, OneCollectionTwoMigrations) {
     future.timed_get(kFutureTimeout);
 }
 
+TEST_F(MigrationManagerTest, OneCollectionTwoMigrationsBetweenTheSameShards) {
+    // Set up two shards in the metadata.
+    ASSERT_OK(catalogClient()->insertConfigDocument(
+        operationContext(), ShardType::ConfigNS, kShard0, kMajorityWriteConcern));
+    ASSERT_OK(catalogClient()->insertConfigDocument(
+        operationContext(), ShardType::ConfigNS, kShard2, kMajorityWriteConcern));
+
+    // Set up the database and collection as sharded in the metadata.
+    std::string dbName = "foo";
+    std::string collName = "foo.bar";
+    ChunkVersion version(2, 0, OID::gen());
+
+    setUpDatabase(dbName, kShardId0);
+    setUpCollection(collName, version);
+
+    // Set up two chunks on the same shard in the metadata.
+    ChunkType chunk1 =
+        setUpChunk(collName, kKeyPattern.globalMin(), BSON(kPattern << 49), kShardId0, version);
+    version.incMinor();
+    ChunkType chunk2 =
+        setUpChunk(collName, BSON(kPattern << 49), kKeyPattern.globalMax(), kShardId0, version);
+
+    // Going to request that both chunks get migrated to the same shard.
+    const std::vector<MigrateInfo> migrationRequests{{kShardId1, chunk1}, {kShardId1, chunk2}};
+
+    auto future = launchAsync([this, migrationRequests] {
+        Client::initThreadIfNotAlready("Test");
+        auto txn = cc().makeOperationContext();
+
+        // Scheduling the moveChunk commands requires finding a host to which to send the command.
+        // Set up a dummy host for the source shard.
+        shardTargeterMock(txn.get(), kShardId0)->setFindHostReturnValue(kShardHost0);
+
+        MigrationStatuses migrationStatuses = _migrationManager->executeMigrationsForAutoBalance(
+            txn.get(), migrationRequests, 0, kDefaultSecondaryThrottle, false);
+
+        for (const auto& migrateInfo : migrationRequests) {
+            ASSERT_OK(migrationStatuses.at(migrateInfo.getName()));
+        }
+    });
+
+    // Expect two moveChunk commands, the second of which is only sent once the first completes.
+    expectMoveChunkCommand(chunk1, kShardId1, false, Status::OK());
+    expectMoveChunkCommand(chunk2, kShardId1, false, Status::OK());
+
+    // Run the MigrationManager code.
+    future.timed_get(kFutureTimeout);
+}
+
 TEST_F(MigrationManagerTest, TwoCollectionsTwoMigrationsEach) {
     // Set up two shards in the metadata.
     ASSERT_OK(catalogClient()->insertConfigDocument(
@@ -32,6 +32,8 @@
 
 #include "mongo/db/s/migration_chunk_cloner_source_legacy.h"
 
+#include <algorithm>
+
 #include "mongo/base/status.h"
 #include "mongo/client/read_preference.h"
 #include "mongo/db/concurrency/locker.h"
@@ -97,7 +99,7 @@ public:
     void doInvalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) override {
         if (type == INVALIDATION_DELETION) {
             stdx::lock_guard<stdx::mutex> sl(_cloner->_mutex);
-            _cloner->_cloneLocs.erase(dl);
+            _cloner->_markCloneLocDeleted_inlock(dl);
         }
     }
 
@@ -251,7 +253,7 @@ Status MigrationChunkClonerSourceLegacy::awaitUntilCriticalSectionIsAppropriate(
 
         stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-        const std::size_t cloneLocsRemaining = _cloneLocs.size();
+        const std::size_t cloneLocsRemaining = _cloneLocsRemaining_inlock();
 
         log() << "moveChunk data transfer progress: " << redact(res) << " mem used: " << _memoryUsed
               << " documents remaining to clone: " << cloneLocsRemaining;
@@ -399,7 +401,7 @@ uint64_t MigrationChunkClonerSourceLegacy::getCloneBatchBufferAllocationSize() {
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
     return std::min(static_cast<uint64_t>(BSONObjMaxUserSize),
-                    _averageObjectSizeForCloneLocs * _cloneLocs.size());
+                    _averageObjectSizeForCloneLocs * _cloneLocsRemaining_inlock());
 }
 
 Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* txn,
@@ -411,35 +413,57 @@ Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* txn,
                            internalQueryExecYieldIterations,
                            Milliseconds(internalQueryExecYieldPeriodMS.load()));
 
-    stdx::lock_guard<stdx::mutex> sl(_mutex);
-
-    std::set<RecordId>::iterator it;
-
-    for (it = _cloneLocs.begin(); it != _cloneLocs.end(); ++it) {
+    // The mutex is not held while fetching documents, so that several recipient requests can fetch
+    // their documents at the same time. A record id stays claimed while its document is fetched, so
+    // that a concurrent deletion, after which the record id may be reused, discards the document.
+    while (true) {
         // We must always make progress in this method by at least one document because empty return
         // indicates there is no more initial clone data.
         if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
             break;
         }
 
-        Snapshotted<BSONObj> doc;
-        if (collection->findDoc(txn, *it, &doc)) {
-            // Use the builder size instead of accumulating the document sizes directly so that we
-            // take into consideration the overhead of BSONArray indices.
-            if (arrBuilder->arrSize() &&
-                (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
+        RecordId nextLoc;
+        {
+            stdx::lock_guard<stdx::mutex> sl(_mutex);
+            if (!_nextCloneLoc_inlock(&nextLoc)) {
                 break;
             }
+        }
+
+        // If fetching the document fails, the record id goes back to be sent in a later batch
+        auto requeueGuard = MakeGuard([&] {
+            stdx::lock_guard<stdx::mutex> sl(_mutex);
+            if (_releaseCloneLoc_inlock(nextLoc)) {
+                _requeuedCloneLocs.push_back(nextLoc);
+            }
+        });
+
+        Snapshotted<BSONObj> doc;
+        const bool found = collection->findDoc(txn, nextLoc, &doc);
+        requeueGuard.Dismiss();
 
-            arrBuilder->append(doc.value());
+        stdx::lock_guard<stdx::mutex> sl(_mutex);
+        if (!_releaseCloneLoc_inlock(nextLoc) || !found) {
+            continue;
         }
+
+        // Use the builder size instead of accumulating the document sizes directly so that we take
+        // into consideration the overhead of BSONArray indices.
+        if (arrBuilder->arrSize() &&
+            (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
+            _requeuedCloneLocs.push_back(nextLoc);
+            break;
+        }
+
+        arrBuilder->append(doc.value());
     }
 
-    _cloneLocs.erase(_cloneLocs.begin(), it);
+    stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-    // If we have drained all the cloned data, there is no need to keep the delete notify executor
-    // around
-    if (_cloneLocs.empty()) {
+    // If we have drained all the cloned data and no other request still has documents in flight,
+    // there is no need to keep the delete notify executor around
+    if (_cloneLocsRemaining_inlock() == 0) {
         _deleteNotifyExec.reset();
     }
 
@@ -454,7 +478,7 @@ Status MigrationChunkClonerSourceLegacy::nextModsBatch(OperationContext* txn,
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
     // All clone data must have been drained before starting to fetch the incremental changes
-    invariant(_cloneLocs.empty());
+    invariant(_cloneLocsRemaining_inlock() == 0);
 
     long long docSizeAccumulator = 0;
 
@@ -605,7 +629,7 @@ Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* txn
 
         if (!isLargeChunk) {
             stdx::lock_guard<stdx::mutex> lk(_mutex);
-            _cloneLocs.insert(recordId);
+            _cloneLocs.push_back(recordId);
         }
 
         if (++recCount > maxRecsWhenFull) {
@@ -646,9 +670,80 @@ Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* txn
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     _averageObjectSizeForCloneLocs = collectionAverageObjectSize + 12;
 
+    // Sort the record ids to avoid seeking the disk when fetching the documents, and drop those
+    // deleted while the chunk was being scanned.
+    std::sort(_cloneLocs.begin(), _cloneLocs.end());
+    if (!_deletedCloneLocs.empty()) {
+        _cloneLocs.erase(std::remove_if(_cloneLocs.begin(),
+                                        _cloneLocs.end(),
+                                        [this](const RecordId& recordId) {
+                                            return _deletedCloneLocs.count(recordId) > 0;
+                                        }),
+                         _cloneLocs.end());
+        _deletedCloneLocs.clear();
+    }
+    _cloneLocsSorted = true;
+
     return Status::OK();
 }
 
+bool MigrationChunkClonerSourceLegacy::_nextCloneLoc_inlock(RecordId* recordId) {
+    if (!_requeuedCloneLocs.empty()) {
+        *recordId = _requeuedCloneLocs.back();
+        _requeuedCloneLocs.pop_back();
+        _inFlightCloneLocs.emplace(*recordId, false);
+        return true;
+    }
+
+    while (_cloneLocsNext < _cloneLocs.size()) {
+        const RecordId& nextLoc = _cloneLocs[_cloneLocsNext++];
+        if (_deletedCloneLocs.erase(nextLoc)) {
+            continue;
+        }
+
+        *recordId = nextLoc;
+        _inFlightCloneLocs.emplace(*recordId, false);
+        return true;
+    }
+
+    return false;
+}
+
+bool MigrationChunkClonerSourceLegacy::_releaseCloneLoc_inlock(const RecordId& recordId) {
+    auto it = _inFlightCloneLocs.find(recordId);
+    invariant(it != _inFlightCloneLocs.end());
+
+    const bool deleted = it->second;
+    _inFlightCloneLocs.erase(it);
+    return !deleted;
+}
+
+size_t MigrationChunkClonerSourceLegacy::_cloneLocsRemaining_inlock() const {
+    return _cloneLocs.size() - _cloneLocsNext + _requeuedCloneLocs.size() +
+        _inFlightCloneLocs.size() - _deletedCloneLocs.size();
+}
+
+void MigrationChunkClonerSourceLegacy::_markCloneLocDeleted_inlock(const RecordId& recordId) {
+    auto inFlightIt = _inFlightCloneLocs.find(recordId);
+    if (inFlightIt != _inFlightCloneLocs.end()) {
+        inFlightIt->second = true;
+        return;
+    }
+
+    auto requeuedIt = std::find(_requeuedCloneLocs.begin(), _requeuedCloneLocs.end(), recordId);
+    if (requeuedIt != _requeuedCloneLocs.end()) {
+        _requeuedCloneLocs.erase(requeuedIt);
+        return;
+    }
+
+    // While the chunk is still being scanned, the record id may be anywhere in _cloneLocs, so it
+    // is filtered out once the scan completes.
+    if (!_cloneLocsSorted ||
+        std::binary_search(_cloneLocs.begin() + _cloneLocsNext, _cloneLocs.end(), recordId)) {
+        _deletedCloneLocs.insert(recordId);
+    }
+}
+
 void MigrationChunkClonerSourceLegacy::_xfer(OperationContext* txn,
                                              Database* db,
                                              std::list<BSONObj>* docIdList,
@@ -29,11 +29,14 @@
 #pragma once
 
 #include <list>
-#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "mongo/bson/bsonobj.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/record_id.h"
 #include "mongo/db/s/migration_chunk_cloner_source.h"
 #include "mongo/db/s/migration_session_id.h"
 #include "mongo/s/move_chunk_request.h"
@@ -49,7 +52,6 @@ class BSONObjBuilder;
 class Collection;
 class Database;
 class PlanExecutor;
-class RecordId;
 
 class MigrationChunkClonerSourceLegacy final : public MigrationChunkClonerSource {
     MONGO_DISALLOW_COPYING(MigrationChunkClonerSourceLegacy);
@@ -106,6 +108,9 @@ public:
      * give a chance to the caller to perform some form of yielding. It does not free or acquire any
      * locks on its own.
      *
+     * May be called concurrently by several recipient requests, each of which is handed a disjoint
+     * set of documents.
+     *
      * NOTE: Must be called with the collection lock held in at least IS mode.
      */
     Status nextCloneBatch(OperationContext* txn,
@@ -148,6 +153,32 @@ private:
      */
     Status _storeCurrentLocs(OperationContext* txn);
 
+    /**
+     * Hands out the record id of the next document to send as part of the initial clone and records
+     * it as in flight until _releaseCloneLoc_inlock is called for it. Returns false if there are
+     * none left. Must be called with _mutex held.
+     */
+    bool _nextCloneLoc_inlock(RecordId* recordId);
+
+    /**
+     * Ends the claim on a record id handed out by _nextCloneLoc_inlock. Returns false if the
+     * document was deleted while it was in flight, in which case whatever was fetched for it must
+     * not be sent. Must be called with _mutex held.
+     */
+    bool _releaseCloneLoc_inlock(const RecordId& recordId);
+
+    /**
+     * Returns how many documents of the initial clone have not been sent yet, including those
+     * currently in flight. Must be called with _mutex held.
+     */
+    size_t _cloneLocsRemaining_inlock() const;
+
+    /**
+     * Ensures that the document at 'recordId', which was just deleted, is not sent as part of the
+     * initial clone. Must be called with _mutex held.
+     */
+    void _markCloneLocDeleted_inlock(const RecordId& recordId);
+
     /**
      * Insert items from docIdList to a new array with the given fieldName in the given builder. If
      * explode is true, the inserted object will be the full version of the document. Note that
@@ -189,8 +220,26 @@ private:
     // The current state of the cloner
     State _state{kNew};
 
-    // List of record ids that needs to be transferred (initial clone)
-    std::set<RecordId> _cloneLocs;
+    // Record ids of the documents that need to be transferred (initial clone). Once the chunk has
+    // been scanned, they are sorted so that documents are fetched in storage order, and the entries
+    // before _cloneLocsNext are those already handed out to a clone batch.
+    std::vector<RecordId> _cloneLocs;
+    size_t _cloneLocsNext{0};
+
+    // Whether _cloneLocs has been fully populated and sorted (initial clone)
+    bool _cloneLocsSorted{false};
+
+    // Record ids which were handed out to a clone batch that had no room left for them, and which
+    // must be sent in a later batch (initial clone)
+    std::vector<RecordId> _requeuedCloneLocs;
+
+    // Record ids of documents deleted during the clone, which must be skipped when they are reached
+    // in _cloneLocs (initial clone)
+    std::unordered_set<RecordId, RecordId::Hasher> _deletedCloneLocs;
+
+    // Record ids handed out to a clone batch whose document is still being fetched, mapped to
+    // whether the document was deleted in the meantime (initial clone)
+    std::unordered_map<RecordId, bool, RecordId::Hasher> _inFlightCloneLocs;
 
     // The estimated average object size during the clone phase. Used for buffer size
     // pre-allocation (initial clone).
@@ -28,18 +28,25 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/client/remote_command_targeter_mock.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/s/migration_chunk_cloner_source_legacy.h"
 #include "mongo/s/catalog/sharding_catalog_client_mock.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/sharding_mongod_test_fixture.h"
+#include "mongo/stdx/future.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/fail_point_service.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -132,7 +139,8 @@ protected:
      * Shortcut to create BSON represenation of a moveChunk request for the specified range with
      * fixed kDonorConnStr and kRecipientConnStr, respectively.
      */
-    static MoveChunkRequest createMoveChunkRequest(const ChunkRange& chunkRange) {
+    static MoveChunkRequest createMoveChunkRequest(const ChunkRange& chunkRange,
+                                                   long long maxChunkSizeBytes = 1024 * 1024) {
         BSONObjBuilder cmdBuilder;
         MoveChunkRequest::appendAsCommand(
             &cmdBuilder,
@@ -143,7 +151,7 @@ protected:
             kRecipientConnStr.getSetName(),
             chunkRange,
             ChunkVersion(1, 0, OID::gen()),
-            1024 * 1024,
+            maxChunkSizeBytes,
             MigrationSecondaryThrottleOptions::create(MigrationSecondaryThrottleOptions::kDefault),
             false,
             false);
@@ -158,6 +166,64 @@ protected:
         return BSON("_id" << value << "X" << value);
     }
 
+    /**
+     * Starts 'cloner', answering its request to the recipient shard.
+     */
+    void startClone(MigrationChunkClonerSourceLegacy* cloner) {
+        auto futureStartClone = launchAsync([&]() {
+            onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+        });
+
+        ASSERT_OK(cloner->startClone(operationContext()));
+        futureStartClone.timed_get(kFutureTimeout);
+    }
+
+    /**
+     * Commits 'cloner', answering its request to the recipient shard.
+     */
+    void commitClone(MigrationChunkClonerSourceLegacy* cloner) {
+        auto futureCommit = launchAsync([&]() {
+            onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+        });
+
+        ASSERT_OK(cloner->commitClone(operationContext()));
+        futureCommit.timed_get(kFutureTimeout);
+    }
+
+    /**
+     * Fetches the next initial clone batch of 'cloner' on 'txn' and returns the "X" values of its
+     * documents.
+     */
+    static std::vector<int> fetchCloneBatch(OperationContext* txn,
+                                            MigrationChunkClonerSourceLegacy* cloner) {
+        AutoGetCollection autoColl(txn, kNss, MODE_IS);
+
+        BSONArrayBuilder arrBuilder;
+        ASSERT_OK(cloner->nextCloneBatch(txn, autoColl.getCollection(), &arrBuilder));
+
+        std::vector<int> values;
+        for (auto&& elem : arrBuilder.arr()) {
+            values.push_back(elem.Obj()["X"].numberInt());
+        }
+        return values;
+    }
+
+    /**
+     * Fetches initial clone batches of 'cloner' on 'txn' until there are none left and returns the
+     * "X" values of their documents.
+     */
+    static std::vector<int> fetchAllCloneBatches(OperationContext* txn,
+                                                 MigrationChunkClonerSourceLegacy* cloner) {
+        std::vector<int> values;
+        while (true) {
+            const auto batch = fetchCloneBatch(txn, cloner);
+            if (batch.empty()) {
+                return values;
+            }
+            values.insert(values.end(), batch.begin(), batch.end());
+        }
+    }
+
 private:
     std::unique_ptr<ShardingCatalogClient> makeShardingCatalogClient(
         std::unique_ptr<DistLockManager> distLockManager) override {
@@ -296,6 +362,189 @@ TEST_F(MigrationChunkClonerSourceLegacyTest, CorrectDocumentsFetched) {
     futureCommit.timed_get(kFutureTimeout);
 }
 
+TEST_F(MigrationChunkClonerSourceLegacyTest, ConcurrentCloneBatchesFetchEachDocumentOnce) {
+    std::vector<BSONObj> contents;
+    for (int i = 100; i < 200; ++i) {
+        contents.push_back(createCollectionDocument(i));
+    }
+    createShardedCollection(contents);
+
+    MigrationChunkClonerSourceLegacy cloner(
+        createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200))),
+        kShardKeyPattern,
+        kDonorConnStr,
+        kRecipientConnStr.getServers()[0]);
+    startClone(&cloner);
+
+    // End each batch after two documents, so that the batches of the two requests interleave.
+    const int yieldIterations = internalQueryExecYieldIterations.load();
+    internalQueryExecYieldIterations.store(2);
+    ON_BLOCK_EXIT([&] { internalQueryExecYieldIterations.store(yieldIterations); });
+
+    const auto fetchOnNewClient = [&] {
+        Client::initThreadIfNotAlready("cloneBatchFetcher");
+        auto txn = cc().makeOperationContext();
+        return fetchAllCloneBatches(txn.get(), &cloner);
+    };
+    auto futureFetch1 = launchAsync(fetchOnNewClient);
+    auto futureFetch2 = launchAsync(fetchOnNewClient);
+    auto fetched = futureFetch1.timed_get(kFutureTimeout);
+    const auto fetched2 = futureFetch2.timed_get(kFutureTimeout);
+    fetched.insert(fetched.end(), fetched2.begin(), fetched2.end());
+
+    std::sort(fetched.begin(), fetched.end());
+    ASSERT_EQ(contents.size(), fetched.size());
+    for (size_t i = 0; i < fetched.size(); ++i) {
+        ASSERT_EQ(contents[i]["X"].numberInt(), fetched[i]);
+    }
+
+    commitClone(&cloner);
+}
+
+TEST_F(MigrationChunkClonerSourceLegacyTest, DocumentOverflowingBatchIsRequeued) {
+    // Documents of 1MB, so that a batch fills up well before the end of the chunk.
+    const std::string padding(1024 * 1024, 'x');
+    std::vector<BSONObj> contents;
+    for (int i = 100; i < 120; ++i) {
+        contents.push_back(BSON("_id" << i << "X" << i << "padding" << padding));
+    }
+    createShardedCollection(contents);
+
+    MigrationChunkClonerSourceLegacy cloner(
+        createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200)), 64 * 1024 * 1024),
+        kShardKeyPattern,
+        kDonorConnStr,
+        kRecipientConnStr.getServers()[0]);
+    startClone(&cloner);
+
+    // Only the size of the batch may end it.
+    const int yieldIterations = internalQueryExecYieldIterations.load();
+    const int yieldPeriodMS = internalQueryExecYieldPeriodMS.load();
+    internalQueryExecYieldIterations.store(1000);
+    internalQueryExecYieldPeriodMS.store(1000 * 1000);
+    ON_BLOCK_EXIT([&] {
+        internalQueryExecYieldIterations.store(yieldIterations);
+        internalQueryExecYieldPeriodMS.store(yieldPeriodMS);
+    });
+
+    const auto batch1 = fetchCloneBatch(operationContext(), &cloner);
+    ASSERT_GT(batch1.size(), 1U);
+    ASSERT_LT(batch1.size(), contents.size());
+
+    // The document which didn't fit comes first in the next batch.
+    const auto batch2 = fetchAllCloneBatches(operationContext(), &cloner);
+    ASSERT_EQ(contents.size(), batch1.size() + batch2.size());
+    ASSERT_EQ(100 + static_cast<int>(batch1.size()), batch2.front());
+
+    std::vector<int> fetched(batch1);
+    fetched.insert(fetched.end(), batch2.begin(), batch2.end());
+    std::sort(fetched.begin(), fetched.end());
+    for (size_t i = 0; i < fetched.size(); ++i) {
+        ASSERT_EQ(100 + static_cast<int>(i), fetched[i]);
+    }
+
+    commitClone(&cloner);
+}
+
+TEST_F(MigrationChunkClonerSourceLegacyTest, DocumentsDeletedAfterScanAreNotCloned) {
+    const std::string padding(1024 * 1024, 'x');
+    std::vector<BSONObj> contents;
+    for (int i = 100; i < 120; ++i) {
+        contents.push_back(BSON("_id" << i << "X" << i << "padding" << padding));
+    }
+    createShardedCollection(contents);
+
+    MigrationChunkClonerSourceLegacy cloner(
+        createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200)), 64 * 1024 * 1024),
+        kShardKeyPattern,
+        kDonorConnStr,
+        kRecipientConnStr.getServers()[0]);
+    startClone(&cloner);
+
+    const int yieldIterations = internalQueryExecYieldIterations.load();
+    const int yieldPeriodMS = internalQueryExecYieldPeriodMS.load();
+    internalQueryExecYieldIterations.store(1000);
+    internalQueryExecYieldPeriodMS.store(1000 * 1000);
+    ON_BLOCK_EXIT([&] {
+        internalQueryExecYieldIterations.store(yieldIterations);
+        internalQueryExecYieldPeriodMS.store(yieldPeriodMS);
+    });
+
+    const auto batch1 = fetchCloneBatch(operationContext(), &cloner);
+    ASSERT_GT(batch1.size(), 1U);
+    ASSERT_LT(batch1.size() + 3, contents.size());
+
+    // Delete a document already cloned, the requeued document which didn't fit in the batch and a
+    // document yet to be cloned.
+    const int requeued = 100 + batch1.size();
+    client()->remove(kNss.ns(), BSON("_id" << 100));
+    client()->remove(kNss.ns(), BSON("_id" << requeued));
+    client()->remove(kNss.ns(), BSON("_id" << requeued + 2));
+
+    std::vector<int> expected;
+    for (int i = requeued + 1; i < 120; ++i) {
+        if (i != requeued + 2) {
+            expected.push_back(i);
+        }
+    }
+    ASSERT(expected == fetchAllCloneBatches(operationContext(), &cloner));
+
+    commitClone(&cloner);
+}
+
+TEST_F(MigrationChunkClonerSourceLegacyTest, DocumentsDeletedDuringScanAreNotCloned) {
+    std::vector<BSONObj> contents;
+    for (int i = 100; i < 200; ++i) {
+        contents.push_back(createCollectionDocument(i));
+    }
+    createShardedCollection(contents);
+
+    MigrationChunkClonerSourceLegacy cloner(
+        createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200))),
+        kShardKeyPattern,
+        kDonorConnStr,
+        kRecipientConnStr.getServers()[0]);
+
+    // Make the scan of the chunk yield its locks for a few milliseconds after every document, so
+    // that it is still under way while the documents are deleted.
+    const int yieldIterations = internalQueryExecYieldIterations.load();
+    internalQueryExecYieldIterations.store(1);
+    auto yieldWait = getGlobalFailPointRegistry()->getFailPoint("setYieldAllLocksWait");
+    yieldWait->setMode(
+        FailPoint::alwaysOn, 0, BSON("namespace" << kNss.ns() << "waitForMillis" << 5));
+    ON_BLOCK_EXIT([&] {
+        yieldWait->setMode(FailPoint::off);
+        internalQueryExecYieldIterations.store(yieldIterations);
+    });
+
+    stdx::promise<void> scanStarting;
+    auto futureStartClone = launchAsync([&] {
+        Client::initThreadIfNotAlready("startClone");
+        auto txn = cc().makeOperationContext();
+        scanStarting.set_value();
+        return cloner.startClone(txn.get());
+    });
+
+    scanStarting.get_future().wait();
+    for (int i = 100; i < 200; i += 2) {
+        client()->remove(kNss.ns(), BSON("_id" << i));
+    }
+
+    onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+    ASSERT_OK(futureStartClone.timed_get(kFutureTimeout));
+
+    yieldWait->setMode(FailPoint::off);
+    internalQueryExecYieldIterations.store(yieldIterations);
+
+    std::vector<int> expected;
+    for (int i = 101; i < 200; i += 2) {
+        expected.push_back(i);
+    }
+    ASSERT(expected == fetchAllCloneBatches(operationContext(), &cloner));
+
+    commitClone(&cloner);
+}
+
 TEST_F(MigrationChunkClonerSourceLegacyTest, CollectionNotFound) {
     MigrationChunkClonerSourceLegacy cloner(
         createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200))),
@@ -61,6 +61,7 @@
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/logger/ramlog.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/stdx/chrono.h"
@@ -69,6 +70,7 @@
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/producer_consumer_queue.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -353,48 +355,132 @@ Status MigrationDestinationManager::start(const NamespaceString& nss,
 void MigrationDestinationManager::cloneDocumentsFromDonor(
     OperationContext* txn,
     stdx::function<void(OperationContext*, BSONObj)> insertBatchFn,
-    stdx::function<BSONObj(OperationContext*)> fetchBatchFn) {
-
-    ProducerConsumerQueue<BSONObj> batches(1);
-    stdx::thread inserterThread{[&] {
-        Client::initThreadIfNotAlready("chunkInserter");
-        auto inserterTxn = Client::getCurrent()->makeOperationContext();
-        auto consumerGuard = MakeGuard([&] { batches.closeConsumerEnd(); });
-        try {
-            while (true) {
-                auto nextBatch = batches.pop(inserterTxn.get());
-                auto arr = nextBatch["objects"].Obj();
-                if (arr.isEmpty()) {
-                    return;
+    stdx::function<BSONObj(OperationContext*)> fetchBatchFn,
+    int numFetchers,
+    int numInserters) {
+    invariant(numFetchers >= 1);
+    invariant(numInserters >= 1);
+
+    // Each inserter may have one batch waiting for it, so that fetching never stalls on a single
+    // slow insert.
+    ProducerConsumerQueue<BSONObj> batches(numInserters);
+    std::vector<stdx::thread> inserterThreads;
+    for (int i = 0; i < numInserters; ++i) {
+        inserterThreads.emplace_back([&] {
+            Client::initThreadIfNotAlready("chunkInserter");
+            auto inserterTxn = Client::getCurrent()->makeOperationContext();
+            auto consumerGuard = MakeGuard([&] { batches.closeConsumerEnd(); });
+            try {
+                while (true) {
+                    auto nextBatch = batches.pop(inserterTxn.get());
+                    auto arr = nextBatch["objects"].Obj();
+                    if (arr.isEmpty()) {
+                        consumerGuard.Dismiss();
+                        return;
+                    }
+                    insertBatchFn(inserterTxn.get(), arr);
                 }
-                insertBatchFn(inserterTxn.get(), arr);
+            } catch (...) {
+                stdx::lock_guard<Client> lk(*txn->getClient());
+                txn->getServiceContext()->killOperation(txn, exceptionToStatus().code());
+                log() << "Batch insertion failed " << causedBy(redact(exceptionToStatus()));
             }
-        } catch (...) {
-            stdx::lock_guard<Client> lk(*txn->getClient());
-            txn->getServiceContext()->killOperation(txn, exceptionToStatus().code());
-            log() << "Batch insertion failed " << causedBy(redact(exceptionToStatus()));
-        }
-    }};
+        });
+    }
     auto inserterThreadJoinGuard = MakeGuard([&] {
         batches.closeProducerEnd();
-        inserterThread.join();
+        for (auto& inserterThread : inserterThreads) {
+            inserterThread.join();
+        }
     });
 
-    while (true) {
-        txn->checkForInterrupt();
+    // This thread fetches batches itself and is the only one to push into 'batches'. Every other
+    // fetcher runs on its own thread and hands its batches over through its own queue, so that up
+    // to 'numFetchers' requests to the donor are in flight at once.
+    std::vector<std::unique_ptr<ProducerConsumerQueue<BSONObj>>> fetchedBatches;
+    std::vector<stdx::thread> fetcherThreads;
+    stdx::mutex fetchErrorMutex;
+    Status fetchError = Status::OK();
+    for (int i = 1; i < numFetchers; ++i) {
+        fetchedBatches.push_back(stdx::make_unique<ProducerConsumerQueue<BSONObj>>(1));
+        auto fetched = fetchedBatches.back().get();
+        fetcherThreads.emplace_back([&, fetched] {
+            Client::initThreadIfNotAlready("chunkFetcher");
+            auto fetcherTxn = Client::getCurrent()->makeOperationContext();
+            auto producerGuard = MakeGuard([&] { fetched->closeProducerEnd(); });
+            try {
+                while (true) {
+                    auto res = fetchBatchFn(fetcherTxn.get()).getOwned();
+                    const bool isLastBatch = res["objects"].Obj().isEmpty();
+                    fetched->push(std::move(res), fetcherTxn.get());
+                    if (isLastBatch) {
+                        return;
+                    }
+                }
+            } catch (...) {
+                stdx::lock_guard<stdx::mutex> lk(fetchErrorMutex);
+                fetchError = exceptionToStatus();
+            }
+        });
+    }
+    auto fetcherThreadJoinGuard = MakeGuard([&] {
+        for (auto& fetched : fetchedBatches) {
+            fetched->closeConsumerEnd();
+        }
+        for (auto& fetcherThread : fetcherThreads) {
+            fetcherThread.join();
+        }
+    });
+
+    std::vector<bool> fetcherDone(numFetchers, false);
+    int numFetchersRemaining = numFetchers;
+    while (numFetchersRemaining > 0) {
+        for (int i = 0; i < numFetchers; ++i) {
+            if (fetcherDone[i]) {
+                continue;
+            }
+
+            txn->checkForInterrupt();
 
-        auto res = fetchBatchFn(txn);
+            BSONObj res;
+            if (i == 0) {
+                res = fetchBatchFn(txn);
+            } else {
+                try {
+                    res = fetchedBatches[i - 1]->pop(txn);
+                } catch (const DBException& ex) {
+                    // The fetcher only closes its queue without a final empty batch if it failed.
+                    if (ex.getCode() == ErrorCodes::ProducerConsumerQueueEndClosed) {
+                        stdx::lock_guard<stdx::mutex> lk(fetchErrorMutex);
+                        uassertStatusOK(fetchError);
+                    }
+                    throw;
+                }
+            }
 
-        txn->checkForInterrupt();
-        batches.push(res.getOwned(), txn);
-        auto arr = res["objects"].Obj();
-        if (arr.isEmpty()) {
-            inserterThreadJoinGuard.Dismiss();
-            inserterThread.join();
             txn->checkForInterrupt();
-            break;
+
+            auto arr = res["objects"].Obj();
+            if (arr.isEmpty()) {
+                fetcherDone[i] = true;
+                --numFetchersRemaining;
+                continue;
+            }
+
+            batches.push(res.getOwned(), txn);
         }
     }
+
+    // Tell each inserter that there is nothing more to insert.
+    for (int i = 0; i < numInserters; ++i) {
+        batches.push(BSON("objects" << BSONArray()), txn);
+    }
+
+    inserterThreadJoinGuard.Dismiss();
+    for (auto& inserterThread : inserterThreads) {
+        inserterThread.join();
+    }
+    txn->checkForInterrupt();
 }
 
 bool MigrationDestinationManager::abort(const MigrationSessionId& sessionId) {
@@ -520,6 +606,13 @@ MONGO_EXPORT_SERVER_PARAMETER(migrateCloneInsertionBatchSize, int, 0);
 // Defaults to 0.
 MONGO_EXPORT_SERVER_PARAMETER(migrateCloneInsertionBatchDelayMS, int, 0);
 
+// The number of _migrateClone requests kept in flight to the donor during migration clone. Each
+// request is handed a disjoint set of documents by the donor.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneConcurrentFetches, int, 2);
+
+// The number of threads inserting batches of cloned documents during migration clone.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneInsertionThreads, int, 2);
+
 void MigrationDestinationManager::_migrateDriver(OperationContext* txn,
                                                  const BSONObj& min,
                                                  const BSONObj& max,
@@ -729,6 +822,11 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* txn,
             uassert(40655, "Migration aborted while copying documents", getState() != ABORT);
         };
 
+        // Time spent waiting on the donor and inserting documents, summed over all of the fetchers
+        // and inserters, which run at the same time.
+        AtomicInt64 cloneNetworkMillis;
+        AtomicInt64 cloneInsertMillis;
+
         auto insertBatchFn = [&](OperationContext* opCtx, BSONObj arr) {
             auto it = arr.begin();
             while (it != arr.end()) {
@@ -752,7 +850,9 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* txn,
                 insertOp.ns = _nss;
                 insertOp.documents = toInsert;
 
+                Timer insertTimer;
                 const WriteResult reply = performInserts(opCtx, insertOp, true);
+                cloneInsertMillis.fetchAndAdd(insertTimer.millis());
 
                 for (unsigned long i = 0; i < reply.results.size(); ++i) {
                     uassertStatusOK(reply.results[i]);
@@ -782,21 +882,32 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* txn,
             }
         };
 
+        // Called concurrently by several fetchers, so each request uses its own connection.
         auto fetchBatchFn = [&](OperationContext* txn) {
+            Timer networkTimer;
+            ScopedDbConnection fetchConn(fromShardConnString);
             BSONObj res;
-            if (!conn->runCommand("admin",
-                                  migrateCloneRequest,
-                                  res)) {  // gets array of objects to copy, in disk order
-                conn.done();
+            if (!fetchConn->runCommand("admin",
+                                       migrateCloneRequest,
+                                       res)) {  // gets array of objects to copy, in disk order
+                fetchConn.done();
                 const std::string errMsg = str::stream() << "_migrateClone failed: "
                                                          << redact(res.toString());
                 uasserted(40656, errMsg);
             }
+            fetchConn.done();
+            cloneNetworkMillis.fetchAndAdd(networkTimer.millis());
             return res;
         };
 
-        cloneDocumentsFromDonor(txn, insertBatchFn, fetchBatchFn);
+        cloneDocumentsFromDonor(txn,
+                                insertBatchFn,
+                                fetchBatchFn,
+                                std::max(1, migrateCloneConcurrentFetches.load()),
+                                std::max(1, migrateCloneInsertionThreads.load()));
 
+        timing.appendTiming("clone network", Milliseconds(cloneNetworkMillis.load()));
+        timing.appendTiming("clone insert", Milliseconds(cloneInsertMillis.load()));
         timing.done(3);
         MONGO_FAIL_POINT_PAUSE_WHILE_SET(migrateThreadHangAtStep3);
     }
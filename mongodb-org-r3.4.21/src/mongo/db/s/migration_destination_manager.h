@@ -101,12 +101,17 @@ public:
                  const WriteConcernOptions& writeConcern);
 
     /**
-     * Clones documents from a donor shard.
+     * Clones documents from a donor shard. Up to 'numFetchers' calls to 'fetchBatchFn' run at the
+     * same time, each until it returns an empty batch, and the fetched batches are handed to
+     * 'numInserters' threads calling 'insertBatchFn'. Both functions must therefore be safe to call
+     * concurrently when more than one fetcher or inserter is requested.
      */
     static void cloneDocumentsFromDonor(
         OperationContext* txn,
         stdx::function<void(OperationContext*, BSONObj)> insertBatchFn,
-        stdx::function<BSONObj(OperationContext*)> fetchBatchFn);
+        stdx::function<BSONObj(OperationContext*)> fetchBatchFn,
+        int numFetchers = 1,
+        int numInserters = 1);
 
     /**
      * Idempotent method, which causes the current ongoing migration to abort only if it has the
@@ -29,7 +29,12 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/s/migration_destination_manager.h"
+
+#include <algorithm>
+
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/sharding_mongod_test_fixture.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -104,6 +109,49 @@ TEST_F(MigrationDestinationManagerTest, CloneDocumentsFromDonorWorksCorrectly) {
     }
 }
 
+// Tests that documents fetched by several fetchers at once are all inserted by the pool of
+// inserters.
+TEST_F(MigrationDestinationManagerTest, CloneDocumentsFromDonorWithConcurrentFetchesAndInserts) {
+    const int kNumBatches = 20;
+    AtomicInt32 numFetches;
+
+    auto fetchBatchFn = [&](OperationContext* opCtx) {
+        const int fetch = numFetches.fetchAndAdd(1);
+
+        BSONArrayBuilder arrayBuilder;
+        if (fetch < kNumBatches) {
+            arrayBuilder.append(createDocument(fetch));
+        }
+
+        BSONObjBuilder fetchBatchResultBuilder;
+        fetchBatchResultBuilder.append("objects", arrayBuilder.arr());
+        return fetchBatchResultBuilder.obj();
+    };
+
+    stdx::mutex resultDocsMutex;
+    std::vector<BSONObj> resultDocs;
+
+    auto insertBatchFn = [&](OperationContext* opCtx, BSONObj docs) {
+        stdx::lock_guard<stdx::mutex> lk(resultDocsMutex);
+        for (auto&& docToClone : docs) {
+            resultDocs.push_back(docToClone.Obj().getOwned());
+        }
+    };
+
+    MigrationDestinationManager::cloneDocumentsFromDonor(
+        operationContext(), insertBatchFn, fetchBatchFn, 4, 3);
+
+    ASSERT_EQ(static_cast<size_t>(kNumBatches), resultDocs.size());
+
+    std::sort(resultDocs.begin(), resultDocs.end(), [](const BSONObj& lhs, const BSONObj& rhs) {
+        return lhs["_id"].numberInt() < rhs["_id"].numberInt();
+    });
+
+    for (int i = 0; i < kNumBatches; ++i) {
+        ASSERT_BSONOBJ_EQ(createDocument(i), resultDocs[i]);
+    }
+}
+
 // Tests that an exception in the fetch logic will successfully throw an exception on the main
 // thread.
 TEST_F(MigrationDestinationManagerTest, CloneDocumentsThrowsFetchErrors) {
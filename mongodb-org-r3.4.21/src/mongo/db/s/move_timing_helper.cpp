@@ -110,4 +110,8 @@ void MoveTimingHelper::done(int step) {
     _t.reset();
 }
 
+void MoveTimingHelper::appendTiming(StringData name, Milliseconds elapsed) {
+    _b.append(name, durationCount<Milliseconds>(elapsed));
+}
+
 }  // namespace mongo
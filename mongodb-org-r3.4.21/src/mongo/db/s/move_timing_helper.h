@@ -30,8 +30,10 @@
 
 #include <string>
 
+#include "mongo/base/string_data.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/s/shard_id.h"
+#include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -54,6 +56,12 @@ public:
 
     void done(int step);
 
+    /**
+     * Records 'elapsed' under 'name' in the changelog entry, next to the per-step timings. Used to
+     * break a step's time down further.
+     */
+    void appendTiming(StringData name, Milliseconds elapsed);
+
 private:
     // Measures how long the receiving of a chunk takes
     Timer _t;
@@ -667,9 +667,7 @@ ChunkVersion ShardingState::_refreshMetadata(OperationContext* txn, const Namesp
     RangeMap shardChunksMap =
         SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<CachedChunkInfo>();
 
-    for (const auto& chunkMapEntry : cm->chunkMap()) {
-        const auto& chunk = chunkMapEntry.second;
-
+    for (const auto& chunk : cm->chunkMap()) {
         if (chunk->getShardId() != shardId)
             continue;
 
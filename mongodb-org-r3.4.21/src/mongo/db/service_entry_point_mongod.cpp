@@ -37,7 +37,6 @@
 #include "mongo/db/client.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/instance.h"
-#include "mongo/stdx/thread.h"
 #include "mongo/transport/service_entry_point_utils.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/ticket.h"
@@ -49,7 +48,6 @@
 #include "mongo/util/net/socket_exception.h"
 #include "mongo/util/net/thread_idle_callback.h"
 #include "mongo/util/quick_exit.h"
-#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -91,80 +89,96 @@ bool setExhaustMessage(Message* m, const DbResponse& dbresponse) {
 using transport::Session;
 using transport::TransportLayer;
 
-ServiceEntryPointMongod::ServiceEntryPointMongod(TransportLayer* tl) : _tl(tl) {}
+/**
+ * State of a session which is carried over from one request/response cycle to the next.
+ */
+struct ServiceEntryPointMongod::SessionState {
+    explicit SessionState(AtomicWord<std::size_t>* nSessions) : nSessions(nSessions) {
+        nSessions->fetchAndAdd(1);
+    }
 
-void ServiceEntryPointMongod::startSession(transport::SessionHandle session) {
-    // Pass ownership of the transport::SessionHandle into our worker thread. When this
-    // thread exits, the session will end.
-    launchWrappedServiceEntryWorkerThread(
-        std::move(session), [this](const transport::SessionHandle& session) {
-            _nWorkers.fetchAndAdd(1);
-            auto guard = MakeGuard([&] { _nWorkers.fetchAndSubtract(1); });
-
-            _sessionLoop(session);
-        });
-}
+    ~SessionState() {
+        nSessions->fetchAndSubtract(1);
+    }
+
+    AtomicWord<std::size_t>* const nSessions;
 
-void ServiceEntryPointMongod::_sessionLoop(const transport::SessionHandle& session) {
     Message inMessage;
     bool inExhaust = false;
     int64_t counter = 0;
+};
 
-    while (true) {
-        // 1. Source a Message from the client (unless we are exhausting)
-        if (!inExhaust) {
-            inMessage.reset();
-            auto status = [&] {
-                MONGO_IDLE_THREAD_BLOCK;
-                return session->sourceMessage(&inMessage).wait();
-            }();
-
-            if (ErrorCodes::isInterruption(status.code()) ||
-                ErrorCodes::isNetworkError(status.code())) {
-                break;
-            }
-
-            // Our session may have been closed internally.
-            if (status == TransportLayer::TicketSessionClosedStatus) {
-                break;
-            }
-
-            uassertStatusOK(status);
-        }
+ServiceEntryPointMongod::ServiceEntryPointMongod(TransportLayer* tl) : _tl(tl) {}
+
+void ServiceEntryPointMongod::startSession(transport::SessionHandle session) {
+    // Pass ownership of the transport::SessionHandle to the service executor. When the last cycle
+    // has run, the session will end.
+    auto state = std::make_shared<SessionState>(&_nWorkers);
+    launchServiceEntrySession(std::move(session),
+                              [this, state](const transport::SessionHandle& session) {
+                                  return _sessionCycle(session, state.get());
+                              });
+}
 
-        // 2. Pass sourced Message up to mongod
-        DbResponse dbresponse;
-        {
-            auto opCtx = cc().makeOperationContext();
-            assembleResponse(opCtx.get(), inMessage, dbresponse, session->remote());
+SessionCycleResult ServiceEntryPointMongod::_sessionCycle(const transport::SessionHandle& session,
+                                                          SessionState* state) {
+    Message& inMessage = state->inMessage;
+
+    // 1. Source a Message from the client (unless we are exhausting)
+    if (!state->inExhaust) {
+        inMessage.reset();
+        auto status = [&] {
+            MONGO_IDLE_THREAD_BLOCK;
+            return session->sourceMessage(&inMessage).wait();
+        }();
+
+        if (ErrorCodes::isInterruption(status.code()) ||
+            ErrorCodes::isNetworkError(status.code())) {
+            return SessionCycleResult::kEnd;
+        }
 
-            // opCtx must go out of scope here so that the operation cannot show
-            // up in currentOp results after the response reaches the client
+        // Our session may have been closed internally.
+        if (status == TransportLayer::TicketSessionClosedStatus) {
+            return SessionCycleResult::kEnd;
         }
 
-        // 3. Format our response, if we have one
-        Message& toSink = dbresponse.response;
-        if (!toSink.empty()) {
-            toSink.header().setId(nextMessageId());
-            toSink.header().setResponseToMsgId(inMessage.header().getId());
-
-            // If this is an exhaust cursor, don't source more Messages
-            if (dbresponse.exhaustNS.size() > 0 && setExhaustMessage(&inMessage, dbresponse)) {
-                inExhaust = true;
-            } else {
-                inExhaust = false;
-            }
-
-            // 4. Sink our response to the client
-            uassertStatusOK(session->sinkMessage(toSink).wait());
+        uassertStatusOK(status);
+    }
+
+    // 2. Pass sourced Message up to mongod
+    DbResponse dbresponse;
+    {
+        auto opCtx = cc().makeOperationContext();
+        assembleResponse(opCtx.get(), inMessage, dbresponse, session->remote());
+
+        // opCtx must go out of scope here so that the operation cannot show
+        // up in currentOp results after the response reaches the client
+    }
+
+    // 3. Format our response, if we have one
+    Message& toSink = dbresponse.response;
+    if (!toSink.empty()) {
+        toSink.header().setId(nextMessageId());
+        toSink.header().setResponseToMsgId(inMessage.header().getId());
+
+        // If this is an exhaust cursor, don't source more Messages
+        if (dbresponse.exhaustNS.size() > 0 && setExhaustMessage(&inMessage, dbresponse)) {
+            state->inExhaust = true;
         } else {
-            inExhaust = false;
+            state->inExhaust = false;
         }
 
-        if ((counter++ & 0xf) == 0) {
-            markThreadIdle();
-        }
+        // 4. Sink our response to the client
+        uassertStatusOK(session->sinkMessage(toSink).wait());
+    } else {
+        state->inExhaust = false;
     }
+
+    if ((state->counter++ & 0xf) == 0) {
+        markThreadIdle();
+    }
+
+    return state->inExhaust ? SessionCycleResult::kContinue : SessionCycleResult::kSourceNext;
 }
 
 }  // namespace mongo
@@ -33,6 +33,7 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/transport/service_entry_point.h"
+#include "mongo/transport/service_entry_point_utils.h"
 
 namespace mongo {
 
@@ -42,8 +43,9 @@ class TransportLayer;
 }  // namespace transport
 
 /**
- * The entry point from the TransportLayer into Mongod. startSession() spawns and
- * detaches a new thread for each incoming connection (transport::Session).
+ * The entry point from the TransportLayer into Mongod. startSession() hands each incoming
+ * connection (transport::Session) to the configured service executor, which runs its
+ * request/response cycles on a dedicated thread or on a shared worker pool.
  */
 class ServiceEntryPointMongod final : public ServiceEntryPoint {
     MONGO_DISALLOW_COPYING(ServiceEntryPointMongod);
@@ -60,7 +62,9 @@ public:
     }
 
 private:
-    void _sessionLoop(const transport::SessionHandle& session);
+    struct SessionState;
+
+    SessionCycleResult _sessionCycle(const transport::SessionHandle& session, SessionState* state);
 
     transport::TransportLayer* _tl;
     AtomicWord<std::size_t> _nWorkers;
@@ -48,6 +48,7 @@
 #include "mongo/db/sorter/sorter.h"
 
 #include <boost/filesystem/operations.hpp>
+#include <exception>
 #include <snappy.h>
 #include <vector>
 
@@ -59,6 +60,11 @@
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/s/mongos_options.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/destructor_guard.h"
@@ -132,6 +138,106 @@ private:
     const std::string _fileName;
 };
 
+/**
+ * Runs a task on a thread of its own. An exception thrown by the task is rethrown by join().
+ */
+class BackgroundThread {
+    MONGO_DISALLOW_COPYING(BackgroundThread);
+
+public:
+    explicit BackgroundThread(stdx::function<void()> task)
+        : _thread([this, task] {
+              try {
+                  task();
+              } catch (...) {
+                  _error = std::current_exception();
+              }
+          }) {}
+
+    ~BackgroundThread() {
+        if (_thread.joinable())
+            _thread.join();
+    }
+
+    void join() {
+        _thread.join();
+        if (_error)
+            std::rethrow_exception(_error);
+    }
+
+private:
+    std::exception_ptr _error;
+    stdx::thread _thread;  // Must be last, as it uses the other members as soon as it starts.
+};
+
+/**
+ * Calls task(i) for each i in [0, n), with i == 0 on the calling thread and each of the others on
+ * a thread of its own. Once all calls have returned, rethrows the first exception any of them threw.
+ */
+template <typename Task>
+void runConcurrently(size_t n, const Task& task) {
+    std::vector<std::unique_ptr<BackgroundThread>> threads;
+    for (size_t i = 1; i < n; i++) {
+        threads.push_back(stdx::make_unique<BackgroundThread>([&task, i] { task(i); }));
+    }
+
+    std::exception_ptr error;
+    try {
+        if (n > 0)
+            task(0);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    for (auto&& thread : threads) {
+        try {
+            thread->join();
+        } catch (...) {
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+/**
+ * Stably sorts 'data' with up to 'numThreads' threads. Each thread sorts an equal share of 'data',
+ * then neighbouring shares are merged pairwise, again in parallel.
+ */
+template <typename Container, typename Less>
+void parallelStableSort(Container& data, const Less& less, size_t numThreads) {
+    // Below this many elements per thread, starting threads costs more than it saves.
+    const size_t kMinElementsPerThread = 16 * 1024;
+
+    const size_t numChunks = std::min(numThreads, data.size() / kMinElementsPerThread);
+    if (numChunks <= 1) {
+        std::stable_sort(data.begin(), data.end(), less);
+        return;
+    }
+
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= numChunks; i++) {
+        bounds.push_back(data.size() * i / numChunks);
+    }
+
+    const auto begin = data.begin();
+    runConcurrently(numChunks, [&](size_t i) {
+        std::stable_sort(begin + bounds[i], begin + bounds[i + 1], less);
+    });
+
+    for (size_t width = 1; width < numChunks; width *= 2) {
+        const size_t numMerges = (numChunks - width + 2 * width - 1) / (2 * width);
+        runConcurrently(numMerges, [&](size_t i) {
+            const size_t first = 2 * width * i;
+            const size_t last = std::min(first + 2 * width, numChunks);
+            std::inplace_merge(
+                begin + bounds[first], begin + bounds[first + width], begin + bounds[last], less);
+        });
+    }
+}
+
 /** Returns results from sorted in-memory storage */
 template <typename Key, typename Value>
 class InMemIterator : public SortIteratorInterface<Key, Value> {
@@ -290,6 +396,113 @@ private:
     std::ifstream _file;
 };
 
+/**
+ * Reads ahead of its consumer by pulling the data of another iterator on a background thread, in
+ * batches of about kBatchBytes, holding at most kMaxBatches batches that haven't been consumed.
+ */
+template <typename Key, typename Value>
+class PrefetchIterator : public SortIteratorInterface<Key, Value> {
+public:
+    typedef SortIteratorInterface<Key, Value> Input;
+    typedef std::pair<Key, Value> Data;
+
+    static const size_t kBatchBytes = 1024 * 1024;
+    static const size_t kMaxBatches = 2;
+
+    explicit PrefetchIterator(std::shared_ptr<Input> input)
+        : _input(std::move(input)), _thread([this] { produce(); }) {}
+
+    ~PrefetchIterator() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _shutdown = true;
+        }
+        _condition.notify_all();
+        _thread.join();
+    }
+
+    bool more() {
+        if (_position < _current.size())
+            return true;
+
+        _current.clear();
+        _position = 0;
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _condition.wait(lk, [this] { return !_batches.empty() || _inputDone; });
+        if (_batches.empty()) {
+            if (_error)
+                std::rethrow_exception(_error);
+            return false;
+        }
+
+        _current = std::move(_batches.front());
+        _batches.pop_front();
+        lk.unlock();
+        _condition.notify_all();
+        return true;
+    }
+
+    Data next() {
+        verify(more());
+        return std::move(_current[_position++]);
+    }
+
+private:
+    void produce() {
+        try {
+            while (_input->more()) {
+                std::vector<Data> batch;
+                size_t batchBytes = 0;
+                while (batchBytes < kBatchBytes && _input->more()) {
+                    Data data = _input->next();
+                    batchBytes += data.first.memUsageForSorter() + data.second.memUsageForSorter();
+                    batch.emplace_back(data.first.getOwned(), data.second.getOwned());
+                }
+
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _condition.wait(lk, [this] { return _batches.size() < kMaxBatches || _shutdown; });
+                if (_shutdown)
+                    return;
+
+                _batches.push_back(std::move(batch));
+                lk.unlock();
+                _condition.notify_all();
+            }
+        } catch (...) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _error = std::current_exception();
+        }
+
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _inputDone = true;
+        }
+        _condition.notify_all();
+    }
+
+    // Only used by the background thread while it runs.
+    const std::shared_ptr<Input> _input;
+
+    // Only used by the consumer.
+    std::vector<Data> _current;
+    size_t _position = 0;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _condition;
+    std::deque<std::vector<Data>> _batches;
+    bool _inputDone = false;
+    bool _shutdown = false;
+    std::exception_ptr _error;
+
+    stdx::thread _thread;  // Must be last, as it uses the other members as soon as it starts.
+};
+
+template <typename Key, typename Value>
+const size_t PrefetchIterator<Key, Value>::kBatchBytes;
+template <typename Key, typename Value>
+const size_t PrefetchIterator<Key, Value>::kMaxBatches;
+
 /** Merge-sorts results from 0 or more FileIterators */
 template <typename Key, typename Value, typename Comparator>
 class MergeIterator : public SortIteratorInterface<Key, Value> {
@@ -426,7 +639,15 @@ public:
     NoLimitSorter(const SortOptions& opts,
                   const Comparator& comp,
                   const Settings& settings = Settings())
-        : _comp(comp), _settings(settings), _opts(opts), _memUsed(0) {
+        : _comp(comp),
+          _settings(settings),
+          _opts(opts),
+          _memUsed(0),
+          // Runs being spilled in the background hold on to their memory while the next run
+          // accumulates, so the memory limit is shared between them.
+          _maxRunMemoryUsageBytes(opts.extSortAllowed
+                                      ? opts.maxMemoryUsageBytes / (opts.workerThreads + 1)
+                                      : opts.maxMemoryUsageBytes) {
         verify(_opts.limit == 0);
     }
 
@@ -436,23 +657,26 @@ public:
         _memUsed += key.memUsageForSorter();
         _memUsed += val.memUsageForSorter();
 
-        if (_memUsed > _opts.maxMemoryUsageBytes)
+        if (_memUsed > _maxRunMemoryUsageBytes)
             spill();
     }
 
     Iterator* done() {
-        if (_iters.empty()) {
-            sort();
+        if (_iters.empty() && _spillingRuns.empty()) {
+            sort(&_data, _opts.workerThreads + 1);
             return new InMemIterator<Key, Value>(_data);
         }
 
         spill();
+        while (!_spillingRuns.empty()) {
+            finishOldestSpillingRun();
+        }
         return Iterator::merge(_iters, _opts, _comp);
     }
 
     // TEMP these are here for compatibility. Will be replaced with a general stats API
     int numFiles() const {
-        return _iters.size();
+        return _iters.size() + _spillingRuns.size();
     }
     size_t memUsed() const {
         return _memUsed;
@@ -471,15 +695,48 @@ private:
         const Comparator& _comp;
     };
 
-    void sort() {
+    /**
+     * A run of data being sorted and written to a file in the background.
+     */
+    struct SpillingRun {
+        std::deque<Data> data;
+        std::shared_ptr<Iterator> iter;
+        std::unique_ptr<BackgroundThread> thread;
+    };
+
+    void sort(std::deque<Data>* data, size_t numThreads) const {
         STLComparator less(_comp);
-        std::stable_sort(_data.begin(), _data.end(), less);
+        parallelStableSort(*data, less, numThreads);
 
         // Does 2x more compares than stable_sort
         // TODO test on windows
         // std::sort(_data.begin(), _data.end(), comp);
     }
 
+    std::shared_ptr<Iterator> sortAndWrite(std::deque<Data>* data) const {
+        sort(data, 1);
+
+        SortedFileWriter<Key, Value> writer(_opts, _settings);
+        for (; !data->empty(); data->pop_front()) {
+            writer.addAlreadySorted(data->front().first, data->front().second);
+        }
+
+        return std::shared_ptr<Iterator>(writer.done());
+    }
+
+    /**
+     * Waits for the oldest run being spilled in the background, and adds its file to '_iters'.
+     * Runs are finished in the order they were started in, so that '_iters' stays in input order,
+     * which the merge relies on to be stable.
+     */
+    void finishOldestSpillingRun() {
+        std::unique_ptr<SpillingRun> run = std::move(_spillingRuns.front());
+        _spillingRuns.pop_front();
+
+        run->thread->join();
+        _iters.push_back(std::move(run->iter));
+    }
+
     void spill() {
         if (_data.empty())
             return;
@@ -497,24 +754,36 @@ private:
                           << " Pass allowDiskUse:true to opt in.");
         }
 
-        sort();
+        _memUsed = 0;
 
-        SortedFileWriter<Key, Value> writer(_opts, _settings);
-        for (; !_data.empty(); _data.pop_front()) {
-            writer.addAlreadySorted(_data.front().first, _data.front().second);
+        if (_opts.workerThreads == 0) {
+            _iters.push_back(sortAndWrite(&_data));
+            return;
         }
 
-        _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
+        if (_spillingRuns.size() >= _opts.workerThreads) {
+            finishOldestSpillingRun();
+        }
 
-        _memUsed = 0;
+        auto run = stdx::make_unique<SpillingRun>();
+        run->data.swap(_data);
+        SpillingRun* const runPtr = run.get();
+        run->thread = stdx::make_unique<BackgroundThread>(
+            [this, runPtr] { runPtr->iter = sortAndWrite(&runPtr->data); });
+        _spillingRuns.push_back(std::move(run));
     }
 
     const Comparator _comp;
     const Settings _settings;
     SortOptions _opts;
     size_t _memUsed;
+    const size_t _maxRunMemoryUsageBytes;
     std::deque<Data> _data;                         // the "current" data
     std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
+
+    // Runs still being spilled, oldest first. Declared last so that they are waited for before any
+    // other member is destroyed.
+    std::deque<std::unique_ptr<SpillingRun>> _spillingRuns;
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -934,7 +1203,34 @@ SortIteratorInterface<Key, Value>* SortIteratorInterface<Key, Value>::merge(
     const std::vector<std::shared_ptr<SortIteratorInterface>>& iters,
     const SortOptions& opts,
     const Comparator& comp) {
-    return new sorter::MergeIterator<Key, Value, Comparator>(iters, opts, comp);
+    if (opts.workerThreads == 0 || iters.size() < 2) {
+        return new sorter::MergeIterator<Key, Value, Comparator>(iters, opts, comp);
+    }
+
+    // Split the inputs into up to 'workerThreads' groups, each merged on a background thread which
+    // reads ahead of the final merge of the groups on this thread. Reading, decompressing and most
+    // of the comparing is thus spread over the workers. The groups are contiguous ranges of the
+    // inputs so that the final merge, which prefers earlier inputs on ties, stays stable.
+    const size_t numGroups = std::min<size_t>(opts.workerThreads, iters.size());
+    std::vector<std::shared_ptr<SortIteratorInterface>> groups;
+    for (size_t i = 0; i < numGroups; i++) {
+        const size_t first = iters.size() * i / numGroups;
+        const size_t last = iters.size() * (i + 1) / numGroups;
+
+        std::shared_ptr<SortIteratorInterface> group;
+        if (last - first == 1) {
+            group = iters[first];
+        } else {
+            group = std::make_shared<sorter::MergeIterator<Key, Value, Comparator>>(
+                std::vector<std::shared_ptr<SortIteratorInterface>>(iters.begin() + first,
+                                                                    iters.begin() + last),
+                opts,
+                comp);
+        }
+        groups.push_back(std::make_shared<sorter::PrefetchIterator<Key, Value>>(std::move(group)));
+    }
+
+    return new sorter::MergeIterator<Key, Value, Comparator>(groups, opts, comp);
 }
 
 template <typename Key, typename Value>
@@ -98,8 +98,13 @@ struct SortOptions {
     bool extSortAllowed;         /// If false, uassert if more mem needed than allowed.
     std::string tempDir;         /// Directory to directly place files in.
                                  /// Must be explicitly set if extSortAllowed is true.
+    unsigned workerThreads;      /// Background threads to sort, spill and merge with. 0 for none.
+                                 /// Keys, values and comparators must then be safe to use from
+                                 /// several threads, and iterators passed to merge() must not
+                                 /// depend on the thread that calls them.
 
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    SortOptions()
+        : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false), workerThreads(0) {}
 
     /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -122,6 +127,11 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& WorkerThreads(unsigned newWorkerThreads) {
+        workerThreads = newWorkerThreads;
+        return *this;
+    }
 };
 
 /// This is the output from the sorting framework
@@ -223,6 +233,7 @@ private:
     template class ::mongo::sorter::MergeIterator<Key, Value, Comparator>;               \
     template class ::mongo::sorter::InMemIterator<Key, Value>;                           \
     template class ::mongo::sorter::FileIterator<Key, Value>;                            \
+    template class ::mongo::sorter::PrefetchIterator<Key, Value>;                        \
     /* factory functions */                                                              \
     template ::mongo::SortIteratorInterface<Key, Value>* ::mongo::                       \
         SortIteratorInterface<Key, Value>::merge<Comparator>(                            \
@@ -544,6 +544,51 @@ class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     }
     enum { MEM_LIMIT = 32 * 1024 };
 };
+
+template <typename Parent>
+class WithWorkerThreads : public Parent {
+    SortOptions adjustSortOptions(SortOptions opts) {
+        return Parent::adjustSortOptions(opts).WorkerThreads(4);
+    }
+};
+
+class ParallelSortIsStable {
+public:
+    void run() {
+        unittest::TempDir tempDir("sorterTests");
+        const SortOptions opts = SortOptions().TempDir(tempDir.path()).WorkerThreads(4);
+
+        // Sort in memory, then with spilling.
+        for (size_t memLimit : {64 * 1024 * 1024, 64 * 1024}) {
+            std::unique_ptr<IWSorter> sorter(
+                IWSorter::make(SortOptions(opts).MaxMemoryUsageBytes(memLimit).ExtSortAllowed(),
+                               IWComparator(ASC)));
+
+            // The values count up, so must stay in order among equal keys.
+            const int numItems = 200 * 1000;
+            for (int i = 0; i < numItems; i++) {
+                sorter->add(i % 100, i);
+            }
+
+            std::unique_ptr<IWIterator> it(sorter->done());
+            IWPair last;
+            int count = 0;
+            for (; it->more(); count++) {
+                IWPair current = it->next();
+                if (count > 0) {
+                    ASSERT_LESS_THAN_OR_EQUALS(last.first, current.first);
+                    if (last.first == current.first) {
+                        ASSERT_LESS_THAN(last.second, current.second);
+                    }
+                }
+                last = current;
+            }
+            ASSERT_EQUALS(count, numItems);
+        }
+
+        ASSERT(boost::filesystem::is_empty(tempDir.path()));
+    }
+};
 }
 
 class SorterSuite : public mongo::unittest::Suite {
@@ -565,6 +610,8 @@ public:
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/true>>();    // fits in mem
         add<SorterTests::LotsOfDataWithLimit<5000, /*random=*/false>>();  // spills
         add<SorterTests::LotsOfDataWithLimit<5000, /*random=*/true>>();   // spills
+        add<SorterTests::WithWorkerThreads<SorterTests::LotsOfDataLittleMemory<true>>>();
+        add<SorterTests::ParallelSortIsStable>();
     }
 };
 
@@ -41,10 +41,13 @@ namespace mongo {
  *   lastDeleteStats: [
  *     {
  *       deleteDocs: NumberLong(5);
+ *       deletedBytes: NumberLong(2048);
  *       queueStart: ISODate("2014-06-11T22:45:30.221Z"),
  *       queueEnd: ISODate("2014-06-11T22:45:30.221Z"),
  *       deleteStart: ISODate("2014-06-11T22:45:30.221Z"),
  *       deleteEnd: ISODate("2014-06-11T22:45:30.221Z"),
+ *       docsPerSec: 5000.0,
+ *       bytesPerSec: 2048000.0,
  *       waitForReplStart: ISODate("2014-06-11T22:45:30.221Z"),
  *       waitForReplEnd: ISODate("2014-06-11T22:45:30.221Z")
  *     }
@@ -74,6 +77,7 @@ public:
              ++it) {
             BSONObjBuilder entryBuilder;
             entryBuilder.append("deletedDocs", (*it)->deletedDocCount);
+            entryBuilder.append("deletedBytes", (*it)->deletedBytes);
 
             if ((*it)->queueEndTS > Date_t()) {
                 entryBuilder.append("queueStart", (*it)->queueStartTS);
@@ -84,6 +88,15 @@ public:
                 entryBuilder.append("deleteStart", (*it)->deleteStartTS);
                 entryBuilder.append("deleteEnd", (*it)->deleteEndTS);
 
+                const auto deleteDurationMs =
+                    durationCount<Milliseconds>((*it)->deleteEndTS - (*it)->deleteStartTS);
+                if (deleteDurationMs > 0) {
+                    const double deleteDurationSecs = deleteDurationMs / 1000.0;
+                    entryBuilder.append("docsPerSec",
+                                        (*it)->deletedDocCount / deleteDurationSecs);
+                    entryBuilder.append("bytesPerSec", (*it)->deletedBytes / deleteDurationSecs);
+                }
+
                 const auto waitForReplDurationMs =
                     durationCount<Milliseconds>((*it)->waitForReplDurationMs);
                 if (waitForReplDurationMs > 0) {
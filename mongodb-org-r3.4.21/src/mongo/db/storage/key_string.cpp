@@ -1711,6 +1711,41 @@ BSONObj KeyString::toBson(const char* buffer, size_t len, Ordering ord, const Ty
     return builder.obj();
 }
 
+BSONObj KeyString::toBsonWithFieldNames(const char* buffer,
+                                        size_t len,
+                                        Ordering ord,
+                                        const TypeBits& typeBits,
+                                        const std::vector<std::string>& fieldNames) {
+    BSONObjBuilder builder;
+    BufReader reader(buffer, len);
+    TypeBits::Reader typeBitsReader(typeBits);
+    for (size_t i = 0; reader.remaining(); i++) {
+        const bool invert = (ord.get(i) == -1);
+        uint8_t ctype = readType<uint8_t>(&reader, invert);
+        if (ctype == kLess || ctype == kGreater) {
+            ctype = readType<uint8_t>(&reader, invert);
+        }
+
+        if (ctype == kEnd)
+            break;
+
+        if (i < fieldNames.size() && !fieldNames[i].empty()) {
+            toBsonValue(ctype,
+                        &reader,
+                        &typeBitsReader,
+                        invert,
+                        typeBits.version,
+                        &(builder << fieldNames[i]));
+        } else {
+            // The value must still be consumed to keep the reader and the type bits in step.
+            BSONObjBuilder skipped;
+            toBsonValue(
+                ctype, &reader, &typeBitsReader, invert, typeBits.version, &(skipped << ""));
+        }
+    }
+    return builder.obj();
+}
+
 BSONObj KeyString::toBson(StringData data, Ordering ord, const TypeBits& typeBits) {
     return toBson(data.rawData(), data.size(), ord, typeBits);
 }
@@ -31,6 +31,8 @@
 #pragma once
 
 #include <limits>
+#include <string>
+#include <vector>
 
 #include "mongo/base/static_assert.h"
 #include "mongo/bson/bsonmisc.h"
@@ -295,6 +297,17 @@ public:
     static BSONObj toBson(StringData data, Ordering ord, const TypeBits& types);
     static BSONObj toBson(const char* buffer, size_t len, Ordering ord, const TypeBits& types);
 
+    /**
+     * Decodes a key into a document in one pass, naming the i-th key field 'fieldNames[i]'.
+     * Key fields whose name is empty, or that are past the end of 'fieldNames', are decoded but
+     * left out of the result. Used to build covered projections without an intermediate key.
+     */
+    static BSONObj toBsonWithFieldNames(const char* buffer,
+                                        size_t len,
+                                        Ordering ord,
+                                        const TypeBits& types,
+                                        const std::vector<std::string>& fieldNames);
+
     /**
      * Decodes a RecordId from the end of a buffer.
      */
@@ -247,6 +247,29 @@ TEST_F(KeyStringTest, Compound1) {
     ROUNDTRIP(version, BSON("" << BSON("" << 5) << "" << 1));
 }
 
+TEST_F(KeyStringTest, ToBsonWithFieldNames) {
+    // The skipped field carries type bits, which must still be consumed for the fields after it.
+    const Ordering ord = Ordering::make(BSON("a" << 1 << "b" << -1 << "c" << 1 << "d" << 1));
+    BSONObj key = BSON("" << 5.0 << "" << 7LL << "" << BSON("x" << 1) << ""
+                          << "str");
+    KeyString ks(version, key, ord);
+
+    const std::vector<std::string> fieldNames{"a", "", "c", "d"};
+    BSONObj projected = KeyString::toBsonWithFieldNames(
+        ks.getBuffer(), ks.getSize(), ord, ks.getTypeBits(), fieldNames);
+    ASSERT_BSONOBJ_EQ(projected,
+                      BSON("a" << 5.0 << "c" << BSON("x" << 1) << "d"
+                               << "str"));
+    ASSERT_EQ(NumberDouble, projected["a"].type());
+
+    // Key fields past the end of the names are left out.
+    const std::vector<std::string> prefixNames{"", "b"};
+    projected = KeyString::toBsonWithFieldNames(
+        ks.getBuffer(), ks.getSize(), ord, ks.getTypeBits(), prefixNames);
+    ASSERT_BSONOBJ_EQ(projected, BSON("b" << 7LL));
+    ASSERT_EQ(NumberLong, projected["b"].type());
+}
+
 TEST_F(KeyStringTest, Undef1) {
     ROUNDTRIP(version, BSON("" << BSONUndefined));
 }
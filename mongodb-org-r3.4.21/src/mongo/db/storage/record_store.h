@@ -247,6 +247,39 @@ public:
      */
     virtual boost::optional<Record> seekExact(const RecordId& id) = 0;
 
+    /**
+     * Seeks to the Records with the provided ids, which must be in non-decreasing order, as if by
+     * calling seekExact() on each. Returns one entry per id, in the same order, which is boost::none
+     * if the Record doesn't exist. The returned Records own their data.
+     *
+     * The resulting position of the cursor is unspecified. Implementations should override this
+     * if they can serve sorted ids more cheaply than with independent seeks.
+     */
+    virtual std::vector<boost::optional<Record>> seekExactBatch(const std::vector<RecordId>& ids) {
+        std::vector<boost::optional<Record>> records;
+        records.reserve(ids.size());
+        for (auto&& id : ids) {
+            auto record = seekExact(id);
+            if (record) {
+                record->data.makeOwned();
+            }
+            records.push_back(std::move(record));
+        }
+        return records;
+    }
+
+    /**
+     * Limits next() on a forward cursor to the Records with ids in ['start', 'end'), so that the
+     * first call to next() lands on the first Record at or after 'start' without reading the ones
+     * before it. A null RecordId leaves that side of the range open. Returns false if the cursor
+     * can't do this, which is the case unless Records come back in RecordId order.
+     *
+     * Must be called before the cursor is positioned. Doesn't affect seekExact().
+     */
+    virtual bool setRange(const RecordId& start, const RecordId& end) {
+        return false;
+    }
+
     /**
      * Prepares for state changes in underlying data without necessarily saving the current
      * state.
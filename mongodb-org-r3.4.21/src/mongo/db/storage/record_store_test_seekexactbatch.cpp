@@ -0,0 +1,110 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/record_store_test_harness.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/record_data.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using std::string;
+using std::unique_ptr;
+
+// Seek to a sorted batch of ids, some of them repeated and some far apart, and check that each
+// result matches what seekExact() finds. Engines which can detect deleted records are also asked
+// for ids which no longer exist.
+TEST(RecordStoreTestHarness, SeekExactBatch) {
+    unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int nToInsert = 100;
+    std::vector<RecordId> locs;
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        for (int i = 0; i < nToInsert; i++) {
+            string data = "record " + std::to_string(i);
+
+            WriteUnitOfWork uow(opCtx.get());
+            StatusWith<RecordId> res =
+                rs->insertRecord(opCtx.get(), data.c_str(), data.size() + 1, false);
+            ASSERT_OK(res.getStatus());
+            locs.push_back(res.getValue());
+            uow.commit();
+        }
+    }
+    std::sort(locs.begin(), locs.end());
+
+    if (harnessHelper->supportsDocLocking()) {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        for (int i = 0; i < nToInsert; i += 3) {
+            WriteUnitOfWork uow(opCtx.get());
+            rs->deleteRecord(opCtx.get(), locs[i]);
+            uow.commit();
+        }
+    }
+
+    std::vector<RecordId> ids;
+    for (int i = 0; i < nToInsert; i++) {
+        if (i < 20 || i % 15 == 0) {
+            ids.push_back(locs[i]);
+        }
+        if (i % 10 == 0) {
+            ids.push_back(locs[i]);
+        }
+    }
+    ASSERT(std::is_sorted(ids.begin(), ids.end()));
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    auto batchCursor = rs->getCursor(opCtx.get());
+    auto records = batchCursor->seekExactBatch(ids);
+    ASSERT_EQUALS(ids.size(), records.size());
+
+    auto cursor = rs->getCursor(opCtx.get());
+    for (size_t i = 0; i < ids.size(); i++) {
+        auto expected = cursor->seekExact(ids[i]);
+        ASSERT_EQUALS(bool(expected), bool(records[i]));
+        if (expected) {
+            ASSERT_EQUALS(ids[i], records[i]->id);
+            ASSERT_EQUALS(string(expected->data.data()), string(records[i]->data.data()));
+            ASSERT(records[i]->data.isOwned());
+        }
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -29,6 +29,8 @@
 #include <boost/optional/optional.hpp>
 #include <boost/optional/optional_io.hpp>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
@@ -253,6 +255,18 @@ public:
          */
         virtual void setEndPosition(const BSONObj& key, bool inclusive) = 0;
 
+        /**
+         * Asks the cursor to return each key as a document whose i-th field is named
+         * 'fieldNames[i]', leaving out key fields with an empty name, rather than as an index key
+         * with empty field names. Returns false if the cursor can't do this, in which case keys
+         * are returned as usual.
+         *
+         * This should be done before seeking. Returned keys are always owned while it is set.
+         */
+        virtual bool setKeyFieldNames(const std::vector<std::string>& fieldNames) {
+            return false;
+        }
+
         /**
          * Moves forward and returns the new data or boost::none if there is no more data.
          * If not positioned, returns boost::none.
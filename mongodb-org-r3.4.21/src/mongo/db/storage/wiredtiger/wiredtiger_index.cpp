@@ -674,6 +674,11 @@ public:
         return curr(parts);
     }
 
+    bool setKeyFieldNames(const std::vector<std::string>& fieldNames) override {
+        _keyFieldNames = fieldNames;
+        return true;
+    }
+
     void setEndPosition(const BSONObj& key, bool inclusive) override {
         TRACE_CURSOR << "setEndPosition inclusive: " << inclusive << ' ' << key;
         if (key.isEmpty()) {
@@ -781,7 +786,14 @@ protected:
         dassert(!_id.isNull());
 
         BSONObj bson;
-        if (TRACING_ENABLED || (parts & kWantKey)) {
+        if (!_keyFieldNames.empty() && (parts & kWantKey)) {
+            // Decode straight into the caller's field names rather than into an index key that
+            // the caller would only copy again.
+            bson = KeyString::toBsonWithFieldNames(
+                _key.getBuffer(), _key.getSize(), _idx.ordering(), _typeBits, _keyFieldNames);
+
+            TRACE_CURSOR << " returning " << bson << ' ' << _id;
+        } else if (TRACING_ENABLED || (parts & kWantKey)) {
             bson = KeyString::toBson(_key.getBuffer(), _key.getSize(), _idx.ordering(), _typeBits);
 
             TRACE_CURSOR << " returning " << bson << ' ' << _id;
@@ -933,6 +945,9 @@ protected:
     KeyString _query;
 
     std::unique_ptr<KeyString> _endPosition;
+
+    // Names for the fields of returned keys, if set by setKeyFieldNames().
+    std::vector<std::string> _keyFieldNames;
 };
 
 class WiredTigerIndexStandardCursor final : public WiredTigerIndexCursorBase {
@@ -56,6 +56,7 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/stats/top.h"
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
@@ -66,6 +67,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_sizer.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/background.h"
@@ -132,6 +134,10 @@ private:
 
 namespace {
 
+// While enabled, the numbers of concurrent read and write transactions set below are only where
+// the WiredTigerTicketSizer starts from, and setParameter can't change them.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveConcurrentTransactions, bool, false);
+
 class TicketServerParameter : public ServerParameter {
     MONGO_DISALLOW_COPYING(TicketServerParameter);
 
@@ -146,6 +152,12 @@ public:
     virtual Status set(const BSONElement& newValueElement) {
         if (!newValueElement.isNumber())
             return Status(ErrorCodes::BadValue, str::stream() << name() << " has to be a number");
+        // The ticket sizer would silently override the new number at its next interval.
+        if (wiredTigerAdaptiveConcurrentTransactions.load()) {
+            return Status(ErrorCodes::IllegalOperation,
+                          str::stream() << name() << " cannot be set while "
+                                        << "wiredTigerAdaptiveConcurrentTransactions is enabled");
+        }
         return _set(newValueElement.numberInt());
     }
 
@@ -177,8 +189,137 @@ TicketHolder openReadTransaction(128);
 TicketServerParameter openReadTransactionParam(&openReadTransaction,
                                                "wiredTigerConcurrentReadTransactions");
 
+// The WiredTigerTicketSizer adjusts the numbers of concurrent transactions every interval, within
+// these bounds.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveConcurrentTransactionsIntervalMillis, int, 1000);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveConcurrentTransactionsMin, int, 16);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveConcurrentTransactionsMax, int, 512);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveConcurrentTransactionsCacheDirtyRatio,
+                              double,
+                              0.15);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveConcurrentTransactionsCacheUsedRatio,
+                              double,
+                              0.92);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveConcurrentTransactionsLatencyRatio, double, 2.0);
+
+WiredTigerTicketSizer ticketSizer;
+
 }  // namespace
 
+class WiredTigerKVEngine::WiredTigerTicketSizerThread : public BackgroundJob {
+public:
+    explicit WiredTigerTicketSizerThread(WT_CONNECTION* conn)
+        : BackgroundJob(false /* deleteSelf */), _conn(conn) {}
+
+    virtual string name() const {
+        return "WTTicketSizer";
+    }
+
+    virtual void run() {
+        Client::initThread(name().c_str());
+
+        LOG(1) << "starting " << name() << " thread";
+
+        WiredTigerSession session(_conn);
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (!_shuttingDown) {
+            const Milliseconds interval(
+                std::max(wiredTigerAdaptiveConcurrentTransactionsIntervalMillis.load(), 10));
+            {
+                MONGO_IDLE_THREAD_BLOCK;
+                _shutdownCondition.wait_for(
+                    lk, interval.toSystemDuration(), [this] { return _shuttingDown; });
+            }
+
+            if (!_shuttingDown && wiredTigerAdaptiveConcurrentTransactions.load()) {
+                _resizeTickets(session.getSession());
+            }
+        }
+        LOG(1) << "stopping " << name() << " thread";
+    }
+
+    void shutdown() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _shuttingDown = true;
+        }
+        _shutdownCondition.notify_one();
+        wait();
+    }
+
+private:
+    void _resizeTickets(WT_SESSION* session) {
+        const auto cacheStat = [session](int key) {
+            return WiredTigerUtil::getStatisticsValueAs<int64_t>(
+                session, "statistics:", "statistics=(fast)", key);
+        };
+        const auto bytesInUse = cacheStat(WT_STAT_CONN_CACHE_BYTES_INUSE);
+        const auto bytesDirty = cacheStat(WT_STAT_CONN_CACHE_BYTES_DIRTY);
+        const auto bytesMax = cacheStat(WT_STAT_CONN_CACHE_BYTES_MAX);
+        for (const auto& stat : {bytesInUse, bytesDirty, bytesMax}) {
+            if (!stat.isOK()) {
+                LOG(1) << "not resizing tickets, unable to read cache statistics: "
+                       << stat.getStatus();
+                return;
+            }
+        }
+        if (bytesMax.getValue() <= 0) {
+            return;
+        }
+
+        WiredTigerTicketSizer::CacheSample cache;
+        cache.usedRatio = static_cast<double>(bytesInUse.getValue()) / bytesMax.getValue();
+        cache.dirtyRatio = static_cast<double>(bytesDirty.getValue()) / bytesMax.getValue();
+
+        BSONObjBuilder latencyBuilder;
+        Top::get(getGlobalServiceContext()).appendGlobalLatencyStats(false, &latencyBuilder);
+        const BSONObj latencies = latencyBuilder.obj();
+
+        WiredTigerTicketSizer::Settings settings;
+        settings.minTickets = wiredTigerAdaptiveConcurrentTransactionsMin.load();
+        settings.maxTickets = wiredTigerAdaptiveConcurrentTransactionsMax.load();
+        settings.cacheDirtyRatio =
+            wiredTigerAdaptiveConcurrentTransactionsCacheDirtyRatio.load();
+        settings.cacheUsedRatio = wiredTigerAdaptiveConcurrentTransactionsCacheUsedRatio.load();
+        settings.latencyRatio = wiredTigerAdaptiveConcurrentTransactionsLatencyRatio.load();
+
+        const auto reads = _sampleQueue(openReadTransaction, latencies["reads"].Obj());
+        _resize(&openReadTransaction, "read", ticketSizer.sizeReads(settings, cache, reads));
+
+        const auto writes = _sampleQueue(openWriteTransaction, latencies["writes"].Obj());
+        _resize(&openWriteTransaction, "write", ticketSizer.sizeWrites(settings, cache, writes));
+    }
+
+    static WiredTigerTicketSizer::QueueSample _sampleQueue(const TicketHolder& holder,
+                                                           const BSONObj& latency) {
+        WiredTigerTicketSizer::QueueSample sample;
+        sample.tickets = holder.outof();
+        sample.waiting = holder.waiting();
+        sample.totalLatencyMicros = latency["latency"].numberLong();
+        sample.totalOps = latency["ops"].numberLong();
+        return sample;
+    }
+
+    static void _resize(TicketHolder* holder, const char* kind, int tickets) {
+        if (tickets == holder->outof()) {
+            return;
+        }
+
+        LOG(1) << "resizing concurrent " << kind << " transactions from " << holder->outof()
+               << " to " << tickets;
+        Status status = holder->resize(tickets);
+        if (!status.isOK()) {
+            warning() << "unable to resize concurrent " << kind << " transactions: " << status;
+        }
+    }
+
+    WT_CONNECTION* _conn;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _shutdownCondition;
+    bool _shuttingDown = false;
+};
+
 WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
                                        const std::string& path,
                                        ClockSource* cs,
@@ -294,6 +435,11 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
     _sizeStorer->fillCache();
 
     Locker::setGlobalThrottling(&openReadTransaction, &openWriteTransaction);
+
+    if (!_readOnly) {
+        _ticketSizerThread = stdx::make_unique<WiredTigerTicketSizerThread>(_conn);
+        _ticketSizerThread->go();
+    }
 }
 
 
@@ -321,6 +467,12 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("totalTickets", openReadTransaction.outof());
         bbb.done();
     }
+    {
+        BSONObjBuilder bbb(bb.subobjStart("adaptive"));
+        bbb.append("enabled", wiredTigerAdaptiveConcurrentTransactions.load());
+        ticketSizer.appendStats(&bbb);
+        bbb.done();
+    }
     bb.done();
 }
 
@@ -330,6 +482,8 @@ void WiredTigerKVEngine::cleanShutdown() {
         syncSizeInfo(true);
     if (_conn) {
         // these must be the last things we do before _conn->close();
+        if (_ticketSizerThread)
+            _ticketSizerThread->shutdown();
         if (_journalFlusher)
             _journalFlusher->shutdown();
         _sizeStorer.reset();
@@ -145,17 +145,19 @@ public:
     void syncSizeInfo(bool sync) const;
 
     /**
-     * Initializes a background job to remove excess documents in the oplog collections.
-     * This applies to the capped collections in the local.oplog.* namespaces (specifically
-     * local.oplog.rs for replica sets and local.oplog.$main for master/slave replication).
+     * Initializes a background job to remove excess documents in a capped collection. This
+     * always applies to the local.oplog.* namespaces (specifically local.oplog.rs for replica
+     * sets and local.oplog.$main for master/slave replication), and to other capped collections
+     * when wiredTigerTruncateCappedCollectionsInBackground is set.
      * Returns true if a background job is running for the namespace.
      */
-    static bool initRsOplogBackgroundThread(StringData ns);
+    static bool initRsBackgroundThread(StringData ns);
 
     static void appendGlobalStats(BSONObjBuilder& b);
 
 private:
     class WiredTigerJournalFlusher;
+    class WiredTigerTicketSizerThread;
 
     Status _salvageIfNeeded(const char* uri);
     void _checkIdentPath(StringData ident);
@@ -179,6 +181,7 @@ private:
     bool _ephemeral;
     bool _readOnly;
     std::unique_ptr<WiredTigerJournalFlusher> _journalFlusher;  // Depends on _sizeStorer
+    std::unique_ptr<WiredTigerTicketSizerThread> _ticketSizerThread;
 
     std::string _rsOptions;
     std::string _indexOptions;
@@ -44,6 +44,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
@@ -88,12 +89,22 @@ bool shouldUseOplogHack(OperationContext* opCtx, const std::string& uri) {
     return (appMetadata.getValue().getIntField("oplogKeyExtractionVersion") == 1);
 }
 
+// The RecordIds of the oplog are optimes, which is how they are best logged.
+std::string describeRecordId(const WiredTigerRecordStore* rs, const RecordId& id) {
+    if (rs->isOplog()) {
+        return str::stream() << "optime " << Timestamp(id.repr()).toStringPretty();
+    }
+    return str::stream() << id;
+}
+
 }  // namespace
 
 MONGO_FP_DECLARE(WTWriteConflictException);
 MONGO_FP_DECLARE(WTWriteConflictExceptionForReads);
 MONGO_FP_DECLARE(WTPausePrimaryOplogDurabilityLoop);
 
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerTruncateCappedCollectionsInBackground, bool, false);
+
 const std::string kWiredTigerEngineName = "wiredTiger";
 
 class WiredTigerRecordStore::OplogStones::InsertChange final : public RecoveryUnit::Change {
@@ -112,8 +123,8 @@ public:
         invariant(_highestInserted.isNormal());
 
         _oplogStones->_currentRecords.addAndFetch(_countInserted);
-        int64_t newCurrentBytes = _oplogStones->_currentBytes.addAndFetch(_bytesInserted);
-        if (newCurrentBytes >= _oplogStones->_minBytesPerStone) {
+        _oplogStones->_currentBytes.addAndFetch(_bytesInserted);
+        if (_oplogStones->_currentStoneIsFull()) {
             _oplogStones->createNewStoneIfNeeded(_highestInserted);
         }
     }
@@ -151,16 +162,8 @@ WiredTigerRecordStore::OplogStones::OplogStones(OperationContext* txn, WiredTige
 
     invariant(rs->isCapped());
     invariant(rs->cappedMaxSize() > 0);
-    unsigned long long maxSize = rs->cappedMaxSize();
-
-    const unsigned long long kMinStonesToKeep = 10ULL;
-    const unsigned long long kMaxStonesToKeep = 100ULL;
-
-    unsigned long long numStones = maxSize / BSONObjMaxInternalSize;
-    size_t numStonesToKeep = std::min(kMaxStonesToKeep, std::max(kMinStonesToKeep, numStones));
-    _minBytesPerStone = maxSize / numStonesToKeep;
-    invariant(_minBytesPerStone > 0);
 
+    size_t numStonesToKeep = _setMinStoneSize_inlock(rs->cappedMaxSize());
     _calculateStones(txn, numStonesToKeep);
     _pokeReclaimThreadIfNeeded();  // Reclaim stones if over the limit.
 }
@@ -217,7 +220,7 @@ void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRec
         return;
     }
 
-    if (_currentBytes.load() < _minBytesPerStone) {
+    if (!_currentStoneIsFull()) {
         // Must have raced to create a new stone, someone else already triggered it.
         return;
     }
@@ -285,12 +288,28 @@ void WiredTigerRecordStore::OplogStones::setMinBytesPerStone(int64_t size) {
     _minBytesPerStone = size;
 }
 
+size_t WiredTigerRecordStore::OplogStones::_setMinStoneSize_inlock(int64_t maxSize) {
+    const unsigned long long kMinStonesToKeep = 10ULL;
+    const unsigned long long kMaxStonesToKeep = 100ULL;
+
+    unsigned long long numStones = maxSize / BSONObjMaxInternalSize;
+    size_t numStonesToKeep = std::min(kMaxStonesToKeep, std::max(kMinStonesToKeep, numStones));
+    _minBytesPerStone = maxSize / numStonesToKeep;
+    invariant(_minBytesPerStone > 0);
+
+    if (_rs->cappedMaxDocs() != -1) {
+        _minRecordsPerStone =
+            std::max(_rs->cappedMaxDocs() / static_cast<int64_t>(numStonesToKeep), int64_t(1));
+    }
+    return numStonesToKeep;
+}
+
 void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* opCtx,
                                                           size_t numStonesToKeep) {
     long long numRecords = _rs->numRecords(opCtx);
     long long dataSize = _rs->dataSize(opCtx);
 
-    log() << "The size storer reports that the oplog contains " << numRecords
+    log() << "The size storer reports that " << _rs->ns() << " contains " << numRecords
           << " records totaling to " << dataSize << " bytes";
 
     // Only use sampling to estimate where to place the oplog stones if the number of samples drawn
@@ -310,13 +329,16 @@ void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* opCt
     // estimate the combined size of the records.
     double avgRecordSize = double(dataSize) / double(numRecords);
     double estRecordsPerStone = std::ceil(_minBytesPerStone / avgRecordSize);
+    if (_minRecordsPerStone > 0) {
+        estRecordsPerStone = std::min(estRecordsPerStone, double(_minRecordsPerStone));
+    }
     double estBytesPerStone = estRecordsPerStone * avgRecordSize;
 
     _calculateStonesBySampling(opCtx, int64_t(estRecordsPerStone), int64_t(estBytesPerStone));
 }
 
 void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationContext* txn) {
-    log() << "Scanning the oplog to determine where to place markers for truncation";
+    log() << "Scanning " << _rs->ns() << " to determine where to place markers for truncation";
 
     long long numRecords = 0;
     long long dataSize = 0;
@@ -324,10 +346,9 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationCon
     auto cursor = _rs->getCursor(txn, true);
     while (auto record = cursor->next()) {
         _currentRecords.addAndFetch(1);
-        int64_t newCurrentBytes = _currentBytes.addAndFetch(record->data.size());
-        if (newCurrentBytes >= _minBytesPerStone) {
-            LOG(1) << "Placing a marker at optime "
-                   << Timestamp(record->id.repr()).toStringPretty();
+        _currentBytes.addAndFetch(record->data.size());
+        if (_currentStoneIsFull()) {
+            LOG(1) << "Placing a marker at " << describeRecordId(_rs, record->id);
 
             OplogStones::Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), record->id};
             _stones.push_back(stone);
@@ -343,8 +364,8 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationCon
 void WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(OperationContext* txn,
                                                                     int64_t estRecordsPerStone,
                                                                     int64_t estBytesPerStone) {
-    Timestamp earliestOpTime;
-    Timestamp latestOpTime;
+    RecordId earliestRecord;
+    RecordId latestRecord;
 
     {
         const bool forward = true;
@@ -352,12 +373,13 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(OperationCon
         auto record = cursor->next();
         if (!record) {
             // This shouldn't really happen unless the size storer values are far off from reality.
-            // The collection is probably empty, but fall back to scanning the oplog just in case.
-            log() << "Failed to determine the earliest optime, falling back to scanning the oplog";
+            // The collection is probably empty, but fall back to scanning it just in case.
+            log() << "Failed to determine the earliest record, falling back to scanning "
+                  << _rs->ns();
             _calculateStonesByScanning(txn);
             return;
         }
-        earliestOpTime = Timestamp(record->id.repr());
+        earliestRecord = record->id;
     }
 
     {
@@ -366,16 +388,18 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(OperationCon
         auto record = cursor->next();
         if (!record) {
             // This shouldn't really happen unless the size storer values are far off from reality.
-            // The collection is probably empty, but fall back to scanning the oplog just in case.
-            log() << "Failed to determine the latest optime, falling back to scanning the oplog";
+            // The collection is probably empty, but fall back to scanning it just in case.
+            log() << "Failed to determine the latest record, falling back to scanning "
+                  << _rs->ns();
             _calculateStonesByScanning(txn);
             return;
         }
-        latestOpTime = Timestamp(record->id.repr());
+        latestRecord = record->id;
     }
 
-    log() << "Sampling from the oplog between " << earliestOpTime.toStringPretty() << " and "
-          << latestOpTime.toStringPretty() << " to determine where to place markers for truncation";
+    log() << "Sampling from " << _rs->ns() << " between " << describeRecordId(_rs, earliestRecord)
+          << " and " << describeRecordId(_rs, latestRecord)
+          << " to determine where to place markers for truncation";
 
     int64_t wholeStones = _rs->numRecords(txn) / estRecordsPerStone;
     int64_t numSamples = kRandomSamplesPerStone * _rs->numRecords(txn) / estRecordsPerStone;
@@ -413,7 +437,7 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(OperationCon
         int sampleIndex = kRandomSamplesPerStone * i - 1;
         RecordId lastRecord = oplogEstimates[sampleIndex];
 
-        log() << "Placing a marker at optime " << Timestamp(lastRecord.repr()).toStringPretty();
+        log() << "Placing a marker at " << describeRecordId(_rs, lastRecord);
         OplogStones::Stone stone = {estRecordsPerStone, estBytesPerStone, lastRecord};
         _stones.push_back(stone);
     }
@@ -449,7 +473,9 @@ public:
             // Nothing after the next line can throw WCEs.
             // Note that an unpositioned (or eof) WT_CURSOR returns the first/last entry in the
             // table when you call next/prev.
-            int advanceRet = WT_READ_CHECK(_forward ? c->next(c) : c->prev(c));
+            int advanceRet = (_lastReturnedId.isNull() && !_rangeStart.isNull())
+                ? seekToRangeStart(c)
+                : WT_READ_CHECK(_forward ? c->next(c) : c->prev(c));
             if (advanceRet == WT_NOTFOUND) {
                 _eof = true;
                 return {};
@@ -471,7 +497,7 @@ public:
             throw WriteConflictException();
         }
 
-        if (!isVisible(id)) {
+        if (!isVisible(id) || (!_rangeEnd.isNull() && id >= _rangeEnd)) {
             _eof = true;
             return {};
         }
@@ -483,6 +509,16 @@ public:
         return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
     }
 
+    bool setRange(const RecordId& start, const RecordId& end) final {
+        if (!_forward)
+            return false;
+
+        invariant(_lastReturnedId.isNull());
+        _rangeStart = start;
+        _rangeEnd = end;
+        return true;
+    }
+
     boost::optional<Record> seekExact(const RecordId& id) final {
         _skipNextAdvance = false;
         WT_CURSOR* c = _cursor->get();
@@ -503,6 +539,78 @@ public:
         return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
     }
 
+    std::vector<boost::optional<Record>> seekExactBatch(const std::vector<RecordId>& ids) final {
+        // Ids close to the last one found are reached by stepping the cursor forward, which is
+        // cheaper than searching the tree again.
+        const int kMaxStepsBetweenIds = 8;
+
+        std::vector<boost::optional<Record>> records;
+        records.reserve(ids.size());
+        _skipNextAdvance = false;
+        WT_CURSOR* c = _cursor->get();
+        bool positioned = false;
+        RecordId positionedId;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            const RecordId& id = ids[i];
+            if (i > 0 && ids[i - 1] == id) {
+                records.push_back(records.back());
+                continue;
+            }
+            invariant(i == 0 || ids[i - 1] < id);
+
+            // Steps forward until at or past 'id', unless it's too far away.
+            for (int steps = 0; positioned && positionedId < id; ++steps) {
+                if (steps == kMaxStepsBetweenIds) {
+                    positioned = false;
+                    break;
+                }
+
+                // Nothing after the next line can throw WCEs.
+                int advanceRet = WT_READ_CHECK(c->next(c));
+                if (advanceRet == WT_NOTFOUND) {
+                    // There are no more records, so none of the remaining ids exist.
+                    records.resize(ids.size());
+                    _eof = true;
+                    return records;
+                }
+                invariantWTOK(advanceRet);
+
+                int64_t key;
+                invariantWTOK(c->get_key(c, &key));
+                positionedId = _fromKey(key);
+            }
+
+            if (!positioned) {
+                c->set_key(c, _makeKey(id));
+                // Nothing after the next line can throw WCEs.
+                int seekRet = WT_READ_CHECK(c->search(c));
+                if (seekRet == WT_NOTFOUND) {
+                    records.push_back(boost::none);
+                    continue;
+                }
+                invariantWTOK(seekRet);
+                positioned = true;
+                positionedId = id;
+            }
+
+            if (positionedId != id) {
+                records.push_back(boost::none);
+                continue;
+            }
+
+            WT_ITEM value;
+            invariantWTOK(c->get_value(c, &value));
+            records.push_back(Record{
+                id,
+                RecordData(static_cast<const char*>(value.data), static_cast<int>(value.size))
+                    .getOwned()});
+        }
+
+        _lastReturnedId = positioned ? positionedId : RecordId();
+        _eof = !positioned;
+        return records;
+    }
+
     void save() final {
         try {
             if (_cursor)
@@ -577,6 +685,19 @@ public:
     }
 
 private:
+    // Positions the cursor on the first record at or after _rangeStart, returning WT_NOTFOUND if
+    // there isn't one.
+    int seekToRangeStart(WT_CURSOR* c) {
+        c->set_key(c, _makeKey(_rangeStart));
+        int cmp;
+        int ret = WT_READ_CHECK(c->search_near(c, &cmp));
+        if (ret == 0 && cmp < 0) {
+            // Landed on the record before the start of the range.
+            ret = WT_READ_CHECK(c->next(c));
+        }
+        return ret;
+    }
+
     bool isVisible(const RecordId& id) {
         if (!_rs._isCapped)
             return true;
@@ -606,17 +727,15 @@ private:
     bool _eof = false;
     RecordId _lastReturnedId;  // If null, need to seek to first/last record.
     const RecordId _readUntilForOplog;
+
+    // Bounds set by setRange(), where a null RecordId leaves that side open.
+    RecordId _rangeStart;
+    RecordId _rangeEnd;
 };
 
 void WiredTigerRecordStore::OplogStones::adjust(int64_t maxSize) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    const unsigned long long kMinStonesToKeep = 10ULL;
-    const unsigned long long kMaxStonesToKeep = 100ULL;
-
-    unsigned long long numStones = maxSize / BSONObjMaxInternalSize;
-    size_t numStonesToKeep = std::min(kMaxStonesToKeep, std::max(kMinStonesToKeep, numStones));
-    _minBytesPerStone = maxSize / numStonesToKeep;
-    invariant(_minBytesPerStone > 0);
+    _setMinStoneSize_inlock(maxSize);
     _pokeReclaimThreadIfNeeded();
 }
 
@@ -849,7 +968,9 @@ WiredTigerRecordStore::WiredTigerRecordStore(OperationContext* ctx,
             _sizeStorer->onCreate(this, 0, 0);
     }
 
-    if (WiredTigerKVEngine::initRsOplogBackgroundThread(ns)) {
+    const bool useStones =
+        _isOplog || (_isCapped && wiredTigerTruncateCappedCollectionsInBackground);
+    if (useStones && WiredTigerKVEngine::initRsBackgroundThread(ns)) {
         _oplogStones = std::make_shared<OplogStones>(ctx, this);
     }
 
@@ -1217,11 +1338,18 @@ bool WiredTigerRecordStore::yieldAndAwaitOplogDeletionRequest(OperationContext*
     return !oplogStones->isDead();
 }
 
-void WiredTigerRecordStore::reclaimOplog(OperationContext* txn) {
+bool WiredTigerRecordStore::reclaimOplog(OperationContext* txn) {
     while (auto stone = _oplogStones->peekOldestStoneIfNeeded()) {
         invariant(stone->lastRecord.isNormal());
 
-        LOG(1) << "Truncating the oplog between " << _oplogStones->firstRecord << " and "
+        // Other capped collections may only lose records that every reader can already see.
+        if (!_isOplog && isCappedHidden(stone->lastRecord)) {
+            LOG(1) << "Not truncating " << ns() << " up to " << stone->lastRecord
+                   << " while earlier inserts are uncommitted";
+            return false;
+        }
+
+        LOG(1) << "Truncating " << ns() << " between " << _oplogStones->firstRecord << " and "
                << stone->lastRecord << " to remove approximately " << stone->records
                << " records totaling to " << stone->bytes << " bytes";
 
@@ -1234,21 +1362,57 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* txn) {
             WiredTigerCursor cwrap(_uri, _tableId, true, txn);
             WT_CURSOR* cursor = cwrap.get();
 
-            // The first record in the oplog should be within the truncate range.
-            int ret = WT_READ_CHECK(cursor->next(cursor));
-            invariantWTOK(ret);
-            int64_t key;
-            invariantWTOK(cursor->get_key(cursor, &key));
-            RecordId firstRecord = _fromKey(key);
-            if (firstRecord < _oplogStones->firstRecord || firstRecord > stone->lastRecord) {
-                warning() << "First oplog record " << firstRecord << " is not in truncation range ("
-                          << _oplogStones->firstRecord << ", " << stone->lastRecord << ")";
+            int64_t recordsRemoved = stone->records;
+            int64_t bytesRemoved = stone->bytes;
+            if (_isOplog) {
+                // The first record in the oplog should be within the truncate range.
+                int ret = WT_READ_CHECK(cursor->next(cursor));
+                invariantWTOK(ret);
+                int64_t key;
+                invariantWTOK(cursor->get_key(cursor, &key));
+                RecordId firstRecord = _fromKey(key);
+                if (firstRecord < _oplogStones->firstRecord || firstRecord > stone->lastRecord) {
+                    warning() << "First oplog record " << firstRecord
+                              << " is not in truncation range (" << _oplogStones->firstRecord
+                              << ", " << stone->lastRecord << ")";
+                }
+            } else {
+                // The indexes of other capped collections have to be maintained, so visit each
+                // record in the range. This also makes the count and size adjustments exact.
+                recordsRemoved = 0;
+                bytesRemoved = 0;
+
+                stdx::lock_guard<stdx::mutex> cappedCallbackLock(_cappedCallbackMutex);
+                int ret;
+                while ((ret = WT_READ_CHECK(cursor->next(cursor))) == 0) {
+                    int64_t key;
+                    invariantWTOK(cursor->get_key(cursor, &key));
+                    RecordId id = _fromKey(key);
+                    if (id > stone->lastRecord) {
+                        break;
+                    }
+
+                    WT_ITEM value;
+                    invariantWTOK(cursor->get_value(cursor, &value));
+                    ++recordsRemoved;
+                    bytesRemoved += value.size;
+
+                    if (_cappedCallback) {
+                        uassertStatusOK(_cappedCallback->aboutToDeleteCapped(
+                            txn,
+                            id,
+                            RecordData(static_cast<const char*>(value.data), value.size)));
+                    }
+                }
+                if (ret != WT_NOTFOUND) {
+                    invariantWTOK(ret);
+                }
             }
 
             cursor->set_key(cursor, _makeKey(stone->lastRecord));
             invariantWTOK(session->truncate(session, nullptr, nullptr, cursor, nullptr));
-            _changeNumRecords(txn, -stone->records);
-            _increaseDataSize(txn, -stone->bytes);
+            _changeNumRecords(txn, -recordsRemoved);
+            _increaseDataSize(txn, -bytesRemoved);
 
             wuow.commit();
 
@@ -1258,12 +1422,13 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* txn) {
             // Stash the truncate point for next time to cleanly skip over tombstones, etc.
             _oplogStones->firstRecord = stone->lastRecord;
         } catch (const WriteConflictException& wce) {
-            LOG(1) << "Caught WriteConflictException while truncating oplog entries, retrying";
+            LOG(1) << "Caught WriteConflictException while truncating " << ns() << ", retrying";
         }
     }
 
-    LOG(1) << "Finished truncating the oplog, it now contains approximately " << _numRecords.load()
-           << " records totaling to " << _dataSize.load() << " bytes";
+    LOG(1) << "Finished truncating " << ns() << ", it now contains approximately "
+           << _numRecords.load() << " records totaling to " << _dataSize.load() << " bytes";
+    return true;
 }
 
 Status WiredTigerRecordStore::insertRecords(OperationContext* txn,
@@ -1444,7 +1609,8 @@ Status WiredTigerRecordStore::updateRecord(OperationContext* txn,
     int64_t old_length = old_value.size;
 
     if (_oplogStones && len != old_length) {
-        return {ErrorCodes::IllegalOperation, "Cannot change the size of a document in the oplog"};
+        return {ErrorCodes::IllegalOperation,
+                str::stream() << "Cannot change the size of a document in " << ns()};
     }
 
     c->set_key(c, _makeKey(id));
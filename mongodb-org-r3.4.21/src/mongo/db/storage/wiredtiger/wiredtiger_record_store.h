@@ -66,6 +66,10 @@ class WiredTigerRecoveryUnit;
 class WiredTigerSizeStorer;
 
 extern const std::string kWiredTigerEngineName;
+
+// When true, capped collections other than the oplog are bounded by truncating whole stones of
+// their oldest records in the background instead of deleting documents as part of each insert.
+extern bool wiredTigerTruncateCappedCollectionsInBackground;
 typedef std::list<RecordId> SortedRecordIds;
 
 class WiredTigerRecordStore final : public RecordStore {
@@ -238,7 +242,9 @@ public:
 
     bool inShutdown() const;
 
-    void reclaimOplog(OperationContext* txn);
+    // Truncates the records covered by excess stones. Returns false if a collection other than
+    // the oplog could not be truncated because some of those records are not yet visible.
+    bool reclaimOplog(OperationContext* txn);
 
     int64_t cappedDeleteAsNeeded(OperationContext* txn, const RecordId& justInserted);
 
@@ -248,12 +254,12 @@ public:
         return _cappedDeleterMutex;
     }
 
-    // Returns false if the oplog was dropped while waiting for a deletion request.
+    // Returns false if the collection was dropped while waiting for a deletion request.
     bool yieldAndAwaitOplogDeletionRequest(OperationContext* txn);
 
     class OplogStones;
 
-    // Exposed only for testing.
+    // Null unless excess records are truncated in the background.
     OplogStones* oplogStones() {
         return _oplogStones.get();
     };
@@ -32,7 +32,6 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/base/init.h"
-#include "mongo/db/namespace_string.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
@@ -41,8 +40,8 @@
 namespace mongo {
 
 // static
-bool WiredTigerKVEngine::initRsOplogBackgroundThread(StringData ns) {
-    return NamespaceString::oplog(ns);
+bool WiredTigerKVEngine::initRsBackgroundThread(StringData ns) {
+    return true;
 }
 
 MONGO_INITIALIZER(SetGlobalEnvironment)(InitializerContext* context) {
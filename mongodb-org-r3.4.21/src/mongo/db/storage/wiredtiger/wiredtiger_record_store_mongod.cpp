@@ -67,13 +67,31 @@ public:
         return _name;
     }
 
+    enum class DeleteResult {
+        kDeleted,         // There was a collection to delete from.
+        kBackOff,         // Nothing could be deleted, try again later.
+        kCollectionGone,  // The capped collection no longer exists, so the thread should exit.
+    };
+
     /**
-     * Returns true iff there was an oplog to delete from.
+     * Only threads for the oplog outlive their collection. Others unregister themselves while
+     * holding the database lock, so a collection cannot be recreated in between and be left
+     * without a thread.
      */
-    bool _deleteExcessDocuments() {
+    DeleteResult _collectionGone() {
+        if (_ns.isOplog()) {
+            return DeleteResult::kBackOff;
+        }
+
+        stdx::lock_guard<stdx::mutex> lock(_backgroundThreadMutex);
+        _backgroundThreadNamespaces.erase(_ns);
+        return DeleteResult::kCollectionGone;
+    }
+
+    DeleteResult _deleteExcessDocuments() {
         if (!getGlobalServiceContext()->getGlobalStorageEngine()) {
             LOG(2) << "no global storage engine yet";
-            return false;
+            return DeleteResult::kBackOff;
         }
 
         const ServiceContext::UniqueOperationContext txnPtr = cc().makeOperationContext();
@@ -85,40 +103,53 @@ public:
             AutoGetDb autoDb(&txn, _ns.db(), MODE_IX);
             Database* db = autoDb.getDb();
             if (!db) {
-                LOG(2) << "no local database yet";
-                return false;
+                LOG(2) << "no database " << _ns.db();
+                return _collectionGone();
             }
 
             Lock::CollectionLock collectionLock(txn.lockState(), _ns.ns(), MODE_IX);
             Collection* collection = db->getCollection(_ns);
             if (!collection) {
                 LOG(2) << "no collection " << _ns;
-                return false;
+                return _collectionGone();
             }
 
             OldClientContext ctx(&txn, _ns.ns(), false);
             WiredTigerRecordStore* rs =
                 checked_cast<WiredTigerRecordStore*>(collection->getRecordStore());
+            if (!rs->oplogStones()) {
+                // Recreated as a collection that is not truncated in the background.
+                return _collectionGone();
+            }
 
             if (!rs->yieldAndAwaitOplogDeletionRequest(&txn)) {
-                return false;  // Oplog went away.
+                return DeleteResult::kBackOff;  // Collection went away.
+            }
+            if (!rs->reclaimOplog(&txn)) {
+                return DeleteResult::kBackOff;  // Waiting for earlier inserts to commit.
             }
-            rs->reclaimOplog(&txn);
         } catch (const std::exception& e) {
             severe() << "error in WiredTigerRecordStoreThread: " << e.what();
             fassertFailedNoTrace(!"error in WiredTigerRecordStoreThread");
         } catch (...) {
             fassertFailedNoTrace(!"unknown error in WiredTigerRecordStoreThread");
         }
-        return true;
+        return DeleteResult::kDeleted;
     }
 
     virtual void run() {
         Client::initThread(_name.c_str());
 
         while (!inShutdown()) {
-            if (!_deleteExcessDocuments()) {
-                sleepmillis(1000);  // Back off in case there were problems deleting.
+            switch (_deleteExcessDocuments()) {
+                case DeleteResult::kDeleted:
+                    break;
+                case DeleteResult::kBackOff:
+                    sleepmillis(1000);  // Back off in case there were problems deleting.
+                    break;
+                case DeleteResult::kCollectionGone:
+                    log() << "Stopping WiredTigerRecordStoreThread " << _ns;
+                    return;
             }
         }
     }
@@ -131,11 +162,7 @@ private:
 }  // namespace
 
 // static
-bool WiredTigerKVEngine::initRsOplogBackgroundThread(StringData ns) {
-    if (!NamespaceString::oplog(ns)) {
-        return false;
-    }
-
+bool WiredTigerKVEngine::initRsBackgroundThread(StringData ns) {
     if (storageGlobalParams.repair || storageGlobalParams.readOnly) {
         LOG(1) << "not starting WiredTigerRecordStoreThread for " << ns
                << " because we are either in repair or read-only mode";
@@ -42,7 +42,10 @@ class OperationContext;
 class RecordId;
 
 // Keep "milestones" against the oplog to efficiently remove the old records when the collection
-// grows beyond its desired maximum size.
+// grows beyond its desired maximum size. Other capped collections use them too when
+// 'wiredTigerTruncateCappedCollectionsInBackground' is set, in which case stones are also placed
+// every so many records and removed once the collection holds more than its maximum number of
+// documents.
 class WiredTigerRecordStore::OplogStones {
 public:
     struct Stone {
@@ -59,12 +62,15 @@ public:
 
     bool hasExcessStones_inlock() const {
         int64_t total_bytes = 0;
+        int64_t total_records = 0;
         for (std::deque<OplogStones::Stone>::const_iterator it = _stones.begin();
              it != _stones.end();
              ++it) {
             total_bytes += it->bytes;
+            total_records += it->records;
         }
-        return total_bytes > _rs->cappedMaxSize();
+        return total_bytes > _rs->cappedMaxSize() ||
+            (_rs->cappedMaxDocs() != -1 && total_records > _rs->cappedMaxDocs());
     }
 
     void awaitHasExcessStonesOrDead();
@@ -113,6 +119,11 @@ public:
 
     void setMinBytesPerStone(int64_t size);
 
+    int64_t minRecordsPerStone() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _minRecordsPerStone;
+    }
+
 private:
     class InsertChange;
     class TruncateChange;
@@ -123,6 +134,15 @@ private:
                                     int64_t estRecordsPerStone,
                                     int64_t estBytesPerStone);
 
+    // Sets how much the stone being filled has to hold to be complete, for a collection of at most
+    // 'maxSize' bytes and 'cappedMaxDocs()' documents. Returns how many stones that makes for.
+    size_t _setMinStoneSize_inlock(int64_t maxSize);
+
+    bool _currentStoneIsFull() const {
+        return _currentBytes.load() >= _minBytesPerStone ||
+            (_minRecordsPerStone > 0 && _currentRecords.load() >= _minRecordsPerStone);
+    }
+
     void _pokeReclaimThreadIfNeeded();
 
     static const uint64_t kRandomSamplesPerStone = 10;
@@ -140,6 +160,10 @@ private:
     // deque of oplog stones.
     int64_t _minBytesPerStone;
 
+    // Minimum number of records the stone being filled should contain before it gets added, or 0
+    // if the collection has no maximum number of documents.
+    int64_t _minRecordsPerStone = 0;
+
     AtomicInt64 _currentRecords;  // Number of records in the stone being filled.
     AtomicInt64 _currentBytes;    // Number of bytes in the stone being filled.
 
@@ -1067,6 +1067,70 @@ TEST(WiredTigerRecordStoreTest, CappedCursorYieldFirst) {
     ASSERT(!cursor->next());
 }
 
+TEST(WiredTigerRecordStoreTest, CursorRange) {
+    unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    std::vector<RecordId> ids;
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        for (int i = 0; i < 10; i++) {
+            StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), "a", 2, false);
+            ASSERT_OK(res.getStatus());
+            ids.push_back(res.getValue());
+        }
+        uow.commit();
+    }
+
+    {
+        // Delete the first record of the range, so the cursor has to land after where it seeks.
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        rs->deleteRecord(opCtx.get(), ids[3]);
+        uow.commit();
+    }
+
+    ServiceContext::UniqueOperationContext cursorCtx(harnessHelper->newOperationContext());
+    auto cursor = rs->getCursor(cursorCtx.get());
+    ASSERT_TRUE(cursor->setRange(ids[3], ids[7]));
+
+    auto record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(ids[4], record->id);
+
+    // The range survives a yield.
+    cursor->save();
+    cursorCtx->recoveryUnit()->abandonSnapshot();
+    ASSERT_TRUE(cursor->restore());
+
+    record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(ids[5], record->id);
+    record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(ids[6], record->id);
+    ASSERT(!cursor->next());
+
+    // Open ended ranges.
+    cursor = rs->getCursor(cursorCtx.get());
+    ASSERT_TRUE(cursor->setRange(RecordId(), ids[1]));
+    record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(ids[0], record->id);
+    ASSERT(!cursor->next());
+
+    cursor = rs->getCursor(cursorCtx.get());
+    ASSERT_TRUE(cursor->setRange(ids[9], RecordId()));
+    record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(ids[9], record->id);
+    ASSERT(!cursor->next());
+
+    // Reverse cursors don't support ranges.
+    ASSERT_FALSE(rs->getCursor(cursorCtx.get(), false)->setRange(ids[1], ids[2]));
+}
+
 BSONObj makeBSONObjWithSize(const Timestamp& opTime, int size, char fill = 'x') {
     BSONObj objTemplate = BSON("ts" << opTime << "str"
                                     << "");
@@ -1514,4 +1578,196 @@ TEST(WiredTigerRecordStoreTest, OplogStones_AscendingOrder) {
     }
 }
 
+StatusWith<RecordId> insertCappedBSONWithSize(OperationContext* opCtx, RecordStore* rs, int size) {
+    BSONObj obj = makeBSONObjWithSize(Timestamp(), size);
+
+    WriteUnitOfWork wuow(opCtx);
+    StatusWith<RecordId> res = rs->insertRecord(opCtx, obj.objdata(), obj.objsize(), false);
+    if (res.isOK()) {
+        wuow.commit();
+    }
+    return res;
+}
+
+class CountingCappedCallback : public CappedCallback {
+public:
+    Status aboutToDeleteCapped(OperationContext* txn, const RecordId& loc, RecordData data) {
+        deleted.push_back(loc);
+        return Status::OK();
+    }
+
+    void notifyCappedWaitersIfNeeded() {}
+
+    std::vector<RecordId> deleted;
+};
+
+// Capped collections other than the oplog only keep stones when truncating in the background.
+TEST(WiredTigerRecordStoreTest, CappedStones_ReclaimStonesBySize) {
+    WiredTigerHarnessHelper harnessHelper;
+
+    const int64_t cappedMaxSize = 10 * 1024;  // 10KB
+    {
+        unique_ptr<RecordStore> rs(harnessHelper.newCappedRecordStore("a.b", cappedMaxSize, -1));
+        ASSERT_FALSE(static_cast<WiredTigerRecordStore*>(rs.get())->oplogStones());
+    }
+
+    wiredTigerTruncateCappedCollectionsInBackground = true;
+    ON_BLOCK_EXIT([] { wiredTigerTruncateCappedCollectionsInBackground = false; });
+
+    unique_ptr<RecordStore> rs(harnessHelper.newCappedRecordStore("a.b", cappedMaxSize, -1));
+    WiredTigerRecordStore* wtrs = static_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wtrs->oplogStones();
+    ASSERT(oplogStones);
+    ASSERT_EQ(0, oplogStones->minRecordsPerStone());
+
+    CountingCappedCallback callback;
+    wtrs->setCappedCallback(&callback);
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+        ASSERT_OK(wtrs->updateCappedSize(opCtx.get(), 230U));
+    }
+
+    oplogStones->setMinBytesPerStone(100);
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+
+        // Inserting does not delete anything, even past the maximum size.
+        ASSERT_EQ(insertCappedBSONWithSize(opCtx.get(), rs.get(), 100), RecordId(1));
+        ASSERT_EQ(insertCappedBSONWithSize(opCtx.get(), rs.get(), 110), RecordId(2));
+        ASSERT_EQ(insertCappedBSONWithSize(opCtx.get(), rs.get(), 120), RecordId(3));
+
+        ASSERT_EQ(3, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(330, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(3U, oplogStones->numStones());
+        ASSERT_TRUE(callback.deleted.empty());
+    }
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+
+        ASSERT_TRUE(wtrs->reclaimOplog(opCtx.get()));
+
+        ASSERT_EQ(2, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(230, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(2U, oplogStones->numStones());
+        ASSERT_FALSE(rs->getCursor(opCtx.get())->seekExact(RecordId(1)));
+    }
+
+    // The callback gets to unindex every truncated record.
+    ASSERT_EQ(1U, callback.deleted.size());
+    ASSERT_EQ(RecordId(1), callback.deleted[0]);
+    wtrs->setCappedCallback(nullptr);
+}
+
+// A collection with a maximum number of documents places stones every so many records.
+TEST(WiredTigerRecordStoreTest, CappedStones_ReclaimStonesByMaxDocs) {
+    wiredTigerTruncateCappedCollectionsInBackground = true;
+    ON_BLOCK_EXIT([] { wiredTigerTruncateCappedCollectionsInBackground = false; });
+
+    WiredTigerHarnessHelper harnessHelper;
+
+    const int64_t cappedMaxSize = 10 * 1024 * 1024;  // 10MB
+    const int64_t cappedMaxDocs = 20;
+    unique_ptr<RecordStore> rs(
+        harnessHelper.newCappedRecordStore("a.b", cappedMaxSize, cappedMaxDocs));
+    WiredTigerRecordStore* wtrs = static_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wtrs->oplogStones();
+    ASSERT_EQ(2, oplogStones->minRecordsPerStone());
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+
+        for (int i = 1; i <= 25; ++i) {
+            ASSERT_EQ(insertCappedBSONWithSize(opCtx.get(), rs.get(), 50), RecordId(i));
+        }
+
+        ASSERT_EQ(25, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(12U, oplogStones->numStones());
+        ASSERT_EQ(1, oplogStones->currentRecords());
+    }
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+
+        // Whole stones are removed until they hold no more than the maximum number of documents.
+        ASSERT_TRUE(wtrs->reclaimOplog(opCtx.get()));
+
+        ASSERT_EQ(21, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(21 * 50, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(10U, oplogStones->numStones());
+
+        auto record = rs->getCursor(opCtx.get())->next();
+        ASSERT(record);
+        ASSERT_EQ(RecordId(5), record->id);
+    }
+}
+
+// Records are not truncated while an earlier insert may still become visible, since readers of
+// a capped collection must never see holes.
+TEST(WiredTigerRecordStoreTest, CappedStones_ReclaimWaitsForVisibility) {
+    wiredTigerTruncateCappedCollectionsInBackground = true;
+    ON_BLOCK_EXIT([] { wiredTigerTruncateCappedCollectionsInBackground = false; });
+
+    WiredTigerHarnessHelper harnessHelper;
+
+    const int64_t cappedMaxSize = 10 * 1024 * 1024;  // 10MB
+    const int64_t cappedMaxDocs = 4;
+    unique_ptr<RecordStore> rs(
+        harnessHelper.newCappedRecordStore("a.b", cappedMaxSize, cappedMaxDocs));
+    WiredTigerRecordStore* wtrs = static_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wtrs->oplogStones();
+    ASSERT_EQ(1, oplogStones->minRecordsPerStone());
+
+    ServiceContext::UniqueOperationContext pendingCtx(harnessHelper.newOperationContext());
+    BSONObj pending = makeBSONObjWithSize(Timestamp(), 50);
+    unique_ptr<WriteUnitOfWork> pendingWuow(new WriteUnitOfWork(pendingCtx.get()));
+    ASSERT_EQ(rs->insertRecord(pendingCtx.get(), pending.objdata(), pending.objsize(), false),
+              RecordId(1));
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+        for (int i = 2; i <= 7; ++i) {
+            ASSERT_EQ(insertCappedBSONWithSize(opCtx.get(), rs.get(), 50), RecordId(i));
+        }
+        ASSERT_EQ(6U, oplogStones->numStones());
+    }
+
+    // Truncating through the oldest stone would remove a record hidden behind the pending insert.
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+        ASSERT_TRUE(wtrs->isCappedHidden(RecordId(2)));
+        ASSERT_FALSE(wtrs->reclaimOplog(opCtx.get()));
+        ASSERT_EQ(6U, oplogStones->numStones());
+        ASSERT_TRUE(rs->getCursor(opCtx.get())->seekExact(RecordId(2)));
+    }
+
+    pendingWuow->commit();
+    pendingWuow.reset();
+
+    // A reader positioned in the truncated range loses its position rather than skipping ahead.
+    ServiceContext::UniqueOperationContext readerCtx(harnessHelper.newOperationContext());
+    auto readerCursor = rs->getCursor(readerCtx.get());
+    auto first = readerCursor->next();
+    ASSERT(first);
+    ASSERT_EQ(RecordId(1), first->id);
+    readerCursor->save();
+    readerCtx->recoveryUnit()->abandonSnapshot();
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper.newOperationContext());
+        ASSERT_TRUE(wtrs->reclaimOplog(opCtx.get()));
+
+        // The stone ending at RecordId(2) also covers the record that committed late.
+        ASSERT_EQ(4, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(4U, oplogStones->numStones());
+        ASSERT_FALSE(rs->getCursor(opCtx.get())->seekExact(RecordId(1)));
+        ASSERT_FALSE(rs->getCursor(opCtx.get())->seekExact(RecordId(3)));
+        ASSERT_TRUE(rs->getCursor(opCtx.get())->seekExact(RecordId(4)));
+    }
+
+    ASSERT_FALSE(readerCursor->restore());
+}
+
 }  // namespace mongo
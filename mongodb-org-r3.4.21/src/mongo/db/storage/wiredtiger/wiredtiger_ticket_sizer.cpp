@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_sizer.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+
+namespace mongo {
+
+int WiredTigerTicketSizer::sizeReads(const Settings& settings,
+                                     const CacheSample& cache,
+                                     const QueueSample& reads) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _lastCache = cache;
+    return _size(settings, cache.usedRatio > settings.cacheUsedRatio, reads, &_reads);
+}
+
+int WiredTigerTicketSizer::sizeWrites(const Settings& settings,
+                                      const CacheSample& cache,
+                                      const QueueSample& writes) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _lastCache = cache;
+    const bool cachePressure =
+        cache.usedRatio > settings.cacheUsedRatio || cache.dirtyRatio > settings.cacheDirtyRatio;
+    return _size(settings, cachePressure, writes, &_writes);
+}
+
+void WiredTigerTicketSizer::appendStats(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    {
+        BSONObjBuilder cacheBuilder(builder->subobjStart("cache"));
+        cacheBuilder.append("usedRatio", _lastCache.usedRatio);
+        cacheBuilder.append("dirtyRatio", _lastCache.dirtyRatio);
+    }
+    {
+        BSONObjBuilder writeBuilder(builder->subobjStart("write"));
+        _appendQueue(_writes, &writeBuilder);
+    }
+    {
+        BSONObjBuilder readBuilder(builder->subobjStart("read"));
+        _appendQueue(_reads, &readBuilder);
+    }
+}
+
+int WiredTigerTicketSizer::_size(const Settings& settings,
+                                 bool cachePressure,
+                                 const QueueSample& sample,
+                                 Queue* queue) {
+    // TicketHolder::resize() doesn't go below 5 tickets.
+    const int minTickets = std::max(settings.minTickets, 5);
+    const int maxTickets = std::max(settings.maxTickets, minTickets);
+    const int step = std::max(settings.step, 1);
+
+    const bool haveLatency = queue->sampled && sample.totalOps > queue->lastTotalOps;
+    double micros = 0;
+    if (haveLatency) {
+        micros = static_cast<double>(sample.totalLatencyMicros - queue->lastTotalLatencyMicros) /
+            (sample.totalOps - queue->lastTotalOps);
+        queue->lastMicros = micros;
+    }
+    queue->sampled = true;
+    queue->lastTotalLatencyMicros = sample.totalLatencyMicros;
+    queue->lastTotalOps = sample.totalOps;
+
+    int tickets = std::min(std::max(sample.tickets, minTickets), maxTickets);
+    const char* change = "bounds";
+
+    if (cachePressure) {
+        tickets = std::max(minTickets, tickets * 3 / 4);
+        change = "cachePressure";
+    } else {
+        // Latency includes the time spent waiting for a ticket, which fewer tickets would only
+        // make longer, so it only counts while no operation is waiting.
+        const bool latencyCounts = haveLatency && sample.waiting == 0;
+        if (latencyCounts && queue->averageMicros > 0 &&
+            micros > queue->averageMicros * settings.latencyRatio) {
+            tickets = std::max(minTickets, tickets - step);
+            change = "latency";
+        } else if (sample.waiting > 0) {
+            tickets = std::min(maxTickets, tickets + step);
+            change = "queueing";
+        }
+
+        // The average adapts slowly, so that a lasting change of workload eventually becomes the
+        // norm instead of shrinking the tickets down to the minimum.
+        if (latencyCounts) {
+            queue->averageMicros =
+                queue->averageMicros == 0 ? micros : 0.9 * queue->averageMicros + 0.1 * micros;
+        }
+    }
+
+    if (tickets > sample.tickets) {
+        queue->increases++;
+        queue->lastChange = change;
+    } else if (tickets < sample.tickets) {
+        queue->decreases++;
+        queue->lastChange = change;
+    }
+    return tickets;
+}
+
+void WiredTigerTicketSizer::_appendQueue(const Queue& queue, BSONObjBuilder* builder) {
+    builder->append("averageLatencyMicros", queue.averageMicros);
+    builder->append("lastLatencyMicros", queue.lastMicros);
+    builder->append("lastChange", queue.lastChange);
+    builder->append("increases", queue.increases);
+    builder->append("decreases", queue.decreases);
+}
+
+}  // namespace mongo
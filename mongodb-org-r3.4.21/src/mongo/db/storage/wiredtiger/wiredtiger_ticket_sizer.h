@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * Decides how many concurrent read and write transactions WiredTiger should admit, from periodic
+ * samples of its cache and of the latency of the operations that completed in between.
+ *
+ * Ticket counts shrink multiplicatively while the cache is under pressure, since admitting more
+ * operations then only makes application threads do eviction. Otherwise they grow by a step while
+ * operations queue up for a ticket, and shrink by a step when operations get much slower than they
+ * used to be while none queue up, since operation latency includes the wait for a ticket. Counts
+ * always stay within the configured bounds.
+ */
+class WiredTigerTicketSizer {
+    MONGO_DISALLOW_COPYING(WiredTigerTicketSizer);
+
+public:
+    struct Settings {
+        int minTickets = 16;
+        int maxTickets = 512;
+
+        // The number of tickets to add or remove when not shrinking because of cache pressure.
+        int step = 8;
+
+        // Write tickets shrink while more than this fraction of the cache is dirty, and all
+        // tickets shrink while more than 'cacheUsedRatio' of it is in use.
+        double cacheDirtyRatio = 0.15;
+        double cacheUsedRatio = 0.92;
+
+        // How many times slower than their running average operations have to get before their
+        // tickets shrink.
+        double latencyRatio = 2.0;
+    };
+
+    struct CacheSample {
+        double usedRatio = 0;
+        double dirtyRatio = 0;
+    };
+
+    struct QueueSample {
+        int tickets = 0;
+        int waiting = 0;
+
+        // Running totals, as kept by OperationLatencyHistogram.
+        long long totalLatencyMicros = 0;
+        long long totalOps = 0;
+    };
+
+    WiredTigerTicketSizer() = default;
+
+    /**
+     * Returns how many read and write tickets there should be, respectively.
+     */
+    int sizeReads(const Settings& settings, const CacheSample& cache, const QueueSample& reads);
+    int sizeWrites(const Settings& settings, const CacheSample& cache, const QueueSample& writes);
+
+    /**
+     * Reports the latest samples and decisions.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    struct Queue {
+        // The running average latency of operations outside of cache pressure and queueing, and
+        // the average latency of those which completed since the previous sample.
+        double averageMicros = 0;
+        double lastMicros = 0;
+
+        bool sampled = false;
+        long long lastTotalLatencyMicros = 0;
+        long long lastTotalOps = 0;
+
+        const char* lastChange = "none";
+        long long increases = 0;
+        long long decreases = 0;
+    };
+
+    int _size(const Settings& settings,
+              bool cachePressure,
+              const QueueSample& sample,
+              Queue* queue);
+
+    static void _appendQueue(const Queue& queue, BSONObjBuilder* builder);
+
+    mutable stdx::mutex _mutex;
+    CacheSample _lastCache;
+    Queue _reads;
+    Queue _writes;
+};
+
+}  // namespace mongo
@@ -0,0 +1,132 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_sizer.h"
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using CacheSample = WiredTigerTicketSizer::CacheSample;
+using QueueSample = WiredTigerTicketSizer::QueueSample;
+using Settings = WiredTigerTicketSizer::Settings;
+
+CacheSample makeCache(double usedRatio, double dirtyRatio) {
+    CacheSample cache;
+    cache.usedRatio = usedRatio;
+    cache.dirtyRatio = dirtyRatio;
+    return cache;
+}
+
+QueueSample makeQueue(int tickets, int waiting, long long totalLatencyMicros, long long totalOps) {
+    QueueSample queue;
+    queue.tickets = tickets;
+    queue.waiting = waiting;
+    queue.totalLatencyMicros = totalLatencyMicros;
+    queue.totalOps = totalOps;
+    return queue;
+}
+
+TEST(WiredTigerTicketSizerTest, GrowsWhileOperationsQueueUp) {
+    WiredTigerTicketSizer sizer;
+    Settings settings;
+    const CacheSample cache = makeCache(0.5, 0.01);
+
+    ASSERT_EQ(128, sizer.sizeReads(settings, cache, makeQueue(128, 0, 0, 0)));
+    ASSERT_EQ(136, sizer.sizeReads(settings, cache, makeQueue(128, 3, 1000, 10)));
+    ASSERT_EQ(512, sizer.sizeReads(settings, cache, makeQueue(510, 3, 2000, 20)));
+}
+
+TEST(WiredTigerTicketSizerTest, ShrinksUnderCachePressure) {
+    WiredTigerTicketSizer sizer;
+    Settings settings;
+
+    // Dirty data only throttles writes.
+    const CacheSample dirty = makeCache(0.8, 0.3);
+    ASSERT_EQ(128, sizer.sizeReads(settings, dirty, makeQueue(128, 0, 0, 0)));
+    ASSERT_EQ(96, sizer.sizeWrites(settings, dirty, makeQueue(128, 5, 0, 0)));
+
+    const CacheSample full = makeCache(0.97, 0.01);
+    ASSERT_EQ(96, sizer.sizeReads(settings, full, makeQueue(128, 5, 0, 0)));
+    ASSERT_EQ(72, sizer.sizeWrites(settings, full, makeQueue(96, 5, 0, 0)));
+    ASSERT_EQ(16, sizer.sizeWrites(settings, full, makeQueue(17, 5, 0, 0)));
+    ASSERT_EQ(16, sizer.sizeWrites(settings, full, makeQueue(16, 5, 0, 0)));
+}
+
+TEST(WiredTigerTicketSizerTest, ShrinksWhenLatencyRegresses) {
+    WiredTigerTicketSizer sizer;
+    Settings settings;
+    const CacheSample cache = makeCache(0.5, 0.01);
+
+    ASSERT_EQ(64, sizer.sizeWrites(settings, cache, makeQueue(64, 0, 0, 0)));
+    // 100us per operation becomes the norm.
+    ASSERT_EQ(64, sizer.sizeWrites(settings, cache, makeQueue(64, 0, 10000, 100)));
+    ASSERT_EQ(64, sizer.sizeWrites(settings, cache, makeQueue(64, 0, 20000, 200)));
+
+    // 500us per operation is too slow, but operations waiting for a ticket may account for it.
+    ASSERT_EQ(72, sizer.sizeWrites(settings, cache, makeQueue(64, 4, 70000, 300)));
+
+    // With no operation waiting, 500us per operation is measured against the 100us norm, which
+    // the wait for tickets didn't raise.
+    ASSERT_EQ(64, sizer.sizeWrites(settings, cache, makeQueue(72, 0, 120000, 400)));
+
+    // No operations completed, so there is no latency to go by.
+    ASSERT_EQ(72, sizer.sizeWrites(settings, cache, makeQueue(64, 4, 120000, 400)));
+
+    BSONObjBuilder builder;
+    sizer.appendStats(&builder);
+    const BSONObj stats = builder.obj();
+    ASSERT_EQ(1, stats["write"]["decreases"].numberLong());
+    ASSERT_EQ(2, stats["write"]["increases"].numberLong());
+    ASSERT_EQ("queueing", stats["write"]["lastChange"].str());
+    ASSERT_EQ(500, stats["write"]["lastLatencyMicros"].numberDouble());
+    ASSERT_EQ(0, stats["read"]["increases"].numberLong());
+}
+
+TEST(WiredTigerTicketSizerTest, KeepsTicketsWithinBounds) {
+    WiredTigerTicketSizer sizer;
+    Settings settings;
+    settings.minTickets = 32;
+    settings.maxTickets = 64;
+    const CacheSample cache = makeCache(0.5, 0.01);
+
+    ASSERT_EQ(64, sizer.sizeReads(settings, cache, makeQueue(128, 0, 0, 0)));
+    ASSERT_EQ(32, sizer.sizeReads(settings, cache, makeQueue(8, 0, 0, 0)));
+
+    // TicketHolder can't go below 5 tickets.
+    settings.minTickets = 1;
+    ASSERT_EQ(5, sizer.sizeWrites(settings, makeCache(0.99, 0.5), makeQueue(6, 0, 0, 0)));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -39,6 +39,7 @@
 #include "mongo/db/write_concern_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -111,11 +112,78 @@ private:
     int _max;
 };
 
+static const char* const batchesNs = "unittests.removetests_batches";
+
+/**
+ * Helpers::removeRange ending each batch on rangeDeleterBatchSizeBytes and resuming the next one
+ * from the last deleted shard key, which is shared by several documents.
+ */
+class RemoveRangeInByteBoundedBatches {
+public:
+    void run() {
+        const ServiceContext::UniqueOperationContext txnPtr = cc().makeOperationContext();
+        OperationContext& txn = *txnPtr;
+        DBDirectClient client(&txn);
+
+        client.dropCollection(batchesNs);
+        ASSERT_OK(dbtests::createIndex(&txn, batchesNs, BSON("a" << 1)));
+
+        // Three documents for each shard key value, so that batches end between documents with
+        // the same shard key.
+        long long rangeBytes = 0;
+        for (int i = 0; i < 30; ++i) {
+            const BSONObj doc = BSON("_id" << i << "a" << i / 3);
+            if (i / 3 >= 2 && i / 3 < 8) {
+                rangeBytes += doc.objsize();
+            }
+            client.insert(batchesNs, doc);
+        }
+
+        // Each batch deletes a single document.
+        const int oldBatchSizeBytes = rangeDeleterBatchSizeBytes.load();
+        const int oldBatchDelayMS = rangeDeleterBatchDelayMS.load();
+        rangeDeleterBatchSizeBytes.store(1);
+        rangeDeleterBatchDelayMS.store(0);
+        ON_BLOCK_EXIT([&] {
+            rangeDeleterBatchSizeBytes.store(oldBatchSizeBytes);
+            rangeDeleterBatchDelayMS.store(oldBatchDelayMS);
+        });
+
+        KeyRange range(batchesNs, BSON("a" << 2), BSON("a" << 8), BSON("a" << 1));
+        WriteConcernOptions dummyWriteConcern;
+        Milliseconds dummyReplWaitDuration;
+        long long deletedBytes = 0;
+        ASSERT_EQUALS(18,
+                      Helpers::removeRange(&txn,
+                                           range,
+                                           BoundInclusion::kIncludeStartKeyOnly,
+                                           dummyWriteConcern,
+                                           dummyReplWaitDuration,
+                                           nullptr,
+                                           false,
+                                           false,
+                                           &deletedBytes));
+        ASSERT_EQUALS(rangeBytes, deletedBytes);
+
+        // Only the documents outside of the range remain.
+        unique_ptr<DBClientCursor> cursor = client.query(batchesNs, Query().hint(BSON("_id" << 1)));
+        for (int i = 0; i < 30; ++i) {
+            if (i / 3 >= 2 && i / 3 < 8) {
+                continue;
+            }
+            ASSERT(cursor->more());
+            ASSERT_BSONOBJ_EQ(BSON("_id" << i << "a" << i / 3), cursor->next());
+        }
+        ASSERT(!cursor->more());
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("remove") {}
     void setupTests() {
         add<RemoveRange>();
+        add<RemoveRangeInByteBoundedBatches>();
     }
 } myall;
 
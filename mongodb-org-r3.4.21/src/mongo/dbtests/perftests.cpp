@@ -48,15 +48,28 @@
 
 #include "mongo/config.h"
 #include "mongo/db/bson/dotted_path_support.h"
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/client.h"
 #include "mongo/db/db.h"
+#include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/limit.h"
+#include "mongo/db/exec/projection.h"
+#include "mongo/db/exec/skip.h"
 #include "mongo/db/lasterror.h"
+#include "mongo/db/matcher/compiled_match_expression.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/matcher/extensions_callback_disallow_extensions.h"
+#include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/chunk_manager.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/log.h"
@@ -450,6 +463,297 @@ public:
     }
 };
 
+/**
+ * Measures how many external sorts of index keys, as done by an index build, complete per second
+ * with a given number of background threads in addition to the calling thread.
+ */
+template <unsigned WorkerThreads>
+class ExternalSort : public B {
+public:
+    typedef Sorter<BSONObj, RecordId> KeySorter;
+
+    string name() {
+        return str::stream() << "externalsort-" << WorkerThreads + 1 << "threads";
+    }
+    virtual int howLongMillis() {
+        return 3000;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual unsigned batchSize() {
+        return 1;
+    }
+
+    void prep() {
+        PseudoRandom random(1);
+        const string padding(32, 'x');
+        _keys.clear();
+        for (int i = 0; i < kNumKeys; i++) {
+            _keys.push_back(BSON("" << random.nextInt32() << "" << padding));
+        }
+    }
+
+    void timed() {
+        const SortOptions opts = SortOptions()
+                                     .TempDir(storageGlobalParams.dbpath + "/_tmp")
+                                     .ExtSortAllowed()
+                                     .MaxMemoryUsageBytes(16 * 1024 * 1024)
+                                     .WorkerThreads(WorkerThreads);
+
+        std::unique_ptr<KeySorter> sorter(KeySorter::make(opts, Comparison()));
+        for (size_t i = 0; i < _keys.size(); i++) {
+            sorter->add(_keys[i], RecordId(i + 1));
+        }
+
+        std::unique_ptr<KeySorter::Iterator> it(sorter->done());
+        while (it->more()) {
+            it->next();
+        }
+    }
+
+private:
+    static const int kNumKeys = 1000 * 1000;
+
+    class Comparison {
+    public:
+        int operator()(const KeySorter::Data& lhs, const KeySorter::Data& rhs) const {
+            const int cmp = lhs.first.woCompare(rhs.first, BSONObj(), false);
+            return cmp ? cmp : lhs.second.compare(rhs.second);
+        }
+    };
+
+    vector<BSONObj> _keys;
+};
+
+/**
+ * Measures how many times per second a filter with several predicates on a few paths is evaluated
+ * against a set of documents, either as a MatchExpression tree or compiled.
+ */
+template <bool Compiled>
+class MatchFilter : public B {
+public:
+    string name() {
+        return Compiled ? "matchfilter-compiled" : "matchfilter-tree";
+    }
+    virtual int howLongMillis() {
+        return 3000;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual unsigned batchSize() {
+        return 1;
+    }
+
+    void prep() {
+        auto swExpr = MatchExpressionParser::parse(
+            BSON("a" << BSON("$gte" << 10 << "$lt" << 90) << "b.c" << BSON("$ne" << 3) << "$or"
+                     << BSON_ARRAY(BSON("d" << "x") << BSON("b.c" << BSON("$gt" << 5)))),
+            ExtensionsCallbackDisallowExtensions(),
+            nullptr);
+        verify(swExpr.isOK());
+        _expr = std::move(swExpr.getValue());
+        _compiled = CompiledMatchExpression::compile(_expr.get());
+        verify(_compiled);
+
+        PseudoRandom random(1);
+        const string padding(64, 'x');
+        _docs.clear();
+        for (int i = 0; i < kNumDocs; i++) {
+            _docs.push_back(BSON("_id" << i << "pad" << padding << "a" << random.nextInt32(100)
+                                       << "b"
+                                       << BSON("c" << random.nextInt32(10))
+                                       << "d"
+                                       << (i % 2 ? "x" : "y")));
+        }
+    }
+
+    void timed() {
+        int matched = 0;
+        for (auto&& doc : _docs) {
+            if (Compiled ? _compiled->matchesBSON(doc) : _expr->matchesBSON(doc)) {
+                ++matched;
+            }
+        }
+        verify(matched > 0);
+    }
+
+private:
+    static const int kNumDocs = 100 * 1000;
+
+    std::unique_ptr<MatchExpression> _expr;
+    std::unique_ptr<CompiledMatchExpression> _compiled;
+    vector<BSONObj> _docs;
+};
+
+/**
+ * Measures how many times per second a collection is scanned through skip, projection and limit
+ * stages, one result at a time with PlanStage::work() or in batches with PlanStage::workBatch().
+ */
+template <bool Batched>
+class StageBatches : public B {
+public:
+    string name() {
+        return Batched ? "stages-batched" : "stages-per-doc";
+    }
+    virtual int howLongMillis() {
+        return 3000;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual unsigned batchSize() {
+        return 1;
+    }
+
+    void prep() {
+        for (int i = 0; i < kNumDocs; i++) {
+            insert(ns(), BSON("_id" << i << "a" << i % 100 << "b" << "x"));
+        }
+    }
+
+    void timed() {
+        AutoGetCollectionForRead ctx(txn(), NamespaceString(ns()));
+        WorkingSet ws;
+        CollectionScanParams params;
+        params.collection = ctx.getCollection();
+        params.direction = CollectionScanParams::FORWARD;
+        ExtensionsCallbackDisallowExtensions extensionsCallback;
+        ProjectionStageParams projParams(extensionsCallback);
+        projParams.projObj = BSON("a" << 1);
+        projParams.projImpl = ProjectionStageParams::SIMPLE_DOC;
+        auto collScan = stdx::make_unique<CollectionScan>(txn(), params, &ws, nullptr);
+        auto skip = stdx::make_unique<SkipStage>(txn(), kToSkip, &ws, collScan.release());
+        auto proj = stdx::make_unique<ProjectionStage>(txn(), projParams, &ws, skip.release());
+        auto root = stdx::make_unique<LimitStage>(txn(), kNumDocs, &ws, proj.release());
+
+        int results = 0;
+        PlanStage::WorkBatch batch;
+        for (;;) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state;
+            if (Batched) {
+                state = root->workBatch(kWorkBatchSize, &batch, &id);
+                for (WorkingSetID result : batch.results) {
+                    ws.free(result);
+                }
+                results += batch.results.size();
+            } else {
+                state = root->work(&id);
+                if (PlanStage::ADVANCED == state) {
+                    ws.free(id);
+                    ++results;
+                    continue;
+                }
+            }
+            if (PlanStage::IS_EOF == state) {
+                break;
+            }
+            verify(PlanStage::NEED_TIME == state);
+        }
+        verify(results == kNumDocs - kToSkip);
+    }
+
+private:
+    static const int kNumDocs = 50 * 1000;
+    static const int kToSkip = 10;
+    static const size_t kWorkBatchSize = 128;
+};
+
+/**
+ * Measures a ChunkMap with NumChunks chunks: how many times per second a batch of keys is routed
+ * to their chunks, how many times per second an existing routing table is refreshed with the split
+ * of one of its chunks, and how many times per second a routing table is loaded from scratch.
+ */
+enum class ChunkRoutingOp { kTarget, kRefresh, kLoad };
+
+template <int NumChunks, ChunkRoutingOp Op>
+class ChunkRouting : public B {
+public:
+    string name() {
+        const char* opNames[] = {"target", "refresh", "load"};
+        return str::stream() << "chunkrouting-" << opNames[static_cast<int>(Op)] << "-"
+                             << NumChunks << "chunks";
+    }
+    virtual int howLongMillis() {
+        return 3000;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual unsigned batchSize() {
+        return 1;
+    }
+
+    void prep() {
+        const NamespaceString nss("perftest", "chunkrouting");
+        const OID epoch = OID::gen();
+
+        _chunks.clear();
+        BSONObj min = BSON("a" << MINKEY);
+        for (long long i = 1; i <= NumChunks; i++) {
+            const BSONObj max = i == NumChunks ? BSON("a" << MAXKEY) : BSON("a" << i * kChunkSize);
+            _chunks.push_back(std::make_shared<Chunk>(
+                ChunkType(nss,
+                          ChunkRange(min, max),
+                          ChunkVersion(i, 0, epoch),
+                          ShardId(str::stream() << "shard" << i % kNumShards))));
+            min = max;
+        }
+        _chunkMap = ChunkMap().makeUpdated(_chunks);
+
+        // Split the chunk in the middle in two, with versions after those of all of the chunks
+        const long long splitChunk = NumChunks / 2;
+        const long long splitKey = splitChunk * kChunkSize + kChunkSize / 2;
+        _split = {std::make_shared<Chunk>(ChunkType(nss,
+                                                    ChunkRange(BSON("a" << splitChunk * kChunkSize),
+                                                               BSON("a" << splitKey)),
+                                                    ChunkVersion(NumChunks + 1, 0, epoch),
+                                                    ShardId("shard0"))),
+                  std::make_shared<Chunk>(
+                      ChunkType(nss,
+                                ChunkRange(BSON("a" << splitKey),
+                                           BSON("a" << (splitChunk + 1) * kChunkSize)),
+                                ChunkVersion(NumChunks + 1, 1, epoch),
+                                ShardId("shard0")))};
+
+        PseudoRandom random(1);
+        _keys.clear();
+        for (int i = 0; i < kNumKeys; i++) {
+            _keys.push_back(BSON("a" << random.nextInt64(NumChunks * kChunkSize)));
+        }
+    }
+
+    void timed() {
+        switch (Op) {
+            case ChunkRoutingOp::kTarget: {
+                for (auto&& key : _keys) {
+                    verify(_chunkMap.findIntersectingChunk(key) != _chunkMap.end());
+                }
+                break;
+            }
+            case ChunkRoutingOp::kRefresh: {
+                verify(_chunkMap.makeUpdated(_split).size() == size_t(NumChunks) + 1);
+                break;
+            }
+            case ChunkRoutingOp::kLoad: {
+                verify(ChunkMap().makeUpdated(_chunks).size() == size_t(NumChunks));
+                break;
+            }
+        }
+    }
+
+private:
+    static const long long kChunkSize = 1000;
+    static const int kNumShards = 10;
+    static const int kNumKeys = 100 * 1000;
+
+    std::vector<std::shared_ptr<Chunk>> _chunks;
+    std::vector<std::shared_ptr<Chunk>> _split;
+    ChunkMap _chunkMap;
+    vector<BSONObj> _keys;
+};
 
 class All : public Suite {
 public:
@@ -463,6 +767,24 @@ public:
         add<boosttimed_mutexspeed>();
         add<stdmutexspeed>();
         add<stdtimed_mutexspeed>();
+        add<ExternalSort<0>>();
+        add<ExternalSort<3>>();
+        add<ExternalSort<15>>();
+        add<MatchFilter<false>>();
+        add<MatchFilter<true>>();
+        add<StageBatches<false>>();
+        add<StageBatches<true>>();
+        add<ChunkRouting<10 * 1000, ChunkRoutingOp::kTarget>>();
+        add<ChunkRouting<100 * 1000, ChunkRoutingOp::kTarget>>();
+        add<ChunkRouting<1000 * 1000, ChunkRoutingOp::kTarget>>();
+        add<ChunkRouting<10 * 1000, ChunkRoutingOp::kRefresh>>();
+        add<ChunkRouting<100 * 1000, ChunkRoutingOp::kRefresh>>();
+        add<ChunkRouting<1000 * 1000, ChunkRoutingOp::kRefresh>>();
+        add<ChunkRouting<10 * 1000, ChunkRoutingOp::kLoad>>();
+        add<ChunkRouting<100 * 1000, ChunkRoutingOp::kLoad>>();
+        add<ChunkRouting<1000 * 1000, ChunkRoutingOp::kLoad>>();
     }
 } myall;
 }
+
+#include "mongo/db/sorter/sorter.cpp"
@@ -426,6 +426,46 @@ public:
     }
 };
 
+/**
+ * Test that a PlanExecutor which works its plan in batches hands out every result of a batch,
+ * including those left over when it saves its state, and reaches EOF after the last of them.
+ */
+class WorkBatchAcrossYield : public PlanExecutorBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_txn, nss.ns());
+        for (int i = 1; i <= 10; ++i) {
+            insert(BSON("_id" << i));
+        }
+
+        BSONObj filterObj = fromjson("{_id: {$gt: 0}}");
+        Collection* coll = ctx.getCollection();
+        unique_ptr<PlanExecutor> exec(makeCollScanExec(coll, filterObj));
+        exec->setWorkBatchSize(4);
+
+        // The first batch scans ahead of the two results handed out.
+        BSONObj objOut;
+        ASSERT_EQUALS(PlanExecutor::ADVANCED, exec->getNext(&objOut, NULL));
+        ASSERT_EQUALS(1, objOut["_id"].numberInt());
+        ASSERT_EQUALS(PlanExecutor::ADVANCED, exec->getNext(&objOut, NULL));
+        ASSERT_EQUALS(2, objOut["_id"].numberInt());
+
+        // The left over results are kept across the yield, and a document the scan has yet to
+        // reach is not returned once removed.
+        exec->saveState();
+        remove(BSON("_id" << 6));
+        ASSERT(exec->restoreState());
+
+        for (int expectedId : {3, 4, 5, 7, 8, 9, 10}) {
+            ASSERT_FALSE(exec->isEOF());
+            ASSERT_EQUALS(PlanExecutor::ADVANCED, exec->getNext(&objOut, NULL));
+            ASSERT_EQUALS(expectedId, objOut["_id"].numberInt());
+        }
+        ASSERT_EQUALS(PlanExecutor::IS_EOF, exec->getNext(&objOut, NULL));
+        ASSERT(exec->isEOF());
+    }
+};
+
 namespace ClientCursor {
 
 using mongo::ClientCursor;
@@ -539,6 +579,7 @@ public:
         add<DropIndexScanAgg>();
         add<SnapshotControl>();
         add<SnapshotTest>();
+        add<WorkBatchAcrossYield>();
         add<ClientCursor::Invalidate>();
         add<ClientCursor::InvalidatePinned>();
         add<ClientCursor::Timeout>();
@@ -143,8 +143,20 @@ public:
 
         // High enough so that we shouldn't trigger a replan based on works.
         const size_t decisionWorks = 50;
-        CachedPlanStage cachedPlanStage(
-            &_txn, collection, &_ws, cq.get(), plannerParams, decisionWorks, mockChild.release());
+        const size_t maxWorksBeforeReplan =
+            static_cast<size_t>(internalQueryCacheEvictionRatio * decisionWorks);
+        const bool needsReevaluation = false;
+        const size_t executionSampleRate = 1;
+        CachedPlanStage cachedPlanStage(&_txn,
+                                        collection,
+                                        &_ws,
+                                        cq.get(),
+                                        plannerParams,
+                                        decisionWorks,
+                                        maxWorksBeforeReplan,
+                                        needsReevaluation,
+                                        executionSampleRate,
+                                        mockChild.release());
 
         // This should succeed after triggering a replan.
         PlanYieldPolicy yieldPolicy(PlanExecutor::YIELD_MANUAL,
@@ -208,15 +220,26 @@ public:
         // Set up queued data stage to take a long time before returning EOF. Should be long
         // enough to trigger a replan.
         const size_t decisionWorks = 10;
-        const size_t mockWorks =
-            1U + static_cast<size_t>(internalQueryCacheEvictionRatio * decisionWorks);
+        const size_t maxWorksBeforeReplan =
+            static_cast<size_t>(internalQueryCacheEvictionRatio * decisionWorks);
+        const size_t mockWorks = 1U + maxWorksBeforeReplan;
         auto mockChild = stdx::make_unique<QueuedDataStage>(&_txn, &_ws);
         for (size_t i = 0; i < mockWorks; i++) {
             mockChild->pushBack(PlanStage::NEED_TIME);
         }
 
-        CachedPlanStage cachedPlanStage(
-            &_txn, collection, &_ws, cq.get(), plannerParams, decisionWorks, mockChild.release());
+        const bool needsReevaluation = false;
+        const size_t executionSampleRate = 1;
+        CachedPlanStage cachedPlanStage(&_txn,
+                                        collection,
+                                        &_ws,
+                                        cq.get(),
+                                        plannerParams,
+                                        decisionWorks,
+                                        maxWorksBeforeReplan,
+                                        needsReevaluation,
+                                        executionSampleRate,
+                                        mockChild.release());
 
         // This should succeed after triggering a replan.
         PlanYieldPolicy yieldPolicy(PlanExecutor::YIELD_MANUAL,
@@ -249,6 +272,84 @@ public:
     }
 };
 
+/**
+ * Test that a cached plan stage whose cache entry needs reevaluation replans the query without a
+ * trial period, and caches the new winner with the history of planning decisions.
+ */
+class QueryStageCachedPlanReevaluate : public QueryStageCachedPlanBase {
+public:
+    void run() {
+        AutoGetCollectionForRead ctx(&_txn, nss.ns());
+        Collection* collection = ctx.getCollection();
+        ASSERT(collection);
+
+        // Query can be answered by either index on "a" or index on "b".
+        auto qr = stdx::make_unique<QueryRequest>(nss);
+        qr->setFilter(fromjson("{a: {$gte: 8}, b: 1}"));
+        auto statusWithCQ = CanonicalQuery::canonicalize(
+            txn(), std::move(qr), ExtensionsCallbackDisallowExtensions());
+        ASSERT_OK(statusWithCQ.getStatus());
+        const std::unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+        PlanCache* cache = collection->infoCache()->getPlanCache();
+        ASSERT(cache);
+        ASSERT_FALSE(cache->contains(*cq));
+
+        QueryPlannerParams plannerParams;
+        fillOutPlannerParams(&_txn, collection, cq.get(), &plannerParams);
+
+        // The cached plan would fail if it ran at all.
+        auto mockChild = stdx::make_unique<QueuedDataStage>(&_txn, &_ws);
+        mockChild->pushBack(PlanStage::FAILURE);
+
+        const size_t decisionWorks = 50;
+        const size_t maxWorksBeforeReplan = 500;
+        const bool needsReevaluation = true;
+        const size_t executionSampleRate = 1;
+        CachedPlanStage cachedPlanStage(&_txn,
+                                        collection,
+                                        &_ws,
+                                        cq.get(),
+                                        plannerParams,
+                                        decisionWorks,
+                                        maxWorksBeforeReplan,
+                                        needsReevaluation,
+                                        executionSampleRate,
+                                        mockChild.release());
+
+        PlanYieldPolicy yieldPolicy(PlanExecutor::YIELD_MANUAL,
+                                    _txn.getServiceContext()->getFastClockSource());
+        ASSERT_OK(cachedPlanStage.pickBestPlan(&yieldPolicy));
+        ASSERT(static_cast<const CachedPlanStats*>(cachedPlanStage.getSpecificStats())->replanned);
+
+        size_t numResults = 0;
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        while (state != PlanStage::IS_EOF) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            state = cachedPlanStage.work(&id);
+
+            ASSERT_NE(state, PlanStage::FAILURE);
+            ASSERT_NE(state, PlanStage::DEAD);
+
+            if (state == PlanStage::ADVANCED) {
+                numResults++;
+            }
+        }
+        ASSERT_EQ(numResults, 2U);
+
+        // The winner of the new race is cached.
+        PlanCacheEntry* rawEntry;
+        ASSERT_OK(cache->getEntry(*cq, &rawEntry));
+        const std::unique_ptr<PlanCacheEntry> entry(rawEntry);
+        ASSERT_FALSE(entry->needsReevaluation);
+        ASSERT_FALSE(entry->history.empty());
+        ASSERT_EQ(entry->history.back().reason, "cached");
+
+        // Runs of the replanned query don't count as runs of the cached plan.
+        ASSERT_EQ(entry->works.count(), 0U);
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_cached_plan") {}
@@ -256,6 +357,7 @@ public:
     void setupTests() {
         add<QueryStageCachedPlanFailure>();
         add<QueryStageCachedPlanHitMaxWorks>();
+        add<QueryStageCachedPlanReevaluate>();
     }
 };
 
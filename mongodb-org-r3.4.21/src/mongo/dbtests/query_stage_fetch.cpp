@@ -44,8 +44,11 @@
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/matcher/extensions_callback_disallow_extensions.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageFetch {
 
@@ -219,6 +222,95 @@ public:
     }
 };
 
+//
+// Test that fetching in batches returns the results in the order of the child stage, including
+// those which already have an obj, whether the stage is worked one result at a time or in batches
+// of its own.
+//
+template <bool WorkBatches>
+class FetchStageBatched : public QueryStageFetchBase {
+public:
+    void run() {
+        const int oldBatchSize = internalQueryExecFetchBatchSize.load();
+        internalQueryExecFetchBatchSize.store(4);
+        ON_BLOCK_EXIT([oldBatchSize] { internalQueryExecFetchBatchSize.store(oldBatchSize); });
+
+        OldClientWriteContext ctx(&_txn, ns());
+        Database* db = ctx.db();
+        Collection* coll = db->getCollection(ns());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_txn);
+            coll = db->createCollection(&_txn, ns());
+            wuow.commit();
+        }
+
+        const int numDocs = 20;
+        for (int i = 0; i < numDocs; ++i) {
+            insert(BSON("foo" << i));
+        }
+        set<RecordId> recordIds;
+        getRecordIds(&recordIds, coll);
+        ASSERT_EQUALS(size_t(numDocs), recordIds.size());
+
+        WorkingSet ws;
+        auto mockStage = make_unique<QueuedDataStage>(&_txn, &ws);
+
+        // Queue the documents in reverse RecordId order, with an owned obj in the middle.
+        std::vector<int> expected;
+        int position = 0;
+        for (auto it = recordIds.rbegin(); it != recordIds.rend(); ++it, ++position) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* mockMember = ws.get(id);
+            mockMember->recordId = *it;
+            ws.transitionToRecordIdAndIdx(id);
+            mockStage->pushBack(id);
+            expected.push_back(coll->docFor(&_txn, *it).value()["foo"].numberInt());
+
+            if (position == numDocs / 2) {
+                WorkingSetID ownedId = ws.allocate();
+                WorkingSetMember* ownedMember = ws.get(ownedId);
+                ownedMember->obj = Snapshotted<BSONObj>(SnapshotId(), BSON("foo" << -1));
+                ownedMember->transitionToOwnedObj();
+                mockStage->pushBack(ownedId);
+                expected.push_back(-1);
+            }
+        }
+
+        unique_ptr<FetchStage> fetchStage(
+            new FetchStage(&_txn, &ws, mockStage.release(), NULL, coll));
+
+        std::vector<int> results;
+        PlanStage::WorkBatch batch;
+        PlanStage::StageState state;
+        do {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            if (WorkBatches) {
+                state = fetchStage->workBatch(3, &batch, &id);
+                for (WorkingSetID result : batch.results) {
+                    results.push_back(ws.get(result)->obj.value()["foo"].numberInt());
+                }
+            } else {
+                state = fetchStage->work(&id);
+                if (PlanStage::ADVANCED == state) {
+                    results.push_back(ws.get(id)->obj.value()["foo"].numberInt());
+                    continue;
+                }
+            }
+            ASSERT(PlanStage::NEED_TIME == state || PlanStage::IS_EOF == state);
+        } while (PlanStage::IS_EOF != state);
+
+        ASSERT(expected == results);
+
+        const FetchStats* stats = static_cast<const FetchStats*>(fetchStage->getSpecificStats());
+        ASSERT_EQUALS(size_t(1), stats->alreadyHasObj);
+        if (supportsDocLocking()) {
+            ASSERT_GREATER_THAN(stats->batches, size_t(1));
+        } else {
+            ASSERT_EQUALS(size_t(0), stats->batches);
+        }
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_fetch") {}
@@ -226,6 +318,8 @@ public:
     void setupTests() {
         add<FetchStageAlreadyFetched>();
         add<FetchStageFilter>();
+        add<FetchStageBatched<false>>();
+        add<FetchStageBatched<true>>();
     }
 };
 
@@ -316,6 +316,62 @@ public:
     }
 };
 
+// A covered projection built by the scan names the key fields and leaves out unnamed ones, both
+// when the cursor decodes it and when the bounds checker needs the index keys.
+class QueryStageIxscanCoveredProjection : public IndexScanTest {
+public:
+    void run() {
+        setup();
+
+        insert(fromjson("{_id: 1, x: 5}"));
+        insert(fromjson("{_id: 2, x: 6.5}"));
+        insert(fromjson("{_id: 3, x: 12}"));
+
+        std::unique_ptr<IndexScan> ixscan(
+            createIndexScan(BSON("x" << 5), BSON("x" << 10), true, true));
+        ixscan->setCoveredKeyFieldNames({"y"});
+
+        WorkingSetMember* member = getNext(ixscan.get());
+        ASSERT_EQ(WorkingSetMember::OWNED_OBJ, member->getState());
+        ASSERT_BSONOBJ_EQ(member->obj.value(), BSON("y" << 5));
+        ASSERT_EQ(NumberInt, member->obj.value()["y"].type());
+
+        // Yielding doesn't disturb the projection.
+        ixscan->saveState();
+        ixscan->restoreState();
+
+        member = getNext(ixscan.get());
+        ASSERT_EQ(WorkingSetMember::OWNED_OBJ, member->getState());
+        ASSERT_BSONOBJ_EQ(member->obj.value(), BSON("y" << 6.5));
+
+        WorkingSetID id;
+        ASSERT_EQ(PlanStage::IS_EOF, ixscan->work(&id));
+
+        // Two intervals need the bounds checker, so the scan projects the BSON keys itself.
+        IndexCatalog* catalog = _coll->getIndexCatalog();
+        std::vector<IndexDescriptor*> indexes;
+        catalog->findIndexesByKeyPattern(&_txn, BSON("x" << 1), false, &indexes);
+        ASSERT_EQ(indexes.size(), 1U);
+
+        IndexScanParams params;
+        params.descriptor = indexes[0];
+        params.direction = 1;
+        OrderedIntervalList oil("x");
+        oil.intervals.push_back(Interval(BSON("" << 5 << "" << 5), true, true));
+        oil.intervals.push_back(Interval(BSON("" << 12 << "" << 12), true, true));
+        params.bounds.fields.push_back(oil);
+        ixscan.reset(new IndexScan(&_txn, params, &_ws, nullptr));
+        ixscan->setCoveredKeyFieldNames({StringData()});
+
+        member = getNext(ixscan.get());
+        ASSERT_EQ(WorkingSetMember::OWNED_OBJ, member->getState());
+        ASSERT_BSONOBJ_EQ(member->obj.value(), BSONObj());
+        member = getNext(ixscan.get());
+        ASSERT_BSONOBJ_EQ(member->obj.value(), BSONObj());
+        ASSERT_EQ(PlanStage::IS_EOF, ixscan->work(&id));
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_ixscan") {}
@@ -326,6 +382,7 @@ public:
         add<QueryStageIxscanInsertDuringSaveExclusive>();
         add<QueryStageIxscanInsertDuringSaveExclusive2>();
         add<QueryStageIxscanInsertDuringSaveReverse>();
+        add<QueryStageIxscanCoveredProjection>();
     }
 } QueryStageIxscanAll;
 
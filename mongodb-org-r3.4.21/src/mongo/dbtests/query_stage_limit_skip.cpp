@@ -88,6 +88,24 @@ int countResults(PlanStage* stage) {
     return count;
 }
 
+int countBatchResults(PlanStage* stage, WorkingSet* ws, size_t maxWorks) {
+    int count = 0;
+    PlanStage::WorkBatch batch;
+    for (;;) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState status = stage->workBatch(maxWorks, &batch, &id);
+        ASSERT_LTE(batch.works, maxWorks);
+        for (WorkingSetID result : batch.results) {
+            ws->free(result);
+        }
+        count += batch.results.size();
+        if (PlanStage::IS_EOF == status) {
+            return count;
+        }
+        ASSERT_EQUALS(PlanStage::NEED_TIME, status);
+    }
+}
+
 //
 // Insert 50 objects.  Filter/skip 0, 1, 2, ..., 100 objects and expect the right # of results.
 //
@@ -111,12 +129,44 @@ protected:
     OperationContext* const _opCtx = _uniqOpCtx.get();
 };
 
+//
+// The same, but working the stages in batches of several sizes. The stages account for a batch as
+// for the calls to work() it stands for.
+//
+class QueryStageLimitSkipBatchTest {
+public:
+    void run() {
+        for (size_t maxWorks : {1, 2, 7, 1000}) {
+            for (int i = 0; i < 2 * N; i += 3) {
+                WorkingSet ws;
+
+                unique_ptr<PlanStage> skip =
+                    make_unique<SkipStage>(_opCtx, i, &ws, getMS(_opCtx, &ws));
+                ASSERT_EQUALS(max(0, N - i), countBatchResults(skip.get(), &ws, maxWorks));
+                const CommonStats* stats = skip->getCommonStats();
+                ASSERT_EQUALS(stats->advanced, static_cast<size_t>(max(0, N - i)));
+                ASSERT_EQUALS(stats->works, stats->advanced + stats->needTime + 1);
+
+                unique_ptr<PlanStage> limit =
+                    make_unique<LimitStage>(_opCtx, i, &ws, getMS(_opCtx, &ws));
+                ASSERT_EQUALS(min(N, i), countBatchResults(limit.get(), &ws, maxWorks));
+                ASSERT_EQUALS(limit->getCommonStats()->advanced, static_cast<size_t>(min(N, i)));
+            }
+        }
+    }
+
+protected:
+    const ServiceContext::UniqueOperationContext _uniqOpCtx = cc().makeOperationContext();
+    OperationContext* const _opCtx = _uniqOpCtx.get();
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_limit_skip") {}
 
     void setupTests() {
         add<QueryStageLimitSkipBasicTest>();
+        add<QueryStageLimitSkipBatchTest>();
     }
 };
 
@@ -33,6 +33,7 @@
 #include "mongo/s/balancer_configuration.h"
 
 #include <algorithm>
+#include <limits>
 
 #include "mongo/base/status.h"
 #include "mongo/base/status_with.h"
@@ -52,6 +53,7 @@ const char kStopped[] = "stopped";
 const char kMode[] = "mode";
 const char kActiveWindow[] = "activeWindow";
 const char kWaitForDelete[] = "_waitForDelete";
+const char kMaxConcurrentMigrationsPerShard[] = "maxConcurrentMigrationsPerShard";
 
 const NamespaceString kSettingsNamespace("config", "settings");
 
@@ -131,6 +133,11 @@ bool BalancerConfiguration::waitForDelete() const {
     return _balancerSettings.waitForDelete();
 }
 
+int BalancerConfiguration::getMaxConcurrentMigrationsPerShard() const {
+    stdx::lock_guard<stdx::mutex> lk(_balancerSettingsMutex);
+    return _balancerSettings.getMaxConcurrentMigrationsPerShard();
+}
+
 Status BalancerConfiguration::refreshAndCheck(OperationContext* txn) {
     // Balancer configuration
     Status balancerSettingsStatus = _refreshBalancerSettings(txn);
@@ -327,6 +334,24 @@ StatusWith<BalancerSettingsType> BalancerSettingsType::fromBSON(const BSONObj& o
         settings._waitForDelete = waitForDelete;
     }
 
+    {
+        long long maxConcurrentMigrationsPerShard;
+        Status status = bsonExtractIntegerFieldWithDefault(
+            obj, kMaxConcurrentMigrationsPerShard, 1, &maxConcurrentMigrationsPerShard);
+        if (!status.isOK())
+            return status;
+
+        if (maxConcurrentMigrationsPerShard < 1) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << kMaxConcurrentMigrationsPerShard
+                                        << " must be at least 1");
+        }
+
+        settings._maxConcurrentMigrationsPerShard =
+            static_cast<int>(std::min<long long>(maxConcurrentMigrationsPerShard,
+                                                 std::numeric_limits<int>::max()));
+    }
+
     return settings;
 }
 
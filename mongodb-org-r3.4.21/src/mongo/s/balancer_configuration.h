@@ -52,7 +52,8 @@ class StatusWith;
  * balancer: {
  *  stopped: <true|false>,
  *  mode: <full|autoSplitOnly|off>,         // Only consulted if "stopped" is missing or false
- *  activeWindow: { start: "<HH:MM>", stop: "<HH:MM>" }
+ *  activeWindow: { start: "<HH:MM>", stop: "<HH:MM>" },
+ *  maxConcurrentMigrationsPerShard: <number of migrations per shard per round, at least 1>
  * }
  */
 class BalancerSettingsType {
@@ -107,6 +108,14 @@ public:
         return _waitForDelete;
     }
 
+    /**
+     * Returns the maximum number of migrations in which a single shard may participate (either as
+     * a donor or as a recipient) during one balancer round.
+     */
+    int getMaxConcurrentMigrationsPerShard() const {
+        return _maxConcurrentMigrationsPerShard;
+    }
+
 private:
     BalancerSettingsType();
 
@@ -118,6 +127,8 @@ private:
     MigrationSecondaryThrottleOptions _secondaryThrottle;
 
     bool _waitForDelete{false};
+
+    int _maxConcurrentMigrationsPerShard{1};
 };
 
 /**
@@ -234,6 +245,12 @@ public:
      */
     bool waitForDelete() const;
 
+    /**
+     * Returns the maximum number of migrations per shard, which the balancer may schedule in a
+     * single round.
+     */
+    int getMaxConcurrentMigrationsPerShard() const;
+
     /**
      * Returns the max chunk size after which a chunk would be considered jumbo.
      */
@@ -83,8 +83,8 @@ std::shared_ptr<ChunkManager> refreshCollectionRoutingInfo(
 
     // Check whether the collection epoch might have changed
     ChunkVersion startingCollectionVersion;
-    ChunkMap chunkMap =
-        SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>();
+    ChunkMap emptyChunkMap;
+    const ChunkMap* baseChunkMap = &emptyChunkMap;
 
     if (!existingRoutingInfo) {
         // If we don't have a basis chunk manager, do a full refresh
@@ -94,11 +94,14 @@ std::shared_ptr<ChunkManager> refreshCollectionRoutingInfo(
         startingCollectionVersion = ChunkVersion(0, 0, collectionAndChunks.epoch);
     } else {
         startingCollectionVersion = existingRoutingInfo->getVersion();
-        chunkMap = existingRoutingInfo->chunkMap();
+        baseChunkMap = &existingRoutingInfo->chunkMap();
     }
 
     ChunkVersion collectionVersion = startingCollectionVersion;
 
+    std::vector<std::shared_ptr<Chunk>> changedChunks;
+    changedChunks.reserve(collectionAndChunks.changedChunks.size());
+
     for (const auto& chunk : collectionAndChunks.changedChunks) {
         const auto& chunkVersion = chunk.getVersion();
 
@@ -115,19 +118,7 @@ std::shared_ptr<ChunkManager> refreshCollectionRoutingInfo(
         // Ensure chunk references a valid shard and that the shard is available and loaded
         uassertStatusOK(Grid::get(opCtx)->shardRegistry()->getShard(opCtx, chunk.getShard()));
 
-        // Returns the first chunk with a max key that is > min - implies that the chunk overlaps
-        // min
-        const auto low = chunkMap.upper_bound(chunk.getMin());
-
-        // Returns the first chunk with a max key that is > max - implies that the next chunk cannot
-        // not overlap max
-        const auto high = chunkMap.upper_bound(chunk.getMax());
-
-        // Erase all chunks from the map, which overlap the chunk we got from the persistent store
-        chunkMap.erase(low, high);
-
-        // Insert only the chunk itself
-        chunkMap.insert(std::make_pair(chunk.getMax(), std::make_shared<Chunk>(chunk)));
+        changedChunks.push_back(std::make_shared<Chunk>(chunk));
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -141,6 +132,10 @@ std::shared_ptr<ChunkManager> refreshCollectionRoutingInfo(
         return existingRoutingInfo;
     }
 
+    // Each changed chunk replaces the chunks it overlaps. The unchanged chunks are shared with the
+    // existing routing table rather than copied.
+    ChunkMap chunkMap = baseChunkMap->makeUpdated(changedChunks);
+
     std::unique_ptr<CollatorInterface> defaultCollator;
     if (!collectionAndChunks.defaultCollation.isEmpty()) {
         // The collation should have been validated upon collection creation
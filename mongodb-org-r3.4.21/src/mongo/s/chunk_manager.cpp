@@ -32,6 +32,7 @@
 
 #include "mongo/s/chunk_manager.h"
 
+#include <limits>
 #include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
@@ -41,6 +42,7 @@
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -57,8 +59,123 @@ void checkAllElementsAreOfType(BSONType type, const BSONObj& o) {
     }
 }
 
+// Chunk bounds are compared through their KeyString encoding, which orders keys the same way as
+// BSONObj::woCompare().
+const Ordering kAllAscending = Ordering::make(BSONObj());
+
+std::string encodeChunkBound(const BSONObj& bound) {
+    const KeyString encodedBound(KeyString::Version::V1, bound, kAllAscending);
+    return std::string(encodedBound.getBuffer(), encodedBound.getSize());
+}
+
+StringData keyData(const KeyString& encodedKey) {
+    return StringData(encodedKey.getBuffer(), encodedKey.getSize());
+}
+
 }  // namespace
 
+ChunkMap ChunkMap::makeUpdated(const std::vector<std::shared_ptr<Chunk>>& changedChunks) const {
+    struct ChangedChunk {
+        std::string encodedMin;
+        std::shared_ptr<Chunk> chunk;
+    };
+
+    // Apply the changed chunks to each other first. Keyed by the encoded max of each chunk.
+    std::map<std::string, ChangedChunk> changes;
+    for (const auto& chunk : changedChunks) {
+        std::string encodedMin = encodeChunkBound(chunk->getMin());
+        std::string encodedMax = encodeChunkBound(chunk->getMax());
+
+        // Erase the earlier changed chunks which overlap this one
+        auto it = changes.upper_bound(encodedMin);
+        while (it != changes.end() && it->second.encodedMin < encodedMax) {
+            it = changes.erase(it);
+        }
+
+        changes.emplace(std::move(encodedMax), ChangedChunk{std::move(encodedMin), chunk});
+    }
+
+    ChunkMap updated;
+    updated._chunks.reserve(_chunks.size() + changes.size());
+    updated._encodedMaxEnds.reserve(_chunks.size() + changes.size());
+    updated._encodedMaxes.reserve(_encodedMaxes.size());
+
+    StringData lastEncodedMax;
+    auto append = [&](StringData encodedMin, StringData encodedMax, std::shared_ptr<Chunk> chunk) {
+        if (updated._chunks.empty()) {
+            updated._encodedMin = encodedMin.toString();
+        } else {
+            uassert(ErrorCodes::ConflictingOperationInProgress,
+                    str::stream() << "Gap or an overlap between chunks "
+                                  << updated._chunks.back()->toString()
+                                  << " and "
+                                  << chunk->toString(),
+                    lastEncodedMax == encodedMin);
+        }
+
+        updated._encodedMaxes.append(encodedMax.rawData(), encodedMax.size());
+        invariant(updated._encodedMaxes.size() <= std::numeric_limits<uint32_t>::max());
+        updated._encodedMaxEnds.push_back(updated._encodedMaxes.size());
+        updated._chunks.push_back(std::move(chunk));
+        lastEncodedMax = encodedMax;
+    };
+
+    // Merge the changed chunks into the unchanged ones, both of which are in key order and do not
+    // overlap among themselves.
+    auto change = changes.begin();
+    for (size_t i = 0; i < _chunks.size(); ++i) {
+        const StringData encodedMin = i == 0 ? StringData(_encodedMin) : _encodedMax(i - 1);
+        const StringData encodedMax = _encodedMax(i);
+
+        for (; change != changes.end() && StringData(change->first) <= encodedMin; ++change) {
+            append(change->second.encodedMin, change->first, change->second.chunk);
+        }
+
+        // Only the first changed chunk which ends after this chunk starts can overlap it
+        if (change != changes.end() && StringData(change->second.encodedMin) < encodedMax) {
+            continue;
+        }
+
+        append(encodedMin, encodedMax, _chunks[i]);
+    }
+
+    for (; change != changes.end(); ++change) {
+        append(change->second.encodedMin, change->first, change->second.chunk);
+    }
+
+    return updated;
+}
+
+ChunkMap::const_iterator ChunkMap::upperBound(const BSONObj& key) const {
+    const KeyString encodedKey(KeyString::Version::V1, key, kAllAscending);
+    return _chunks.begin() + _upperBound(keyData(encodedKey));
+}
+
+ChunkMap::const_iterator ChunkMap::findIntersectingChunk(const BSONObj& key) const {
+    const KeyString encodedKey(KeyString::Version::V1, key, kAllAscending);
+    if (_chunks.empty() || keyData(encodedKey) < StringData(_encodedMin)) {
+        return _chunks.end();
+    }
+
+    // Since the chunks are contiguous, the chunk before the upper bound ends where it starts
+    return _chunks.begin() + _upperBound(keyData(encodedKey));
+}
+
+size_t ChunkMap::_upperBound(StringData encodedKey) const {
+    size_t low = 0;
+    size_t high = _chunks.size();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (_encodedMax(mid) <= encodedKey) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
 ChunkManager::ChunkManager(NamespaceString nss,
                            KeyPattern shardKeyPattern,
                            std::unique_ptr<CollatorInterface> defaultCollator,
@@ -89,12 +206,12 @@ std::shared_ptr<Chunk> ChunkManager::findIntersectingChunk(const BSONObj& shardK
         }
     }
 
-    const auto it = _chunkMap.upper_bound(shardKey);
+    const auto it = _chunkMap.findIntersectingChunk(shardKey);
     uassert(ErrorCodes::ShardKeyNotFound,
             str::stream() << "Cannot target single shard using key " << shardKey,
-            it != _chunkMap.end() && it->second->containsKey(shardKey));
+            it != _chunkMap.end());
 
-    return it->second;
+    return *it;
 }
 
 std::shared_ptr<Chunk> ChunkManager::findIntersectingChunkWithSimpleCollation(
@@ -163,26 +280,37 @@ void ChunkManager::getShardIdsForQuery(OperationContext* txn,
     // For now, we satisfy that assumption by adding a shard with no matches rather than returning
     // an empty set of shards.
     if (shardIds->empty()) {
-        shardIds->insert(_chunkMapViews.chunkRangeMap.begin()->second.shardId);
+        shardIds->insert(_chunkMapViews.shardChunksRanges.front().shardId);
     }
 }
 
 void ChunkManager::getShardIdsForRange(const BSONObj& min,
                                        const BSONObj& max,
                                        std::set<ShardId>* shardIds) const {
-    auto it = _chunkMapViews.chunkRangeMap.upper_bound(min);
-    auto end = _chunkMapViews.chunkRangeMap.upper_bound(max);
+    const size_t firstChunk = _chunkMap.upperBound(min) - _chunkMap.begin();
+    size_t chunksEnd = _chunkMap.upperBound(max) - _chunkMap.begin();
 
-    // The chunk range map must always cover the entire key space
-    invariant(it != _chunkMapViews.chunkRangeMap.end());
+    // The chunk map must always cover the entire key space
+    invariant(firstChunk != _chunkMap.size());
 
     // We need to include the last chunk
-    if (end != _chunkMapViews.chunkRangeMap.cend()) {
-        ++end;
+    if (chunksEnd != _chunkMap.size()) {
+        ++chunksEnd;
     }
 
-    for (; it != end; ++it) {
-        shardIds->insert(it->second.shardId);
+    const auto& ranges = _chunkMapViews.shardChunksRanges;
+    auto it = std::upper_bound(
+        ranges.begin(), ranges.end(), firstChunk, [](size_t chunk, const ShardChunksRange& range) {
+            return chunk < range.chunksEnd;
+        });
+
+    for (; it != ranges.end(); ++it) {
+        shardIds->insert(it->shardId);
+
+        // The rest of the ranges start after the last chunk
+        if (it->chunksEnd >= chunksEnd) {
+            break;
+        }
 
         // No need to iterate through the rest of the ranges, because we already know we need to use
         // all shards.
@@ -332,8 +460,8 @@ std::string ChunkManager::toString() const {
     StringBuilder sb;
     sb << "ChunkManager: " << _nss.ns() << " key:" << _shardKeyPattern.toString() << '\n';
 
-    for (const auto& entry : _chunkMap) {
-        sb << "\t" << entry.second->toString() << '\n';
+    for (const auto& chunk : _chunkMap) {
+        sb << "\t" << chunk->toString() << '\n';
     }
 
     return sb.str();
@@ -343,15 +471,14 @@ ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epo
                                                                   const ChunkMap& chunkMap) {
     invariant(!chunkMap.empty());
 
-    ChunkRangeMap chunkRangeMap =
-        SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ShardAndChunkRange>();
+    std::vector<ShardChunksRange> shardChunksRanges;
 
     ShardVersionMap shardVersions;
 
-    ChunkMap::const_iterator current = chunkMap.cbegin();
+    ChunkMap::const_iterator current = chunkMap.begin();
 
-    while (current != chunkMap.cend()) {
-        const auto& firstChunkInRange = current->second;
+    while (current != chunkMap.end()) {
+        const auto& firstChunkInRange = *current;
 
         // Tracks the max shard version for the shard on which the current range will reside
         auto shardVersionIt = shardVersions.find(firstChunkInRange->getShardId());
@@ -365,10 +492,8 @@ ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epo
 
         current = std::find_if(
             current,
-            chunkMap.cend(),
-            [&firstChunkInRange, &maxShardVersion](const ChunkMap::value_type& chunkMapEntry) {
-                const auto& currentChunk = chunkMapEntry.second;
-
+            chunkMap.end(),
+            [&firstChunkInRange, &maxShardVersion](const std::shared_ptr<Chunk>& currentChunk) {
                 if (currentChunk->getShardId() != firstChunkInRange->getShardId())
                     return true;
 
@@ -378,46 +503,22 @@ ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epo
                 return false;
             });
 
-        const auto rangeLast = std::prev(current);
-
-        const BSONObj rangeMin = firstChunkInRange->getMin();
-        const BSONObj rangeMax = rangeLast->second->getMax();
-
-        const auto oldSize = chunkRangeMap.size();
-        const auto insertIterator = chunkRangeMap.insert(
-            chunkRangeMap.end(),
-            std::make_pair(
-                rangeMax,
-                ShardAndChunkRange{{rangeMin, rangeMax}, firstChunkInRange->getShardId()}));
-        uassert(ErrorCodes::ConflictingOperationInProgress,
-                str::stream() << "Metadata contains two chunks with the same max value "
-                              << rangeMax,
-                oldSize + 1 == chunkRangeMap.size());
-
-
-        if (insertIterator != chunkRangeMap.begin()) {
-            // Make sure there are no gaps in the ranges
-            uassert(ErrorCodes::ConflictingOperationInProgress,
-                    str::stream() << "Gap or an overlap between ranges "
-                                  << insertIterator->second.range.toString()
-                                  << " and "
-                                  << std::prev(insertIterator)->second.range.toString(),
-                    SimpleBSONObjComparator::kInstance.evaluate(std::prev(insertIterator)->first ==
-                                                                rangeMin));
-        }
+        // The chunk map has already checked that there are no gaps or overlaps between the chunks
+        shardChunksRanges.push_back(
+            ShardChunksRange{size_t(current - chunkMap.begin()), firstChunkInRange->getShardId()});
 
         // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
         // somewhere, which should have been caught at chunk load time
         invariant(maxShardVersion.isSet());
     }
 
-    invariant(!chunkRangeMap.empty());
+    invariant(!shardChunksRanges.empty());
     invariant(!shardVersions.empty());
 
-    checkAllElementsAreOfType(MinKey, chunkRangeMap.begin()->second.min());
-    checkAllElementsAreOfType(MaxKey, chunkRangeMap.rbegin()->first);
+    checkAllElementsAreOfType(MinKey, (*chunkMap.begin())->getMin());
+    checkAllElementsAreOfType(MaxKey, (*std::prev(chunkMap.end()))->getMax());
 
-    return {std::move(chunkRangeMap), std::move(shardVersions)};
+    return {std::move(shardChunksRanges), std::move(shardVersions)};
 }
 
 }  // namespace mongo
@@ -31,8 +31,10 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/s/chunk.h"
@@ -47,8 +49,70 @@ class CanonicalQuery;
 struct QuerySolutionNode;
 class OperationContext;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
-using ChunkMap = BSONObjIndexedMap<std::shared_ptr<Chunk>>;
+/**
+ * Routing table of a sharded collection: its chunks ordered by key range, covering a contiguous
+ * range of keys without gaps or overlaps. The max bound of every chunk is KeyString-encoded into
+ * one contiguous buffer, so finding the chunk which owns a key is a binary search over memcmp
+ * comparisons rather than a walk down a tree of BSONObj::woCompare() calls.
+ */
+class ChunkMap {
+public:
+    using const_iterator = std::vector<std::shared_ptr<Chunk>>::const_iterator;
+
+    /**
+     * Returns a copy of this routing table with 'changedChunks', which must be in increasing
+     * version order, applied: each of them replaces all of the chunks its range overlaps. The
+     * chunks which did not change are shared with this routing table.
+     *
+     * Throws ConflictingOperationInProgress if the result has a gap or an overlap between chunks.
+     */
+    ChunkMap makeUpdated(const std::vector<std::shared_ptr<Chunk>>& changedChunks) const;
+
+    const_iterator begin() const {
+        return _chunks.begin();
+    }
+
+    const_iterator end() const {
+        return _chunks.end();
+    }
+
+    size_t size() const {
+        return _chunks.size();
+    }
+
+    bool empty() const {
+        return _chunks.empty();
+    }
+
+    /**
+     * Returns the first chunk whose max is greater than 'key', or end() if there is none.
+     */
+    const_iterator upperBound(const BSONObj& key) const;
+
+    /**
+     * Returns the chunk which contains 'key', or end() if there is none.
+     */
+    const_iterator findIntersectingChunk(const BSONObj& key) const;
+
+private:
+    // Returns the index of the first chunk whose max is greater than 'encodedKey'.
+    size_t _upperBound(StringData encodedKey) const;
+
+    StringData _encodedMax(size_t chunkIndex) const {
+        const uint32_t begin = chunkIndex == 0 ? 0 : _encodedMaxEnds[chunkIndex - 1];
+        return StringData(_encodedMaxes.data() + begin, _encodedMaxEnds[chunkIndex] - begin);
+    }
+
+    std::vector<std::shared_ptr<Chunk>> _chunks;
+
+    // The encoded min of the first chunk.
+    std::string _encodedMin;
+
+    // The encoded max of each chunk, back to back in chunk order, and the offset in
+    // '_encodedMaxes' at which each of them ends.
+    std::string _encodedMaxes;
+    std::vector<uint32_t> _encodedMaxEnds;
+};
 
 // Map from a shard is to the max chunk version on that shard
 using ShardVersionMap = std::map<ShardId, ChunkVersion>;
@@ -179,32 +243,22 @@ private:
     friend class CollectionRoutingDataLoader;
 
     /**
-     * Represents a range of chunk keys [getMin(), getMax()) and the id of the shard on which they
-     * reside according to the metadata.
+     * Represents a run of consecutive chunks, which starts where the previous run ends and ends
+     * before the chunk at index 'chunksEnd' of the chunk map, and the id of the shard on which
+     * they reside according to the metadata.
      */
-    struct ShardAndChunkRange {
-        const BSONObj& min() const {
-            return range.getMin();
-        }
-
-        const BSONObj& max() const {
-            return range.getMax();
-        }
-
-        ChunkRange range;
+    struct ShardChunksRange {
+        size_t chunksEnd;
         ShardId shardId;
     };
 
-    using ChunkRangeMap = BSONObjIndexedMap<ShardAndChunkRange>;
-
     /**
      * Contains different transformations of the chunk map for efficient querying
      */
     struct ChunkMapViews {
-        // Transformation of the chunk map containing what range of keys reside on which shard. The
-        // index is the max key of the respective range and the union of all ranges in a such
-        // constructed map must cover the complete space from [MinKey, MaxKey).
-        const ChunkRangeMap chunkRangeMap;
+        // Transformation of the chunk map containing what range of keys reside on which shard, in
+        // key order. Consecutive ranges are on different shards.
+        const std::vector<ShardChunksRange> shardChunksRanges;
 
         // Map from shard id to the maximum chunk version for that shard. If a shard contains no
         // chunks, it won't be present in this map.
@@ -232,8 +286,8 @@ private:
     // Whether the sharding key is unique
     const bool _unique;
 
-    // Map from the max for each chunk to an entry describing the chunk. The union of all chunks'
-    // ranges must cover the complete space from [MinKey, MaxKey).
+    // The chunks in key order. The union of all chunks' ranges must cover the complete space from
+    // [MinKey, MaxKey).
     const ChunkMap _chunkMap;
 
     // Different transformations of the chunk map for efficient querying
@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2019 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/chunk_manager.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("TestDB", "TestColl");
+const OID kEpoch = OID::gen();
+
+std::shared_ptr<Chunk> makeChunk(const BSONObj& min,
+                                 const BSONObj& max,
+                                 uint32_t majorVersion,
+                                 const std::string& shard) {
+    return std::make_shared<Chunk>(ChunkType(
+        kNss, ChunkRange(min, max), ChunkVersion(majorVersion, 0, kEpoch), ShardId(shard)));
+}
+
+ChunkMap makeChunkMap(const std::vector<int>& splitPoints) {
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    BSONObj min = BSON("a" << MINKEY);
+    for (int splitPoint : splitPoints) {
+        const BSONObj max = BSON("a" << splitPoint);
+        chunks.push_back(makeChunk(min, max, chunks.size() + 1, "0"));
+        min = max;
+    }
+    chunks.push_back(makeChunk(min, BSON("a" << MAXKEY), chunks.size() + 1, "0"));
+    return ChunkMap().makeUpdated(chunks);
+}
+
+std::vector<BSONObj> chunkMins(const ChunkMap& chunkMap) {
+    std::vector<BSONObj> mins;
+    for (const auto& chunk : chunkMap) {
+        mins.push_back(chunk->getMin());
+    }
+    return mins;
+}
+
+TEST(ChunkMapTest, FindIntersectingChunk) {
+    const auto chunkMap = makeChunkMap({0, 10, 20});
+    ASSERT_EQ(4U, chunkMap.size());
+
+    ASSERT(chunkMap.findIntersectingChunk(BSON("a" << -5)) == chunkMap.begin());
+    ASSERT(chunkMap.findIntersectingChunk(BSON("a" << 0)) == chunkMap.begin() + 1);
+    ASSERT(chunkMap.findIntersectingChunk(BSON("a" << 9.5)) == chunkMap.begin() + 1);
+    ASSERT(chunkMap.findIntersectingChunk(BSON("a" << 10LL)) == chunkMap.begin() + 2);
+    ASSERT(chunkMap.findIntersectingChunk(BSON("a" << 25)) == chunkMap.begin() + 3);
+    ASSERT(chunkMap.findIntersectingChunk(BSON("a" << MINKEY)) == chunkMap.begin());
+    ASSERT(chunkMap.findIntersectingChunk(BSON("a" << MAXKEY)) == chunkMap.end());
+}
+
+TEST(ChunkMapTest, FindIntersectingChunkBeforeTheFirstChunk) {
+    const auto chunkMap = ChunkMap().makeUpdated({makeChunk(
+        BSON("a" << MINKEY << "b" << MINKEY), BSON("a" << MAXKEY << "b" << MAXKEY), 1, "0")});
+
+    // A prefix of the shard key orders before the MinKey bound of the first chunk
+    ASSERT(chunkMap.findIntersectingChunk(BSON("a" << MINKEY)) == chunkMap.end());
+    ASSERT(chunkMap.findIntersectingChunk(BSON("a" << 1)) == chunkMap.begin());
+}
+
+TEST(ChunkMapTest, UpperBound) {
+    const auto chunkMap = makeChunkMap({0, 10});
+    ASSERT(chunkMap.upperBound(BSON("a" << -1)) == chunkMap.begin());
+    ASSERT(chunkMap.upperBound(BSON("a" << 0)) == chunkMap.begin() + 1);
+    ASSERT(chunkMap.upperBound(BSON("a" << 10)) == chunkMap.begin() + 2);
+    ASSERT(chunkMap.upperBound(BSON("a" << MAXKEY)) == chunkMap.end());
+}
+
+TEST(ChunkMapTest, SplitSharesUnchangedChunks) {
+    const auto chunkMap = makeChunkMap({0, 10});
+    const auto updated = chunkMap.makeUpdated({makeChunk(BSON("a" << 0), BSON("a" << 5), 4, "0"),
+                                               makeChunk(BSON("a" << 5), BSON("a" << 10), 5, "1")});
+
+    ASSERT_EQ(4U, updated.size());
+    const auto mins = chunkMins(updated);
+    ASSERT_BSONOBJ_EQ(BSON("a" << 5), mins[2]);
+    ASSERT(*updated.begin() == *chunkMap.begin());
+    ASSERT(*(updated.begin() + 3) == *(chunkMap.begin() + 2));
+    ASSERT_EQ(ShardId("1"), (*updated.findIntersectingChunk(BSON("a" << 7)))->getShardId());
+}
+
+TEST(ChunkMapTest, MergeReplacesAllOverlappedChunks) {
+    const auto chunkMap = makeChunkMap({0, 10, 20});
+    const auto updated =
+        chunkMap.makeUpdated({makeChunk(BSON("a" << MINKEY), BSON("a" << 20), 5, "0")});
+
+    ASSERT_EQ(2U, updated.size());
+    ASSERT(updated.findIntersectingChunk(BSON("a" << 15)) == updated.begin());
+}
+
+TEST(ChunkMapTest, LaterChangesOverrideEarlierOnes) {
+    const auto chunkMap = makeChunkMap({0});
+    const auto updated =
+        chunkMap.makeUpdated({makeChunk(BSON("a" << 0), BSON("a" << MAXKEY), 3, "1"),
+                              makeChunk(BSON("a" << 0), BSON("a" << 50), 4, "1"),
+                              makeChunk(BSON("a" << 50), BSON("a" << MAXKEY), 5, "2")});
+
+    ASSERT_EQ(3U, updated.size());
+    ASSERT_EQ(ShardId("2"), (*updated.findIntersectingChunk(BSON("a" << 60)))->getShardId());
+}
+
+TEST(ChunkMapTest, GapIsRejected) {
+    const auto chunkMap = makeChunkMap({0, 10});
+    ASSERT_THROWS_CODE(chunkMap.makeUpdated({makeChunk(BSON("a" << 0), BSON("a" << 5), 4, "0")}),
+                       UserException,
+                       ErrorCodes::ConflictingOperationInProgress);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -603,7 +603,7 @@ public:
                     routingInfo.cm());
             auto chunkManager = routingInfo.cm();
 
-            const auto chunkMap = chunkManager->chunkMap();
+            const auto& chunkMap = chunkManager->chunkMap();
 
             // 2. Move and commit each "big chunk" to a different shard.
             int i = 0;
@@ -615,7 +615,7 @@ public:
                 }
                 const auto to = toStatus.getValue();
 
-                auto chunk = c->second;
+                auto chunk = *c;
 
                 // Can't move chunk to shard it's already on
                 if (to->getId() == chunk->getShardId()) {
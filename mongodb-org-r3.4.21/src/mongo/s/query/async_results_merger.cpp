@@ -51,13 +51,25 @@ namespace {
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+/**
+ * Returns the sort key mongod attached to 'result'. A result carrying a resolved view definition
+ * has no sort key and is given the empty key, which sorts before all others.
+ */
+BSONObj getSortKey(const ClusterQueryResult& result) {
+    if (!result.getResult()) {
+        return BSONObj();
+    }
+
+    return (*result.getResult())[ClusterClientCursorParams::kSortKeyField].Obj();
+}
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(executor::TaskExecutor* executor,
                                        ClusterClientCursorParams&& params)
     : _executor(executor),
       _params(std::move(params)),
-      _mergeQueue(MergingComparator(_remotes, _params.sort)) {
+      _mergeTree(_remotes, _params.sort) {
     for (const auto& remote : _params.remotes) {
         if (remote.shardId) {
             invariant(remote.cmdObj);
@@ -72,6 +84,14 @@ AsyncResultsMerger::AsyncResultsMerger(executor::TaskExecutor* executor,
         }
     }
 
+    _mergeTree.reset();
+
+    // Tailable cursors keep returning results past the end of each batch, so only a non-tailable
+    // cursor's limit bounds what the remotes need to send.
+    if (_params.limit && !_params.isTailable) {
+        _numResultsNeeded = *_params.limit + _params.skip.get_value_or(0);
+    }
+
     // Initialize command metadata to handle the read preference.
     if (_params.readPreference) {
         BSONObjBuilder metadataBuilder;
@@ -159,7 +179,7 @@ bool AsyncResultsMerger::readySorted_inlock() {
     invariant(!_params.isTailable);
 
     for (const auto& remote : _remotes) {
-        if (!remote.hasNext() && !remote.exhausted()) {
+        if (!remote.hasNext() && !remote.exhausted() && !remote.pastLimit) {
             return false;
         }
     }
@@ -170,7 +190,7 @@ bool AsyncResultsMerger::readySorted_inlock() {
 bool AsyncResultsMerger::readyUnsorted_inlock() {
     bool allExhausted = true;
     for (const auto& remote : _remotes) {
-        if (!remote.exhausted()) {
+        if (!remote.exhausted() && !remote.pastLimit) {
             allExhausted = false;
         }
 
@@ -199,31 +219,37 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     }
 
     const bool hasSort = !_params.sort.isEmpty();
-    return hasSort ? nextReadySorted() : nextReadyUnsorted();
+    auto result = hasSort ? nextReadySorted() : nextReadyUnsorted();
+
+    if (_numResultsNeeded && *_numResultsNeeded > 0 && !result.isEOF()) {
+        if (--*_numResultsNeeded == 0) {
+            // The limit has been reached, so nothing more is needed from any remote.
+            markRemotesPastLimit_inlock();
+        }
+    }
+
+    return result;
 }
 
 ClusterQueryResult AsyncResultsMerger::nextReadySorted() {
     // Tailable cursors cannot have a sort.
     invariant(!_params.isTailable);
 
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
+    size_t smallestRemote = _mergeTree.top();
 
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
 
     ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    _remotes[smallestRemote].docBuffer.pop_front();
 
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
-    }
+    // Replay the tree with the next result from 'smallestRemote', or with none if its buffer is
+    // now empty.
+    _mergeTree.update(smallestRemote);
 
     return front;
 }
@@ -236,7 +262,7 @@ ClusterQueryResult AsyncResultsMerger::nextReadyUnsorted() {
 
         if (_remotes[_gettingFromRemote].hasNext()) {
             ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
-            _remotes[_gettingFromRemote].docBuffer.pop();
+            _remotes[_gettingFromRemote].docBuffer.pop_front();
 
             if (_params.isTailable && !_remotes[_gettingFromRemote].hasNext()) {
                 // The cursor is tailable and we're about to return the last buffered result. This
@@ -276,6 +302,13 @@ Status AsyncResultsMerger::askForNextBatch_inlock(size_t remoteIndex) {
             adjustedBatchSize = *_params.batchSize - remote.fetchedCount;
         }
 
+        // A single remote may end up supplying every result the merged stream still has to
+        // return, but never more than that.
+        if (_numResultsNeeded && *_numResultsNeeded > 0 &&
+            (!adjustedBatchSize || *adjustedBatchSize > *_numResultsNeeded)) {
+            adjustedBatchSize = *_numResultsNeeded;
+        }
+
         cmdObj = GetMoreRequest(_params.nsString,
                                 *remote.cursorId,
                                 adjustedBatchSize,
@@ -345,7 +378,8 @@ StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent()
             return remote.status;
         }
 
-        if (!remote.hasNext() && !remote.exhausted() && !remote.cbHandle.isValid()) {
+        if (!remote.hasNext() && !remote.exhausted() && !remote.pastLimit &&
+            !remote.cbHandle.isValid()) {
             // If we already have established a cursor with this remote, and there is no outstanding
             // request for which we have a valid callback handle, then schedule work to retrieve the
             // next batch.
@@ -444,6 +478,16 @@ void AsyncResultsMerger::handleBatchResponse(
         cbData.response.isOK() ? parseCursorResponse(cbData.response.data, remote)
                                : cbData.response.status);
 
+    if (remote.pastLimit) {
+        // Nothing this remote sends can be returned any more, so the batch is dropped, along with
+        // any error. Keep track of the cursor id so that the remote cursor can still be killed.
+        if (cursorResponseStatus.isOK()) {
+            remote.cursorId = cursorResponseStatus.getValue().getCursorId();
+            remote.numDiscarded += cursorResponseStatus.getValue().getBatch().size();
+        }
+        return;
+    }
+
     if (!cursorResponseStatus.isOK()) {
         // In the case a read is performed against a view, the shard primary can return an error
         // indicating that the underlying collection may be sharded. When this occurs the return
@@ -471,14 +515,13 @@ void AsyncResultsMerger::handleBatchResponse(
             ClusterQueryResult result;
             result.setViewDefinition(resolvedViewObj.getOwned());
 
-            remote.docBuffer.push(result);
+            remote.docBuffer.push_back(result);
             remote.cursorId = 0;
             remote.status = Status::OK();
 
             if (!_params.sort.isEmpty()) {
-                // Push the index of this remote to the merge queue so that the resolved view is
-                // visible to nextReadySorted().
-                _mergeQueue.push(remoteIndex);
+                // Update the merge tree so that the resolved view is visible to nextReadySorted().
+                _mergeTree.update(remoteIndex);
             }
             return;
         }
@@ -534,9 +577,12 @@ void AsyncResultsMerger::handleBatchResponse(
             remote.status = Status::OK();
 
             // Clear the results buffer and cursor id.
-            std::queue<ClusterQueryResult> emptyBuffer;
-            std::swap(remote.docBuffer, emptyBuffer);
+            remote.docBuffer.clear();
             remote.cursorId = 0;
+
+            if (!_params.sort.isEmpty()) {
+                _mergeTree.update(remoteIndex);
+            }
         }
 
         return;
@@ -560,16 +606,19 @@ void AsyncResultsMerger::handleBatchResponse(
         }
 
         ClusterQueryResult result(obj);
-        remote.docBuffer.push(result);
+        remote.docBuffer.push_back(result);
         ++remote.fetchedCount;
     }
 
-    // If we're doing a sorted merge, then we have to make sure to put this remote onto the
-    // merge queue.
+    // If we're doing a sorted merge, then we have to make sure this remote's results are visible
+    // in the merge tree.
     if (!_params.sort.isEmpty() && !cursorResponse.getBatch().empty()) {
-        _mergeQueue.push(remoteIndex);
+        remote.lastSortKey = getSortKey(remote.docBuffer.back()).getOwned();
+        _mergeTree.update(remoteIndex);
     }
 
+    markRemotesPastLimit_inlock();
+
     // If the cursor is tailable and we just received an empty batch, the next return value should
     // be boost::none in order to indicate the end of the batch.
     if (_params.isTailable && !remote.hasNext()) {
@@ -581,7 +630,7 @@ void AsyncResultsMerger::handleBatchResponse(
     //
     // We do not ask for the next batch if the cursor is tailable, as batches received from remote
     // tailable cursors should be passed through to the client without asking for more batches.
-    if (!_params.isTailable && !remote.hasNext() && !remote.exhausted()) {
+    if (!_params.isTailable && !remote.hasNext() && !remote.exhausted() && !remote.pastLimit) {
         remote.status = askForNextBatch_inlock(remoteIndex);
         if (!remote.status.isOK()) {
             return;
@@ -603,6 +652,60 @@ void AsyncResultsMerger::signalCurrentEventIfReady_inlock() {
     }
 }
 
+void AsyncResultsMerger::markRemotesPastLimit_inlock() {
+    if (!_numResultsNeeded) {
+        return;
+    }
+
+    const bool hasSort = !_params.sort.isEmpty();
+
+    for (auto& remote : _remotes) {
+        // A remote whose cursor is not established yet must still be waited on, because every
+        // remote has to respond once before any results are returned.
+        if (remote.exhausted() || remote.pastLimit || !remote.cursorId) {
+            continue;
+        }
+
+        if (*_numResultsNeeded > 0) {
+            // Until a remote has sent a document, nothing bounds where its results sort.
+            if (hasSort && remote.lastSortKey.isEmpty()) {
+                continue;
+            }
+
+            // Count the buffered results which will be returned ahead of anything this remote has
+            // yet to send. Without a sort that is every buffered result. With a sort it is those
+            // that sort at or before the last document the remote sent, since the remote's
+            // results arrive in sort order.
+            long long numAhead = 0;
+            for (const auto& other : _remotes) {
+                for (const auto& result : other.docBuffer) {
+                    if (hasSort &&
+                        getSortKey(result).woCompare(remote.lastSortKey, _params.sort, false) > 0) {
+                        break;
+                    }
+
+                    if (++numAhead == *_numResultsNeeded) {
+                        break;
+                    }
+                }
+
+                if (numAhead == *_numResultsNeeded) {
+                    break;
+                }
+            }
+
+            if (numAhead < *_numResultsNeeded) {
+                continue;
+            }
+        }
+
+        // A batch already requested from the remote is still awaited, and discarded when it
+        // arrives. Canceling the request would let kill() issue killCursors while the getMore is
+        // still running on the remote, which refuses to kill a cursor in use.
+        remote.pastLimit = true;
+    }
+}
+
 bool AsyncResultsMerger::haveOutstandingBatchRequests_inlock() {
     for (const auto& remote : _remotes) {
         if (remote.cbHandle.isValid()) {
@@ -647,6 +750,14 @@ executor::TaskExecutor::EventHandle AsyncResultsMerger::kill() {
 
     _lifecycleState = kKillStarted;
 
+    for (const auto& remote : _remotes) {
+        const long long numDiscarded = remote.numDiscarded + remote.docBuffer.size();
+        if (numDiscarded > 0) {
+            LOG(1) << "Discarding " << numDiscarded << " results received from "
+                   << remote.getTargetHost() << " which were not returned on " << _params.nsString;
+        }
+    }
+
     // Make '_killCursorsScheduledEvent', which we will signal as soon as we have scheduled a
     // killCursors command to run on all the remote shards.
     auto statusWithEvent = _executor->makeEvent();
@@ -728,19 +839,67 @@ std::shared_ptr<Shard> AsyncResultsMerger::RemoteCursorData::getShard() {
 }
 
 //
-// AsyncResultsMerger::MergingComparator
+// AsyncResultsMerger::MergeTree
 //
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
-    const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
-    const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
+void AsyncResultsMerger::MergeTree::reset() {
+    const size_t numRemotes = _remotes.size();
 
-    BSONObj leftDocKey = (*leftDoc.getResult())[ClusterClientCursorParams::kSortKeyField].Obj();
-    BSONObj rightDocKey = (*rightDoc.getResult())[ClusterClientCursorParams::kSortKeyField].Obj();
+    _frontSortKeys.assign(numRemotes, BSONObj());
+    _nodes.assign(2 * numRemotes, 0);
+
+    for (size_t i = 0; i < numRemotes; ++i) {
+        invariant(!_remotes[i].hasNext());
+        _nodes[numRemotes + i] = i;
+    }
+
+    for (size_t node = numRemotes > 0 ? numRemotes - 1 : 0; node >= 1; --node) {
+        const size_t left = _nodes[2 * node];
+        const size_t right = _nodes[2 * node + 1];
+        _nodes[node] = precedes(right, left) ? right : left;
+    }
+}
+
+void AsyncResultsMerger::MergeTree::update(size_t remoteIndex) {
+    const size_t numRemotes = _remotes.size();
+    invariant(remoteIndex < numRemotes);
+
+    _frontSortKeys[remoteIndex] = _remotes[remoteIndex].hasNext()
+        ? getSortKey(_remotes[remoteIndex].docBuffer.front())
+        : BSONObj();
+
+    for (size_t node = (numRemotes + remoteIndex) / 2; node >= 1; node /= 2) {
+        const size_t left = _nodes[2 * node];
+        const size_t right = _nodes[2 * node + 1];
+        _nodes[node] = precedes(right, left) ? right : left;
+    }
+}
+
+bool AsyncResultsMerger::MergeTree::empty() const {
+    return _remotes.empty() || !_remotes[top()].hasNext();
+}
+
+size_t AsyncResultsMerger::MergeTree::top() const {
+    invariant(!_remotes.empty());
+    return _nodes[1];
+}
+
+bool AsyncResultsMerger::MergeTree::precedes(size_t lhs, size_t rhs) const {
+    const bool lhsHasNext = _remotes[lhs].hasNext();
+    const bool rhsHasNext = _remotes[rhs].hasNext();
+    if (lhsHasNext != rhsHasNext) {
+        return lhsHasNext;
+    }
+
+    if (!lhsHasNext) {
+        return lhs < rhs;
+    }
 
     // This does not need to sort with a collator, since mongod has already mapped strings to their
     // ICU comparison keys as part of the $sortKey meta projection.
-    return leftDocKey.woCompare(rightDocKey, _sort, false /*considerFieldName*/) > 0;
+    const int cmp =
+        _frontSortKeys[lhs].woCompare(_frontSortKeys[rhs], _sort, false /*considerFieldName*/);
+    return cmp < 0 || (cmp == 0 && lhs < rhs);
 }
 
 }  // namespace mongo
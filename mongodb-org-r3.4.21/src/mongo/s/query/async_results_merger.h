@@ -29,7 +29,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
-#include <queue>
+#include <deque>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
@@ -65,6 +65,12 @@ class CursorResponse;
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
  *
+ * If there is a limit, the ARM tracks how many more results the merged stream can produce and never
+ * asks a remote for a getMore batch larger than that. Once the results already buffered are enough
+ * to satisfy the limit ahead of anything a remote has yet to send, that remote is no longer waited
+ * on or asked for more. A request already outstanding against it is left to finish, its batch is
+ * dropped, and kill() waits for it before sending the killCursors.
+ *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
  * Does not throw exceptions.
@@ -242,7 +248,7 @@ private:
         // established but is now exhausted, this member will be set to zero.
         boost::optional<CursorId> cursorId;
 
-        std::queue<ClusterQueryResult> docBuffer;
+        std::deque<ClusterQueryResult> docBuffer;
         executor::TaskExecutor::CallbackHandle cbHandle;
         Status status = Status::OK();
 
@@ -255,23 +261,73 @@ private:
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
 
+        // The sort key of the last document received from this remote. Everything the remote has
+        // yet to send sorts at or after it. Used only if there is a sort.
+        BSONObj lastSortKey;
+
+        // Set once the remote cannot contribute any result it has not already sent, because the
+        // results buffered from all remotes are enough to satisfy the limit. Its cursor is left
+        // open until the ARM is killed, but it is neither waited on nor asked for more batches.
+        bool pastLimit = false;
+
+        // Number of documents received from this remote after it went past the limit, which were
+        // dropped without being buffered.
+        long long numDiscarded = 0;
+
     private:
         // For a cursor, which has shard id associated contains the exact host on which the remote
         // cursor resides.
         boost::optional<HostAndPort> _shardHostAndPort;
     };
 
-    class MergingComparator {
+    /**
+     * A tournament tree over the remotes, used to find the remote whose next buffered result comes
+     * first in the sort order. Each internal node holds the index of the remote that wins among the
+     * leaves below it. When the front of a remote's buffer changes, only the path from its leaf to
+     * the root is replayed, at one comparison per level. A binary heap pays about two comparisons
+     * per level for the same pop and push. Remotes with nothing buffered lose to every other
+     * remote.
+     */
+    class MergeTree {
     public:
-        MergingComparator(const std::vector<RemoteCursorData>& remotes, const BSONObj& sort)
+        MergeTree(const std::vector<RemoteCursorData>& remotes, const BSONObj& sort)
             : _remotes(remotes), _sort(sort) {}
 
-        bool operator()(const size_t& lhs, const size_t& rhs);
+        /**
+         * Sizes the tree for the current set of remotes, none of which may have buffered results.
+         */
+        void reset();
+
+        /**
+         * Must be called whenever the front of the buffer of the remote at 'remoteIndex' changes,
+         * including when the buffer becomes empty or non-empty.
+         */
+        void update(size_t remoteIndex);
+
+        /**
+         * Returns true if no remote has a buffered result.
+         */
+        bool empty() const;
+
+        /**
+         * Returns the index of the remote with the next result to return.
+         */
+        size_t top() const;
 
     private:
+        bool precedes(size_t lhs, size_t rhs) const;
+
         const std::vector<RemoteCursorData>& _remotes;
 
         const BSONObj& _sort;
+
+        // The sort key of the front of each remote's buffer, cached so that every comparison does
+        // not have to look it up within the document again.
+        std::vector<BSONObj> _frontSortKeys;
+
+        // Node 'i' has children '2i' and '2i + 1'. The leaf for remote 'r' is node
+        // '_remotes.size() + r', and the overall winner is held in node 1.
+        std::vector<size_t> _nodes;
     };
 
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
@@ -305,6 +361,14 @@ private:
      */
     bool remotesExhausted_inlock();
 
+    /**
+     * Marks as past the limit each remote whose remaining results can no longer be returned
+     * because enough results sorting at or before them are already buffered. A batch request
+     * outstanding against such a remote is left to finish and its batch is dropped, and kill()
+     * waits for it before sending the killCursors. Does nothing if there is no limit.
+     */
+    void markRemotesPastLimit_inlock();
+
     //
     // Helpers for ready().
     //
@@ -366,9 +430,13 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
-    // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    // The top of this tree is the index into '_remotes' for the remote host that has the next
+    // document to return, according to the sort order. Used only if there is a sort.
+    MergeTree _mergeTree;
+
+    // The number of results the merged stream can still return before reaching the limit, which
+    // includes any results to be skipped. Unset if there is no limit.
+    boost::optional<long long> _numResultsNeeded;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
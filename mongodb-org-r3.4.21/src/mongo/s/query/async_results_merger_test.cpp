@@ -1172,6 +1172,188 @@ TEST_F(AsyncResultsMergerTest, GetMoreBatchSizes) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, GetMoreBatchSizeCappedByLimit) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', limit: 5, batchSize: 2}");
+    const long long getMoreBatchSize = 10LL;
+    makeCursorFromFindCmd(findCmd, {kTestShardIds[0]}, getMoreBatchSize);
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_FALSE(arm->ready());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1}"), fromjson("{_id: 2}")};
+    responses.emplace_back(_nss, CursorId(1), batch1);
+    scheduleNetworkResponses(std::move(responses), CursorResponse::ResponseType::InitialResponse);
+    executor()->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+
+    // Only three more results can be returned before reaching the limit, so the getMore asks for
+    // no more than that.
+    readyEvent = unittest::assertGet(arm->nextEvent());
+    auto request = GetMoreRequest::parseFromBSON("anydbname", getFirstPendingRequest().cmdObj);
+    ASSERT_OK(request.getStatus());
+    ASSERT_EQ(*request.getValue().batchSize, 3LL);
+
+    responses.clear();
+    std::vector<BSONObj> batch2 = {
+        fromjson("{_id: 3}"), fromjson("{_id: 4}"), fromjson("{_id: 5}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 4}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 5}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, SortedLimitStopsWaitingOnRemotesPastLimit) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}, limit: 3}");
+    makeCursorFromFindCmd(findCmd, {kTestShardIds[0], kTestShardIds[1]});
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_FALSE(arm->ready());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1, $sortKey: {'': 1}}"),
+                                   fromjson("{_id: 2, $sortKey: {'': 2}}")};
+    responses.emplace_back(_nss, CursorId(5), batch1);
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 3, $sortKey: {'': 3}}")};
+    responses.emplace_back(_nss, CursorId(6), batch2);
+    scheduleNetworkResponses(std::move(responses), CursorResponse::ResponseType::InitialResponse);
+    executor()->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1, $sortKey: {'': 1}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2, $sortKey: {'': 2}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+
+    // The first shard may still have results sorting before {_id: 3}, so it has to be asked for
+    // more, but only for the one result still needed. The three results buffered so far are
+    // enough to fill the limit ahead of anything else the second shard has, so it is not asked.
+    ASSERT_FALSE(arm->ready());
+    readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_FALSE(arm->ready());
+
+    auto pendingRequest = getFirstPendingRequest();
+    ASSERT_EQ(pendingRequest.target, kTestShardHosts[0]);
+    auto request = GetMoreRequest::parseFromBSON("anydbname", pendingRequest.cmdObj);
+    ASSERT_OK(request.getStatus());
+    ASSERT_EQ(*request.getValue().batchSize, 1LL);
+    ASSERT_EQ(request.getValue().cursorid, 5LL);
+
+    responses.clear();
+    std::vector<BSONObj> batch3 = {fromjson("{_id: 4, $sortKey: {'': 4}}")};
+    responses.emplace_back(_nss, CursorId(5), batch3);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    executor::NetworkInterfaceMock* net = network();
+    net->enterNetwork();
+    ASSERT_FALSE(net->hasReadyRequests());
+    net->exitNetwork();
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3, $sortKey: {'': 3}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+
+    // The limit has been reached without exhausting either remote cursor. Nothing more is asked
+    // of either shard; the caller stops reading here and kills the cursor.
+    ASSERT_FALSE(arm->remotesExhausted());
+
+    auto killEvent = arm->kill();
+    executor()->waitForEvent(killEvent);
+}
+
+TEST_F(AsyncResultsMergerTest, LimitAwaitsGetMoreOfRemotePastLimitBeforeKillingCursors) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', limit: 3}");
+    makeCursorFromFindCmd(findCmd, {kTestShardIds[0], kTestShardIds[1]});
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_FALSE(arm->ready());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1}")};
+    responses.emplace_back(_nss, CursorId(5), batch1);
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 2}")};
+    responses.emplace_back(_nss, CursorId(6), batch2);
+    scheduleNetworkResponses(std::move(responses), CursorResponse::ResponseType::InitialResponse);
+    executor()->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+
+    // Both shards are asked for the one result still needed.
+    ASSERT_FALSE(arm->ready());
+    readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_FALSE(arm->ready());
+
+    ASSERT_EQ(getFirstPendingRequest().target, kTestShardHosts[0]);
+    responses.clear();
+    std::vector<BSONObj> batch3 = {fromjson("{_id: 3}")};
+    responses.emplace_back(_nss, CursorId(5), batch3);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    // The first shard's result fills the limit, so the second shard is past it. Its getMore is not
+    // canceled, since the cursor can't be killed while the getMore runs on the shard.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+
+    auto pendingRequest = getFirstPendingRequest();
+    ASSERT_EQ(pendingRequest.target, kTestShardHosts[1]);
+    auto request = GetMoreRequest::parseFromBSON("anydbname", pendingRequest.cmdObj);
+    ASSERT_OK(request.getStatus());
+    ASSERT_EQ(request.getValue().cursorid, 6LL);
+
+    // The kill waits for the getMore, whose batch is discarded, before killing both cursors.
+    auto killEvent = arm->kill();
+    ASSERT_TRUE(GetMoreRequest::parseFromBSON("anydbname", getFirstPendingRequest().cmdObj)
+                    .getStatus()
+                    .isOK());
+
+    responses.clear();
+    std::vector<BSONObj> batch4 = {fromjson("{_id: 4}")};
+    responses.emplace_back(_nss, CursorId(6), batch4);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+
+    executor::NetworkInterfaceMock* net = network();
+    net->enterNetwork();
+    for (CursorId cursorId : {CursorId(5), CursorId(6)}) {
+        ASSERT_TRUE(net->hasReadyRequests());
+        auto noi = net->getNextReadyRequest();
+        BSONObj expectedCmdObj = BSON("killCursors"
+                                      << "testcoll"
+                                      << "cursors"
+                                      << BSON_ARRAY(cursorId));
+        ASSERT_BSONOBJ_EQ(noi->getRequest().cmdObj, expectedCmdObj);
+        net->blackHole(noi);
+    }
+    net->exitNetwork();
+
+    executor()->waitForEvent(killEvent);
+}
+
 TEST_F(AsyncResultsMergerTest, SendsSecondaryOkAsMetadata) {
     BSONObj findCmd = fromjson("{find: 'testcoll', batchSize: 2}");
     makeCursorFromFindCmd(
@@ -70,119 +70,120 @@ BSONObj buildErrReply(const DBException& ex) {
 ServiceEntryPointMongos::ServiceEntryPointMongos(TransportLayer* tl) : _tl(tl) {}
 
 void ServiceEntryPointMongos::startSession(transport::SessionHandle session) {
-    launchWrappedServiceEntryWorkerThread(
-        std::move(session),
-        [this](const transport::SessionHandle& session) { _sessionLoop(session); });
+    auto counter = std::make_shared<int64_t>(0);
+    launchServiceEntrySession(std::move(session),
+                              [this, counter](const transport::SessionHandle& session) {
+                                  return _sessionCycle(session, counter.get());
+                              });
 }
 
-void ServiceEntryPointMongos::_sessionLoop(const transport::SessionHandle& session) {
-    int64_t counter = 0;
+SessionCycleResult ServiceEntryPointMongos::_sessionCycle(const transport::SessionHandle& session,
+                                                          int64_t* counter) {
+    // Release any cached egress connections for client back to pool before destroying
+    auto guard = MakeGuard(ShardConnection::releaseMyConnections);
 
-    while (true) {
-        // Release any cached egress connections for client back to pool before destroying
-        auto guard = MakeGuard(ShardConnection::releaseMyConnections);
+    Message message;
 
-        Message message;
+    // Source a Message from the client
+    {
+        auto status = [&] {
+            MONGO_IDLE_THREAD_BLOCK;
+            return session->sourceMessage(&message).wait();
+        }();
 
-        // Source a Message from the client
-        {
-            auto status = [&] {
-                MONGO_IDLE_THREAD_BLOCK;
-                return session->sourceMessage(&message).wait();
-            }();
-
-            if (ErrorCodes::isInterruption(status.code()) ||
-                ErrorCodes::isNetworkError(status.code())) {
-                break;
-            }
-
-            // Our session may have been closed internally.
-            if (status == TransportLayer::TicketSessionClosedStatus) {
-                break;
-            }
+        if (ErrorCodes::isInterruption(status.code()) ||
+            ErrorCodes::isNetworkError(status.code())) {
+            return SessionCycleResult::kEnd;
+        }
 
-            uassertStatusOK(status);
+        // Our session may have been closed internally.
+        if (status == TransportLayer::TicketSessionClosedStatus) {
+            return SessionCycleResult::kEnd;
         }
 
-        auto txn = cc().makeOperationContext();
+        uassertStatusOK(status);
+    }
 
-        const int32_t msgId = message.header().getId();
+    auto txn = cc().makeOperationContext();
 
-        const NetworkOp op = message.operation();
+    const int32_t msgId = message.header().getId();
 
-        // This exception will not be returned to the caller, but will be logged and will close the
-        // connection
-        uassert(ErrorCodes::IllegalOperation,
-                str::stream() << "Message type " << op << " is not supported.",
-                op > dbMsg);
+    const NetworkOp op = message.operation();
 
-        // Start a new LastError session. Any exceptions thrown from here onwards will be returned
-        // to the caller (if the type of the message permits it).
-        ClusterLastErrorInfo::get(txn->getClient()).newRequest();
-        LastError::get(txn->getClient()).startRequest();
+    // This exception will not be returned to the caller, but will be logged and will close the
+    // connection
+    uassert(ErrorCodes::IllegalOperation,
+            str::stream() << "Message type " << op << " is not supported.",
+            op > dbMsg);
 
-        DbMessage dbm(message);
+    // Start a new LastError session. Any exceptions thrown from here onwards will be returned
+    // to the caller (if the type of the message permits it).
+    ClusterLastErrorInfo::get(txn->getClient()).newRequest();
+    LastError::get(txn->getClient()).startRequest();
 
-        NamespaceString nss;
+    DbMessage dbm(message);
 
-        try {
+    NamespaceString nss;
 
-            if (dbm.messageShouldHaveNs()) {
-                nss = NamespaceString(StringData(dbm.getns()));
+    try {
 
-                uassert(ErrorCodes::InvalidNamespace,
-                        str::stream() << "Invalid ns [" << nss.ns() << "]",
-                        nss.isValid());
+        if (dbm.messageShouldHaveNs()) {
+            nss = NamespaceString(StringData(dbm.getns()));
 
-                uassert(ErrorCodes::IllegalOperation,
-                        "Can't use 'local' database through mongos",
-                        nss.db() != NamespaceString::kLocalDb);
-            }
+            uassert(ErrorCodes::InvalidNamespace,
+                    str::stream() << "Invalid ns [" << nss.ns() << "]",
+                    nss.isValid());
 
-            AuthorizationSession::get(txn->getClient())->startRequest(txn.get());
+            uassert(ErrorCodes::IllegalOperation,
+                    "Can't use 'local' database through mongos",
+                    nss.db() != NamespaceString::kLocalDb);
+        }
 
-            LOG(3) << "Request::process begin ns: " << nss << " msg id: " << msgId
-                   << " op: " << networkOpToString(op);
+        AuthorizationSession::get(txn->getClient())->startRequest(txn.get());
 
-            switch (op) {
-                case dbQuery:
-                    if (nss.isCommand() || nss.isSpecialCommand()) {
-                        Strategy::clientCommandOp(txn.get(), nss, &dbm);
-                    } else {
-                        Strategy::queryOp(txn.get(), nss, &dbm);
-                    }
-                    break;
-                case dbGetMore:
-                    Strategy::getMore(txn.get(), nss, &dbm);
-                    break;
-                case dbKillCursors:
-                    Strategy::killCursors(txn.get(), &dbm);
-                    break;
-                default:
-                    Strategy::writeOp(txn.get(), &dbm);
-                    break;
-            }
+        LOG(3) << "Request::process begin ns: " << nss << " msg id: " << msgId
+               << " op: " << networkOpToString(op);
 
-            LOG(3) << "Request::process end ns: " << nss << " msg id: " << msgId
-                   << " op: " << networkOpToString(op);
+        switch (op) {
+            case dbQuery:
+                if (nss.isCommand() || nss.isSpecialCommand()) {
+                    Strategy::clientCommandOp(txn.get(), nss, &dbm);
+                } else {
+                    Strategy::queryOp(txn.get(), nss, &dbm);
+                }
+                break;
+            case dbGetMore:
+                Strategy::getMore(txn.get(), nss, &dbm);
+                break;
+            case dbKillCursors:
+                Strategy::killCursors(txn.get(), &dbm);
+                break;
+            default:
+                Strategy::writeOp(txn.get(), &dbm);
+                break;
+        }
 
-        } catch (const DBException& ex) {
-            LOG(1) << "Exception thrown"
-                   << " while processing " << networkOpToString(op) << " op"
-                   << " for " << nss.ns() << causedBy(ex);
+        LOG(3) << "Request::process end ns: " << nss << " msg id: " << msgId
+               << " op: " << networkOpToString(op);
 
-            if (op == dbQuery || op == dbGetMore) {
-                replyToQuery(ResultFlag_ErrSet, session, message, buildErrReply(ex));
-            }
+    } catch (const DBException& ex) {
+        LOG(1) << "Exception thrown"
+               << " while processing " << networkOpToString(op) << " op"
+               << " for " << nss.ns() << causedBy(ex);
 
-            // We *always* populate the last error for now
-            LastError::get(txn->getClient()).setLastError(ex.getCode(), ex.what());
+        if (op == dbQuery || op == dbGetMore) {
+            replyToQuery(ResultFlag_ErrSet, session, message, buildErrReply(ex));
         }
 
-        if ((counter++ & 0xf) == 0) {
-            markThreadIdle();
-        }
+        // We *always* populate the last error for now
+        LastError::get(txn->getClient()).setLastError(ex.getCode(), ex.what());
+    }
+
+    if (((*counter)++ & 0xf) == 0) {
+        markThreadIdle();
     }
+
+    return SessionCycleResult::kSourceNext;
 }
 
 }  // namespace mongo
@@ -32,6 +32,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/transport/service_entry_point.h"
+#include "mongo/transport/service_entry_point_utils.h"
 
 namespace mongo {
 
@@ -41,8 +42,9 @@ class TransportLayer;
 }  // namespace transport
 
 /**
- * The entry point from the TransportLayer into Mongos. startSession() spawns and
- * detaches a new thread for each incoming connection (transport::Session).
+ * The entry point from the TransportLayer into Mongos. startSession() hands each incoming
+ * connection (transport::Session) to the configured service executor, which runs its
+ * request/response cycles on a dedicated thread or on a shared worker pool.
  */
 class ServiceEntryPointMongos final : public ServiceEntryPoint {
     MONGO_DISALLOW_COPYING(ServiceEntryPointMongos);
@@ -55,7 +57,7 @@ public:
     void startSession(transport::SessionHandle session) override;
 
 private:
-    void _sessionLoop(const transport::SessionHandle& session);
+    SessionCycleResult _sessionCycle(const transport::SessionHandle& session, int64_t* counter);
 
     transport::TransportLayer* _tl;
 };
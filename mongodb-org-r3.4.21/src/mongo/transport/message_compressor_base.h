@@ -39,6 +39,7 @@ namespace mongo {
 enum class MessageCompressor : uint8_t {
     kNoop = 0,
     kSnappy = 1,
+    kZlib = 2,
     kExtended = 255,
 };
 
@@ -113,6 +114,31 @@ public:
         return _decompressBytesOut.loadRelaxed();
     }
 
+    /*
+     * This returns the number of microseconds spent in compressData
+     */
+    int64_t getCompressedMicros() const {
+        return _compressMicros.loadRelaxed();
+    }
+
+    /*
+     * This returns the number of microseconds spent in decompressData
+     */
+    int64_t getDecompressedMicros() const {
+        return _decompressMicros.loadRelaxed();
+    }
+
+    /*
+     * Called by the MessageCompressorManager to bump the time spent compressing and decompressing
+     */
+    void counterHitCompressMicros(int64_t micros) {
+        _compressMicros.addAndFetch(micros);
+    }
+
+    void counterHitDecompressMicros(int64_t micros) {
+        _decompressMicros.addAndFetch(micros);
+    }
+
 
 protected:
     /*
@@ -147,5 +173,7 @@ private:
 
     AtomicInt64 _decompressBytesIn;
     AtomicInt64 _decompressBytesOut;
+    AtomicInt64 _compressMicros;
+    AtomicInt64 _decompressMicros;
 };
 }  // namespace mongo
@@ -39,6 +39,7 @@
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
@@ -118,7 +119,9 @@ StatusWith<Message> MessageCompressorManager::compressMessage(const Message& msg
     compressionHeader.serialize(&output);
     ConstDataRange input(inputHeader.data(), inputHeader.data() + inputHeader.dataLen());
 
+    Timer timer;
     auto sws = compressor->compressData(input, output);
+    compressor->counterHitCompressMicros(timer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -158,7 +161,9 @@ StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& m
 
     DataRangeCursor output(outMessage.data(), outMessage.data() + outMessage.dataLen());
 
+    Timer timer;
     auto sws = compressor->decompressData(input, output);
+    compressor->counterHitDecompressMicros(timer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
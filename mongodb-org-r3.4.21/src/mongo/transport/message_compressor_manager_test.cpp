@@ -36,6 +36,7 @@
 #include "mongo/transport/message_compressor_noop.h"
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/message_compressor_snappy.h"
+#include "mongo/transport/message_compressor_zlib.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
@@ -225,6 +226,17 @@ TEST(SnappyMessageCompressor, Overflow) {
     checkOverflow(stdx::make_unique<SnappyMessageCompressor>());
 }
 
+TEST(ZlibMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, stdx::make_unique<ZlibMessageCompressor>());
+    checkFidelity(testMessage, stdx::make_unique<ZlibMessageCompressor>(1));
+    checkFidelity(testMessage, stdx::make_unique<ZlibMessageCompressor>(9));
+}
+
+TEST(ZlibMessageCompressor, Overflow) {
+    checkOverflow(stdx::make_unique<ZlibMessageCompressor>());
+}
+
 TEST(MessageCompressorManager, MessageSizeTooLarge) {
     auto registry = buildRegistry();
     MessageCompressorManager compManager(&registry);
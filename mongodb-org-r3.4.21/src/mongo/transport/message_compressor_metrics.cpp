@@ -35,6 +35,7 @@ namespace mongo {
 namespace {
 const auto kBytesIn = "bytesIn"_sd;
 const auto kBytesOut = "bytesOut"_sd;
+const auto kMicros = "micros"_sd;
 }  // namespace
 
 void appendMessageCompressionStats(BSONObjBuilder* b) {
@@ -51,12 +52,14 @@ void appendMessageCompressionStats(BSONObjBuilder* b) {
 
         BSONObjBuilder compressed(base.subobjStart("compressed"));
         compressed << kBytesIn << compressor->getCompressedBytesIn() << kBytesOut
-                   << compressor->getCompressedBytesOut();
+                   << compressor->getCompressedBytesOut() << kMicros
+                   << compressor->getCompressedMicros();
         compressed.doneFast();
 
         BSONObjBuilder decompressed(base.subobjStart("decompressed"));
         decompressed << kBytesIn << compressor->getDecompressedBytesIn() << kBytesOut
-                     << compressor->getDecompressedBytesOut();
+                     << compressor->getDecompressedBytesOut() << kMicros
+                     << compressor->getDecompressedMicros();
         decompressed.doneFast();
         base.doneFast();
     }
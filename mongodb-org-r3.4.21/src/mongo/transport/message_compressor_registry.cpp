@@ -34,6 +34,7 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/message_compressor_noop.h"
 #include "mongo/transport/message_compressor_snappy.h"
+#include "mongo/transport/message_compressor_zlib.h"
 #include "mongo/util/options_parser/option_section.h"
 
 #include <boost/algorithm/string/classification.hpp>
@@ -47,6 +48,8 @@ StringData getMessageCompressorName(MessageCompressor id) {
             return "noop"_sd;
         case MessageCompressor::kSnappy:
             return "snappy"_sd;
+        case MessageCompressor::kZlib:
+            return "zlib"_sd;
         default:
             fassert(40269, "Invalid message compressor ID");
     }
@@ -104,6 +107,14 @@ void MessageCompressorRegistry::setSupportedCompressors(std::vector<std::string>
     _compressorNames = std::move(names);
 }
 
+void MessageCompressorRegistry::setZlibCompressionLevel(int level) {
+    _zlibCompressionLevel = level;
+}
+
+int MessageCompressorRegistry::getZlibCompressionLevel() const {
+    return _zlibCompressionLevel;
+}
+
 Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell) {
     auto ret =
         options
@@ -115,6 +126,16 @@ Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell)
     if (forShell)
         ret.hidden();
 
+    auto& zlibLevel = options
+                         ->addOptionChaining("net.compression.zlibCompressionLevel",
+                                             "zlibCompressionLevel",
+                                             moe::Int,
+                                             "Compression level of the zlib network message "
+                                             "compressor, from 0 (none) to 9 (best)")
+                         .validRange(0, 9);
+    if (forShell)
+        zlibLevel.hidden();
+
     return Status::OK();
 }
 
@@ -128,6 +149,11 @@ Status storeMessageCompressionOptions(const moe::Environment& params) {
     auto& compressorFactory = MessageCompressorRegistry::get();
     compressorFactory.setSupportedCompressors(std::move(restrict));
 
+    if (params.count("net.compression.zlibCompressionLevel")) {
+        compressorFactory.setZlibCompressionLevel(
+            params["net.compression.zlibCompressionLevel"].as<int>());
+    }
+
     return Status::OK();
 }
 
@@ -109,12 +109,21 @@ public:
      */
     Status finalizeSupportedCompressors();
 
+    /*
+     * Sets the compression level of the zlib compressor. Should be called during option parsing,
+     * before the compressors are registered.
+     */
+    void setZlibCompressionLevel(int level);
+
+    int getZlibCompressionLevel() const;
+
 private:
     StringMap<MessageCompressorBase*> _compressorsByName;
     std::array<std::unique_ptr<MessageCompressorBase>,
                std::numeric_limits<MessageCompressorId>::max() + 1>
         _compressorsByIds;
     std::vector<std::string> _compressorNames;
+    int _zlibCompressionLevel = -1;  // zlib's default level.
 };
 
 Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell);
@@ -32,15 +32,21 @@
 
 #include "mongo/transport/service_entry_point_utils.h"
 
+#include "mongo/base/init.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/client.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/transport/service_executor_fixed.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/socket_exception.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/quick_exit.h"
 
 #ifdef __linux__  // TODO: consider making this ifndef _WIN32
@@ -55,27 +61,60 @@ namespace mongo {
 
 namespace {
 
-/**
- * This object takes ownership of transport::SessionHandle.
- */
-struct Context {
-    Context(transport::SessionHandle session,
-            stdx::function<void(const transport::SessionHandle&)> task)
-        : session(std::move(session)), task(std::move(task)) {}
+const char kServiceExecutorSynchronous[] = "synchronous";
+const char kServiceExecutorFixed[] = "fixed";
 
-    transport::SessionHandle session;
-    stdx::function<void(const transport::SessionHandle&)> task;
-};
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(serviceExecutor, std::string, kServiceExecutorSynchronous);
 
-void* runFunc(void* ptr) {
-    std::unique_ptr<Context> ctx(static_cast<Context*>(ptr));
+// Number of workers of the "fixed" service executor, where 0 means four workers per core. A worker
+// is occupied for the whole duration of a request, including lock and I/O waits, so the pool must
+// be large enough that requests waiting on each other (e.g. behind fsyncLock) can't fill it.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(serviceExecutorFixedPoolSize, int, 0);
 
-    auto tl = ctx->session->getTransportLayer();
-    Client::initThread("conn", ctx->session);
-    setThreadName(str::stream() << "conn" << ctx->session->id());
+MONGO_INITIALIZER(serviceExecutor)(InitializerContext*) {
+    if (serviceExecutor == kServiceExecutorFixed) {
+#ifndef __linux__
+        return Status(ErrorCodes::BadValue,
+                      "the fixed service executor is only supported on Linux");
+#endif
+    } else if (serviceExecutor != kServiceExecutorSynchronous) {
+        return Status(ErrorCodes::BadValue, "unsupported service executor: " + serviceExecutor);
+    }
 
+    if (serviceExecutorFixedPoolSize < 0) {
+        return Status(ErrorCodes::BadValue, "serviceExecutorFixedPoolSize must not be negative");
+    }
+    return Status::OK();
+}
+
+bool isServiceExecutorFixed() {
+    return serviceExecutor == kServiceExecutorFixed;
+}
+
+transport::ServiceExecutorFixed* getFixedServiceExecutor() {
+    static transport::ServiceExecutorFixed* const executor = [] {
+        size_t numWorkers = serviceExecutorFixedPoolSize;
+        if (numWorkers == 0) {
+            numWorkers = 4 * std::max(ProcessInfo().getNumCores(), 1u);
+        }
+
+        // Never destroyed, as sessions may still be running on it at process exit.
+        auto executor = new transport::ServiceExecutorFixed(numWorkers);
+        fassertStatusOK(40701, executor->start());
+        log() << "started fixed service executor with " << numWorkers << " workers";
+        return executor;
+    }();
+    return executor;
+}
+
+/**
+ * Runs 'task', logging any exception which should close the client connection. Returns false if
+ * such an exception was thrown.
+ */
+bool runReportingErrors(const stdx::function<void()>& task) {
     try {
-        ctx->task(ctx->session);
+        task();
+        return true;
     } catch (const AssertionException& e) {
         log() << "AssertionException handling request, closing client connection: " << e;
     } catch (const SocketException& e) {
@@ -87,26 +126,54 @@ void* runFunc(void* ptr) {
         error() << "Uncaught std::exception: " << e.what() << ", terminating";
         quickExit(EXIT_UNCAUGHT);
     }
+    return false;
+}
 
-    tl->end(ctx->session);
+void endSession(const transport::SessionHandle& session) {
+    auto tl = session->getTransportLayer();
+    tl->end(session);
 
     if (!serverGlobalParams.quiet) {
         auto conns = tl->sessionStats().numOpenSessions;
         const char* word = (conns == 1 ? " connection" : " connections");
-        log() << "end connection " << ctx->session->remote() << " (" << conns << word
+        log() << "end connection " << session->remote() << " (" << conns << word
               << " now open)";
     }
+}
+
+struct Context {
+    Context(transport::SessionHandle session,
+            stdx::function<void(const transport::SessionHandle&)> task,
+            ServiceContext::UniqueClient client = {})
+        : session(std::move(session)), task(std::move(task)), client(std::move(client)) {}
+
+    transport::SessionHandle session;
+    stdx::function<void(const transport::SessionHandle&)> task;
+
+    // Set when the session already has a Client, because it started out on a service executor.
+    ServiceContext::UniqueClient client;
+};
+
+void* runFunc(void* ptr) {
+    std::unique_ptr<Context> ctx(static_cast<Context*>(ptr));
+
+    if (ctx->client) {
+        Client::setCurrent(std::move(ctx->client));
+    } else {
+        Client::initThread("conn", ctx->session);
+        setThreadName(str::stream() << "conn" << ctx->session->id());
+    }
+
+    runReportingErrors([&] { ctx->task(ctx->session); });
+
+    endSession(ctx->session);
 
     Client::destroy();
 
     return nullptr;
 }
-}  // namespace
-
-void launchWrappedServiceEntryWorkerThread(
-    transport::SessionHandle session, stdx::function<void(const transport::SessionHandle&)> task) {
-    auto ctx = stdx::make_unique<Context>(std::move(session), std::move(task));
 
+void launchWorkerThread(std::unique_ptr<Context> ctx) {
     try {
 #ifndef __linux__  // TODO: consider making this ifdef _WIN32
         stdx::thread(stdx::bind(runFunc, ctx.get())).detach();
@@ -155,4 +222,108 @@ void launchWrappedServiceEntryWorkerThread(
     }
 }
 
+void runCyclesUntilEnd(const SessionCycleFn& cycle, const transport::SessionHandle& session) {
+    while (cycle(session) != SessionCycleResult::kEnd) {
+    }
+}
+
+/**
+ * A session whose cycles run on the fixed service executor. Between cycles the session's Client
+ * is detached from any thread and kept here.
+ */
+struct PooledSession {
+    PooledSession(transport::SessionHandle session, SessionCycleFn cycle)
+        : session(std::move(session)), cycle(std::move(cycle)) {}
+
+    transport::SessionHandle session;
+    SessionCycleFn cycle;
+    ServiceContext::UniqueClient client;
+};
+
+void runPooledCycle(std::shared_ptr<PooledSession> pooled);
+
+/**
+ * Schedules the next cycle of 'pooled' on the fixed service executor, waiting for the client to
+ * send a message first unless 'lastResult' is kContinue. The session's Client must be detached.
+ */
+void schedulePooledCycle(std::shared_ptr<PooledSession> pooled, SessionCycleResult lastResult) {
+    auto executor = getFixedServiceExecutor();
+    auto next = [pooled] { runPooledCycle(pooled); };
+
+    Status status = Status::OK();
+    if (lastResult == SessionCycleResult::kContinue) {
+        status = executor->schedule(std::move(next));
+    } else if (pooled->session->pollableFD() >= 0) {
+        status = executor->scheduleWhenReadable(pooled->session, std::move(next));
+    } else {
+        // Readiness of this session can't be polled for, most likely because it has negotiated
+        // TLS, so it continues on a thread of its own.
+        const auto cycle = pooled->cycle;
+        launchWorkerThread(stdx::make_unique<Context>(
+            pooled->session,
+            [cycle](const transport::SessionHandle& session) {
+                runCyclesUntilEnd(cycle, session);
+            },
+            std::move(pooled->client)));
+        return;
+    }
+
+    if (!status.isOK()) {
+        log() << "failed to schedule request for " << pooled->session->remote() << ": "
+              << status;
+    }
+}
+
+void runPooledCycle(std::shared_ptr<PooledSession> pooled) {
+    const std::string workerName = getThreadName().toString();
+    Client::setCurrent(std::move(pooled->client));
+
+    auto result = SessionCycleResult::kEnd;
+    if (!runReportingErrors([&] { result = pooled->cycle(pooled->session); })) {
+        result = SessionCycleResult::kEnd;
+    }
+
+    if (result == SessionCycleResult::kEnd) {
+        endSession(pooled->session);
+        Client::destroy();
+        setThreadName(workerName);
+        return;
+    }
+
+    pooled->client = Client::releaseCurrent();
+    setThreadName(workerName);
+
+    schedulePooledCycle(std::move(pooled), result);
+}
+
+}  // namespace
+
+void launchWrappedServiceEntryWorkerThread(
+    transport::SessionHandle session, stdx::function<void(const transport::SessionHandle&)> task) {
+    launchWorkerThread(stdx::make_unique<Context>(std::move(session), std::move(task)));
+}
+
+void launchServiceEntrySession(transport::SessionHandle session, SessionCycleFn cycle) {
+    if (!isServiceExecutorFixed()) {
+        launchWrappedServiceEntryWorkerThread(
+            std::move(session), [cycle](const transport::SessionHandle& session) {
+                runCyclesUntilEnd(cycle, session);
+            });
+        return;
+    }
+
+    auto pooled = std::make_shared<PooledSession>(std::move(session), std::move(cycle));
+    pooled->client = getGlobalServiceContext()->makeClient(
+        str::stream() << "conn" << pooled->session->id(), pooled->session);
+
+    schedulePooledCycle(std::move(pooled), SessionCycleResult::kSourceNext);
+}
+
+void appendServiceExecutorStats(BSONObjBuilder* bob) {
+    bob->append("executor", serviceExecutor);
+    if (isServiceExecutorFixed()) {
+        getFixedServiceExecutor()->appendStats(bob);
+    }
+}
+
 }  // namespace mongo
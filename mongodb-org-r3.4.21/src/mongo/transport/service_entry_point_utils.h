@@ -33,7 +33,40 @@
 
 namespace mongo {
 
+class BSONObjBuilder;
+
+/**
+ * The outcome of running one request/response cycle of a service entry session.
+ */
+enum class SessionCycleResult {
+    // The client must send another message before the next cycle can run.
+    kSourceNext,
+
+    // The next cycle can run immediately, without waiting on the client (e.g. exhaust cursors).
+    kContinue,
+
+    // The session is over and its connection should be closed.
+    kEnd,
+};
+
+using SessionCycleFn = stdx::function<SessionCycleResult(const transport::SessionHandle&)>;
+
 void launchWrappedServiceEntryWorkerThread(
     transport::SessionHandle session, stdx::function<void(const transport::SessionHandle&)> task);
 
+/**
+ * Runs 'cycle' for 'session' until it returns SessionCycleResult::kEnd, and then ends the session.
+ *
+ * With the default "synchronous" serviceExecutor, the session is given a dedicated worker thread
+ * for its whole lifetime. With the "fixed" serviceExecutor, each cycle runs on a shared pool of
+ * workers and the session is parked without a thread while it waits for the client. Sessions
+ * which cannot be parked (such as encrypted ones) are moved onto a dedicated thread.
+ */
+void launchServiceEntrySession(transport::SessionHandle session, SessionCycleFn cycle);
+
+/**
+ * Appends the serviceExecutor in use and, for pooled executors, its statistics to 'bob'.
+ */
+void appendServiceExecutorStats(BSONObjBuilder* bob);
+
 }  // namespace mongo
@@ -0,0 +1,296 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_fixed.h"
+
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+// Token used for the eventfd which interrupts the poller on shutdown.
+const uint64_t kWakeupToken = 0;
+
+// Maximum number of readiness events consumed by one call to epoll_wait.
+const int kMaxEventsPerWait = 256;
+
+// How often parked sessions are checked for having been closed. Closing a descriptor silently
+// removes it from the epoll set, so such sessions would otherwise never be woken.
+const Milliseconds kClosedSessionSweepInterval{1000};
+
+ThreadPool::Options makeWorkerPoolOptions(size_t numWorkers) {
+    ThreadPool::Options options;
+    options.poolName = "ServiceExecutorFixed";
+    options.threadNamePrefix = "worker-";
+    options.minThreads = numWorkers;
+    options.maxThreads = numWorkers;
+    return options;
+}
+
+}  // namespace
+
+ServiceExecutorFixed::ServiceExecutorFixed(size_t numWorkers)
+    : _numWorkers(numWorkers), _workers(makeWorkerPoolOptions(numWorkers)) {
+    invariant(_numWorkers > 0);
+}
+
+ServiceExecutorFixed::~ServiceExecutorFixed() {
+    shutdown();
+}
+
+Status ServiceExecutorFixed::start() {
+#ifdef __linux__
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd < 0) {
+        return {ErrorCodes::InternalError,
+                str::stream() << "epoll_create1 failed: " << errnoWithDescription()};
+    }
+
+    _wakeupFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_wakeupFd < 0) {
+        return {ErrorCodes::InternalError,
+                str::stream() << "eventfd failed: " << errnoWithDescription()};
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = kWakeupToken;
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeupFd, &event) != 0) {
+        return {ErrorCodes::InternalError,
+                str::stream() << "epoll_ctl failed: " << errnoWithDescription()};
+    }
+
+    _workers.startup();
+    _poller = stdx::thread([this] { _runPoller(); });
+    return Status::OK();
+#else
+    return {ErrorCodes::IllegalOperation, "The fixed service executor is only supported on Linux"};
+#endif
+}
+
+void ServiceExecutorFixed::shutdown() {
+    if (_inShutdown.swap(true)) {
+        return;
+    }
+
+#ifdef __linux__
+    if (_poller.joinable()) {
+        uint64_t one = 1;
+        ssize_t written = ::write(_wakeupFd, &one, sizeof(one));
+        invariant(written == sizeof(one));
+        _poller.join();
+    }
+
+    if (_wakeupFd >= 0) {
+        ::close(_wakeupFd);
+    }
+    if (_epollFd >= 0) {
+        ::close(_epollFd);
+    }
+#endif
+
+    _workers.shutdown();
+    _workers.join();
+
+    // Drop the parked sessions outside of the mutex, since releasing the last reference to a
+    // session closes its connection.
+    std::map<uint64_t, ParkedSession> parked;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        parked.swap(_parked);
+    }
+}
+
+Status ServiceExecutorFixed::schedule(Task task) {
+    if (_inShutdown.load()) {
+        return {ErrorCodes::ShutdownInProgress, "Service executor is shutting down"};
+    }
+
+    _queued.fetchAndAdd(1);
+    _totalScheduled.fetchAndAdd(1);
+
+    Timer sinceScheduled;
+    auto status = _workers.schedule([this, sinceScheduled, task] {
+        _queued.fetchAndSubtract(1);
+        _totalDispatchLatencyMicros.fetchAndAdd(sinceScheduled.micros());
+
+        Timer execution;
+        task();
+        _totalExecutionMicros.fetchAndAdd(execution.micros());
+        _totalExecuted.fetchAndAdd(1);
+    });
+
+    if (!status.isOK()) {
+        _queued.fetchAndSubtract(1);
+    }
+    return status;
+}
+
+Status ServiceExecutorFixed::scheduleWhenReadable(const SessionHandle& session, Task task) {
+#ifdef __linux__
+    if (_inShutdown.load()) {
+        return {ErrorCodes::ShutdownInProgress, "Service executor is shutting down"};
+    }
+
+    const int fd = session->pollableFD();
+    if (fd < 0) {
+        return schedule(std::move(task));
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    const uint64_t token = _nextToken++;
+
+    // Descriptors are registered with EPOLLONESHOT and never explicitly removed, because by the
+    // time a session is woken its descriptor may already have been closed and reused by another
+    // connection. A descriptor that is re-parked is therefore usually still in the set, disarmed.
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.u64 = token;
+    int ret = epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &event);
+    if (ret != 0 && errno == ENOENT) {
+        ret = epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    if (ret != 0) {
+        // The session can't be polled, most likely because it has just been closed. Let the task
+        // discover its state right away.
+        LOG(2) << "Failed to park session " << session->id() << ": " << errnoWithDescription();
+        lk.unlock();
+        return schedule(std::move(task));
+    }
+
+    _parked.emplace(token, ParkedSession{session, fd, std::move(task)});
+    _totalParked.fetchAndAdd(1);
+    return Status::OK();
+#else
+    MONGO_UNREACHABLE;
+#endif
+}
+
+void ServiceExecutorFixed::appendStats(BSONObjBuilder* bob) const {
+    size_t parked;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        parked = _parked.size();
+    }
+
+    bob->append("workers", static_cast<long long>(_numWorkers));
+    bob->append("queuedTasks", _queued.load());
+    bob->append("parkedSessions", static_cast<long long>(parked));
+    bob->append("totalScheduled", _totalScheduled.load());
+    bob->append("totalExecuted", _totalExecuted.load());
+    bob->append("totalParked", _totalParked.load());
+    bob->append("totalDispatchLatencyMicros", _totalDispatchLatencyMicros.load());
+    bob->append("totalExecutionMicros", _totalExecutionMicros.load());
+}
+
+void ServiceExecutorFixed::_collectClosedSessions(std::vector<ParkedSession>* ready) {
+    for (auto it = _parked.begin(); it != _parked.end();) {
+        if (it->second.session->pollableFD() != it->second.fd) {
+            ready->push_back(std::move(it->second));
+            it = _parked.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ServiceExecutorFixed::_runPoller() {
+#ifdef __linux__
+    setThreadName("ServiceExecutorFixedPoller");
+
+    std::vector<epoll_event> events(kMaxEventsPerWait);
+    Date_t lastSweep = Date_t::now();
+
+    while (!_inShutdown.load()) {
+        int numEvents = epoll_wait(_epollFd,
+                                   events.data(),
+                                   kMaxEventsPerWait,
+                                   durationCount<Milliseconds>(kClosedSessionSweepInterval));
+        if (numEvents < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            severe() << "epoll_wait failed: " << errnoWithDescription();
+            fassertFailed(40700);
+        }
+
+        std::vector<ParkedSession> ready;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            for (int i = 0; i < numEvents; ++i) {
+                const uint64_t token = events[i].data.u64;
+                if (token == kWakeupToken) {
+                    continue;
+                }
+
+                // The session may already have been woken by a sweep.
+                auto it = _parked.find(token);
+                if (it == _parked.end()) {
+                    continue;
+                }
+                ready.push_back(std::move(it->second));
+                _parked.erase(it);
+            }
+
+            const auto now = Date_t::now();
+            if (now - lastSweep >= kClosedSessionSweepInterval) {
+                _collectClosedSessions(&ready);
+                lastSweep = now;
+            }
+        }
+
+        for (auto&& parked : ready) {
+            auto status = schedule(std::move(parked.task));
+            if (!status.isOK()) {
+                LOG(2) << "Dropping session " << parked.session->id() << ": " << status;
+            }
+        }
+    }
+#endif
+}
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,135 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/session.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+namespace transport {
+
+/**
+ * A service executor which multiplexes sessions over a fixed pool of worker threads.
+ *
+ * Instead of dedicating a thread to each session for its whole lifetime, an idle session is
+ * parked on an epoll set and a worker is only assigned to it once its client has sent a request.
+ * The number of threads servicing clients is therefore bounded by the size of the pool rather
+ * than by the number of open connections.
+ *
+ * Parking sessions is only supported on Linux.
+ */
+class ServiceExecutorFixed {
+    MONGO_DISALLOW_COPYING(ServiceExecutorFixed);
+
+public:
+    using Task = stdx::function<void()>;
+
+    explicit ServiceExecutorFixed(size_t numWorkers);
+    ~ServiceExecutorFixed();
+
+    /**
+     * Starts the worker threads and the thread polling parked sessions for readiness.
+     */
+    Status start();
+
+    /**
+     * Stops the executor. Tasks already queued for a worker are run, sessions which are parked
+     * are released without running their tasks.
+     */
+    void shutdown();
+
+    /**
+     * Runs 'task' on the next available worker thread.
+     */
+    Status schedule(Task task);
+
+    /**
+     * Parks 'session' until it has data available to be sourced, and then runs 'task' on the next
+     * available worker thread. 'task' is also run if the session is closed while parked.
+     *
+     * If the session has no pollableFD(), for instance because it was closed concurrently,
+     * 'task' is scheduled right away.
+     */
+    Status scheduleWhenReadable(const SessionHandle& session, Task task);
+
+    /**
+     * Appends the number of workers, the queue depth, the number of parked sessions and the
+     * cumulative dispatch latency and execution time of tasks to 'bob'.
+     */
+    void appendStats(BSONObjBuilder* bob) const;
+
+private:
+    struct ParkedSession {
+        SessionHandle session;
+        int fd;
+        Task task;
+    };
+
+    void _runPoller();
+
+    // Returns parked sessions whose descriptor no longer matches the one they were parked on,
+    // which means they were closed while parked. Must be called with _mutex held.
+    void _collectClosedSessions(std::vector<ParkedSession>* ready);
+
+    const size_t _numWorkers;
+    ThreadPool _workers;
+
+    AtomicWord<bool> _inShutdown{false};
+
+    int _epollFd = -1;
+    int _wakeupFd = -1;
+    stdx::thread _poller;
+
+    // Protects _parked and _nextToken.
+    mutable stdx::mutex _mutex;
+    std::map<uint64_t, ParkedSession> _parked;
+    uint64_t _nextToken = 1;
+
+    AtomicInt64 _queued{0};
+    AtomicInt64 _totalScheduled{0};
+    AtomicInt64 _totalExecuted{0};
+    AtomicInt64 _totalParked{0};
+    AtomicInt64 _totalDispatchLatencyMicros{0};
+    AtomicInt64 _totalExecutionMicros{0};
+};
+
+}  // namespace transport
+}  // namespace mongo
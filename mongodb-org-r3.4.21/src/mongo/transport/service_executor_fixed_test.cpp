@@ -0,0 +1,190 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <unistd.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/transport/mock_session.h"
+#include "mongo/transport/service_executor_fixed.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/notification.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+/**
+ * A MockSession which is readable whenever the read end of a pipe is.
+ */
+class PipeSession : public MockSession {
+public:
+    static std::shared_ptr<PipeSession> create() {
+        return std::shared_ptr<PipeSession>(new PipeSession());
+    }
+
+    ~PipeSession() {
+        closeReadEnd();
+        ::close(_fds[1]);
+    }
+
+    int pollableFD() const override {
+        return _readFd.load();
+    }
+
+    void makeReadable() {
+        char c = 'x';
+        ASSERT_EQ(1, ::write(_fds[1], &c, 1));
+    }
+
+    void closeReadEnd() {
+        int fd = _readFd.swap(-1);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+private:
+    PipeSession() : MockSession(nullptr) {
+        invariant(::pipe(_fds) == 0);
+        _readFd.store(_fds[0]);
+    }
+
+    int _fds[2];
+    AtomicInt32 _readFd{-1};
+};
+
+class ServiceExecutorFixedTest : public unittest::Test {
+public:
+    void setUp() override {
+        _executor = stdx::make_unique<ServiceExecutorFixed>(4);
+        ASSERT_OK(_executor->start());
+    }
+
+    void tearDown() override {
+        _executor->shutdown();
+    }
+
+    ServiceExecutorFixed* executor() {
+        return _executor.get();
+    }
+
+    BSONObj stats() {
+        BSONObjBuilder bob;
+        _executor->appendStats(&bob);
+        return bob.obj();
+    }
+
+private:
+    std::unique_ptr<ServiceExecutorFixed> _executor;
+};
+
+TEST_F(ServiceExecutorFixedTest, ScheduledTasksRun) {
+    const int kNumTasks = 100;
+    AtomicInt32 numRun{0};
+    Notification<void> allRun;
+
+    for (int i = 0; i < kNumTasks; ++i) {
+        ASSERT_OK(executor()->schedule([&] {
+            if (numRun.addAndFetch(1) == kNumTasks) {
+                allRun.set();
+            }
+        }));
+    }
+
+    allRun.get();
+    executor()->shutdown();
+
+    auto s = stats();
+    ASSERT_EQ(4, s["workers"].numberLong());
+    ASSERT_EQ(kNumTasks, s["totalScheduled"].numberLong());
+    ASSERT_EQ(kNumTasks, s["totalExecuted"].numberLong());
+    ASSERT_EQ(0, s["queuedTasks"].numberLong());
+}
+
+TEST_F(ServiceExecutorFixedTest, ParkedSessionRunsOnceReadable) {
+    auto session = PipeSession::create();
+    Notification<void> ran;
+
+    ASSERT_OK(executor()->scheduleWhenReadable(session, [&] { ran.set(); }));
+    ASSERT_EQ(1, stats()["parkedSessions"].numberLong());
+    ASSERT_FALSE(static_cast<bool>(ran));
+
+    session->makeReadable();
+    ran.get();
+
+    ASSERT_EQ(0, stats()["parkedSessions"].numberLong());
+    ASSERT_EQ(1, stats()["totalParked"].numberLong());
+}
+
+TEST_F(ServiceExecutorFixedTest, SessionCanBeParkedAgain) {
+    auto session = PipeSession::create();
+    session->makeReadable();
+
+    for (int i = 0; i < 3; ++i) {
+        Notification<void> ran;
+        ASSERT_OK(executor()->scheduleWhenReadable(session, [&] { ran.set(); }));
+        ran.get();
+    }
+
+    ASSERT_EQ(3, stats()["totalParked"].numberLong());
+}
+
+TEST_F(ServiceExecutorFixedTest, ParkedSessionRunsWhenClosed) {
+    auto session = PipeSession::create();
+    Notification<void> ran;
+
+    ASSERT_OK(executor()->scheduleWhenReadable(session, [&] { ran.set(); }));
+    session->closeReadEnd();
+    ran.get();
+
+    ASSERT_EQ(0, stats()["parkedSessions"].numberLong());
+}
+
+TEST_F(ServiceExecutorFixedTest, UnpollableSessionRunsImmediately) {
+    auto session = PipeSession::create();
+    session->closeReadEnd();
+    Notification<void> ran;
+
+    ASSERT_OK(executor()->scheduleWhenReadable(session, [&] { ran.set(); }));
+    ran.get();
+
+    ASSERT_EQ(0, stats()["totalParked"].numberLong());
+}
+
+TEST_F(ServiceExecutorFixedTest, ScheduleFailsAfterShutdown) {
+    executor()->shutdown();
+    ASSERT_EQ(ErrorCodes::ShutdownInProgress, executor()->schedule([] {}));
+}
+
+}  // namespace
+}  // namespace transport
+}  // namespace mongo
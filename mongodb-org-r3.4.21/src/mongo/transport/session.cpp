@@ -71,5 +71,9 @@ MessageCompressorManager& Session::getCompressorManager() {
     return _messageCompressorManager;
 }
 
+int Session::pollableFD() const {
+    return -1;
+}
+
 }  // namespace transport
 }  // namespace mongo
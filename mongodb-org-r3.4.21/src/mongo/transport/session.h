@@ -137,6 +137,13 @@ public:
      */
     virtual MessageCompressorManager& getCompressorManager();
 
+    /**
+     * Return a native descriptor which becomes readable once a Message can be sourced from this
+     * Session without blocking on the network, or -1 if this Session cannot be polled for
+     * readiness (for example because it is closed or encrypted).
+     */
+    virtual int pollableFD() const;
+
 protected:
     /**
      * Construct a new session.
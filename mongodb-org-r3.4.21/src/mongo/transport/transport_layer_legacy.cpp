@@ -95,6 +95,14 @@ TransportLayerLegacy::LegacySession::~LegacySession() {
     _tl->_destroy(*this);
 }
 
+int TransportLayerLegacy::LegacySession::pollableFD() const {
+    stdx::lock_guard<stdx::mutex> lk(_connection->closeMutex);
+    if (_connection->closed) {
+        return -1;
+    }
+    return _connection->amp->pollableFD();
+}
+
 TransportLayerLegacy::LegacyTicket::LegacyTicket(const LegacySessionHandle& session,
                                                  Date_t expiration,
                                                  WorkHandle work)
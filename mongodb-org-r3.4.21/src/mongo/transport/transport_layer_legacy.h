@@ -152,6 +152,8 @@ private:
             return _connection.get();
         }
 
+        int pollableFD() const override;
+
         void setIter(SessionEntry it) {
             _entry = std::move(it);
         }
@@ -31,186 +31,114 @@
 
 #include "mongo/util/concurrency/ticketholder.h"
 
-#include <iostream>
+#include <algorithm>
 
-#include "mongo/util/log.h"
+#include "mongo/util/assert_util.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
-#if defined(__linux__)
-namespace {
-void _check(int ret) {
-    if (ret == 0)
-        return;
-    int err = errno;
-    severe() << "error in Ticketholder: " << errnoWithDescription(err);
-    fassertFailed(28604);
-}
-}
+TicketHolder::TicketHolder(int num) : _available(num), _outof(num) {}
 
-TicketHolder::TicketHolder(int num) : _outof(num) {
-    _check(sem_init(&_sem, 0, num));
-}
-
-TicketHolder::~TicketHolder() {
-    _check(sem_destroy(&_sem));
-}
+TicketHolder::~TicketHolder() = default;
 
 bool TicketHolder::tryAcquire() {
-    while (0 != sem_trywait(&_sem)) {
-        if (errno == EAGAIN)
-            return false;
-        if (errno != EINTR)
-            _check(-1);
+    // Don't take a ticket ahead of those who are waiting for one.
+    if (_numWaiters.load() > 0) {
+        return false;
     }
-    return true;
+    return _tryAcquireAvailable();
 }
 
 void TicketHolder::waitForTicket() {
-    while (0 != sem_wait(&_sem)) {
-        if (errno != EINTR)
-            _check(-1);
+    if (!tryAcquire()) {
+        invariant(_waitInLine(Date_t::max()));
     }
 }
 
 bool TicketHolder::waitForTicketUntil(Date_t until) {
-    const long long millisSinceEpoch = until.toMillisSinceEpoch();
-    struct timespec ts;
-
-    ts.tv_sec = millisSinceEpoch / 1000;
-    ts.tv_nsec = (millisSinceEpoch % 1000) * (1000 * 1000);
-    while (0 != sem_timedwait(&_sem, &ts)) {
-        if (errno == ETIMEDOUT)
-            return false;
-
-        if (errno != EINTR)
-            _check(-1);
-    }
-    return true;
+    return tryAcquire() || _waitInLine(until);
 }
 
 void TicketHolder::release() {
-    _check(sem_post(&_sem));
+    _available.fetchAndAdd(1);
+
+    // A waiter which counted itself before our increment is handed the ticket here, and one which
+    // counts itself after it finds the ticket available.
+    if (_numWaiters.load() > 0) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _grantToWaiters(lk);
+    }
 }
 
 Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_resizeMutex);
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
 
     if (newSize < 5)
         return Status(ErrorCodes::BadValue,
                       str::stream() << "Minimum value for semaphore is 5; given " << newSize);
 
-    if (newSize > SEM_VALUE_MAX)
-        return Status(ErrorCodes::BadValue,
-                      str::stream() << "Maximum value for semaphore is " << SEM_VALUE_MAX
-                                    << "; given "
-                                    << newSize);
-
-    while (_outof.load() < newSize) {
-        release();
-        _outof.fetchAndAdd(1);
-    }
-
-    while (_outof.load() > newSize) {
-        waitForTicket();
-        _outof.subtractAndFetch(1);
-    }
-
-    invariant(_outof.load() == newSize);
+    _available.fetchAndAdd(newSize - _outof.load());
+    _outof.store(newSize);
+    _grantToWaiters(lk);
     return Status::OK();
 }
 
 int TicketHolder::available() const {
-    int val = 0;
-    _check(sem_getvalue(&_sem, &val));
-    return val;
+    return std::max(_available.load(), 0);
 }
 
 int TicketHolder::used() const {
-    return outof() - available();
+    return outof() - _available.load();
 }
 
 int TicketHolder::outof() const {
     return _outof.load();
 }
 
-#else
-
-TicketHolder::TicketHolder(int num) : _outof(num), _num(num) {}
-
-TicketHolder::~TicketHolder() = default;
-
-bool TicketHolder::tryAcquire() {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-    return _tryAcquire();
-}
-
-void TicketHolder::waitForTicket() {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    while (!_tryAcquire()) {
-        _newTicket.wait(lk);
+bool TicketHolder::_tryAcquireAvailable() {
+    int available = _available.load();
+    while (available > 0) {
+        const int previous = _available.compareAndSwap(available, available - 1);
+        if (previous == available) {
+            return true;
+        }
+        available = previous;
     }
+    return false;
 }
 
-bool TicketHolder::waitForTicketUntil(Date_t until) {
+bool TicketHolder::_waitInLine(Date_t until) {
     stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    return _newTicket.wait_until(lk, until.toSystemTimePoint(), [this] { return _tryAcquire(); });
-}
-
-void TicketHolder::release() {
-    {
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
-        _num++;
+    _numWaiters.fetchAndAdd(1);
+    ON_BLOCK_EXIT([this] { _numWaiters.fetchAndSubtract(1); });
+
+    // Tickets released before we counted ourselves go to the front of the queue, which is us if
+    // nobody else is waiting.
+    Waiter waiter;
+    _waiters.push_back(&waiter);
+    _grantToWaiters(lk);
+    while (!waiter.granted) {
+        if (until == Date_t::max()) {
+            waiter.cv.wait(lk);
+        } else if (waiter.cv.wait_until(lk, until.toSystemTimePoint()) ==
+                       stdx::cv_status::timeout &&
+                   !waiter.granted) {
+            _waiters.erase(std::find(_waiters.begin(), _waiters.end(), &waiter));
+            return false;
+        }
     }
-    _newTicket.notify_one();
+    return true;
 }
 
-Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-
-    int used = _outof.load() - _num;
-    if (used > newSize) {
-        std::stringstream ss;
-        ss << "can't resize since we're using (" << used << ") "
-           << "more than newSize(" << newSize << ")";
-
-        std::string errmsg = ss.str();
-        log() << errmsg;
-        return Status(ErrorCodes::BadValue, errmsg);
+void TicketHolder::_grantToWaiters(WithLock) {
+    while (!_waiters.empty() && _tryAcquireAvailable()) {
+        Waiter* waiter = _waiters.front();
+        _waiters.pop_front();
+        waiter->granted = true;
+        waiter->cv.notify_one();
     }
-
-    _outof.store(newSize);
-    _num = _outof.load() - used;
-
-    // Potentially wasteful, but easier to see is correct
-    _newTicket.notify_all();
-    return Status::OK();
 }
 
-int TicketHolder::available() const {
-    return _num;
-}
-
-int TicketHolder::used() const {
-    return outof() - _num;
-}
-
-int TicketHolder::outof() const {
-    return _outof.load();
-}
-
-bool TicketHolder::_tryAcquire() {
-    if (_num <= 0) {
-        if (_num < 0) {
-            std::cerr << "DISASTER! in TicketHolder" << std::endl;
-        }
-        return false;
-    }
-    _num--;
-    return true;
-}
-#endif
-}
+}  // namespace mongo
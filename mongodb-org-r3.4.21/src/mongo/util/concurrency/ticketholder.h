@@ -26,18 +26,25 @@
  */
 #pragma once
 
-#if defined(__linux__)
-#include <semaphore.h>
-#endif
+#include <deque>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
 
+/**
+ * Hands out a limited number of tickets. While nobody is waiting, a ticket is taken or returned
+ * with a single atomic operation on the count of available tickets. Threads which have to wait
+ * queue up and are served in the order they arrived: a returned ticket goes straight to the
+ * longest waiter, and tryAcquire() doesn't take a ticket ahead of them.
+ */
 class TicketHolder {
     MONGO_DISALLOW_COPYING(TicketHolder);
 
@@ -53,6 +60,10 @@ public:
 
     void release();
 
+    /**
+     * Changes the number of tickets. Shrinking takes effect as tickets in use are released, so
+     * available() stays at 0 until used() drops below the new size.
+     */
     Status resize(int newSize);
 
     int available() const;
@@ -61,21 +72,46 @@ public:
 
     int outof() const;
 
-private:
-#if defined(__linux__)
-    mutable sem_t _sem;
+    /**
+     * The number of threads waiting for a ticket.
+     */
+    int waiting() const {
+        return _numWaiters.load();
+    }
 
-    // You can read _outof without a lock, but have to hold _resizeMutex to change.
+private:
+    struct Waiter {
+        stdx::condition_variable cv;
+        bool granted = false;
+    };
+
+    /**
+     * Takes one of the available tickets, if there is one.
+     */
+    bool _tryAcquireAvailable();
+
+    /**
+     * Queues up for a ticket until 'until', or without a time limit if it is Date_t::max().
+     * Returns whether a ticket was acquired.
+     */
+    bool _waitInLine(Date_t until);
+
+    /**
+     * Hands available tickets to the waiters at the front of the queue.
+     */
+    void _grantToWaiters(WithLock);
+
+    // The number of tickets not in use. It is negative while more tickets are in use than there
+    // are after resize() made them fewer.
+    AtomicInt32 _available;
     AtomicInt32 _outof;
-    stdx::mutex _resizeMutex;
-#else
-    bool _tryAcquire();
 
-    AtomicInt32 _outof;
-    int _num;
+    // The number of threads in _waitInLine(). A release() which sees none needn't lock '_mutex',
+    // because a thread about to queue up checks '_available' after counting itself here.
+    AtomicInt32 _numWaiters;
+
     stdx::mutex _mutex;
-    stdx::condition_variable _newTicket;
-#endif
+    std::deque<Waiter*> _waiters;
 };
 
 class ScopedTicket {
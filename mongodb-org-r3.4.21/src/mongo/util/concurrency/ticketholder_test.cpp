@@ -31,8 +31,16 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace {
 using namespace mongo;
@@ -71,4 +79,115 @@ TEST(TicketholderTest, BasicTimeout) {
     holder.release();
     ASSERT_EQ(holder.used(), 0);
 }
+
+TEST(TicketholderTest, WaitersAreServedInOrder) {
+    TicketHolder holder(1);
+    holder.waitForTicket();
+
+    const int numWaiters = 4;
+    stdx::mutex mutex;
+    std::vector<int> order;
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < numWaiters; i++) {
+        threads.emplace_back([&holder, &mutex, &order, i] {
+            holder.waitForTicket();
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                order.push_back(i);
+            }
+            holder.release();
+        });
+
+        // Don't start the next thread before this one has queued up.
+        while (holder.waiting() < i + 1) {
+            sleepmillis(1);
+        }
+    }
+
+    // A released ticket must not be taken ahead of the queue.
+    ASSERT_FALSE(holder.tryAcquire());
+    ASSERT_FALSE(holder.waitForTicketUntil(Date_t::now() + Milliseconds(5)));
+    ASSERT_EQ(holder.waiting(), numWaiters);
+
+    holder.release();
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(holder.waiting(), 0);
+    ASSERT_EQ(holder.used(), 0);
+    ASSERT_EQ(order.size(), size_t(numWaiters));
+    for (int i = 0; i < numWaiters; i++) {
+        ASSERT_EQ(order[i], i);
+    }
+}
+
+TEST(TicketholderTest, ResizeShrinksAsTicketsAreReleased) {
+    TicketHolder holder(6);
+    for (int i = 0; i < 6; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    ASSERT_EQ(holder.resize(4).code(), ErrorCodes::BadValue);
+    ASSERT_OK(holder.resize(5));
+    ASSERT_EQ(holder.outof(), 5);
+    ASSERT_EQ(holder.used(), 6);
+    ASSERT_EQ(holder.available(), 0);
+
+    holder.release();
+    ASSERT_FALSE(holder.tryAcquire());
+    holder.release();
+    ASSERT_EQ(holder.used(), 4);
+    ASSERT_EQ(holder.available(), 1);
+
+    ASSERT_OK(holder.resize(7));
+    ASSERT_EQ(holder.available(), 3);
+    for (int i = 0; i < 3; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+    ASSERT_FALSE(holder.tryAcquire());
+}
+
+TEST(TicketholderTest, GrowingWakesWaiters) {
+    TicketHolder holder(5);
+    for (int i = 0; i < 5; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    stdx::thread waiter([&holder] { holder.waitForTicket(); });
+    while (holder.waiting() < 1) {
+        sleepmillis(1);
+    }
+
+    ASSERT_OK(holder.resize(6));
+    waiter.join();
+    ASSERT_EQ(holder.used(), 6);
+    ASSERT_EQ(holder.available(), 0);
+}
+
+TEST(TicketholderTest, Throughput) {
+    const int iterations = 200 * 1000;
+    for (int numThreads = 1; numThreads <= 8; numThreads *= 2) {
+        TicketHolder holder(4);
+        std::vector<stdx::thread> threads;
+
+        Timer timer;
+        for (int i = 0; i < numThreads; i++) {
+            threads.emplace_back([&holder] {
+                for (int j = 0; j < iterations; j++) {
+                    holder.waitForTicket();
+                    holder.release();
+                }
+            });
+        }
+        for (auto&& thread : threads) {
+            thread.join();
+        }
+
+        const long long micros = std::max(timer.micros(), 1LL);
+        log() << numThreads << " thread(s), 4 tickets: "
+              << (1000 * 1000LL * iterations * numThreads) / micros << " acquisitions/sec";
+        ASSERT_EQ(holder.used(), 0);
+    }
+}
 }  // namespace
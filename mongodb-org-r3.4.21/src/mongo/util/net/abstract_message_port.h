@@ -131,6 +131,12 @@ public:
      */
     virtual bool isStillConnected() const = 0;
 
+    /**
+     * The descriptor which may be polled for readability to learn when recv() can make progress,
+     * or -1 if there is no such descriptor (for example, because the connection is encrypted).
+     */
+    virtual int pollableFD() const = 0;
+
     /**
      * Point in time (in micro seconds) when this was created.
      */
@@ -609,6 +609,13 @@ bool ASIOMessagingPort::isStillConnected() const {
     return _getSocket().is_open();
 }
 
+int ASIOMessagingPort::pollableFD() const {
+    if (_isEncrypted || !_getSocket().is_open()) {
+        return -1;
+    }
+    return _getSocket().native_handle();
+}
+
 uint64_t ASIOMessagingPort::getSockCreationMicroSec() const {
     return _creationTime;
 }
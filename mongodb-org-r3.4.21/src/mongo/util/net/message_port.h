@@ -132,6 +132,10 @@ public:
         return _psock->isStillConnected();
     }
 
+    int pollableFD() const override {
+        return _psock->pollableFD();
+    }
+
     uint64_t getSockCreationMicroSec() const override {
         return _psock->getSockCreationMicroSec();
     }
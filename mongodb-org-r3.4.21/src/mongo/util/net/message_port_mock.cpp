@@ -84,6 +84,10 @@ bool MessagingPortMock::isStillConnected() const {
     return true;
 }
 
+int MessagingPortMock::pollableFD() const {
+    return -1;
+}
+
 void MessagingPortMock::setLogLevel(logger::LogSeverity logLevel) {}
 
 void MessagingPortMock::clearCounters() {}
@@ -182,6 +182,20 @@ public:
         return _fd;
     }
 
+    /**
+     * Returns the descriptor which may be polled for readability before calling recv(), or -1 if
+     * readability of the descriptor does not reliably indicate that recv() can make progress.
+     * This is the case once the socket is encrypted, as decrypted bytes may already be buffered.
+     */
+    int pollableFD() const {
+#ifdef MONGO_CONFIG_SSL
+        if (_sslConnection) {
+            return -1;
+        }
+#endif
+        return _fd;
+    }
+
     /**
      * This sets the Sock's socket descriptor to be invalid and returns the old descriptor. This
      * only gets called in listen.cpp in Listener::_accepted(). This gets called on the listener